@@ -1,11 +1,13 @@
 #version 410 core
 
 layout(location = 0) in vec4 a_Position;
-layout(location = 3) in int a_Selected;
 
 out vec4 v_Color;
 
 uniform mat4 u_VP;
+// One selection bit per vertex, indexed by vertex
+uniform usamplerBuffer u_Selection;
+uniform bool u_ShowSelection;
 
 const float pointSize = 20.0;
 
@@ -16,5 +18,12 @@ void main()
 {
     gl_Position = u_VP * a_Position;
     gl_PointSize = pointSize;
-    v_Color = (a_Selected != 0) ? selectedColor : color;
+
+    bool selected = false;
+    if (u_ShowSelection)
+    {
+        uint word = texelFetch(u_Selection, gl_VertexID / 32).r;
+        selected = ((word >> uint(gl_VertexID % 32)) & 1u) != 0u;
+    }
+    v_Color = selected ? selectedColor : color;
 }
\ No newline at end of file
@@ -0,0 +1,23 @@
+#version 410 core
+
+in vec2 v_TexCoords;
+out vec4 FragColor;
+
+uniform sampler2D u_Texture;
+// The corners of the view of the camera in texture coordinates
+uniform vec4 u_View;
+
+const vec4 viewColor = vec4(1.0, 0.5, 0.0, 1.0);
+
+void main()
+{
+    // Outline the view with a line one pixel wide
+    vec2 pixel = fwidth(v_TexCoords);
+    bool inOutline =
+        all(greaterThanEqual(v_TexCoords, u_View.xy - pixel)) &&
+        all(lessThanEqual(v_TexCoords, u_View.zw + pixel)) &&
+        !(all(greaterThan(v_TexCoords, u_View.xy)) &&
+          all(lessThan(v_TexCoords, u_View.zw)));
+
+    FragColor = inOutline ? viewColor : texture(u_Texture, v_TexCoords);
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+#version 410 core
+
+layout(location = 0) in vec4 a_Position;
+layout(location = 2) in vec2 a_TexCoords;
+
+out vec2 v_TexCoords;
+
+// The corners of the minimap in normalized device coordinates
+uniform vec4 u_Rect;
+
+void main()
+{
+    gl_Position = vec4(mix(u_Rect.xy, u_Rect.zw, a_Position.xy), 0.0, 1.0);
+    v_TexCoords = a_TexCoords;
+}
\ No newline at end of file
@@ -0,0 +1,7 @@
+#version 410 core
+
+layout(location = 0) in vec4 a_Position;
+// The position of the instance
+layout(location = 3) in vec2 a_Offset;
+
+void main() { gl_Position = a_Position + vec4(a_Offset, 0.0, 0.0); }
\ No newline at end of file
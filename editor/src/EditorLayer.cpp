@@ -1,7 +1,12 @@
 #include "EditorLayer.h"
 
+#include <algorithm>
+#include <fstream>
 #include <vector>
 
+#include "io/UdmfReader.h"
+#include "io/WadMapReader.h"
+#include "map/IntersectionSweep.h"
 #include "utils/macros.h"
 
 using namespace Engine;
@@ -10,7 +15,13 @@ EditorLayer::EditorLayer()
     : camera(
           {0.0f, 0.0f, 1.0f}, Application::getInstance().getWindow().getWidth(),
           Application::getInstance().getWindow().getHeight(), 1.0f, 0.5f, 3.0f),
-      gridSpacing(40.0f)
+      gridSpacing(40.0f),
+      sectorDetector(map.getTopology()),
+      validator(threadPool),
+      generator(threadPool),
+      prefabs(map),
+      renderCache(map.getTopology()),
+      minimap(map)
 {
     // Compile shaders
     lineVertexShader.addShader(ShaderType::VERTEX,
@@ -30,14 +41,59 @@ EditorLayer::EditorLayer()
                                   "res/shaders/line_vertex.frag");
     phantomVertexShader.compileShader();
 
+    prefabShader.addShader(ShaderType::VERTEX, "res/shaders/prefab.vert");
+    prefabShader.addShader(ShaderType::GEOMETRY, "res/shaders/line.geom");
+    prefabShader.addShader(ShaderType::FRAGMENT, "res/shaders/line.frag");
+    prefabShader.compileShader();
+
+    // Create the map mesh and the selection bitfields read by its shaders
+    mapMesh = std::make_unique<DynamicMesh>("map", MeshType::LINES);
+    vertexSelectionBuffer = std::make_unique<TextureBuffer>();
+    lineSelectionBuffer = std::make_unique<TextureBuffer>();
+
+    // Create the offscreen texture the grid and the map are cached in
+    Window& window = Application::getInstance().getWindow();
+    staticLayer =
+        std::make_unique<Framebuffer>(window.getWidth(), window.getHeight());
+
     // Add event handlers
     dispatcher.addHandler<MouseScrolledEvent>([this](MouseScrolledEvent& event)
                                               { onMouseScroll(event); });
     dispatcher.addHandler<MouseButtonPressedEvent>(
         [this](MouseButtonPressedEvent& event) { onMouseButtonPress(event); });
+    dispatcher.addHandler<MouseButtonReleasedEvent>(
+        [this](MouseButtonReleasedEvent& event)
+        { onMouseButtonRelease(event); });
 
     dispatcher.addHandler<KeyReleasedEvent>([this](KeyReleasedEvent& event)
                                             { onKeyRelease(event); });
+
+    // Mirror every edit into the render cache, then restore the map saved by
+    // the last session before the history and the journal record edits
+    map.addListener(&renderCache);
+    map.addListener(&minimap);
+    map.addListener(&sectorDetector);
+    map.addListener(&prefabs);
+    journal.open(map, MAP_PATH);
+    map.addListener(&history);
+    map.addListener(&journal);
+
+    // The sectors found in the restored map are not the user's to undo
+    sectorDetector.update(map);
+    history.clear();
+
+    // Add selection handlers
+    selectionManager.setHandlers(
+        [this](MapElement element) { selectElement(element, true); },
+        [this](MapElement element) { selectElement(element, false); },
+        [this](MapElement element) { deleteElement(element); });
+}
+
+EditorLayer::~EditorLayer()
+{
+    // Closing the chunked map may page chunks in, which the other listeners
+    // follow, so it is closed before they are destroyed
+    streamer.close();
 }
 
 void EditorLayer::onAttach() {}
@@ -46,13 +102,22 @@ void EditorLayer::onDetach() {}
 
 void EditorLayer::onUpdate(float deltaTime)
 {
+    journal.update(map.getStore());
     camera.onUpdate(deltaTime);
-    grid.draw(gridSpacing, camera);
-    drawComponents();
+    if (streamer.isOpen()) pageChunks();
+    syncBuffers();
+    if (isStaticLayerCached)
+        drawStaticLayer();
+    else
+    {
+        grid.draw(gridSpacing, camera);
+        drawComponents();
+    }
     if (mode == EditorMode::SELECT)
         handleSelectMode();
     else if (mode == EditorMode::INSERT)
         handleInsertMode();
+    if (isMinimapVisible) minimap.draw(camera);
 }
 
 void EditorLayer::onEvent(Event& event)
@@ -63,365 +128,909 @@ void EditorLayer::onEvent(Event& event)
 
 void EditorLayer::drawComponents()
 {
-    // Create custom attribute layout
-    CustomAttributeLayout layout;
-    // Add a_IsSelected attribute
-    int index = layout.addAttribute(AttributeType::INT, 1);
-
     // Draw lines
-    Mesh lineMesh("lines", vertexVBO, lineIBO, MeshType::LINES,
-                  DrawMode::STATIC, layout);
-    lineMesh.attachCustomBuffer(index, selectedVertices);
-
+    lineSelectionBuffer->bind(0);
     lineShader.bind();
     lineShader.setUniform1f("u_LineWeight", 4.0f * camera.getZoom());
     lineShader.setUniformMat4f("u_VP", camera.getViewProjectionMatrix());
-    lineMesh.draw(lineShader);
+    lineShader.setUniform1i("u_Selection", 0);
+    lineShader.setUniform1i("u_ShowSelection", 1);
+    mapMesh->draw(lineShader);
     lineShader.unbind();
 
-    // Draw vertices and cursor vertex
-    Mesh vertexMesh("vertices", vertexVBO, vertexIBO, MeshType::POINTS,
-                    DrawMode::STATIC, layout);
-    vertexMesh.attachCustomBuffer(index, selectedVertices);
+    // Draw every instance of each prefab with one draw call
+    prefabShader.bind();
+    prefabShader.setUniform1f("u_LineWeight", 4.0f * camera.getZoom());
+    prefabShader.setUniformMat4f("u_VP", camera.getViewProjectionMatrix());
+    prefabShader.setUniform1i("u_ShowSelection", 0);
+    prefabRenderer.draw(prefabShader);
+    prefabShader.unbind();
 
+    // Draw vertices
+    vertexSelectionBuffer->bind(0);
     lineVertexShader.bind();
     lineVertexShader.setUniformMat4f("u_VP", camera.getViewProjectionMatrix());
-    vertexMesh.draw(lineVertexShader);
+    lineVertexShader.setUniform1i("u_Selection", 0);
+    lineVertexShader.setUniform1i("u_ShowSelection", 1);
+    mapMesh->drawArrays(lineVertexShader, MeshType::POINTS);
     lineVertexShader.unbind();
+    vertexSelectionBuffer->unbind();
 }
 
-int EditorLayer::getVertexIndex(glm::vec2 worldPos, float threshold)
+void EditorLayer::drawStaticLayer()
 {
-    for (int i = 0; i < lineVertices.size(); ++i)
+    Window& window = Application::getInstance().getWindow();
+    int width = window.getWidth();
+    int height = window.getHeight();
+
+    // A minimized window has nothing to draw
+    if (width <= 0 || height <= 0) return;
+
+    if (width != staticLayer->getWidth() || height != staticLayer->getHeight())
     {
-        const LineVertex& vertex = lineVertices.at(i);
+        staticLayer->resize(width, height);
+        isStaticLayerStale = true;
+    }
 
-        // Check if the vertex is deleted
-        if (vertex.deleted) continue;
+    // Moving or zooming the camera moves everything in the layer
+    glm::mat4 viewProjection = camera.getViewProjectionMatrix();
+    if (viewProjection != staticLayerViewProjection ||
+        gridSpacing != staticLayerGridSpacing)
+        isStaticLayerStale = true;
 
-        glm::vec2 vertexPos = {vertex.x, vertex.y};
-        if (glm::distance(worldPos, vertexPos) <= threshold) return i;
+    if (isStaticLayerStale)
+    {
+        // The layer is cleared to the clear color of the window
+        staticLayer->bind();
+        staticLayer->clear(glm::vec4(0.0f));
+        grid.draw(gridSpacing, camera);
+        drawComponents();
+        staticLayer->unbind();
+
+        staticLayerViewProjection = viewProjection;
+        staticLayerGridSpacing = gridSpacing;
+        isStaticLayerStale = false;
     }
 
-    return -1;
+    staticLayer->blit();
 }
 
-int EditorLayer::getLineIndex(glm::vec2 worldPos, float threshold)
+void EditorLayer::syncBuffers()
 {
-    for (int i = 0; i < lines.size(); ++i)
+    // Removing the last element shrinks the buffers without dirtying them
+    if (mapMesh->getVertexCount() != renderCache.getVertices().size() ||
+        mapMesh->getIndexCount() != renderCache.getLineIndices().size())
+        isStaticLayerStale = true;
+
+    // Upload only the slots touched since the last frame, one call per range.
+    // A buffer with nothing dirty is still updated once so it follows the
+    // size of the cache
+    auto forEachRange = [](const DirtyRanges& dirty, auto upload)
     {
-        const Line& line = lines.at(i);
+        if (dirty.isEmpty()) upload(0, 0);
+        for (const DirtyRange& range : dirty.getRanges())
+            upload(range.begin, range.getCount());
+    };
 
-        // Check if the line is deleted
-        if (line.deleted) continue;
+    const DirtyRanges& vertices = renderCache.getDirtyVertices();
+    forEachRange(vertices,
+                 [&](size_t first, size_t count)
+                 {
+                     mapMesh->updateVertices(renderCache.getVertices(), first,
+                                             count);
+                 });
+
+    // Selection is uploaded by changed 32-bit words rather than per slot
+    const DirtyRanges& vertexSelection =
+        renderCache.getDirtyVertexSelection();
+    forEachRange(vertexSelection,
+                 [&](size_t first, size_t count)
+                 {
+                     vertexSelectionBuffer->update(
+                         renderCache.getVertexSelection(), first, count);
+                 });
+
+    const DirtyRanges& lineSelection = renderCache.getDirtyLineSelection();
+    forEachRange(lineSelection,
+                 [&](size_t first, size_t count)
+                 {
+                     lineSelectionBuffer->update(renderCache.getLineSelection(),
+                                                 first, count);
+                 });
+
+    const DirtyRanges& lineIndices = renderCache.getDirtyLineIndices();
+    forEachRange(lineIndices,
+                 [&](size_t first, size_t count)
+                 {
+                     mapMesh->updateIndices(renderCache.getLineIndices(), first,
+                                            count);
+                 });
+
+    // Anything uploaded changes how the map is drawn
+    if (!vertices.isEmpty() || !vertexSelection.isEmpty() ||
+        !lineSelection.isEmpty() || !lineIndices.isEmpty())
+        isStaticLayerStale = true;
+
+    renderCache.clearDirty();
+
+    if (prefabRenderer.sync(prefabs)) isStaticLayerStale = true;
+}
+
+int EditorLayer::getVertexIndex(glm::vec2 worldPos, float threshold)
+{
+    return map.findVertex(worldPos, threshold);
+}
 
-        const LineVertex& start = lineVertices.at(line.startVertex);
-        const LineVertex& end = lineVertices.at(line.endVertex);
+int EditorLayer::getLineIndex(glm::vec2 worldPos, float threshold)
+{
+    return map.findLine(worldPos, threshold);
+}
 
-        glm::vec2 startVertex = {start.x, start.y};
-        glm::vec2 endVertex = {end.x, end.y};
+int EditorLayer::getLineIndex(int vertex1, int vertex2)
+{
+    return map.getTopology().findLine(vertex1, vertex2);
+}
+
+std::vector<int> EditorLayer::getLineIndices(int vertex)
+{
+    return map.getTopology().getIncidentLines(vertex);
+}
+
+int EditorLayer::addLineVertex(float x, float y)
+{
+    // Check if the vertex already exists
+    int index = getVertexIndex({x, y});
+    if (index != -1) return index;
 
-        glm::vec2 startToEnd = endVertex - startVertex;
-        glm::vec2 startToCursor = worldPos - startVertex;
+    // Add the vertex to the map
+    return map.addVertex(x, y);
+}
 
-        // Calculate the scalar projection of the cursor onto the line
-        float scalar = glm::dot(startToCursor, startToEnd) /
-                       glm::dot(startToEnd, startToEnd);
+int EditorLayer::addLine(int startVertex, int endVertex)
+{
+    ASSERT(map.getStore().hasVertex(startVertex));
 
-        // Clamp scalar to [0, 1] so that the projection is on the line
-        scalar = glm::clamp(scalar, 0.0f, 1.0f);
+    ASSERT(map.getStore().hasVertex(endVertex));
 
-        // Calculate the vector projection of the cursor onto the line
-        glm::vec2 projection = startVertex + scalar * startToEnd;
+    // Check if the vertices are the same
+    if (startVertex == endVertex) return -1;
 
-        float distance = glm::distance(worldPos, projection);
-        if (distance <= threshold) return i;
-    }
+    // Check if the line already exists
+    if (getLineIndex(startVertex, endVertex) != -1) return -1;
 
-    return -1;
+    // Add the line to the map
+    return map.addLine(startVertex, endVertex);
 }
 
-int EditorLayer::getLineIndex(int vertex1, int vertex2)
+void EditorLayer::placeLine(glm::vec2 start, glm::vec2 end)
 {
-    for (int i = 0; i < lines.size(); ++i)
+    map.findIntersections(start, end, intersections);
+
+    for (const LineIntersection& intersection : intersections)
+    {
+        if (intersection.type == Geometry::ContactType::OVERLAPPING)
+        {
+            LOG_WARN("The new line overlaps an existing line");
+            return;
+        }
+    }
+
+    if (!intersections.empty() && !isAutoSplitEnabled)
+    {
+        LOG_WARN("The new line touches %zu existing lines",
+                 intersections.size());
+        return;
+    }
+
+    history.beginTransaction();
+
+    // Chain the new line through the points where it meets other lines
+    int previousVertex = addLineVertex(start.x, start.y);
+    for (const LineIntersection& intersection : intersections)
     {
-        const Line& line = lines.at(i);
+        int vertex =
+            addLineVertex(intersection.position.x, intersection.position.y);
 
-        // Check if the line is deleted
-        if (line.deleted) continue;
+        // The line is only split where the new line meets its inside
+        const Line& line = map.getStore().getLine(intersection.line);
+        if (vertex != line.startVertex && vertex != line.endVertex)
+            map.splitLine(intersection.line, vertex);
 
-        if ((line.startVertex == vertex1 && line.endVertex == vertex2) ||
-            (line.startVertex == vertex2 && line.endVertex == vertex1))
-            return i;
+        addLine(previousVertex, vertex);
+        previousVertex = vertex;
     }
 
-    return -1;
+    addLine(previousVertex, addLineVertex(end.x, end.y));
+
+    commitTransaction();
 }
 
-std::vector<int> EditorLayer::getLineIndices(int vertex)
+void EditorLayer::commitTransaction()
+{
+    sectorDetector.update(map);
+    history.endTransaction();
+}
+
+void EditorLayer::removeVertex(int index)
 {
-    std::vector<int> lineIndices;
+    if (!map.getStore().hasVertex(index)) return;
+
+    map.deleteVertex(index);
+}
 
-    for (int i = 0; i < lines.size(); ++i)
+void EditorLayer::removeLine(int index)
+{
+    if (!map.getStore().hasLine(index)) return;
+
+    map.deleteLine(index);
+}
+
+void EditorLayer::buildVertexVBO()
+{
+    renderCache.rebuild(map.getStore());
+
+    // Restore the highlights of the selected elements
+    for (MapElement element : selectionManager.getSelected())
+        selectElement(element, true);
+}
+
+void EditorLayer::selectElement(MapElement element, bool selected)
+{
+    const MapStore& store = map.getStore();
+
+    switch (element.type)
     {
-        const Line& line = lines.at(i);
+        case ElementType::VERTEX:
+            if (!store.contains(element)) return;
+            renderCache.setVertexSelected(element.index, selected);
+            break;
+        case ElementType::LINE:
+            if (!store.contains(element)) return;
+            renderCache.setLineSelected(element.index, selected);
+            break;
+        default:
+            break;
+    }
+}
 
-        // Check if the line is deleted
-        if (line.deleted) continue;
+void EditorLayer::deleteElement(MapElement element)
+{
+    // Skip elements that were removed along with an earlier element
+    if (!map.getStore().contains(element)) return;
 
-        if (line.startVertex == vertex || line.endVertex == vertex)
-            lineIndices.push_back(i);
+    switch (element.type)
+    {
+        case ElementType::VERTEX:
+            removeVertex(element.index);
+            break;
+        case ElementType::LINE:
+            removeLine(element.index);
+            break;
+        default:
+            break;
     }
+}
+
+void EditorLayer::selectAll()
+{
+    const MapStore& store = map.getStore();
+
+    for (uint32_t vertex : store.getVertexIndices())
+        selectionManager.select(store.getElement(ElementType::VERTEX, vertex));
+
+    for (uint32_t line : store.getLineIndices())
+        selectionManager.select(store.getElement(ElementType::LINE, line));
+}
 
-    return lineIndices;
+void EditorLayer::invertSelection()
+{
+    const MapStore& store = map.getStore();
+
+    for (uint32_t vertex : store.getVertexIndices())
+        selectionManager.toggle(store.getElement(ElementType::VERTEX, vertex));
+
+    for (uint32_t line : store.getLineIndices())
+        selectionManager.toggle(store.getElement(ElementType::LINE, line));
+}
+
+void EditorLayer::selectRegion(glm::vec2 min, glm::vec2 max,
+                               const std::function<bool(glm::vec2)>& contains)
+{
+    const MapStore& store = map.getStore();
+
+    map.queryVertices(min, max,
+                      [&](uint32_t vertex)
+                      {
+                          const LineVertex& position = store.getVertex(vertex);
+                          if (contains({position.x, position.y}))
+                              selectionManager.select(store.getElement(
+                                  ElementType::VERTEX, vertex));
+                          return true;
+                      });
+
+    // Lines are selected when they lie entirely inside the region
+    map.queryLines(min, max,
+                   [&](uint32_t lineIndex)
+                   {
+                       const Line& line = store.getLine(lineIndex);
+                       const LineVertex& start =
+                           store.getVertex(line.startVertex);
+                       const LineVertex& end = store.getVertex(line.endVertex);
+                       if (contains({start.x, start.y}) &&
+                           contains({end.x, end.y}))
+                           selectionManager.select(
+                               store.getElement(ElementType::LINE, lineIndex));
+                       return true;
+                   });
 }
 
-int EditorLayer::getIndexInVertexVBO(int vertex)
+bool EditorLayer::isInsidePolygon(glm::vec2 point,
+                                  const std::vector<glm::vec2>& polygon)
 {
-    for (int i = 0; i < vertexVBO.size(); ++i)
+    bool inside = false;
+
+    // Count the edges crossed by a ray cast from the point towards +x
+    for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++)
     {
-        const Vertex& v = vertexVBO.at(i);
+        const glm::vec2& a = polygon[i];
+        const glm::vec2& b = polygon[j];
 
-        if (FP_EQUAL(v.position.x, lineVertices.at(vertex).x) &&
-            FP_EQUAL(v.position.y, lineVertices.at(vertex).y))
-            return i;
+        if ((a.y > point.y) != (b.y > point.y) &&
+            point.x < (b.x - a.x) * (point.y - a.y) / (b.y - a.y) + a.x)
+            inside = !inside;
     }
 
-    return -1;
+    return inside;
 }
 
-int EditorLayer::addLineVertex(float x, float y)
+void EditorLayer::finishMarquee()
 {
-    // Check if the vertex already exists
-    int index = getVertexIndex({x, y});
-    if (index != -1) return index;
+    isMarqueeActive = false;
 
-    LineVertex vertex(x, y);
+    if (isLasso)
+    {
+        if (lassoPoints.size() < 3) return;
 
-    // Add the vertex to the list
-    int vertexIndex = getFreeVertexIndex();
-    if (vertexIndex == -1) vertexIndex = lineVertices.size();
+        glm::vec2 min = lassoPoints[0], max = lassoPoints[0];
+        for (const glm::vec2& point : lassoPoints)
+        {
+            min = glm::min(min, point);
+            max = glm::max(max, point);
+        }
 
-    // Set the line vertex callbacks
-    vertex.onSelect = [this, vertexIndex](Selectable* vertex)
-    {
-        vertex->selected = true;
-        int vboIndex = getIndexInVertexVBO(vertexIndex);
-        ASSERT(vboIndex != -1);
-        selectedVertices.at(vboIndex) = 1;
-    };
-    vertex.onDeselect = [this, vertexIndex](Selectable* vertex)
+        selectRegion(min, max, [this](glm::vec2 point)
+                     { return isInsidePolygon(point, lassoPoints); });
+    }
+    else
     {
-        vertex->selected = false;
-        int vboIndex = getIndexInVertexVBO(vertexIndex);
-        ASSERT(vboIndex != -1);
-        selectedVertices.at(vboIndex) = 0;
-    };
-    vertex.onDelete = [this, vertexIndex](Selectable* vertex)
-    { removeVertex(vertexIndex); };
+        glm::vec2 min = glm::min(marqueeStart, marqueeEnd);
+        glm::vec2 max = glm::max(marqueeStart, marqueeEnd);
+
+        // Ignore clicks that did not drag out a box
+        if (glm::distance(min, max) < 2.0f * camera.getZoom()) return;
+
+        selectRegion(min, max,
+                     [min, max](glm::vec2 point)
+                     {
+                         return point.x >= min.x && point.x <= max.x &&
+                                point.y >= min.y && point.y <= max.y;
+                     });
+    }
+}
 
-    if (vertexIndex == lineVertices.size())
-        lineVertices.push_back(vertex);
+void EditorLayer::drawMarquee()
+{
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+
+    if (isLasso)
+    {
+        for (const glm::vec2& point : lassoPoints)
+            vertices.push_back({{point.x, point.y, 0.0f}});
+    }
     else
-        lineVertices.at(vertexIndex) = vertex;
+    {
+        vertices = {{{marqueeStart.x, marqueeStart.y, 0.0f}},
+                    {{marqueeEnd.x, marqueeStart.y, 0.0f}},
+                    {{marqueeEnd.x, marqueeEnd.y, 0.0f}},
+                    {{marqueeStart.x, marqueeEnd.y, 0.0f}}};
+    }
 
-    vertexRefMap[vertexIndex] = 0;
-    vertexIBO.push_back(vertexVBO.size());
-    vertexVBO.push_back({{x, y, 0.0f}});
-    selectedVertices.push_back(0);
+    if (vertices.size() < 2) return;
 
-    return vertexIndex;
+    // Close the outline
+    for (unsigned int i = 0; i < vertices.size(); ++i)
+    {
+        indices.push_back(i);
+        indices.push_back((i + 1) % vertices.size());
+    }
+
+    Mesh marqueeMesh("marquee", vertices, indices, MeshType::LINES);
+
+    lineShader.bind();
+    lineShader.setUniform1f("u_LineWeight", 2.0f * camera.getZoom());
+    lineShader.setUniformMat4f("u_VP", camera.getViewProjectionMatrix());
+    lineShader.setUniform1i("u_ShowSelection", 0);
+    marqueeMesh.draw(lineShader);
+    lineShader.unbind();
 }
 
-int EditorLayer::addLine(int startVertex, int endVertex)
+void EditorLayer::undo()
 {
-    ASSERT(startVertex >= 0 && startVertex < lineVertices.size());
+    if (isDragging) return;
 
-    ASSERT(endVertex >= 0 && endVertex < lineVertices.size());
+    // The restored sides already match the restored lines, so the detector
+    // only syncs with them, and makes no edit that would clear the redos
+    history.undo(map);
+    sectorDetector.sync(map);
+}
 
-    // Check if the vertices are the same
-    if (startVertex == endVertex) return -1;
+void EditorLayer::redo()
+{
+    if (isDragging) return;
 
-    // Check if the line already exists
-    if (getLineIndex(startVertex, endVertex) != -1) return -1;
+    history.redo(map);
+    sectorDetector.sync(map);
+}
 
-    Line line(startVertex, endVertex);
+void EditorLayer::saveMap(MapFileFormat format)
+{
+    const char* path = getMapPath(format);
+    bool saved = false;
 
-    // Add the line to the list
-    int lineIndex = getFreeLineIndex();
-    if (lineIndex == -1) lineIndex = lines.size();
+    if (streamer.isOpen() && format != MapFileFormat::BINARY)
+        LOG_WARN("Only the resident chunks of the chunked map are exported");
 
-    // Set the line callbacks
-    line.onSelect = [this, lineIndex](Selectable* line)
+    // Exports hold the geometry of the prefab instances as well
+    MapStore baked;
+    const MapStore* store = &map.getStore();
+    if (format != MapFileFormat::BINARY && !prefabs.getInstances().empty())
     {
-        line->selected = true;
-        int vboIndex = getIndexInVertexVBO(lines.at(lineIndex).startVertex);
-        ASSERT(vboIndex != -1);
-        selectedVertices.at(vboIndex) = 1;
-        vboIndex = getIndexInVertexVBO(lines.at(lineIndex).endVertex);
-        ASSERT(vboIndex != -1);
-        selectedVertices.at(vboIndex) = 1;
-    };
-    line.onDeselect = [this, lineIndex](Selectable* line)
-    {
-        line->selected = false;
-        int vboIndex = getIndexInVertexVBO(lines.at(lineIndex).startVertex);
-        ASSERT(vboIndex != -1);
-        selectedVertices.at(vboIndex) = 0;
-        vboIndex = getIndexInVertexVBO(lines.at(lineIndex).endVertex);
-        ASSERT(vboIndex != -1);
-        selectedVertices.at(vboIndex) = 0;
-    };
-    line.onDelete = [this, lineIndex](Selectable* line)
-    { removeLine(lineIndex); };
+        baked = map.getStore();
+        baked.bakeInstances();
+        store = &baked;
+    }
 
-    if (lineIndex == lines.size())
-        lines.push_back(line);
-    else
-        lines.at(lineIndex) = line;
+    switch (format)
+    {
+        case MapFileFormat::BINARY:
+            if (streamer.isOpen())
+            {
+                path = CHUNKED_MAP_PATH;
+                saved = streamer.flush();
+                break;
+            }
+
+            // Only the edits made since the last flush are written
+            saved = journal.isOpen() && journal.flush();
+            break;
+        case MapFileFormat::TEXT:
+            saved = textMapWriter.write(*store, path);
+            break;
+        case MapFileFormat::WAD:
+            saved = wadWriter.write(*store, path);
+            break;
+    }
+
+    if (saved) LOG_INFO("Saved map to %s", path);
+}
+
+void EditorLayer::loadMap(MapFileFormat format)
+{
+    if (isDragging) return;
+
+    const char* path = getMapPath(format);
+    UdmfReader textReader;
+    WadFile wad;
+    WadMapReader wadReader;
+    MapArrays arrays;
+
+    switch (format)
+    {
+        case MapFileFormat::BINARY:
+            // The journal reads the file along with the edits made since
+            break;
+        case MapFileFormat::TEXT:
+            if (!textReader.open(path)) return;
+            arrays = textReader.getArrays();
+            break;
+        case MapFileFormat::WAD:
+        {
+            if (!wad.open(path)) return;
+
+            std::vector<int> maps = wad.findMaps();
+            if (maps.empty())
+            {
+                LOG_WARN("No maps in %s", path);
+                return;
+            }
+
+            if (!wadReader.read(wad, maps.front())) return;
+            arrays = wadReader.getArrays();
+            break;
+        }
+    }
+
+    isMarqueeActive = false;
+    tempStartVertex.reset();
+    selectionManager.deselectAll();
+
+    if (streamer.isOpen()) closeChunkedMap();
 
-    ++vertexRefMap[startVertex];
-    int startIndex = getIndexInVertexVBO(startVertex);
-    ASSERT(startIndex != -1);
-    lineIBO.push_back(startIndex);
+    if (format == MapFileFormat::BINARY)
+    {
+        if (!journal.open(map, path)) return;
+    }
+    else
+    {
+        // The elements are copied out of the readers, so they can be closed
+        map.load(arrays);
+
+        // Imported maps may have been drawn without intersection checks
+        IntersectionSweep sweep;
+        size_t pairCount = sweep.findPairs(map.getStore()).size();
+        if (pairCount > 0)
+            LOG_WARN("%zu pairs of lines cross or overlap in %s", pairCount,
+                     path);
+    }
 
-    ++vertexRefMap[endVertex];
-    int endIndex = getIndexInVertexVBO(endVertex);
-    ASSERT(endIndex != -1);
-    lineIBO.push_back(endIndex);
+    // Neither the replayed edits nor the sectors found in the loaded map are
+    // the user's to undo
+    sectorDetector.update(map);
+    history.clear();
+    activePrefab = -1;
 
-    return lineIndex;
+    LOG_INFO("Loaded map from %s", path);
 }
 
-void EditorLayer::removeVertex(int index)
+void EditorLayer::weldVertices()
 {
-    ASSERT(index >= 0 && index < lineVertices.size());
+    if (isDragging) return;
+
+    selectionManager.deselectAll();
 
-    LineVertex& vertex = lineVertices.at(index);
-    if (vertex.deleted) return;
+    history.beginTransaction();
+    const WeldReport& report = welder.weld(map, WELD_TOLERANCE);
+    commitTransaction();
 
-    removeVertexImpl(index);
-    buildVertexVBO();
+    LOG_INFO("Merged %d vertices, moved %d lines, and removed %d degenerate "
+             "lines, %d duplicate lines, %d dangling vertices, %d dangling "
+             "sides and %d dangling sectors",
+             report.mergedVertices, report.remappedLines,
+             report.degenerateLines, report.duplicateLines,
+             report.danglingVertices, report.danglingSides,
+             report.danglingSectors);
 }
 
-void EditorLayer::removeLine(int index)
+void EditorLayer::generateDungeon(DungeonStyle style)
 {
-    ASSERT(index >= 0 && index < lines.size());
+    if (isDragging) return;
+
+    DungeonSettings settings;
+    settings.seed = ++dungeonSeed;
+    settings.style = style;
+    const MapData& data = generator.generate(settings);
+
+    isMarqueeActive = false;
+    tempStartVertex.reset();
+    selectionManager.deselectAll();
+
+    if (streamer.isOpen()) closeChunkedMap();
+
+    // Replace the map one edit at a time rather than loading the dungeon, so
+    // that the replacement can be undone and the journal records it as edits
+    // instead of writing the dungeon over the base
+    AppendedElements added;
+    history.beginTransaction();
+    map.deleteAll();
+    map.append(data.getArrays(), {0.0f, 0.0f}, added);
+    commitTransaction();
+
+    LOG_INFO("Generated dungeon %llu with %zu lines in %.3f ms",
+             static_cast<unsigned long long>(settings.seed), data.lines.size(),
+             generator.getLastTime());
+}
 
-    Line& line = lines.at(index);
-    if (line.deleted) return;
+void EditorLayer::chunkMap()
+{
+    if (streamer.isOpen())
+    {
+        LOG_WARN("The chunked map is already open");
+        return;
+    }
 
-    removeLineImpl(index);
-    buildVertexVBO();
+    if (MapStreamer::build(map.getStore(), CHUNKED_MAP_PATH))
+        LOG_INFO("Chunked map into %s", CHUNKED_MAP_PATH);
 }
 
-void EditorLayer::removeVertexImpl(int index)
+void EditorLayer::openChunkedMap()
 {
-    ASSERT(index >= 0 && index < lineVertices.size());
+    if (isDragging) return;
 
-    LineVertex& vertex = lineVertices.at(index);
+    // Neither the journal nor the detector may follow the paging
+    map.removeListener(&journal);
+    map.removeListener(&sectorDetector);
+    if (!streamer.open(map, CHUNKED_MAP_PATH))
+    {
+        map.addListener(&sectorDetector);
+        map.addListener(&journal);
+        return;
+    }
+    journal.close();
 
-    std::vector<int> lineIndices = getLineIndices(index);
-    for (int lineIndex : lineIndices) removeLineImpl(lineIndex);
+    isMarqueeActive = false;
+    tempStartVertex.reset();
+    selectionManager.deselectAll();
+    history.clear();
+    activePrefab = -1;
 }
 
-void EditorLayer::removeLineImpl(int index)
+void EditorLayer::closeChunkedMap()
 {
-    ASSERT(index >= 0 && index < lines.size());
+    if (!streamer.close())
+        LOG_WARN("Failed to write back chunked map: %s", CHUNKED_MAP_PATH);
+
+    // As in the constructor, the journal restores the map before it follows
+    // the edits
+    map.addListener(&sectorDetector);
+    journal.open(map, MAP_PATH);
+    map.addListener(&journal);
+
+    sectorDetector.update(map);
+    history.clear();
+    activePrefab = -1;
+}
 
-    Line& line = lines.at(index);
+void EditorLayer::pageChunks()
+{
+    // The indices held by a drag must stay valid until it ends
+    if (draggedVertex != -1) return;
+
+    Window& window = Application::getInstance().getWindow();
+    glm::vec2 corner = camera.screenToWorld({0.0f, 0.0f});
+    glm::vec2 oppositeCorner = camera.screenToWorld(
+        {static_cast<float>(window.getWidth()),
+         static_cast<float>(window.getHeight())});
+
+    // Paging is not an edit of the user, but the transactions referring to
+    // the slots it fills or frees can no longer be replayed
+    history.suspend();
+    bool isPaged = streamer.update(glm::min(corner, oppositeCorner),
+                                   glm::max(corner, oppositeCorner));
+    history.resume();
+
+    if (!isPaged) return;
+
+    // Deselect the elements of the evicted chunks
+    std::vector<MapElement> evicted;
+    for (MapElement element : selectionManager.getSelected())
+    {
+        if (!map.getStore().contains(element)) evicted.push_back(element);
+    }
 
-    line.deleted = true;
-    freeLineIndices.push(index);
+    for (MapElement element : evicted) selectionManager.deselect(element);
+}
 
-    LineVertex& start = lineVertices.at(line.startVertex);
-    LineVertex& end = lineVertices.at(line.endVertex);
+void EditorLayer::validateMap()
+{
+    const std::vector<MapIssue>& issues = validator.validate(map.getStore());
 
-    if (--vertexRefMap[line.startVertex] <= 0)
+    std::ofstream stream(REPORT_PATH);
+    validator.writeReport(stream);
+    stream.close();
+    if (!stream)
     {
-        vertexRefMap.erase(line.startVertex);
-        start.deleted = true;
-        freeVertexIndices.push(line.startVertex);
+        LOG_WARN("Failed to write file: %s", REPORT_PATH);
+        return;
     }
 
-    if (--vertexRefMap[line.endVertex] <= 0)
+    if (issues.empty())
     {
-        vertexRefMap.erase(line.endVertex);
-        end.deleted = true;
-        freeVertexIndices.push(line.endVertex);
+        LOG_INFO("Found no issues in %.3f ms", validator.getLastTime());
+        return;
     }
+
+    LOG_WARN("Found %zu issues in %.3f ms, see %s", issues.size(),
+             validator.getLastTime(), REPORT_PATH);
 }
 
-void EditorLayer::buildVertexVBO()
+bool EditorLayer::copySelection()
 {
-    vertexVBO.clear();
-    vertexIBO.clear();
-    lineIBO.clear();
-    selectedVertices.clear();
+    const MapStore& store = map.getStore();
 
-    ASSERT(vertexVBO.size() == 0);
-    ASSERT(vertexIBO.size() == 0);
-    ASSERT(lineIBO.size() == 0);
-
-    for (int i = 0; i < lineVertices.size(); ++i)
+    std::vector<int> lines;
+    for (MapElement element : selectionManager.getSelected())
     {
-        const LineVertex& lineVertex = lineVertices.at(i);
-        // Skip deleted vertices
-        if (lineVertex.deleted) continue;
-
-        vertexRefMap[i] = 0;
-        vertexIBO.push_back(vertexVBO.size());
-        vertexVBO.push_back({{lineVertex.x, lineVertex.y, 0.0f}});
-        selectedVertices.push_back(0);
+        if (element.type == ElementType::LINE && store.contains(element))
+            lines.push_back(element.index);
     }
 
-    for (const Line& line : lines)
+    if (lines.empty())
     {
-        // Skip deleted lines
-        if (line.deleted) continue;
+        LOG_WARN("No lines are selected");
+        return false;
+    }
 
-        const LineVertex& start = lineVertices.at(line.startVertex);
-        const LineVertex& end = lineVertices.at(line.endVertex);
+    clipboard = std::make_shared<const MapFragment>(store, lines);
+    LOG_INFO("Copied %zu lines", lines.size());
+    return true;
+}
 
-        ++vertexRefMap[line.startVertex];
-        int startIndex = getIndexInVertexVBO(line.startVertex);
-        ASSERT(startIndex != -1);
-        lineIBO.push_back(startIndex);
+void EditorLayer::cutSelection()
+{
+    if (isDragging || !copySelection()) return;
 
-        ++vertexRefMap[line.endVertex];
-        int endIndex = getIndexInVertexVBO(line.endVertex);
-        ASSERT(endIndex != -1);
-        lineIBO.push_back(endIndex);
-    }
+    history.beginTransaction();
+    selectionManager.deleteSelected();
+    commitTransaction();
+}
+
+void EditorLayer::paste()
+{
+    if (isDragging || !clipboard) return;
+
+    glm::vec2 offset = getCursorGridPoint();
+    if (!checkInRange(offset, offset + clipboard->getSize())) return;
+
+    AppendedElements added;
+    history.beginTransaction();
+    map.append(clipboard->getArrays(), offset, added);
+    commitTransaction();
+
+    selectionManager.deselectAll();
+    selectAppended(added);
+}
+
+void EditorLayer::createPrefab()
+{
+    if (!copySelection()) return;
+
+    // The prefab shares the copied geometry with the clipboard
+    activePrefab = map.addPrefab(clipboard);
+    LOG_INFO("Created prefab %d", activePrefab);
 }
 
-int EditorLayer::getFreeVertexIndex()
+void EditorLayer::stampPrefab()
 {
-    if (freeVertexIndices.size() > 0)
+    if (activePrefab == -1)
     {
-        int index = freeVertexIndices.front();
-        freeVertexIndices.pop();
-        return index;
+        LOG_WARN("No prefab has been created");
+        return;
     }
 
-    return -1;
+    // The geometry of the instance must fit once it is unpacked
+    glm::vec2 position = getCursorGridPoint();
+    const MapFragment& prefab = *map.getStore().getPrefab(activePrefab);
+    if (!checkInRange(position, position + prefab.getSize())) return;
+
+    map.addInstance(activePrefab, position);
+}
+
+void EditorLayer::removePrefabInstance()
+{
+    glm::vec2 worldPos = camera.screenToWorld(Input::getMousePosition());
+    int instance = prefabs.findInstance(worldPos);
+    if (instance != -1) map.removeInstance(instance);
 }
 
-int EditorLayer::getFreeLineIndex()
+void EditorLayer::unpackPrefabInstance()
 {
-    if (freeLineIndices.size() > 0)
+    if (isDragging) return;
+
+    glm::vec2 worldPos = camera.screenToWorld(Input::getMousePosition());
+    int instance = prefabs.findInstance(worldPos);
+    if (instance == -1) return;
+
+    AppendedElements added;
+    history.beginTransaction();
+    prefabs.unpack(instance, added);
+    commitTransaction();
+
+    selectionManager.deselectAll();
+    selectAppended(added);
+}
+
+void EditorLayer::selectAppended(const AppendedElements& added)
+{
+    const MapStore& store = map.getStore();
+
+    for (int vertex : added.vertices)
+        selectionManager.select(store.getElement(ElementType::VERTEX, vertex));
+
+    for (int line : added.lines)
+        selectionManager.select(store.getElement(ElementType::LINE, line));
+}
+
+glm::vec2 EditorLayer::getCursorGridPoint()
+{
+    glm::vec2 worldPos = camera.screenToWorld(Input::getMousePosition());
+    return glm::round(worldPos / gridSpacing) * gridSpacing;
+}
+
+bool EditorLayer::checkInRange(glm::vec2 min, glm::vec2 max) const
+{
+    if (Map::isInRange(min) && Map::isInRange(max)) return true;
+
+    LOG_WARN("Map coordinates must lie within %g of the origin",
+             MAX_MAP_COORD);
+    return false;
+}
+
+MapFileFormat EditorLayer::getHeldMapFileFormat() const
+{
+    if (Input::isKeyPressed(GLFW_KEY_LEFT_SHIFT) ||
+        Input::isKeyPressed(GLFW_KEY_RIGHT_SHIFT))
+        return MapFileFormat::TEXT;
+
+    if (Input::isKeyPressed(GLFW_KEY_LEFT_ALT) ||
+        Input::isKeyPressed(GLFW_KEY_RIGHT_ALT))
+        return MapFileFormat::WAD;
+
+    return MapFileFormat::BINARY;
+}
+
+const char* EditorLayer::getMapPath(MapFileFormat format)
+{
+    switch (format)
+    {
+        case MapFileFormat::TEXT:
+            return TEXT_MAP_PATH;
+        case MapFileFormat::WAD:
+            return WAD_PATH;
+        default:
+            return MAP_PATH;
+    }
+}
+
+void EditorLayer::dragVertex()
+{
+    const MapStore& store = map.getStore();
+    if (!store.hasVertex(draggedVertex)) return;
+
+    glm::vec2 worldPos = camera.screenToWorld(Input::getMousePosition());
+    float gridX = round(worldPos.x / gridSpacing) * gridSpacing;
+    float gridY = round(worldPos.y / gridSpacing) * gridSpacing;
+
+    // The vertex stops at the edge of the range of map coordinates
+    const LineVertex& vertex = store.getVertex(draggedVertex);
+    if (vertex.x == gridX && vertex.y == gridY) return;
+    if (!Map::isInRange({gridX, gridY})) return;
+
+    // The whole drag is undone as one move
+    if (!isDragging)
     {
-        int index = freeLineIndices.front();
-        freeLineIndices.pop();
-        return index;
+        history.beginTransaction();
+        isDragging = true;
     }
 
-    return -1;
+    map.moveVertex(draggedVertex, {gridX, gridY});
+}
+
+void EditorLayer::finishDrag()
+{
+    if (isDragging) commitTransaction();
+
+    draggedVertex = -1;
+    isDragging = false;
 }
 
 void EditorLayer::handleSelectMode()
 {
     if (mode != EditorMode::SELECT) return;
+
+    if (draggedVertex != -1) dragVertex();
+
+    if (!isMarqueeActive) return;
+
+    glm::vec2 worldPos = camera.screenToWorld(Input::getMousePosition());
+    marqueeEnd = worldPos;
+
+    // Record a lasso point whenever the cursor has moved far enough
+    if (isLasso &&
+        glm::distance(lassoPoints.back(), worldPos) > 4.0f * camera.getZoom())
+        lassoPoints.push_back(worldPos);
+
+    drawMarquee();
 }
 
 void EditorLayer::handleInsertMode()
@@ -443,6 +1052,7 @@ void EditorLayer::handleInsertMode()
         lineShader.bind();
         lineShader.setUniform1f("u_LineWeight", 4.0f * camera.getZoom());
         lineShader.setUniformMat4f("u_VP", camera.getViewProjectionMatrix());
+        lineShader.setUniform1i("u_ShowSelection", 0);
         phantomLineMesh.draw(lineShader);
         lineShader.unbind();
 
@@ -455,6 +1065,7 @@ void EditorLayer::handleInsertMode()
         lineVertexShader.bind();
         lineVertexShader.setUniformMat4f("u_VP",
                                          camera.getViewProjectionMatrix());
+        lineVertexShader.setUniform1i("u_ShowSelection", 0);
         tempStartVertexMesh.draw(lineVertexShader);
         lineVertexShader.unbind();
     }
@@ -486,33 +1097,56 @@ void EditorLayer::onMouseButtonPress(MouseButtonPressedEvent& event)
 
         if (mode == EditorMode::SELECT)
         {
+            // Shift adds to the selection instead of replacing it
+            bool additive = Input::isKeyPressed(GLFW_KEY_LEFT_SHIFT) ||
+                            Input::isKeyPressed(GLFW_KEY_RIGHT_SHIFT);
+
+            const MapStore& store = map.getStore();
+            MapElement element = {ElementType::VERTEX, -1};
+
             int vertexIndex =
                 getVertexIndex(worldPos, 10.0f * camera.getZoom());
             if (vertexIndex != -1)
+                element = store.getElement(ElementType::VERTEX, vertexIndex);
+            else
             {
-                LineVertex& vertex = lineVertices.at(vertexIndex);
-                bool isSelected = vertex.isSelected();
-                selectionManager.deselectAll();
-                if (!isSelected) selectionManager.select(&vertex);
-                return;
+                int lineIndex = getLineIndex(worldPos, 6.0f);
+                if (lineIndex != -1)
+                    element = store.getElement(ElementType::LINE, lineIndex);
             }
 
-            int lineIndex = getLineIndex(worldPos, 6.0f);
-            if (lineIndex != -1)
+            if (element.index != -1)
             {
-                Line& line = lines.at(lineIndex);
-                bool isSelected = line.isSelected();
-                selectionManager.deselectAll();
-                if (!isSelected) selectionManager.select(&line);
+                if (additive)
+                    selectionManager.toggle(element);
+                else
+                {
+                    bool isSelected = selectionManager.isSelected(element);
+                    selectionManager.deselectAll();
+                    if (!isSelected) selectionManager.select(element);
+
+                    // Dragging a vertex moves it
+                    if (element.type == ElementType::VERTEX)
+                        draggedVertex = element.index;
+                }
                 return;
             }
 
-            selectionManager.deselectAll();
+            if (!additive) selectionManager.deselectAll();
+
+            // Start a rubber band selection, or a lasso if alt is held
+            isMarqueeActive = true;
+            isLasso = Input::isKeyPressed(GLFW_KEY_LEFT_ALT) ||
+                      Input::isKeyPressed(GLFW_KEY_RIGHT_ALT);
+            marqueeStart = worldPos;
+            marqueeEnd = worldPos;
+            lassoPoints.assign(1, worldPos);
         }
         else if (mode == EditorMode::INSERT)
         {
             float gridX = round(worldPos.x / gridSpacing) * gridSpacing;
             float gridY = round(worldPos.y / gridSpacing) * gridSpacing;
+            if (!checkInRange({gridX, gridY}, {gridX, gridY})) return;
 
             if (!tempStartVertex)
                 tempStartVertex = std::make_unique<LineVertex>(gridX, gridY);
@@ -520,14 +1154,8 @@ void EditorLayer::onMouseButtonPress(MouseButtonPressedEvent& event)
             {
                 // Check if the start vertex is the same as the end vertex
                 if (tempStartVertex->x != gridX || tempStartVertex->y != gridY)
-                {
-                    int startVertex =
-                        addLineVertex(tempStartVertex->x, tempStartVertex->y);
-                    ASSERT(startVertex != -1);
-                    int endVertex = addLineVertex(gridX, gridY);
-                    ASSERT(endVertex != -1);
-                    addLine(startVertex, endVertex);
-                }
+                    placeLine({tempStartVertex->x, tempStartVertex->y},
+                              {gridX, gridY});
 
                 tempStartVertex.reset();
             }
@@ -535,6 +1163,14 @@ void EditorLayer::onMouseButtonPress(MouseButtonPressedEvent& event)
     }
 }
 
+void EditorLayer::onMouseButtonRelease(MouseButtonReleasedEvent& event)
+{
+    if (event.getButton() != GLFW_MOUSE_BUTTON_LEFT) return;
+
+    if (draggedVertex != -1) finishDrag();
+    if (isMarqueeActive) finishMarquee();
+}
+
 void EditorLayer::onKeyRelease(KeyReleasedEvent& event)
 {
     // We use key release event instead of key press event to prevent
@@ -547,6 +1183,8 @@ void EditorLayer::onKeyRelease(KeyReleasedEvent& event)
             if (mode != EditorMode::INSERT)
             {
                 mode = EditorMode::INSERT;
+                isMarqueeActive = false;
+                finishDrag();
                 selectionManager.deselectAll();
             }
             else
@@ -560,7 +1198,125 @@ void EditorLayer::onKeyRelease(KeyReleasedEvent& event)
             mode = EditorMode::SELECT;
             break;
         case GLFW_KEY_BACKSPACE:
-            if (mode == EditorMode::SELECT) selectionManager.deleteSelected();
+            if (mode == EditorMode::SELECT)
+            {
+                history.beginTransaction();
+                selectionManager.deleteSelected();
+                commitTransaction();
+            }
+            break;
+        case GLFW_KEY_A:
+            if (mode == EditorMode::SELECT &&
+                (Input::isKeyPressed(GLFW_KEY_LEFT_CONTROL) ||
+                 Input::isKeyPressed(GLFW_KEY_RIGHT_CONTROL)))
+                selectAll();
+            break;
+        case GLFW_KEY_I:
+            if (mode == EditorMode::SELECT) invertSelection();
+            break;
+        case GLFW_KEY_T:
+            isAutoSplitEnabled = !isAutoSplitEnabled;
+            LOG_INFO("Auto-splitting %s",
+                     isAutoSplitEnabled ? "enabled" : "disabled");
+            break;
+        case GLFW_KEY_M:
+            isMinimapVisible = !isMinimapVisible;
+            break;
+        case GLFW_KEY_L:
+            isStaticLayerCached = !isStaticLayerCached;
+            isStaticLayerStale = true;
+            LOG_INFO("Static layer caching %s",
+                     isStaticLayerCached ? "enabled" : "disabled");
+            break;
+        case GLFW_KEY_C:
+            if (mode == EditorMode::SELECT &&
+                (Input::isKeyPressed(GLFW_KEY_LEFT_CONTROL) ||
+                 Input::isKeyPressed(GLFW_KEY_RIGHT_CONTROL)))
+                copySelection();
+            break;
+        case GLFW_KEY_X:
+            if (mode == EditorMode::SELECT &&
+                (Input::isKeyPressed(GLFW_KEY_LEFT_CONTROL) ||
+                 Input::isKeyPressed(GLFW_KEY_RIGHT_CONTROL)))
+                cutSelection();
+            break;
+        case GLFW_KEY_V:
+            if (Input::isKeyPressed(GLFW_KEY_LEFT_CONTROL) ||
+                Input::isKeyPressed(GLFW_KEY_RIGHT_CONTROL))
+            {
+                if (mode == EditorMode::SELECT) paste();
+            }
+            else
+                validateMap();
+            break;
+        case GLFW_KEY_P:
+            if (mode != EditorMode::SELECT) break;
+
+            // Control makes a prefab and shift removes an instance
+            if (Input::isKeyPressed(GLFW_KEY_LEFT_CONTROL) ||
+                Input::isKeyPressed(GLFW_KEY_RIGHT_CONTROL))
+                createPrefab();
+            else if (Input::isKeyPressed(GLFW_KEY_LEFT_SHIFT) ||
+                     Input::isKeyPressed(GLFW_KEY_RIGHT_SHIFT))
+                removePrefabInstance();
+            else
+                stampPrefab();
+            break;
+        case GLFW_KEY_U:
+            if (mode == EditorMode::SELECT) unpackPrefabInstance();
+            break;
+        case GLFW_KEY_W:
+            weldVertices();
+            break;
+        case GLFW_KEY_G:
+            if (!Input::isKeyPressed(GLFW_KEY_LEFT_CONTROL) &&
+                !Input::isKeyPressed(GLFW_KEY_RIGHT_CONTROL))
+                break;
+
+            // Shift generates caves instead of rooms
+            if (Input::isKeyPressed(GLFW_KEY_LEFT_SHIFT) ||
+                Input::isKeyPressed(GLFW_KEY_RIGHT_SHIFT))
+                generateDungeon(DungeonStyle::CAVES);
+            else
+                generateDungeon(DungeonStyle::ROOMS);
+            break;
+        case GLFW_KEY_Z:
+            if (Input::isKeyPressed(GLFW_KEY_LEFT_CONTROL) ||
+                Input::isKeyPressed(GLFW_KEY_RIGHT_CONTROL))
+            {
+                if (Input::isKeyPressed(GLFW_KEY_LEFT_SHIFT) ||
+                    Input::isKeyPressed(GLFW_KEY_RIGHT_SHIFT))
+                    redo();
+                else
+                    undo();
+            }
+            break;
+        case GLFW_KEY_Y:
+            if (Input::isKeyPressed(GLFW_KEY_LEFT_CONTROL) ||
+                Input::isKeyPressed(GLFW_KEY_RIGHT_CONTROL))
+                redo();
+            break;
+        case GLFW_KEY_S:
+            if (Input::isKeyPressed(GLFW_KEY_LEFT_CONTROL) ||
+                Input::isKeyPressed(GLFW_KEY_RIGHT_CONTROL))
+                saveMap(getHeldMapFileFormat());
+            break;
+        case GLFW_KEY_O:
+            if (Input::isKeyPressed(GLFW_KEY_LEFT_CONTROL) ||
+                Input::isKeyPressed(GLFW_KEY_RIGHT_CONTROL))
+                loadMap(getHeldMapFileFormat());
+            break;
+        case GLFW_KEY_K:
+            if (!Input::isKeyPressed(GLFW_KEY_LEFT_CONTROL) &&
+                !Input::isKeyPressed(GLFW_KEY_RIGHT_CONTROL))
+                break;
+
+            // Shift writes the chunked map instead of opening it
+            if (Input::isKeyPressed(GLFW_KEY_LEFT_SHIFT) ||
+                Input::isKeyPressed(GLFW_KEY_RIGHT_SHIFT))
+                chunkMap();
+            else
+                openChunkedMap();
             break;
     }
 }
\ No newline at end of file
@@ -2,16 +2,30 @@
 
 #include <Engine.h>
 
-#include <queue>
-#include <unordered_map>
+#include <functional>
+#include <memory>
 #include <vector>
 
 #include "Grid.h"
+#include "MapRenderCache.h"
+#include "Minimap.h"
+#include "PrefabRenderer.h"
 #include "SelectionManager.h"
-#include "map_components/Line.h"
+#include "io/EditJournal.h"
+#include "io/MapStreamer.h"
+#include "io/UdmfWriter.h"
+#include "io/WadWriter.h"
+#include "map/DungeonGenerator.h"
+#include "map/EditHistory.h"
+#include "map/Map.h"
+#include "map/MapElement.h"
+#include "map/MapFragment.h"
+#include "map/MapValidator.h"
+#include "map/PrefabLibrary.h"
+#include "map/SectorDetector.h"
+#include "map/VertexWelder.h"
 #include "map_components/LineVertex.h"
-#include "map_components/Sector.h"
-#include "map_components/Side.h"
+#include "utils/ThreadPool.h"
 
 using namespace Engine;
 
@@ -21,11 +35,20 @@ enum class EditorMode
     INSERT
 };
 
+enum class MapFileFormat
+{
+    BINARY,
+    TEXT,
+    WAD
+};
+
 class EditorLayer : public Layer
 {
 public:
     EditorLayer();
 
+    ~EditorLayer();
+
     void onAttach() override;
 
     void onDetach() override;
@@ -35,6 +58,19 @@ public:
     void onEvent(Event& event) override;
 
 private:
+    // The path of the file the map is saved to and loaded from
+    static constexpr const char* MAP_PATH = "map.dvmap";
+    // The path of the file the map is exported to and imported from as text
+    static constexpr const char* TEXT_MAP_PATH = "map.udmf";
+    // The path of the file the map is exported to and imported from as a WAD
+    static constexpr const char* WAD_PATH = "map.wad";
+    // The path of the directory the map is chunked into for streaming
+    static constexpr const char* CHUNKED_MAP_PATH = "map.chunks";
+    // The path of the file the validation report is written to
+    static constexpr const char* REPORT_PATH = "map.report.json";
+    // The largest distance between vertices merged by a weld
+    static constexpr float WELD_TOLERANCE = 1.0f;
+
     EditorMode mode = EditorMode::SELECT;
 
     // The camera used to view the scene
@@ -44,34 +80,85 @@ private:
     // The spacing between grid lines
     float gridSpacing;
 
-    // The list of line vertices in the map
-    std::vector<LineVertex> lineVertices;
-    // The list of lines in the map
-    std::vector<Line> lines;
-    // The list of sides in the map
-    std::vector<Side> sides;
-    // The list of sectors in the map
-    std::vector<Sector> sectors;
+    // The map being edited
+    Map map;
+    // The undo history of the map
+    EditHistory history;
+    // The journal that keeps the map file up to date with every edit
+    EditJournal journal;
+    // The streamer that pages a chunked map in and out around the view in
+    // place of the journal
+    MapStreamer streamer;
+    // The detector that keeps the sectors in step with the closed loops
+    SectorDetector sectorDetector;
+    // The worker threads shared by the data-parallel passes over the map
+    ThreadPool threadPool;
+    // The validator that checks the map before it is shipped
+    MapValidator validator;
+    // The welder that merges near-duplicate vertices
+    VertexWelder welder;
+    // The generator of procedural dungeons
+    DungeonGenerator generator;
+    // The seed of the last generated dungeon
+    uint64_t dungeonSeed = 0;
+    // The writer used to export the map as text
+    UdmfWriter textMapWriter;
+    // The writer used to export the map as a WAD
+    WadWriter wadWriter;
     // The temporary start vertex when placing a new line
     std::unique_ptr<LineVertex> tempStartVertex;
-
-    // Cached vertex list for drawing vertices
-    std::vector<Vertex> vertexVBO;
-    // Cached index list for drawing vertices
-    std::vector<unsigned int> vertexIBO;
-    // Cached index list for drawing lines
-    std::vector<unsigned int> lineIBO;
-    // List of selected vertices
-    std::vector<int> selectedVertices;
-    // A map of vertex indices to their reference count
-    std::unordered_map<int, unsigned int> vertexRefMap;
-    // A queue of free (deleted) vertex indices
-    std::queue<int> freeVertexIndices;
-    // A queue of free (deleted) line indices
-    std::queue<int> freeLineIndices;
+    // Whether new lines are split where they touch existing lines
+    bool isAutoSplitEnabled = true;
+    // The existing lines touched by the line being placed
+    std::vector<LineIntersection> intersections;
+    // The lines last copied or cut, or null if nothing was copied
+    std::shared_ptr<const MapFragment> clipboard;
+    // The finder of the prefab instances of the map
+    PrefabLibrary prefabs;
+    // The prefab stamped by the next stamp, or -1 if there is none
+    int activePrefab = -1;
+
+    // The CPU-side buffers used to draw the map
+    MapRenderCache renderCache;
+    // The GPU-side mesh of the map's lines and vertices
+    std::unique_ptr<DynamicMesh> mapMesh;
+    // The selection bits of the vertex slots of the map mesh
+    std::unique_ptr<TextureBuffer> vertexSelectionBuffer;
+    // The selection bits of the line slots of the map mesh
+    std::unique_ptr<TextureBuffer> lineSelectionBuffer;
+    // The GPU-side meshes of the prefab instances
+    PrefabRenderer prefabRenderer;
+    // The overview of the whole map drawn over the scene
+    Minimap minimap;
+    // Whether the minimap is drawn
+    bool isMinimapVisible = true;
+    // The offscreen texture the grid and the map are cached in
+    std::unique_ptr<Framebuffer> staticLayer;
+    // Whether the grid and the map are drawn from the cached texture
+    bool isStaticLayerCached = true;
+    // Whether the cached texture must be redrawn before it is shown
+    bool isStaticLayerStale = true;
+    // The view-projection matrix the cached texture was drawn with
+    glm::mat4 staticLayerViewProjection = glm::mat4(1.0f);
+    // The grid spacing the cached texture was drawn with
+    float staticLayerGridSpacing = 0.0f;
 
     // The selection manager
     SelectionManager selectionManager;
+    // The vertex under the cursor when the left button was pressed, or -1
+    int draggedVertex = -1;
+    // Whether the pressed vertex has been moved since the press
+    bool isDragging = false;
+    // Whether a rubber band selection is being dragged
+    bool isMarqueeActive = false;
+    // Whether the rubber band selection is a lasso rather than a box
+    bool isLasso = false;
+    // The world position where the rubber band selection started
+    glm::vec2 marqueeStart;
+    // The world position where the rubber band selection currently ends
+    glm::vec2 marqueeEnd;
+    // The outline of the lasso selection
+    std::vector<glm::vec2> lassoPoints;
 
     // The shader used to draw the line vertices
     Shader lineVertexShader;
@@ -79,6 +166,8 @@ private:
     Shader lineShader;
     // The shader used to draw phantom vertices
     Shader phantomVertexShader;
+    // The shader used to draw the lines of the prefab instances
+    Shader prefabShader;
 
     /**
      * @brief Draws the components of the map.
@@ -88,6 +177,25 @@ private:
      */
     void drawComponents();
 
+    /**
+     * @brief Draws the grid and the components of the map from the cached
+     * static layer.
+     *
+     * The layer is only redrawn when the camera, the grid spacing, the window
+     * size or the uploaded buffers have changed since it was last drawn, so
+     * frames in which only the overlays change copy it to the window instead.
+     */
+    void drawStaticLayer();
+
+    /**
+     * @brief Uploads the dirty ranges of the map buffers to the GPU.
+     *
+     * This method uploads the vertex and line index ranges and the selection
+     * words that have changed since the last upload and clears them. The
+     * static layer is marked stale if anything was uploaded.
+     */
+    void syncBuffers();
+
     /**
      * @brief Gets the index of the vertex at the specified world position
      * within the specified threshold.
@@ -123,7 +231,8 @@ private:
      * as endpoints.
      *
      * This method gets the index of the line that has the specified two
-     * vertices as endpoints.
+     * vertices as endpoints. The lookup walks the half-edges around the
+     * vertices, so it scales with their degree rather than the map size.
      *
      * @param vertex1 The index of the first vertex.
      * @param vertex2 The index of the second vertex.
@@ -136,24 +245,13 @@ private:
      * an endpoint.
      *
      * This method gets the indices of the lines that have the specified vertex
-     * as an endpoint.
+     * as an endpoint, in counter-clockwise order around the vertex.
      *
      * @param vertex The index of the vertex.
      * @return A vector containing the indices of the lines.
      */
     std::vector<int> getLineIndices(int vertex);
 
-    /**
-     * @brief Gets the index of the specified vertex in the vertex VBO.
-     *
-     * This method gets the index of the specified vertex in the vertex VBO.
-     *
-     * @param vertex The index of the vertex.
-     * @return The index of the vertex in the VBO, or -1 if the vertex is not
-     * found.
-     */
-    int getIndexInVertexVBO(int vertex);
-
     /**
      * @brief Adds a line vertex at the specified position.
      *
@@ -185,72 +283,316 @@ private:
     int addLine(int startVertex, int endVertex);
 
     /**
-     * @brief Removes the vertex at the specified index and rebuilds the buffer
-     * objects.
+     * @brief Places a line between two positions as one undoable edit.
      *
-     * This method removes the vertex at the specified index and rebuilds the
-     * vertex and line buffer objects.
+     * Only the existing lines near the new line are tested against it. If
+     * auto-splitting is enabled, the new line and the lines it crosses or
+     * touches are split where they meet, so that the map stays planar.
+     * Otherwise, or if the new line overlaps an existing line, nothing is
+     * placed.
      *
-     * @param index The index of the vertex to remove.
+     * @param start The start position of the line.
+     * @param end The end position of the line.
      */
-    void removeVertex(int index);
+    void placeLine(glm::vec2 start, glm::vec2 end);
 
     /**
-     * @brief Removes the line at the specified index and rebuilds the buffer
-     * objects.
-     *
-     * This method removes the line at the specified index and rebuilds the
-     * vertex and line buffer objects.
-     *
-     * @param index The index of the line to remove.
+     * @brief Updates the sectors touched by the open transaction and closes
+     * it, so that undoing the edit also undoes its sector changes.
      */
-    void removeLine(int index);
+    void commitTransaction();
 
     /**
      * @brief Removes the vertex at the specified index.
      *
-     * This method removes the vertex at the specified index.
+     * This method removes the vertex at the specified index along with its
+     * lines, and the vertices left without lines.
      *
      * @param index The index of the vertex to remove.
      */
-    void removeVertexImpl(int index);
+    void removeVertex(int index);
 
     /**
      * @brief Removes the line at the specified index.
      *
-     * This method removes the line at the specified index.
+     * This method removes the line at the specified index, and its vertices
+     * if no other line uses them.
      *
      * @param index The index of the line to remove.
      */
-    void removeLineImpl(int index);
+    void removeLine(int index);
 
     /**
      * @brief Builds the vertex VBO.
      *
-     * This method builds the vertex VBO and the IBOs for the vertices and
-     * lines.
+     * This method rebuilds the vertex VBO and the line IBO from scratch in a
+     * single pass over the vertices and lines. Edits do not need it, as they
+     * patch the buffers in place.
      */
     void buildVertexVBO();
 
     /**
-     * @brief Gets the index of a free vertex in the vertex list.
+     * @brief Selects or deselects the specified element.
      *
-     * This method gets the index of a free vertex in the vertex list, or -1 if
-     * no free vertex is found.
+     * This method updates the highlight of the element in the render cache,
+     * dispatching on the element type.
      *
-     * @return The index of a free vertex.
+     * @param element The element to select or deselect.
+     * @param selected Whether the element is selected.
      */
-    int getFreeVertexIndex();
+    void selectElement(MapElement element, bool selected);
 
     /**
-     * @brief Gets the index of a free line in the line list.
+     * @brief Deletes the specified element.
      *
-     * This method gets the index of a free line in the line list, or -1 if no
-     * free line is found.
+     * This method removes the element from the map, dispatching on the
+     * element type.
      *
-     * @return The index of a free line.
+     * @param element The element to delete.
      */
-    int getFreeLineIndex();
+    void deleteElement(MapElement element);
+
+    /**
+     * @brief Selects every vertex and line of the map.
+     */
+    void selectAll();
+
+    /**
+     * @brief Inverts the selection of every vertex and line of the map.
+     */
+    void invertSelection();
+
+    /**
+     * @brief Selects the vertices and lines inside a region.
+     *
+     * This method queries the spatial indices for the elements overlapping
+     * the bounding box of the region, so its cost depends on the size of the
+     * region rather than the size of the map. Lines are selected when both of
+     * their vertices are inside the region.
+     *
+     * @param min The minimum corner of the bounding box of the region.
+     * @param max The maximum corner of the bounding box of the region.
+     * @param contains A function that checks if a point is inside the region.
+     */
+    void selectRegion(glm::vec2 min, glm::vec2 max,
+                      const std::function<bool(glm::vec2)>& contains);
+
+    /**
+     * @brief Checks if a point is inside a polygon.
+     *
+     * @param point The point.
+     * @param polygon The vertices of the polygon, in order.
+     * @return True if the point is inside the polygon, false otherwise.
+     */
+    static bool isInsidePolygon(glm::vec2 point,
+                                const std::vector<glm::vec2>& polygon);
+
+    /**
+     * @brief Ends the rubber band selection and selects the elements inside
+     * it.
+     */
+    void finishMarquee();
+
+    /**
+     * @brief Draws the outline of the rubber band selection.
+     */
+    void drawMarquee();
+
+    /**
+     * @brief Reverts the last edit of the map.
+     */
+    void undo();
+
+    /**
+     * @brief Reapplies the last reverted edit of the map.
+     */
+    void redo();
+
+    /**
+     * @brief Saves the map to the map file of the specified format.
+     *
+     * The binary map file is kept up to date by the journal, so saving it
+     * only flushes the edits that have not been written yet. While a chunked
+     * map is open, saving in the binary format writes back its dirty chunks
+     * instead.
+     *
+     * @param format The format of the file.
+     */
+    void saveMap(MapFileFormat format);
+
+    /**
+     * @brief Replaces the map with the contents of the map file of the
+     * specified format.
+     *
+     * The selection and the undo history are cleared. The binary map file is
+     * read along with its journal, and WAD files are read from their first
+     * map.
+     *
+     * @param format The format of the file.
+     */
+    void loadMap(MapFileFormat format);
+
+    /**
+     * @brief Merges the vertices closer than the weld tolerance as one
+     * undoable edit, and logs what was changed.
+     *
+     * The selection is cleared, since welding removes elements.
+     */
+    void weldVertices();
+
+    /**
+     * @brief Replaces the map with a dungeon generated from the next seed.
+     *
+     * The selection and the prefab instances are cleared. Unlike a load, the
+     * replacement is made of edits in one transaction, so it can be undone
+     * and the journal records it instead of writing a new base.
+     *
+     * @param style The kind of dungeon to generate.
+     */
+    void generateDungeon(DungeonStyle style);
+
+    /**
+     * @brief Writes the map as a chunked map that can be opened for
+     * streaming.
+     */
+    void chunkMap();
+
+    /**
+     * @brief Replaces the map with the chunks of the chunked map around the
+     * view, which are then paged in and out as the view moves.
+     *
+     * The journal and the sector detector are detached while streaming, as
+     * the map only holds part of the chunked map. The selection, the prefab
+     * instances and the undo history are cleared, as when a map is loaded.
+     */
+    void openChunkedMap();
+
+    /**
+     * @brief Writes back the edits of the chunked map and reattaches the
+     * journal and the sector detector, restoring the map of the journal.
+     */
+    void closeChunkedMap();
+
+    /**
+     * @brief Pages the chunks in and out of the map for the current view.
+     *
+     * Paging only adds and removes elements, so the indices of the others
+     * stay valid. The evicted elements are deselected, and the transactions
+     * referring to the slots paging touched are dropped from the history.
+     */
+    void pageChunks();
+
+    /**
+     * @brief Checks the map for problems and writes the report.
+     *
+     * The number of issues is logged, and the issues themselves are written
+     * to the report file as JSON.
+     */
+    void validateMap();
+
+    /**
+     * @brief Copies the selected lines to the clipboard.
+     *
+     * @return True if any line was copied, false otherwise.
+     */
+    bool copySelection();
+
+    /**
+     * @brief Copies the selected lines to the clipboard, then deletes the
+     * selection as one undoable edit.
+     */
+    void cutSelection();
+
+    /**
+     * @brief Inserts the clipboard at the grid point under the cursor as one
+     * undoable edit, and selects the inserted lines and vertices.
+     *
+     * The elements are appended in bulk rather than placed line by line, so
+     * pasted lines are not split where they cross existing lines.
+     */
+    void paste();
+
+    /**
+     * @brief Makes a prefab of the selected lines and makes it the active
+     * prefab.
+     */
+    void createPrefab();
+
+    /**
+     * @brief Stamps the active prefab at the grid point under the cursor.
+     *
+     * Instances share the geometry of their prefab and are not part of the
+     * map until they are unpacked, so stamping is not recorded in the undo
+     * history or the journal.
+     */
+    void stampPrefab();
+
+    /**
+     * @brief Removes the prefab instance under the cursor.
+     */
+    void removePrefabInstance();
+
+    /**
+     * @brief Copies the geometry of the prefab instance under the cursor into
+     * the map as one undoable edit, so that it can be edited, and removes the
+     * instance.
+     */
+    void unpackPrefabInstance();
+
+    /**
+     * @brief Selects the vertices and lines appended to the map.
+     *
+     * @param added The indices of the appended elements.
+     */
+    void selectAppended(const AppendedElements& added);
+
+    /**
+     * @brief Gets the grid point closest to the cursor.
+     *
+     * @return The grid point.
+     */
+    glm::vec2 getCursorGridPoint();
+
+    /**
+     * @brief Checks if a box fits the range of map coordinates, and warns if
+     * it does not.
+     *
+     * @param min The minimum corner of the box.
+     * @param max The maximum corner of the box.
+     * @return True if the box fits, false otherwise.
+     */
+    bool checkInRange(glm::vec2 min, glm::vec2 max) const;
+
+    /**
+     * @brief Gets the map file format selected by the held modifier keys.
+     *
+     * Shift selects the text format, Alt selects the WAD format, and no
+     * modifier selects the binary format.
+     *
+     * @return The selected format.
+     */
+    MapFileFormat getHeldMapFileFormat() const;
+
+    /**
+     * @brief Gets the path of the map file of the specified format.
+     *
+     * @param format The format of the file.
+     * @return The path of the file.
+     */
+    static const char* getMapPath(MapFileFormat format);
+
+    /**
+     * @brief Moves the dragged vertex to the grid point under the cursor.
+     */
+    void dragVertex();
+
+    /**
+     * @brief Ends the drag of a vertex.
+     *
+     * This method commits the moves made during the drag to the history as a
+     * single edit.
+     */
+    void finishDrag();
 
     /**
      * @brief Handles the select mode.
@@ -284,6 +626,15 @@ private:
      */
     void onMouseButtonPress(MouseButtonPressedEvent& event);
 
+    /**
+     * @brief Handles the mouse button release event.
+     *
+     * This method handles the mouse button release event.
+     *
+     * @param event The mouse button release event.
+     */
+    void onMouseButtonRelease(MouseButtonReleasedEvent& event);
+
     /**
      * @brief Handles the key release event.
      *
@@ -0,0 +1,235 @@
+#include "MapRenderCache.h"
+
+#include "utils/macros.h"
+
+int MapRenderCache::addVertex(int vertex, glm::vec2 position)
+{
+    ASSERT(vertex >= 0);
+    ASSERT(getVertexSlot(vertex) == -1);
+
+    if (vertex >= vertexSlots.size()) vertexSlots.resize(vertex + 1, -1);
+
+    // The vertex takes the next slot at the end of the vertex buffer
+    int slot = vertices.size();
+    vertexSlots.at(vertex) = slot;
+    slotVertices.push_back(vertex);
+    vertices.push_back({{position.x, position.y, 0.0f}});
+    setBit(vertexSelection, dirtyVertexSelection, slot, false);
+
+    dirtyVertices.mark(slot);
+
+    return slot;
+}
+
+void MapRenderCache::removeVertex(int vertex)
+{
+    int slot = getVertexSlot(vertex);
+    ASSERT(slot != -1);
+
+    int lastSlot = vertices.size() - 1;
+    if (slot != lastSlot)
+    {
+        // Move the last vertex into the freed slot
+        int moved = slotVertices.at(lastSlot);
+        vertices.at(slot) = vertices.at(lastSlot);
+        setBit(vertexSelection, dirtyVertexSelection, slot,
+               getBit(vertexSelection, lastSlot));
+        slotVertices.at(slot) = moved;
+        vertexSlots.at(moved) = slot;
+
+        dirtyVertices.mark(slot);
+
+        // Point the lines of the moved vertex at its new slot. A front
+        // half-edge leaves the start vertex of its line and a back half-edge
+        // leaves the end vertex.
+        for (int halfEdge : topology.getOutgoing(moved))
+        {
+            int lineSlot = getLineSlot(MapTopology::getLine(halfEdge));
+            if (lineSlot == -1) continue;
+
+            int entry = 2 * lineSlot + (MapTopology::isBack(halfEdge) ? 1 : 0);
+            lineIndices.at(entry) = slot;
+            dirtyLineIndices.mark(entry);
+        }
+    }
+
+    setBit(vertexSelection, dirtyVertexSelection, lastSlot, false);
+    shrinkBits(vertexSelection, lastSlot);
+
+    vertices.pop_back();
+    slotVertices.pop_back();
+    vertexSlots.at(vertex) = -1;
+}
+
+void MapRenderCache::setVertexPosition(int vertex, glm::vec2 position)
+{
+    int slot = getVertexSlot(vertex);
+    ASSERT(slot != -1);
+
+    vertices.at(slot) = {{position.x, position.y, 0.0f}};
+    dirtyVertices.mark(slot);
+}
+
+int MapRenderCache::addLine(int line, int startVertex, int endVertex)
+{
+    ASSERT(line >= 0);
+    ASSERT(getLineSlot(line) == -1);
+
+    int startSlot = getVertexSlot(startVertex);
+    ASSERT(startSlot != -1);
+    int endSlot = getVertexSlot(endVertex);
+    ASSERT(endSlot != -1);
+
+    if (line >= lineSlots.size()) lineSlots.resize(line + 1, -1);
+
+    // The line takes the next slot at the end of the line index buffer
+    int slot = slotLines.size();
+    lineSlots.at(line) = slot;
+    slotLines.push_back(line);
+    lineIndices.push_back(startSlot);
+    lineIndices.push_back(endSlot);
+    setBit(lineSelection, dirtyLineSelection, slot, false);
+
+    dirtyLineIndices.mark(2 * slot, 2 * slot + 2);
+
+    return slot;
+}
+
+void MapRenderCache::removeLine(int line)
+{
+    int slot = getLineSlot(line);
+    ASSERT(slot != -1);
+
+    int lastSlot = slotLines.size() - 1;
+    if (slot != lastSlot)
+    {
+        // Move the last line into the freed slot
+        int moved = slotLines.at(lastSlot);
+        lineIndices.at(2 * slot) = lineIndices.at(2 * lastSlot);
+        lineIndices.at(2 * slot + 1) = lineIndices.at(2 * lastSlot + 1);
+        setBit(lineSelection, dirtyLineSelection, slot,
+               getBit(lineSelection, lastSlot));
+        slotLines.at(slot) = moved;
+        lineSlots.at(moved) = slot;
+
+        dirtyLineIndices.mark(2 * slot, 2 * slot + 2);
+    }
+
+    setBit(lineSelection, dirtyLineSelection, lastSlot, false);
+    shrinkBits(lineSelection, lastSlot);
+
+    lineIndices.pop_back();
+    lineIndices.pop_back();
+    slotLines.pop_back();
+    lineSlots.at(line) = -1;
+}
+
+void MapRenderCache::setVertexSelected(int vertex, bool selected)
+{
+    int slot = getVertexSlot(vertex);
+    ASSERT(slot != -1);
+
+    setBit(vertexSelection, dirtyVertexSelection, slot, selected);
+}
+
+void MapRenderCache::setLineSelected(int line, bool selected)
+{
+    int slot = getLineSlot(line);
+    ASSERT(slot != -1);
+
+    setBit(lineSelection, dirtyLineSelection, slot, selected);
+}
+
+void MapRenderCache::onVertexAdded(int vertex, glm::vec2 position)
+{
+    addVertex(vertex, position);
+}
+
+void MapRenderCache::onVertexRemoved(int vertex, glm::vec2 position)
+{
+    removeVertex(vertex);
+}
+
+void MapRenderCache::onVertexMoved(int vertex, glm::vec2 from, glm::vec2 to)
+{
+    setVertexPosition(vertex, to);
+}
+
+void MapRenderCache::onLineAdded(int index, const Line& line)
+{
+    addLine(index, line.startVertex, line.endVertex);
+}
+
+void MapRenderCache::onLineRemoved(int index, const Line& line)
+{
+    removeLine(index);
+}
+
+void MapRenderCache::onMapLoaded(const MapStore& store) { rebuild(store); }
+
+void MapRenderCache::clear()
+{
+    vertices.clear();
+    lineIndices.clear();
+    vertexSelection.clear();
+    lineSelection.clear();
+    vertexSlots.clear();
+    slotVertices.clear();
+    lineSlots.clear();
+    slotLines.clear();
+    clearDirty();
+}
+
+void MapRenderCache::rebuild(const MapStore& store)
+{
+    clear();
+
+    const std::vector<LineVertex>& positions = store.getVertexPositions();
+    const std::vector<uint32_t>& vertexIndices = store.getVertexIndices();
+
+    vertices.reserve(positions.size());
+    slotVertices.reserve(positions.size());
+    for (size_t i = 0; i < positions.size(); ++i)
+        addVertex(vertexIndices[i], {positions[i].x, positions[i].y});
+
+    const std::vector<Line>& lines = store.getLines();
+    const std::vector<uint32_t>& lineIndices = store.getLineIndices();
+
+    this->lineIndices.reserve(2 * lines.size());
+    slotLines.reserve(lines.size());
+    for (size_t i = 0; i < lines.size(); ++i)
+        addLine(lineIndices[i], lines[i].startVertex, lines[i].endVertex);
+}
+
+void MapRenderCache::clearDirty()
+{
+    dirtyVertices.clear();
+    dirtyLineIndices.clear();
+    dirtyVertexSelection.clear();
+    dirtyLineSelection.clear();
+}
+
+void MapRenderCache::setBit(std::vector<uint32_t>& bits, DirtyRanges& dirty,
+                            int slot, bool value)
+{
+    size_t word = slot / 32;
+    if (word >= bits.size())
+    {
+        // New words start cleared and must be uploaded
+        dirty.mark(bits.size(), word + 1);
+        bits.resize(word + 1, 0);
+    }
+
+    uint32_t mask = uint32_t(1) << (slot % 32);
+    uint32_t updated = value ? (bits[word] | mask) : (bits[word] & ~mask);
+    if (updated == bits[word]) return;
+
+    bits[word] = updated;
+    dirty.mark(word);
+}
+
+void MapRenderCache::shrinkBits(std::vector<uint32_t>& bits, size_t slotCount)
+{
+    // The removed slots were cleared, so the dropped words hold no bits
+    bits.resize((slotCount + 31) / 32);
+}
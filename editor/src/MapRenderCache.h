@@ -0,0 +1,442 @@
+#pragma once
+
+#include <graphics/Vertex.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "map/MapListener.h"
+#include "map/MapStore.h"
+#include "map/MapTopology.h"
+
+using namespace Engine;
+
+/**
+ * @brief A struct representing a range [begin, end) of dirty buffer elements.
+ */
+struct DirtyRange
+{
+    // Index of the first dirty element
+    size_t begin;
+    // Index one past the last dirty element
+    size_t end;
+
+    /**
+     * @brief Gets the number of elements in the range.
+     *
+     * @return The number of elements in the range.
+     */
+    inline size_t getCount() const { return end - begin; }
+};
+
+/**
+ * @brief A struct representing the dirty elements of a buffer as a short
+ * list of ranges.
+ *
+ * The ranges are kept sorted and disjoint, and a marked range that overlaps
+ * or touches one is merged into it. When there are more than MAX_RANGES
+ * ranges, the two closest ones are merged. A swap-remove dirties the removed
+ * slot and the fix-ups of the moved element at unrelated slots, so covering
+ * them with one range would upload most of the buffer.
+ */
+struct DirtyRanges
+{
+    // The largest number of ranges kept before the closest ones are merged
+    static constexpr size_t MAX_RANGES = 16;
+
+    /**
+     * @brief Marks the element at the specified index as dirty.
+     *
+     * @param index The index of the element.
+     */
+    inline void mark(size_t index) { mark(index, index + 1); }
+
+    /**
+     * @brief Marks the elements in [first, last) as dirty.
+     *
+     * @param first The index of the first element.
+     * @param last The index one past the last element.
+     */
+    void mark(size_t first, size_t last)
+    {
+        if (first >= last) return;
+
+        // Most marks extend the last range, as elements are appended
+        if (!ranges.empty() && ranges.back().begin <= first)
+        {
+            DirtyRange& back = ranges.back();
+            if (first <= back.end)
+            {
+                back.end = std::max(back.end, last);
+                return;
+            }
+        }
+
+        // Find the first range that ends at or after the new one starts, and
+        // merge every range the new one overlaps or touches into it
+        auto it = std::lower_bound(ranges.begin(), ranges.end(), first,
+                                   [](const DirtyRange& range, size_t index)
+                                   { return range.end < index; });
+        auto merged = it;
+        while (merged != ranges.end() && merged->begin <= last)
+        {
+            first = std::min(first, merged->begin);
+            last = std::max(last, merged->end);
+            ++merged;
+        }
+
+        it = ranges.erase(it, merged);
+        ranges.insert(it, {first, last});
+
+        if (ranges.size() > MAX_RANGES) mergeClosest();
+    }
+
+    /**
+     * @brief Checks if no element is dirty.
+     *
+     * @return True if no element is dirty, false otherwise.
+     */
+    inline bool isEmpty() const { return ranges.empty(); }
+
+    /**
+     * @brief Gets the dirty ranges.
+     *
+     * @return The ranges, sorted and disjoint.
+     */
+    inline const std::vector<DirtyRange>& getRanges() const { return ranges; }
+
+    /**
+     * @brief Gets the number of dirty elements.
+     *
+     * @return The number of elements in the ranges.
+     */
+    inline size_t getCount() const
+    {
+        size_t count = 0;
+        for (const DirtyRange& range : ranges) count += range.getCount();
+        return count;
+    }
+
+    /**
+     * @brief Clears the ranges.
+     */
+    inline void clear() { ranges.clear(); }
+
+private:
+    // The dirty ranges, sorted and disjoint
+    std::vector<DirtyRange> ranges;
+
+    /**
+     * @brief Merges the two ranges with the smallest gap between them.
+     */
+    void mergeClosest()
+    {
+        size_t best = 0;
+        for (size_t i = 1; i + 1 < ranges.size(); ++i)
+        {
+            if (ranges[i + 1].begin - ranges[i].end <
+                ranges[best + 1].begin - ranges[best].end)
+                best = i;
+        }
+
+        ranges[best].end = ranges[best + 1].end;
+        ranges.erase(ranges.begin() + best + 1);
+    }
+};
+
+/**
+ * @brief A class that keeps the GPU-side buffers of the map up to date.
+ *
+ * This class owns the CPU copies of the vertex buffer, the line index buffer
+ * and the vertex and line selection bitfields used to draw the map. Selection
+ * is packed one bit per slot into 32-bit words, which shaders read from buffer
+ * textures by gl_VertexID and gl_PrimitiveID. Map edits are applied
+ * in place: new elements are appended, and removed elements are replaced by
+ * the last element of their buffer (swap-remove) with the indices that
+ * referred to the moved element fixed up through the map topology. Every edit
+ * marks the slots (or selection words) it touched as dirty, so only those
+ * byte ranges need to be uploaded.
+ *
+ * The cache follows a Map as one of its listeners, so every edit of the map
+ * is mirrored into the buffers as it is made.
+ */
+class MapRenderCache : public MapListener
+{
+public:
+    /**
+     * @brief Constructs a new MapRenderCache object.
+     *
+     * @param topology The topology of the map, used to find the lines that
+     * refer to a vertex when its slot moves.
+     */
+    explicit MapRenderCache(const MapTopology& topology) : topology(topology)
+    {
+    }
+
+    /**
+     * @brief Appends a vertex to the vertex buffer.
+     *
+     * @param vertex The index of the vertex.
+     * @param position The position of the vertex.
+     * @return The slot of the vertex in the vertex buffer.
+     */
+    int addVertex(int vertex, glm::vec2 position);
+
+    /**
+     * @brief Removes a vertex from the vertex buffer.
+     *
+     * This method moves the last vertex of the buffer into the slot of the
+     * removed vertex and rewrites the line indices that referred to the
+     * moved vertex. The vertex must no longer have any lines.
+     *
+     * @param vertex The index of the vertex.
+     */
+    void removeVertex(int vertex);
+
+    /**
+     * @brief Moves a vertex in the vertex buffer.
+     *
+     * @param vertex The index of the vertex.
+     * @param position The new position of the vertex.
+     */
+    void setVertexPosition(int vertex, glm::vec2 position);
+
+    /**
+     * @brief Appends a line to the line index buffer.
+     *
+     * Both vertices must already be in the vertex buffer.
+     *
+     * @param line The index of the line.
+     * @param startVertex The index of the start vertex.
+     * @param endVertex The index of the end vertex.
+     * @return The slot of the line in the line index buffer.
+     */
+    int addLine(int line, int startVertex, int endVertex);
+
+    /**
+     * @brief Removes a line from the line index buffer.
+     *
+     * This method moves the last line of the buffer into the slot of the
+     * removed line.
+     *
+     * @param line The index of the line.
+     */
+    void removeLine(int line);
+
+    /**
+     * @brief Sets whether the specified vertex is drawn as selected.
+     *
+     * @param vertex The index of the vertex.
+     * @param selected Whether the vertex is selected.
+     */
+    void setVertexSelected(int vertex, bool selected);
+
+    /**
+     * @brief Sets whether the specified line is drawn as selected.
+     *
+     * @param line The index of the line.
+     * @param selected Whether the line is selected.
+     */
+    void setLineSelected(int line, bool selected);
+
+    void onVertexAdded(int vertex, glm::vec2 position) override;
+
+    void onVertexRemoved(int vertex, glm::vec2 position) override;
+
+    void onVertexMoved(int vertex, glm::vec2 from, glm::vec2 to) override;
+
+    void onLineAdded(int index, const Line& line) override;
+
+    void onLineRemoved(int index, const Line& line) override;
+
+    void onMapLoaded(const MapStore& store) override;
+
+    /**
+     * @brief Gets the slot of the specified vertex in the vertex buffer.
+     *
+     * @param vertex The index of the vertex.
+     * @return The slot of the vertex, or -1 if the vertex is not in the
+     * buffer.
+     */
+    inline int getVertexSlot(int vertex) const
+    {
+        if (vertex < 0 || vertex >= vertexSlots.size()) return -1;
+        return vertexSlots[vertex];
+    }
+
+    /**
+     * @brief Gets the slot of the specified line in the line index buffer.
+     *
+     * @param line The index of the line.
+     * @return The slot of the line, or -1 if the line is not in the buffer.
+     */
+    inline int getLineSlot(int line) const
+    {
+        if (line < 0 || line >= lineSlots.size()) return -1;
+        return lineSlots[line];
+    }
+
+    /**
+     * @brief Removes every vertex and line from the buffers.
+     */
+    void clear();
+
+    /**
+     * @brief Rebuilds the buffers from scratch in a single pass over the
+     * vertices and lines of a store.
+     *
+     * Every selection bit is cleared.
+     *
+     * @param store The elements of the map.
+     */
+    void rebuild(const MapStore& store);
+
+    /**
+     * @brief Clears the dirty ranges after the buffers have been uploaded.
+     */
+    void clearDirty();
+
+    /**
+     * @brief Gets the vertex buffer.
+     *
+     * @return The vertex buffer, one entry per vertex slot.
+     */
+    inline const std::vector<Vertex>& getVertices() const { return vertices; }
+
+    /**
+     * @brief Gets the vertex selection bitfield.
+     *
+     * @return The selection bits of the vertex slots, 32 per word.
+     */
+    inline const std::vector<uint32_t>& getVertexSelection() const
+    {
+        return vertexSelection;
+    }
+
+    /**
+     * @brief Gets the line selection bitfield.
+     *
+     * @return The selection bits of the line slots, 32 per word.
+     */
+    inline const std::vector<uint32_t>& getLineSelection() const
+    {
+        return lineSelection;
+    }
+
+    /**
+     * @brief Gets the line index buffer.
+     *
+     * @return The line index buffer, two entries per line slot.
+     */
+    inline const std::vector<unsigned int>& getLineIndices() const
+    {
+        return lineIndices;
+    }
+
+    /**
+     * @brief Gets the ranges of vertex slots that need to be uploaded.
+     *
+     * @return The dirty ranges of the vertex buffer.
+     */
+    inline const DirtyRanges& getDirtyVertices() const { return dirtyVertices; }
+
+    /**
+     * @brief Gets the ranges of vertex selection words that need to be
+     * uploaded.
+     *
+     * @return The dirty ranges of the vertex selection bitfield.
+     */
+    inline const DirtyRanges& getDirtyVertexSelection() const
+    {
+        return dirtyVertexSelection;
+    }
+
+    /**
+     * @brief Gets the ranges of line selection words that need to be
+     * uploaded.
+     *
+     * @return The dirty ranges of the line selection bitfield.
+     */
+    inline const DirtyRanges& getDirtyLineSelection() const
+    {
+        return dirtyLineSelection;
+    }
+
+    /**
+     * @brief Gets the ranges of line index entries that need to be
+     * uploaded.
+     *
+     * @return The dirty ranges of the line index buffer.
+     */
+    inline const DirtyRanges& getDirtyLineIndices() const
+    {
+        return dirtyLineIndices;
+    }
+
+private:
+    // The topology of the map
+    const MapTopology& topology;
+
+    // The vertex buffer, one entry per vertex slot
+    std::vector<Vertex> vertices;
+    // The line index buffer, two entries per line slot
+    std::vector<unsigned int> lineIndices;
+    // The selection bits of the vertex slots
+    std::vector<uint32_t> vertexSelection;
+    // The selection bits of the line slots
+    std::vector<uint32_t> lineSelection;
+
+    // A map of vertex indices to their slot (-1 if none)
+    std::vector<int> vertexSlots;
+    // A map of vertex slots to the vertex indices they hold
+    std::vector<int> slotVertices;
+    // A map of line indices to their slot (-1 if none)
+    std::vector<int> lineSlots;
+    // A map of line slots to the line indices they hold
+    std::vector<int> slotLines;
+
+    // The vertex slots that need to be uploaded
+    DirtyRanges dirtyVertices;
+    // The line index entries that need to be uploaded
+    DirtyRanges dirtyLineIndices;
+    // The vertex selection words that need to be uploaded
+    DirtyRanges dirtyVertexSelection;
+    // The line selection words that need to be uploaded
+    DirtyRanges dirtyLineSelection;
+
+    /**
+     * @brief Gets the selection bit of a slot.
+     *
+     * @param bits The selection bitfield.
+     * @param slot The slot.
+     * @return True if the bit is set, false otherwise.
+     */
+    static inline bool getBit(const std::vector<uint32_t>& bits, int slot)
+    {
+        return (bits[slot / 32] >> (slot % 32)) & 1;
+    }
+
+    /**
+     * @brief Sets or clears the selection bit of a slot.
+     *
+     * The bitfield grows to cover the slot, and the word holding the bit is
+     * marked dirty if it changes.
+     *
+     * @param bits The selection bitfield.
+     * @param dirty The dirty ranges of the bitfield.
+     * @param slot The slot.
+     * @param value Whether to set the bit.
+     */
+    static void setBit(std::vector<uint32_t>& bits, DirtyRanges& dirty,
+                       int slot, bool value);
+
+    /**
+     * @brief Shrinks a selection bitfield to the specified number of slots.
+     *
+     * @param bits The selection bitfield.
+     * @param slotCount The number of slots.
+     */
+    static void shrinkBits(std::vector<uint32_t>& bits, size_t slotCount);
+};
\ No newline at end of file
@@ -0,0 +1,274 @@
+#include "Minimap.h"
+
+#include <algorithm>
+#include <cmath>
+
+// The color of the texture where there are no lines
+static const glm::vec4 BACKGROUND_COLOR = {0.1f, 0.1f, 0.1f, 0.85f};
+
+Minimap::Minimap(const Map& map) : map(map)
+{
+    lineShader.addShader(ShaderType::VERTEX, "res/shaders/line.vert");
+    lineShader.addShader(ShaderType::GEOMETRY, "res/shaders/line.geom");
+    lineShader.addShader(ShaderType::FRAGMENT, "res/shaders/line.frag");
+    lineShader.compileShader();
+
+    quadShader.addShader(ShaderType::VERTEX, "res/shaders/minimap.vert");
+    quadShader.addShader(ShaderType::FRAGMENT, "res/shaders/minimap.frag");
+    quadShader.compileShader();
+
+    framebuffer = std::make_unique<Framebuffer>(TEXTURE_SIZE, TEXTURE_SIZE);
+
+    // The quad is placed on the screen by the vertex shader
+    glm::vec4 white = {1.0f, 1.0f, 1.0f, 1.0f};
+    std::vector<Vertex> corners = {{{0.0f, 0.0f, 0.0f}, white, {0.0f, 0.0f}},
+                                   {{1.0f, 0.0f, 0.0f}, white, {1.0f, 0.0f}},
+                                   {{1.0f, 1.0f, 0.0f}, white, {1.0f, 1.0f}},
+                                   {{0.0f, 1.0f, 0.0f}, white, {0.0f, 1.0f}}};
+    quad = std::make_unique<Mesh>("minimap", corners,
+                                  std::vector<unsigned int>{0, 1, 2, 0, 2, 3});
+}
+
+void Minimap::onVertexMoved(int vertex, glm::vec2 from, glm::vec2 to)
+{
+    // The lines of the vertex are erased where they were and drawn where
+    // they are
+    const MapTopology& topology = map.getTopology();
+    for (int halfEdge : topology.getOutgoing(vertex))
+    {
+        glm::vec2 other = getPosition(topology.getDestination(halfEdge));
+        markSegmentDirty(other, from);
+        markSegmentDirty(other, to);
+    }
+}
+
+void Minimap::onLineAdded(int index, const Line& line)
+{
+    markSegmentDirty(getPosition(line.startVertex),
+                     getPosition(line.endVertex));
+}
+
+void Minimap::onLineRemoved(int index, const Line& line)
+{
+    // The vertices of a line outlive it, so their positions are still stored
+    markSegmentDirty(getPosition(line.startVertex),
+                     getPosition(line.endVertex));
+}
+
+void Minimap::onMapLoaded(const MapStore& store)
+{
+    isRedrawNeeded = true;
+    dirtyRegions.clear();
+}
+
+void Minimap::draw(const Camera2D& camera)
+{
+    refresh();
+
+    float width = Application::getInstance().getWindow().getWidth();
+    float height = Application::getInstance().getWindow().getHeight();
+
+    // Place the quad in the top-right corner, in normalized device
+    // coordinates
+    float right = 1.0f - 2.0f * SCREEN_MARGIN / width;
+    float top = 1.0f - 2.0f * SCREEN_MARGIN / height;
+    float left = right - 2.0f * SCREEN_SIZE / width;
+    float bottom = top - 2.0f * SCREEN_SIZE / height;
+
+    // Find the view of the camera in texture coordinates
+    glm::vec3 cameraPos = camera.getPosition();
+    glm::vec2 halfView =
+        glm::vec2(width / 2.0f, height / 2.0f) * camera.getZoom();
+    glm::vec2 viewMin =
+        (glm::vec2(cameraPos) - halfView - origin) / worldSize;
+    glm::vec2 viewMax =
+        (glm::vec2(cameraPos) + halfView - origin) / worldSize;
+
+    framebuffer->bindTexture(0);
+    quadShader.bind();
+    quadShader.setUniform1i("u_Texture", 0);
+    quadShader.setUniform4f("u_Rect", left, bottom, right, top);
+    quadShader.setUniform4f("u_View", viewMin.x, viewMin.y, viewMax.x,
+                            viewMax.y);
+    quad->draw(quadShader);
+    quadShader.unbind();
+    framebuffer->unbindTexture();
+}
+
+void Minimap::markDirty(glm::vec2 min, glm::vec2 max)
+{
+    if (isRedrawNeeded) return;
+
+    // The texture must be refitted to show elements outside of it
+    glm::vec2 end = origin + glm::vec2(worldSize);
+    if (min.x < origin.x || min.y < origin.y || max.x > end.x ||
+        max.y > end.y)
+    {
+        isRedrawNeeded = true;
+        dirtyRegions.clear();
+        return;
+    }
+
+    dirtyRegions.push_back({min, max});
+
+    // Bound the work left for the next frame by merging the regions
+    if (dirtyRegions.size() > MAX_DIRTY_REGIONS)
+    {
+        Region merged = dirtyRegions.front();
+        for (const Region& region : dirtyRegions)
+        {
+            merged.min = glm::min(merged.min, region.min);
+            merged.max = glm::max(merged.max, region.max);
+        }
+
+        dirtyRegions.assign(1, merged);
+    }
+}
+
+void Minimap::markSegmentDirty(glm::vec2 start, glm::vec2 end)
+{
+    markDirty(glm::min(start, end), glm::max(start, end));
+}
+
+void Minimap::refresh()
+{
+    if (!isRedrawNeeded && dirtyRegions.empty()) return;
+
+    framebuffer->bind();
+
+    // Fall back to a full redraw if a region is too large to patch
+    if (!isRedrawNeeded)
+    {
+        for (const Region& region : dirtyRegions)
+        {
+            if (!patch(region))
+            {
+                isRedrawNeeded = true;
+                break;
+            }
+        }
+
+        framebuffer->clearScissor();
+    }
+
+    if (isRedrawNeeded) redraw();
+
+    framebuffer->unbind();
+
+    isRedrawNeeded = false;
+    dirtyRegions.clear();
+}
+
+void Minimap::redraw()
+{
+    const std::vector<LineVertex>& positions =
+        map.getStore().getVertexPositions();
+
+    // Fit the texture to the bounds of the map, with room to grow
+    glm::vec2 min(0.0f), max(0.0f);
+    if (!positions.empty())
+    {
+        min = max = {positions[0].x, positions[0].y};
+        for (const LineVertex& position : positions)
+        {
+            glm::vec2 point = {position.x, position.y};
+            min = glm::min(min, point);
+            max = glm::max(max, point);
+        }
+    }
+
+    glm::vec2 size = max - min;
+    float padding = 1.0f + 2.0f * BOUNDS_PADDING;
+    worldSize = std::max(std::max(size.x, size.y) * padding, MIN_WORLD_SIZE);
+    origin = (min + max) / 2.0f - glm::vec2(worldSize / 2.0f);
+
+    std::vector<int> lines;
+    const std::vector<uint32_t>& indices = map.getStore().getLineIndices();
+    lines.assign(indices.begin(), indices.end());
+
+    framebuffer->clear(BACKGROUND_COLOR);
+    drawLines(lines);
+}
+
+bool Minimap::patch(const Region& region)
+{
+    float texelSize = getTexelSize();
+
+    // Round the region out to whole texels, with room for the line weight
+    int minX = (int)std::floor((region.min.x - origin.x) / texelSize);
+    int minY = (int)std::floor((region.min.y - origin.y) / texelSize);
+    int maxX = (int)std::ceil((region.max.x - origin.x) / texelSize);
+    int maxY = (int)std::ceil((region.max.y - origin.y) / texelSize);
+    minX = std::max(minX - TEXEL_MARGIN, 0);
+    minY = std::max(minY - TEXEL_MARGIN, 0);
+    maxX = std::min(maxX + TEXEL_MARGIN, TEXTURE_SIZE);
+    maxY = std::min(maxY + TEXEL_MARGIN, TEXTURE_SIZE);
+
+    int width = maxX - minX;
+    int height = maxY - minY;
+    if (width <= 0 || height <= 0) return true;
+
+    // Querying a large region costs more than drawing every line
+    if ((float)width * height >
+        MAX_PATCH_FRACTION * TEXTURE_SIZE * TEXTURE_SIZE)
+        return false;
+
+    // Lines ending just outside the region still cover its edge texels
+    glm::vec2 min = origin + glm::vec2(minX - 1, minY - 1) * texelSize;
+    glm::vec2 max = origin + glm::vec2(maxX + 1, maxY + 1) * texelSize;
+
+    std::vector<int> lines;
+    map.queryLines(min, max,
+                   [&](int line)
+                   {
+                       lines.push_back(line);
+                       return true;
+                   });
+
+    framebuffer->setScissor(minX, minY, width, height);
+    framebuffer->clear(BACKGROUND_COLOR);
+    drawLines(lines);
+
+    return true;
+}
+
+void Minimap::drawLines(const std::vector<int>& lines)
+{
+    if (lines.empty()) return;
+
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    vertices.reserve(lines.size() * 2);
+    indices.reserve(lines.size() * 2);
+
+    const MapStore& store = map.getStore();
+    for (int index : lines)
+    {
+        const Line& line = store.getLine(index);
+        glm::vec2 start = getPosition(line.startVertex);
+        glm::vec2 end = getPosition(line.endVertex);
+
+        indices.push_back(vertices.size());
+        vertices.push_back({{start.x, start.y, 0.0f}});
+        indices.push_back(vertices.size());
+        vertices.push_back({{end.x, end.y, 0.0f}});
+    }
+
+    Mesh mesh("minimapLines", vertices, indices, MeshType::LINES);
+
+    glm::mat4 projection = glm::ortho(origin.x, origin.x + worldSize, origin.y,
+                                      origin.y + worldSize, -1.0f, 1.0f);
+
+    lineShader.bind();
+    lineShader.setUniform1f("u_LineWeight", getTexelSize());
+    lineShader.setUniformMat4f("u_VP", projection);
+    lineShader.setUniform1i("u_ShowSelection", 0);
+    mesh.draw(lineShader);
+    lineShader.unbind();
+}
+
+glm::vec2 Minimap::getPosition(int vertex) const
+{
+    const LineVertex& position = map.getStore().getVertex(vertex);
+    return {position.x, position.y};
+}
\ No newline at end of file
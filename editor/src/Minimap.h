@@ -0,0 +1,167 @@
+#pragma once
+
+#include <Engine.h>
+
+#include <memory>
+#include <vector>
+
+#include "map/Map.h"
+#include "map/MapListener.h"
+
+using namespace Engine;
+
+/**
+ * @brief A class that draws an overview of the whole map in a corner of the
+ * window.
+ *
+ * The lines of the map are rendered once into an offscreen texture, which is
+ * then drawn as a single textured quad every frame. Edits mark the bounding
+ * boxes of the lines they touch as dirty, and only those regions of the
+ * texture are cleared and redrawn, from the lines the spatial index finds in
+ * them. The whole texture is only redrawn when the map is loaded or grows
+ * past the area the texture covers.
+ */
+class Minimap : public MapListener
+{
+public:
+    /**
+     * @brief Constructs a new Minimap object for the specified map.
+     *
+     * The minimap must be added as a listener of the map to follow its edits.
+     *
+     * @param map The map to draw.
+     */
+    Minimap(const Map& map);
+
+    Minimap(const Minimap&) = delete;
+    Minimap& operator=(const Minimap&) = delete;
+
+    void onVertexMoved(int vertex, glm::vec2 from, glm::vec2 to) override;
+
+    void onLineAdded(int index, const Line& line) override;
+
+    void onLineRemoved(int index, const Line& line) override;
+
+    void onMapLoaded(const MapStore& store) override;
+
+    /**
+     * @brief Redraws the dirty regions of the texture, then draws it in the
+     * top-right corner of the window with the view of the camera outlined.
+     *
+     * @param camera The camera used to view the scene.
+     */
+    void draw(const Camera2D& camera);
+
+private:
+    /**
+     * @brief A struct representing a box of the map that must be redrawn.
+     */
+    struct Region
+    {
+        // The minimum corner of the box
+        glm::vec2 min;
+        // The maximum corner of the box
+        glm::vec2 max;
+    };
+
+    // The width and height of the texture in texels
+    static constexpr int TEXTURE_SIZE = 512;
+    // The width and height of the minimap on the screen in pixels
+    static constexpr float SCREEN_SIZE = 240.0f;
+    // The distance between the minimap and the corner of the window in pixels
+    static constexpr float SCREEN_MARGIN = 16.0f;
+    // The number of texels redrawn around a dirty region for the line weight
+    static constexpr int TEXEL_MARGIN = 2;
+    // The fraction of the map size left empty on each side when the texture
+    // is fitted to the map, so that the map can grow before it is refitted
+    static constexpr float BOUNDS_PADDING = 0.25f;
+    // The smallest width of the area covered by the texture
+    static constexpr float MIN_WORLD_SIZE = 2048.0f;
+    // The number of dirty regions kept before they are merged into one
+    static constexpr size_t MAX_DIRTY_REGIONS = 64;
+    // The fraction of the texture above which a patch redraws it all instead
+    static constexpr float MAX_PATCH_FRACTION = 0.5f;
+
+    // The map being drawn
+    const Map& map;
+    // The offscreen texture the map is rendered into
+    std::unique_ptr<Framebuffer> framebuffer;
+    // The unit quad the texture is drawn on
+    std::unique_ptr<Mesh> quad;
+    // The shader used to draw the lines into the texture
+    Shader lineShader;
+    // The shader used to draw the texture on the screen
+    Shader quadShader;
+
+    // The world position of the bottom-left corner of the texture
+    glm::vec2 origin = {0.0f, 0.0f};
+    // The width and height of the area covered by the texture
+    float worldSize = MIN_WORLD_SIZE;
+    // Whether the whole texture must be redrawn
+    bool isRedrawNeeded = true;
+    // The regions of the texture that must be redrawn
+    std::vector<Region> dirtyRegions;
+
+    /**
+     * @brief Marks a box of the map as dirty.
+     *
+     * A box outside the area covered by the texture makes the whole texture
+     * be redrawn, fitted to the new bounds of the map.
+     *
+     * @param min The minimum corner of the box.
+     * @param max The maximum corner of the box.
+     */
+    void markDirty(glm::vec2 min, glm::vec2 max);
+
+    /**
+     * @brief Marks the bounding box of a segment as dirty.
+     *
+     * @param start The start of the segment.
+     * @param end The end of the segment.
+     */
+    void markSegmentDirty(glm::vec2 start, glm::vec2 end);
+
+    /**
+     * @brief Redraws the whole texture or its dirty regions, whichever is
+     * needed, and clears them.
+     */
+    void refresh();
+
+    /**
+     * @brief Fits the texture to the bounds of the map and draws every line
+     * into it.
+     */
+    void redraw();
+
+    /**
+     * @brief Clears a region of the texture and draws the lines overlapping
+     * it, clipped to the region.
+     *
+     * @param region The dirty region.
+     * @return False if the region is too large to be worth patching, in which
+     * case nothing is drawn.
+     */
+    bool patch(const Region& region);
+
+    /**
+     * @brief Draws the specified lines into the bound texture.
+     *
+     * @param lines The indices of the lines.
+     */
+    void drawLines(const std::vector<int>& lines);
+
+    /**
+     * @brief Gets the position of a vertex of the map.
+     *
+     * @param vertex The index of the vertex.
+     * @return The position of the vertex.
+     */
+    glm::vec2 getPosition(int vertex) const;
+
+    /**
+     * @brief Gets the width of a texel in world units.
+     *
+     * @return The width of a texel.
+     */
+    inline float getTexelSize() const { return worldSize / TEXTURE_SIZE; }
+};
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include "PrefabRenderer.h"
+
+bool PrefabRenderer::sync(const PrefabLibrary& library)
+{
+    size_t prefabCount = library.getPrefabCount();
+    bool prefabsChanged = meshes.size() != prefabCount;
+
+    // Prefabs are never modified, so only new prefabs need to be uploaded
+    meshes.resize(prefabCount);
+    for (size_t i = 0; i < prefabCount; ++i)
+    {
+        // Holding the geometry keeps it from being replaced at its address
+        const std::shared_ptr<const MapFragment>& fragment =
+            library.getPrefab(i);
+        if (meshes[i].source == fragment) continue;
+
+        build(meshes[i], fragment);
+        prefabsChanged = true;
+    }
+
+    if (!prefabsChanged && revision == library.getRevision()) return false;
+    revision = library.getRevision();
+
+    for (PrefabMesh& prefabMesh : meshes) prefabMesh.offsets.clear();
+
+    for (const PrefabInstance& instance : library.getInstances())
+    {
+        std::vector<float>& offsets = meshes[instance.prefab].offsets;
+        offsets.push_back(instance.position.x);
+        offsets.push_back(instance.position.y);
+    }
+
+    for (PrefabMesh& prefabMesh : meshes)
+    {
+        size_t instanceCount = prefabMesh.offsets.size() / 2;
+        prefabMesh.mesh->updateCustomBuffer(offsetLocation, prefabMesh.offsets,
+                                            0, instanceCount);
+    }
+
+    return true;
+}
+
+void PrefabRenderer::draw(const Shader& shader)
+{
+    for (PrefabMesh& prefabMesh : meshes)
+        prefabMesh.mesh->drawInstanced(shader, prefabMesh.offsets.size() / 2);
+}
+
+void PrefabRenderer::build(PrefabMesh& prefabMesh,
+                           const std::shared_ptr<const MapFragment>& fragment)
+{
+    const MapData& data = fragment->getData();
+
+    std::vector<Vertex> vertices;
+    vertices.reserve(data.vertices.size());
+    for (const LineVertex& vertex : data.vertices)
+        vertices.push_back({{vertex.x, vertex.y, 0.0f}});
+
+    std::vector<unsigned int> indices;
+    indices.reserve(data.lines.size() * 2);
+    for (const Line& line : data.lines)
+    {
+        indices.push_back(line.startVertex);
+        indices.push_back(line.endVertex);
+    }
+
+    // The position of the instance advances once per instance
+    CustomAttributeLayout layout;
+    offsetLocation = layout.addAttribute(AttributeType::FLOAT, 2, 1);
+
+    prefabMesh.source = fragment;
+    prefabMesh.mesh =
+        std::make_unique<DynamicMesh>("prefab", MeshType::LINES, layout);
+    prefabMesh.mesh->updateVertices(vertices, 0, vertices.size());
+    prefabMesh.mesh->updateIndices(indices, 0, indices.size());
+    prefabMesh.offsets.clear();
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <Engine.h>
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "map/MapFragment.h"
+#include "map/PrefabLibrary.h"
+
+using namespace Engine;
+
+/**
+ * @brief A class that draws the instances of the prefabs of a library.
+ *
+ * The geometry of each prefab is uploaded once, to a mesh of its own, and the
+ * positions of its instances are uploaded to a per-instance attribute of that
+ * mesh. Every instance of a prefab is then drawn by a single instanced draw
+ * call, so neither the memory nor the number of draw calls grows with the
+ * number of instances.
+ */
+class PrefabRenderer
+{
+public:
+    /**
+     * @brief Constructs a new PrefabRenderer object with no meshes.
+     */
+    PrefabRenderer() = default;
+
+    PrefabRenderer(const PrefabRenderer&) = delete;
+    PrefabRenderer& operator=(const PrefabRenderer&) = delete;
+
+    /**
+     * @brief Uploads the prefabs added and the instances changed since the
+     * last call.
+     *
+     * @param library The library to draw.
+     * @return True if anything was uploaded, false otherwise.
+     */
+    bool sync(const PrefabLibrary& library);
+
+    /**
+     * @brief Draws every instance.
+     *
+     * The shader reads the position of the instance at location 3.
+     *
+     * @param shader The shader to draw with.
+     */
+    void draw(const Shader& shader);
+
+private:
+    /**
+     * @brief A struct representing the GPU-side data of a prefab.
+     */
+    struct PrefabMesh
+    {
+        // The geometry the mesh was built from
+        std::shared_ptr<const MapFragment> source;
+        // The lines of the prefab and the positions of its instances
+        std::unique_ptr<DynamicMesh> mesh;
+        // The positions of the instances, two floats per instance
+        std::vector<float> offsets;
+    };
+
+    // The location of the per-instance position attribute
+    int offsetLocation = -1;
+    // The mesh of each prefab
+    std::vector<PrefabMesh> meshes;
+    // The revision of the library when the instances were last uploaded
+    uint64_t revision = std::numeric_limits<uint64_t>::max();
+
+    /**
+     * @brief Uploads the geometry of a prefab to a new mesh.
+     *
+     * @param prefabMesh The mesh to build.
+     * @param fragment The geometry of the prefab.
+     */
+    void build(PrefabMesh& prefabMesh,
+               const std::shared_ptr<const MapFragment>& fragment);
+};
\ No newline at end of file
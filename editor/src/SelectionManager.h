@@ -1,53 +1,142 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <functional>
 #include <vector>
 
-#include "Selectable.h"
+#include "map/MapElement.h"
 
 /**
  * @brief A class that manages the selection of objects.
  *
  * This class provides a way to manage the selection of objects in the editor.
+ * Selected objects are referred to by their element type and index, and the
+ * behaviour of selecting, deselecting and deleting them is provided once for
+ * all elements through handlers that dispatch on the element type.
+ *
+ * The selection is stored as one bitset per element type, indexed by element
+ * index, alongside a dense list of the selected elements. Membership tests,
+ * selection and deselection are O(1), and bulk operations only visit the
+ * selected elements.
  */
 class SelectionManager
 {
 public:
+    // The element handler function type
+    using ElementHandler = std::function<void(MapElement)>;
+
+    /**
+     * @brief Sets the handlers called when elements change state.
+     *
+     * @param onSelect The handler called when an element is selected.
+     * @param onDeselect The handler called when an element is deselected.
+     * @param onDelete The handler called when an element is deleted.
+     */
+    void setHandlers(ElementHandler onSelect, ElementHandler onDeselect,
+                     ElementHandler onDelete);
+
+    /**
+     * @brief Checks if the specified object is selected.
+     *
+     * @param object The object to check.
+     * @return True if the object is selected, false otherwise.
+     */
+    bool isSelected(MapElement object) const;
+
     /**
      * @brief Selects the specified object.
      *
-     * This method selects the specified object and calls the onSelect callback.
+     * This method selects the specified object and calls the onSelect handler.
+     * Selecting an object that is already selected does nothing.
      *
      * @param object The object to select.
      */
-    void select(Selectable* object);
+    void select(MapElement object);
 
     /**
      * @brief Deselects the specified object.
      *
      * This method deselects the specified object and calls the onDeselect
-     * callback.
+     * handler. Deselecting an object that is not selected does nothing.
      *
      * @param object The object to deselect.
      */
-    void deselect(Selectable* object);
+    void deselect(MapElement object);
+
+    /**
+     * @brief Selects the specified object if it is not selected, and
+     * deselects it otherwise.
+     *
+     * @param object The object to toggle.
+     */
+    void toggle(MapElement object);
 
     /**
      * @brief Deselects all selected objects.
      *
      * This method deselects all selected objects and calls the onDeselect
-     * callback for each object.
+     * handler for each object.
      */
     void deselectAll();
 
     /**
      * @brief Deletes all selected objects.
      *
-     * This method deletes all selected objects and calls the onDelete callback
+     * This method deletes all selected objects and calls the onDelete handler
      * for each object.
      */
     void deleteSelected();
 
+    /**
+     * @brief Gets the selected objects.
+     *
+     * @return The selected objects, in no particular order.
+     */
+    inline const std::vector<MapElement>& getSelected() const
+    {
+        return selectedObjects;
+    }
+
+    /**
+     * @brief Gets the number of selected objects.
+     *
+     * @return The number of selected objects.
+     */
+    inline size_t getSelectedCount() const { return selectedObjects.size(); }
+
 private:
+    // The number of element types
+    static constexpr size_t ELEMENT_TYPE_COUNT = 4;
+
     // A vector of selected objects
-    std::vector<Selectable*> selectedObjects;
+    std::vector<MapElement> selectedObjects;
+    // The selection bits of each element type, indexed by element index
+    std::array<std::vector<uint64_t>, ELEMENT_TYPE_COUNT> selectionBits;
+    // The position of each selected element in selectedObjects, per type
+    std::array<std::vector<uint32_t>, ELEMENT_TYPE_COUNT> positions;
+    // The handler called when an element is selected
+    ElementHandler onSelect;
+    // The handler called when an element is deselected
+    ElementHandler onDeselect;
+    // The handler called when an element is deleted
+    ElementHandler onDelete;
+
+    /**
+     * @brief Checks if the bit of the specified object is set.
+     *
+     * The bit is per index, so it does not check the generation.
+     *
+     * @param object The object to check.
+     * @return True if the bit is set, false otherwise.
+     */
+    bool hasBit(MapElement object) const;
+
+    /**
+     * @brief Sets or clears the bit of the specified object.
+     *
+     * @param object The object whose bit to set or clear.
+     * @param value Whether to set the bit.
+     */
+    void setBit(MapElement object, bool value);
 };
\ No newline at end of file
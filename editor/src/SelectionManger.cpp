@@ -1,36 +1,115 @@
 #include "SelectionManager.h"
 
-void SelectionManager::select(Selectable* object)
+void SelectionManager::setHandlers(ElementHandler onSelect,
+                                   ElementHandler onDeselect,
+                                   ElementHandler onDelete)
 {
-    if (object)
-    {
-        object->onSelect(object);
-        selectedObjects.push_back(object);
-    }
+    this->onSelect = onSelect;
+    this->onDeselect = onDeselect;
+    this->onDelete = onDelete;
 }
 
-void SelectionManager::deselect(Selectable* object)
+bool SelectionManager::isSelected(MapElement object) const
 {
-    if (object)
-    {
-        object->onDeselect(object);
-        selectedObjects.erase(
-            std::remove(selectedObjects.begin(), selectedObjects.end(), object),
-            selectedObjects.end());
-    }
+    if (!hasBit(object)) return false;
+
+    // The bit may belong to a removed element that reused the same index
+    uint32_t position =
+        positions[static_cast<size_t>(object.type)][object.index];
+    return selectedObjects[position].generation == object.generation;
+}
+
+void SelectionManager::select(MapElement object)
+{
+    if (object.index < 0 || isSelected(object)) return;
+
+    std::vector<uint32_t>& typePositions =
+        positions[static_cast<size_t>(object.type)];
+
+    // Replace a stale element that was selected at the same index
+    if (hasBit(object))
+        deselect(selectedObjects[typePositions[object.index]]);
+
+    if (object.index >= typePositions.size())
+        typePositions.resize(object.index + 1);
+
+    typePositions[object.index] = selectedObjects.size();
+    selectedObjects.push_back(object);
+    setBit(object, true);
+
+    if (onSelect) onSelect(object);
+}
+
+void SelectionManager::deselect(MapElement object)
+{
+    if (!hasBit(object)) return;
+
+    size_t type = static_cast<size_t>(object.type);
+    uint32_t position = positions[type][object.index];
+    MapElement selected = selectedObjects[position];
+    if (selected.generation != object.generation) return;
+
+    // Move the last selected element into the hole
+    MapElement last = selectedObjects.back();
+    selectedObjects[position] = last;
+    positions[static_cast<size_t>(last.type)][last.index] = position;
+    selectedObjects.pop_back();
+    setBit(object, false);
+
+    if (onDeselect) onDeselect(object);
+}
+
+void SelectionManager::toggle(MapElement object)
+{
+    if (isSelected(object))
+        deselect(object);
+    else
+        select(object);
 }
 
 void SelectionManager::deselectAll()
 {
-    for (auto* object : selectedObjects) object->onDeselect(object);
-    selectedObjects.clear();
+    std::vector<MapElement> objects;
+    objects.swap(selectedObjects);
+
+    for (MapElement object : objects) setBit(object, false);
+
+    if (onDeselect)
+        for (MapElement object : objects) onDeselect(object);
 }
 
 void SelectionManager::deleteSelected()
 {
-    for (auto* object : selectedObjects)
+    std::vector<MapElement> objects;
+    objects.swap(selectedObjects);
+
+    for (MapElement object : objects) setBit(object, false);
+
+    if (onDelete)
+        for (MapElement object : objects) onDelete(object);
+}
+
+bool SelectionManager::hasBit(MapElement object) const
+{
+    if (object.index < 0) return false;
+
+    const std::vector<uint64_t>& bits =
+        selectionBits[static_cast<size_t>(object.type)];
+    size_t word = object.index / 64;
+    return word < bits.size() && (bits[word] >> (object.index % 64)) & 1;
+}
+
+void SelectionManager::setBit(MapElement object, bool value)
+{
+    std::vector<uint64_t>& bits =
+        selectionBits[static_cast<size_t>(object.type)];
+    size_t word = object.index / 64;
+    if (word >= bits.size())
     {
-        if (object->onDelete) object->onDelete(object);
+        if (!value) return;
+        bits.resize(word + 1, 0);
     }
-    selectedObjects.clear();
+
+    uint64_t mask = uint64_t(1) << (object.index % 64);
+    bits[word] = value ? (bits[word] | mask) : (bits[word] & ~mask);
 }
\ No newline at end of file
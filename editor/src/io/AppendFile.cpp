@@ -0,0 +1,177 @@
+#include "AppendFile.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "../utils/macros.h"
+
+AppendFile::~AppendFile() { close(); }
+
+#ifdef _WIN32
+
+bool AppendFile::open(const std::string& path, bool truncate)
+{
+    close();
+
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_WRITE,
+                              FILE_SHARE_READ, nullptr,
+                              truncate ? CREATE_ALWAYS : OPEN_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        LOG_WARN("Failed to open file: %s", path.c_str());
+        return false;
+    }
+
+    // Every write goes to the end, where the file pointer is kept
+    LARGE_INTEGER fileSize;
+    LARGE_INTEGER zero = {};
+    if (!GetFileSizeEx(file, &fileSize) ||
+        !SetFilePointerEx(file, zero, nullptr, FILE_END))
+    {
+        LOG_WARN("Failed to open file: %s", path.c_str());
+        CloseHandle(file);
+        return false;
+    }
+
+    fileHandle = file;
+    size = static_cast<uint64_t>(fileSize.QuadPart);
+
+    return true;
+}
+
+void AppendFile::close()
+{
+    if (fileHandle) CloseHandle(fileHandle);
+
+    fileHandle = nullptr;
+    size = 0;
+}
+
+bool AppendFile::isOpen() const { return fileHandle != nullptr; }
+
+bool AppendFile::append(const void* data, size_t size)
+{
+    const char* bytes = static_cast<const char*>(data);
+
+    while (size > 0)
+    {
+        DWORD chunk = static_cast<DWORD>(std::min<size_t>(size, 1u << 30));
+        DWORD written;
+        if (!WriteFile(fileHandle, bytes, chunk, &written, nullptr))
+            return false;
+
+        bytes += written;
+        size -= written;
+        this->size += written;
+    }
+
+    return true;
+}
+
+bool AppendFile::sync() { return FlushFileBuffers(fileHandle) != 0; }
+
+bool AppendFile::syncFile(const std::string& path)
+{
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    bool synced = FlushFileBuffers(file) != 0;
+    CloseHandle(file);
+
+    return synced;
+}
+
+#else
+
+bool AppendFile::open(const std::string& path, bool truncate)
+{
+    close();
+
+    int flags = O_WRONLY | O_CREAT | O_APPEND | (truncate ? O_TRUNC : 0);
+    int file = ::open(path.c_str(), flags, 0644);
+    if (file == -1)
+    {
+        LOG_WARN("Failed to open file: %s", path.c_str());
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(file, &status) == -1)
+    {
+        LOG_WARN("Failed to open file: %s", path.c_str());
+        ::close(file);
+        return false;
+    }
+
+    fileDescriptor = file;
+    size = static_cast<uint64_t>(status.st_size);
+
+    return true;
+}
+
+void AppendFile::close()
+{
+    if (fileDescriptor != -1) ::close(fileDescriptor);
+
+    fileDescriptor = -1;
+    size = 0;
+}
+
+bool AppendFile::isOpen() const { return fileDescriptor != -1; }
+
+bool AppendFile::append(const void* data, size_t size)
+{
+    const char* bytes = static_cast<const char*>(data);
+
+    while (size > 0)
+    {
+        ssize_t written = ::write(fileDescriptor, bytes, size);
+        if (written == -1)
+        {
+            if (errno == EINTR) continue;
+            return false;
+        }
+
+        bytes += written;
+        size -= written;
+        this->size += written;
+    }
+
+    return true;
+}
+
+bool AppendFile::sync()
+{
+#ifdef __APPLE__
+    // fsync does not reach the storage device on macOS
+    return fcntl(fileDescriptor, F_FULLFSYNC) != -1;
+#else
+    return fdatasync(fileDescriptor) == 0;
+#endif
+}
+
+bool AppendFile::syncFile(const std::string& path)
+{
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file == -1) return false;
+
+    bool synced = fsync(file) == 0;
+    ::close(file);
+
+    return synced;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief A class representing a file that is only ever appended to.
+ *
+ * Writes go straight to the operating system without user-space buffering,
+ * and sync flushes them to the storage device, so the caller decides how many
+ * writes share the cost of one flush. The file is closed when the object is
+ * destroyed or closed.
+ */
+class AppendFile
+{
+public:
+    /**
+     * @brief Constructs a new AppendFile object with no file open.
+     */
+    AppendFile() = default;
+
+    /**
+     * @brief Destroys the AppendFile object and closes the file.
+     */
+    ~AppendFile();
+
+    AppendFile(const AppendFile&) = delete;
+    AppendFile& operator=(const AppendFile&) = delete;
+
+    /**
+     * @brief Opens the specified file for appending, closing the previous
+     * one.
+     *
+     * @param path The path of the file.
+     * @param truncate Whether to discard the previous contents of the file.
+     * @return True if the file was opened, false otherwise.
+     */
+    bool open(const std::string& path, bool truncate);
+
+    /**
+     * @brief Closes the file.
+     */
+    void close();
+
+    /**
+     * @brief Checks if a file is open.
+     *
+     * @return True if a file is open, false otherwise.
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Appends bytes to the end of the file.
+     *
+     * @param data The bytes to append.
+     * @param size The number of bytes.
+     * @return True if every byte was written, false otherwise.
+     */
+    bool append(const void* data, size_t size);
+
+    /**
+     * @brief Flushes the appended bytes to the storage device.
+     *
+     * @return True if the bytes were flushed, false otherwise.
+     */
+    bool sync();
+
+    /**
+     * @brief Gets the size of the file.
+     *
+     * @return The size of the file in bytes.
+     */
+    inline uint64_t getSize() const { return size; }
+
+    /**
+     * @brief Flushes a file written through another handle to the storage
+     * device.
+     *
+     * @param path The path of the file.
+     * @return True if the file was flushed, false otherwise.
+     */
+    static bool syncFile(const std::string& path);
+
+private:
+    // The size of the file in bytes
+    uint64_t size = 0;
+#ifdef _WIN32
+    // The handle of the file
+    void* fileHandle = nullptr;
+#else
+    // The descriptor of the file
+    int fileDescriptor = -1;
+#endif
+};
\ No newline at end of file
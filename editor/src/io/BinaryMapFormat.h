@@ -0,0 +1,252 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "../map_components/Line.h"
+#include "../map_components/LineVertex.h"
+#include "../map_components/PrefabInstance.h"
+#include "../map_components/Sector.h"
+#include "../map_components/Side.h"
+
+/**
+ * @brief The layout of the binary map format.
+ *
+ * A binary map file is little-endian and made of a header, a table of
+ * sections and the section contents. Each section is a fixed-stride array of
+ * records whose layout is exactly that of the map component it stores, so a
+ * mapped file can be used in place or copied into the map store in bulk,
+ * without parsing individual elements. Sections start at 8-byte aligned
+ * offsets. Lines refer to vertices and sides, and sides refer to sectors, by
+ * their position in the file, with -1 meaning none.
+ *
+ * A file may also carry an index section for every element type, listing the
+ * index of each element. The references then use those indices instead of
+ * positions, which preserves the indices of a map with free slots. An
+ * optional revision section holds a single number identifying the state of
+ * the map that the file holds.
+ *
+ * A file may also hold the prefabs of the map and their instances. A prefab
+ * section lists the number of vertices, lines, sides and sectors of each
+ * prefab, whose elements follow those of the previous prefab in the prefab
+ * element sections and refer to each other by their position within the
+ * prefab. An instance refers to its prefab by position, and has an index
+ * section like the elements.
+ *
+ * Vertices are stored in the coordinate type of the build that wrote the
+ * file, as floats or as 16.16 fixed-point numbers, each in a section of its
+ * own type. A vertex section of the other type is converted when it is read,
+ * and so are the vertices of the prefabs.
+ *
+ * Readers skip sections of unknown types, so new sections can be added
+ * without changing the version. Changing the layout of a record requires a
+ * new version.
+ */
+namespace BinaryMapFormat
+{
+    // The magic bytes at the start of every file
+    static constexpr char MAGIC[4] = {'D', 'V', 'M', 'P'};
+    // The current version of the format
+    static constexpr uint16_t VERSION = 1;
+    // The alignment of the section offsets
+    static constexpr uint64_t SECTION_ALIGNMENT = 8;
+
+    /**
+     * @brief Makes a section type from four characters.
+     *
+     * @param a The first character.
+     * @param b The second character.
+     * @param c The third character.
+     * @param d The fourth character.
+     * @return The section type, with the first character in the lowest byte.
+     */
+    constexpr uint32_t makeSectionType(char a, char b, char c, char d)
+    {
+        return static_cast<uint32_t>(static_cast<uint8_t>(a)) |
+               static_cast<uint32_t>(static_cast<uint8_t>(b)) << 8 |
+               static_cast<uint32_t>(static_cast<uint8_t>(c)) << 16 |
+               static_cast<uint32_t>(static_cast<uint8_t>(d)) << 24;
+    }
+
+    // The type of the section holding vertices with float coordinates
+    static constexpr uint32_t VERTEX_SECTION =
+        makeSectionType('V', 'R', 'T', 'X');
+    // The type of the section holding vertices with 16.16 fixed-point
+    // coordinates
+    static constexpr uint32_t FIXED_VERTEX_SECTION =
+        makeSectionType('V', 'R', 'T', 'F');
+#ifdef MAP_FIXED_POINT
+    // The type of the vertex section whose records are LineVertex records
+    static constexpr uint32_t NATIVE_VERTEX_SECTION = FIXED_VERTEX_SECTION;
+#else
+    // The type of the vertex section whose records are LineVertex records
+    static constexpr uint32_t NATIVE_VERTEX_SECTION = VERTEX_SECTION;
+#endif
+    // The type of the section holding Line records
+    static constexpr uint32_t LINE_SECTION =
+        makeSectionType('L', 'I', 'N', 'E');
+    // The type of the section holding Side records
+    static constexpr uint32_t SIDE_SECTION =
+        makeSectionType('S', 'I', 'D', 'E');
+    // The type of the section holding Sector records
+    static constexpr uint32_t SECTOR_SECTION =
+        makeSectionType('S', 'E', 'C', 'T');
+    // The type of the section holding the uint32_t index of each vertex
+    static constexpr uint32_t VERTEX_INDEX_SECTION =
+        makeSectionType('V', 'I', 'D', 'X');
+    // The type of the section holding the uint32_t index of each line
+    static constexpr uint32_t LINE_INDEX_SECTION =
+        makeSectionType('L', 'I', 'D', 'X');
+    // The type of the section holding the uint32_t index of each side
+    static constexpr uint32_t SIDE_INDEX_SECTION =
+        makeSectionType('S', 'I', 'D', 'X');
+    // The type of the section holding the uint32_t index of each sector
+    static constexpr uint32_t SECTOR_INDEX_SECTION =
+        makeSectionType('C', 'I', 'D', 'X');
+    // The type of the section holding the uint64_t revision of the map
+    static constexpr uint32_t REVISION_SECTION =
+        makeSectionType('R', 'E', 'V', 'N');
+    // The type of the section holding a PrefabRecord for each prefab
+    static constexpr uint32_t PREFAB_SECTION =
+        makeSectionType('P', 'R', 'F', 'B');
+    // The type of the section holding the vertices of the prefabs with float
+    // coordinates
+    static constexpr uint32_t PREFAB_VERTEX_SECTION =
+        makeSectionType('P', 'V', 'T', 'X');
+    // The type of the section holding the vertices of the prefabs with 16.16
+    // fixed-point coordinates
+    static constexpr uint32_t PREFAB_FIXED_VERTEX_SECTION =
+        makeSectionType('P', 'V', 'T', 'F');
+#ifdef MAP_FIXED_POINT
+    // The type of the prefab vertex section whose records are LineVertex
+    // records
+    static constexpr uint32_t NATIVE_PREFAB_VERTEX_SECTION =
+        PREFAB_FIXED_VERTEX_SECTION;
+#else
+    // The type of the prefab vertex section whose records are LineVertex
+    // records
+    static constexpr uint32_t NATIVE_PREFAB_VERTEX_SECTION =
+        PREFAB_VERTEX_SECTION;
+#endif
+    // The type of the section holding the Line records of the prefabs
+    static constexpr uint32_t PREFAB_LINE_SECTION =
+        makeSectionType('P', 'L', 'I', 'N');
+    // The type of the section holding the Side records of the prefabs
+    static constexpr uint32_t PREFAB_SIDE_SECTION =
+        makeSectionType('P', 'S', 'I', 'D');
+    // The type of the section holding the Sector records of the prefabs
+    static constexpr uint32_t PREFAB_SECTOR_SECTION =
+        makeSectionType('P', 'S', 'E', 'C');
+    // The type of the section holding PrefabInstance records
+    static constexpr uint32_t INSTANCE_SECTION =
+        makeSectionType('I', 'N', 'S', 'T');
+    // The type of the section holding the uint32_t index of each instance
+    static constexpr uint32_t INSTANCE_INDEX_SECTION =
+        makeSectionType('I', 'I', 'D', 'X');
+
+    /**
+     * @brief A struct representing the header of a file.
+     */
+    struct Header
+    {
+        // The magic bytes
+        char magic[4];
+        // The version of the format
+        uint16_t version;
+        // The number of entries in the section table
+        uint16_t sectionCount;
+        // Reserved for flags, written as zero
+        uint32_t flags;
+        // Reserved, written as zero
+        uint32_t reserved;
+    };
+
+    /**
+     * @brief A struct representing an entry of the section table.
+     */
+    struct Section
+    {
+        // The type of the section
+        uint32_t type;
+        // The size of a record in bytes
+        uint32_t stride;
+        // The offset of the first record from the start of the file
+        uint64_t offset;
+        // The number of records
+        uint64_t count;
+    };
+
+    /**
+     * @brief A struct representing a record of a vertex section with float
+     * coordinates.
+     */
+    struct FloatVertex
+    {
+        // The coordinates of the vertex
+        float x, y;
+    };
+
+    /**
+     * @brief A struct representing a record of a vertex section with
+     * fixed-point coordinates.
+     */
+    struct FixedVertex
+    {
+        // The coordinates of the vertex
+        Fixed x, y;
+    };
+
+    /**
+     * @brief A struct representing a record of the prefab section.
+     */
+    struct PrefabRecord
+    {
+        // The number of vertices of the prefab
+        uint32_t vertexCount;
+        // The number of lines of the prefab
+        uint32_t lineCount;
+        // The number of sides of the prefab
+        uint32_t sideCount;
+        // The number of sectors of the prefab
+        uint32_t sectorCount;
+    };
+
+    static_assert(sizeof(Header) == 16, "Unexpected header layout");
+    static_assert(sizeof(Section) == 24, "Unexpected section layout");
+
+    // The records are the in-memory components, so pin down their layout
+    static_assert(sizeof(FloatVertex) == 8 && sizeof(FixedVertex) == 8,
+                  "Unexpected vertex record layout");
+    static_assert(std::is_trivially_copyable<LineVertex>::value &&
+                      sizeof(LineVertex) == 8 && offsetof(LineVertex, y) == 4,
+                  "Unexpected LineVertex layout");
+    static_assert(std::is_trivially_copyable<Line>::value &&
+                      sizeof(Line) == 16 && offsetof(Line, endVertex) == 4 &&
+                      offsetof(Line, front) == 8 && offsetof(Line, back) == 12,
+                  "Unexpected Line layout");
+    static_assert(std::is_trivially_copyable<Side>::value && sizeof(Side) == 4,
+                  "Unexpected Side layout");
+    static_assert(std::is_trivially_copyable<Sector>::value &&
+                      sizeof(Sector) == 12 &&
+                      offsetof(Sector, ceilingHeight) == 4 &&
+                      offsetof(Sector, lightLevel) == 8,
+                  "Unexpected Sector layout");
+    static_assert(sizeof(PrefabRecord) == 16, "Unexpected prefab layout");
+    static_assert(std::is_trivially_copyable<PrefabInstance>::value &&
+                      sizeof(PrefabInstance) == 12 &&
+                      offsetof(PrefabInstance, position) == 4,
+                  "Unexpected PrefabInstance layout");
+
+    /**
+     * @brief Checks if the host stores integers in little-endian order, so
+     * that records can be used without byte swapping.
+     *
+     * @return True if the host is little-endian, false otherwise.
+     */
+    inline bool isHostLittleEndian()
+    {
+        const uint16_t probe = 1;
+        return *reinterpret_cast<const uint8_t*>(&probe) == 1;
+    }
+}  // namespace BinaryMapFormat
\ No newline at end of file
@@ -0,0 +1,299 @@
+#include "BinaryMapReader.h"
+
+#include <cstring>
+
+#include "../utils/macros.h"
+
+bool BinaryMapReader::open(const std::string& path)
+{
+    close();
+
+    if (!BinaryMapFormat::isHostLittleEndian())
+    {
+        LOG_WARN("Binary maps can only be read on little-endian hosts");
+        return false;
+    }
+
+    if (!file.open(path)) return false;
+
+    if (!readSections() || !arrays.hasValidReferences())
+    {
+        LOG_WARN("Invalid binary map: %s", path.c_str());
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void BinaryMapReader::close()
+{
+    file.close();
+    arrays = MapArrays();
+    revision = 0;
+    convertedVertices.clear();
+    prefabs.clear();
+    convertedPrefabVertices.clear();
+}
+
+bool BinaryMapReader::readSections()
+{
+    using namespace BinaryMapFormat;
+
+    if (file.getSize() < sizeof(Header)) return false;
+
+    Header header;
+    std::memcpy(&header, file.getData(), sizeof(Header));
+
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) return false;
+
+    if (header.version != VERSION)
+    {
+        LOG_WARN("Unsupported binary map version: %u", header.version);
+        return false;
+    }
+
+    size_t tableSize = header.sectionCount * sizeof(Section);
+    if (file.getSize() - sizeof(Header) < tableSize) return false;
+
+    const unsigned char* table = file.getData() + sizeof(Header);
+    uint32_t found = 0;
+    size_t vertexIndexCount = 0, lineIndexCount = 0;
+    size_t sideIndexCount = 0, sectorIndexCount = 0;
+    size_t instanceIndexCount = 0;
+    const uint64_t* revisions = nullptr;
+    size_t revisionCount = 0;
+    const PrefabRecord* prefabRecords = nullptr;
+    size_t prefabCount = 0;
+    MapArrays prefabElements;
+
+    for (uint16_t i = 0; i < header.sectionCount; ++i)
+    {
+        Section section;
+        std::memcpy(&section, table + i * sizeof(Section), sizeof(Section));
+
+        // Each known section may appear once
+        uint32_t bit;
+        bool valid;
+
+        switch (section.type)
+        {
+            case NATIVE_VERTEX_SECTION:
+                bit = 1;
+                valid = readSection(section, arrays.vertices,
+                                    arrays.vertexCount);
+                break;
+#ifdef MAP_FIXED_POINT
+            case VERTEX_SECTION:
+                bit = 1;
+                valid = convertVertices<FloatVertex>(
+                    section, convertedVertices, arrays.vertices,
+                    arrays.vertexCount);
+                break;
+#else
+            case FIXED_VERTEX_SECTION:
+                bit = 1;
+                valid = convertVertices<FixedVertex>(
+                    section, convertedVertices, arrays.vertices,
+                    arrays.vertexCount);
+                break;
+#endif
+            case LINE_SECTION:
+                bit = 2;
+                valid = readSection(section, arrays.lines, arrays.lineCount);
+                break;
+            case SIDE_SECTION:
+                bit = 4;
+                valid = readSection(section, arrays.sides, arrays.sideCount);
+                break;
+            case SECTOR_SECTION:
+                bit = 8;
+                valid = readSection(section, arrays.sectors,
+                                    arrays.sectorCount);
+                break;
+            case VERTEX_INDEX_SECTION:
+                bit = 16;
+                valid = readSection(section, arrays.vertexIndices,
+                                    vertexIndexCount);
+                break;
+            case LINE_INDEX_SECTION:
+                bit = 32;
+                valid = readSection(section, arrays.lineIndices,
+                                    lineIndexCount);
+                break;
+            case SIDE_INDEX_SECTION:
+                bit = 64;
+                valid = readSection(section, arrays.sideIndices,
+                                    sideIndexCount);
+                break;
+            case SECTOR_INDEX_SECTION:
+                bit = 128;
+                valid = readSection(section, arrays.sectorIndices,
+                                    sectorIndexCount);
+                break;
+            case REVISION_SECTION:
+                bit = 256;
+                valid = readSection(section, revisions, revisionCount) &&
+                        revisionCount == 1;
+                break;
+            case PREFAB_SECTION:
+                bit = 512;
+                valid = readSection(section, prefabRecords, prefabCount);
+                break;
+            case NATIVE_PREFAB_VERTEX_SECTION:
+                bit = 1024;
+                valid = readSection(section, prefabElements.vertices,
+                                    prefabElements.vertexCount);
+                break;
+#ifdef MAP_FIXED_POINT
+            case PREFAB_VERTEX_SECTION:
+                bit = 1024;
+                valid = convertVertices<FloatVertex>(
+                    section, convertedPrefabVertices, prefabElements.vertices,
+                    prefabElements.vertexCount);
+                break;
+#else
+            case PREFAB_FIXED_VERTEX_SECTION:
+                bit = 1024;
+                valid = convertVertices<FixedVertex>(
+                    section, convertedPrefabVertices, prefabElements.vertices,
+                    prefabElements.vertexCount);
+                break;
+#endif
+            case PREFAB_LINE_SECTION:
+                bit = 2048;
+                valid = readSection(section, prefabElements.lines,
+                                    prefabElements.lineCount);
+                break;
+            case PREFAB_SIDE_SECTION:
+                bit = 4096;
+                valid = readSection(section, prefabElements.sides,
+                                    prefabElements.sideCount);
+                break;
+            case PREFAB_SECTOR_SECTION:
+                bit = 8192;
+                valid = readSection(section, prefabElements.sectors,
+                                    prefabElements.sectorCount);
+                break;
+            case INSTANCE_SECTION:
+                bit = 16384;
+                valid = readSection(section, arrays.instances,
+                                    arrays.instanceCount);
+                break;
+            case INSTANCE_INDEX_SECTION:
+                bit = 32768;
+                valid = readSection(section, arrays.instanceIndices,
+                                    instanceIndexCount);
+                break;
+            default:
+                continue;
+        }
+
+        if (!valid || (found & bit)) return false;
+        found |= bit;
+    }
+
+    if (revisions) revision = *revisions;
+
+    // An index section lists one index per element
+    return (!arrays.vertexIndices || vertexIndexCount == arrays.vertexCount) &&
+           (!arrays.lineIndices || lineIndexCount == arrays.lineCount) &&
+           (!arrays.sideIndices || sideIndexCount == arrays.sideCount) &&
+           (!arrays.sectorIndices || sectorIndexCount == arrays.sectorCount) &&
+           (!arrays.instanceIndices ||
+            instanceIndexCount == arrays.instanceCount) &&
+           readPrefabs(prefabRecords, prefabCount, prefabElements);
+}
+
+template <typename T>
+bool BinaryMapReader::readSection(const BinaryMapFormat::Section& section,
+                                  const T*& records, size_t& count)
+{
+    if (section.stride != sizeof(T)) return false;
+    if (section.offset % BinaryMapFormat::SECTION_ALIGNMENT != 0) return false;
+    if (section.offset > file.getSize()) return false;
+
+    // Compare counts rather than byte sizes so that the check cannot overflow
+    if (section.count > (file.getSize() - section.offset) / sizeof(T))
+        return false;
+
+    // The mapping is page aligned, so the records are suitably aligned
+    records = reinterpret_cast<const T*>(file.getData() + section.offset);
+    count = static_cast<size_t>(section.count);
+
+    return true;
+}
+
+template <typename T>
+bool BinaryMapReader::convertVertices(const BinaryMapFormat::Section& section,
+                                      std::vector<LineVertex>& converted,
+                                      const LineVertex*& vertices,
+                                      size_t& count)
+{
+    const T* records;
+    if (!readSection(section, records, count)) return false;
+
+    // Fixed-point coordinates are rounded to floats and floats to fixed-point
+    // coordinates
+    converted.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        float x = static_cast<float>(records[i].x);
+        float y = static_cast<float>(records[i].y);
+
+        // Floats past the fixed-point range would be clamped onto each other
+        if (!isMapCoordInRange(x) || !isMapCoordInRange(y))
+        {
+            LOG_WARN("Vertex %zu lies outside the range of map coordinates",
+                     i);
+            return false;
+        }
+
+        converted[i] = LineVertex(x, y);
+    }
+
+    vertices = converted.data();
+    return true;
+}
+
+bool BinaryMapReader::readPrefabs(const BinaryMapFormat::PrefabRecord* records,
+                                  size_t count, const MapArrays& elements)
+{
+    // The elements of each prefab follow those of the previous one
+    MapArrays next = elements;
+    prefabs.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const BinaryMapFormat::PrefabRecord& record = records[i];
+        if (record.vertexCount > next.vertexCount ||
+            record.lineCount > next.lineCount ||
+            record.sideCount > next.sideCount ||
+            record.sectorCount > next.sectorCount)
+            return false;
+
+        MapArrays& prefab = prefabs[i];
+        prefab.vertices = next.vertices;
+        prefab.vertexCount = record.vertexCount;
+        prefab.lines = next.lines;
+        prefab.lineCount = record.lineCount;
+        prefab.sides = next.sides;
+        prefab.sideCount = record.sideCount;
+        prefab.sectors = next.sectors;
+        prefab.sectorCount = record.sectorCount;
+
+        next.vertices += record.vertexCount;
+        next.vertexCount -= record.vertexCount;
+        next.lines += record.lineCount;
+        next.lineCount -= record.lineCount;
+        next.sides += record.sideCount;
+        next.sideCount -= record.sideCount;
+        next.sectors += record.sectorCount;
+        next.sectorCount -= record.sectorCount;
+    }
+
+    arrays.prefabs = prefabs.data();
+    arrays.prefabCount = count;
+
+    return next.vertexCount == 0 && next.lineCount == 0 &&
+           next.sideCount == 0 && next.sectorCount == 0;
+}
\ No newline at end of file
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../map/MapArrays.h"
+#include "BinaryMapFormat.h"
+#include "MappedFile.h"
+
+/**
+ * @brief A class that reads binary map files in place.
+ *
+ * This class memory-maps a binary map file and checks its header, section
+ * table and cross-references, after which the arrays of the file are exposed
+ * directly from the mapping. No element is parsed or copied: the arrays can be
+ * read in place, or handed to Map::load to be copied into the map in bulk. The
+ * arrays stay valid until the reader is closed or destroyed. Only vertices
+ * written in the other coordinate type are copied, to be converted, and the
+ * arrays of each prefab are views into the shared prefab sections.
+ */
+class BinaryMapReader
+{
+public:
+    /**
+     * @brief Opens and validates the specified file, closing the previous
+     * one.
+     *
+     * @param path The path of the file.
+     * @return True if the file is a valid binary map, false otherwise.
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Closes the file.
+     */
+    void close();
+
+    /**
+     * @brief Gets the arrays of the file.
+     *
+     * @return The arrays, which point into the mapped file.
+     */
+    inline const MapArrays& getArrays() const { return arrays; }
+
+    /**
+     * @brief Gets the revision of the map held by the file.
+     *
+     * @return The revision, or 0 if the file has no revision section.
+     */
+    inline uint64_t getRevision() const { return revision; }
+
+private:
+    // The mapped file
+    MappedFile file;
+    // The arrays of the file
+    MapArrays arrays;
+    // The revision of the map held by the file
+    uint64_t revision = 0;
+    // The vertices of the file converted to the coordinate type of the build
+    std::vector<LineVertex> convertedVertices;
+    // The arrays of each prefab
+    std::vector<MapArrays> prefabs;
+    // The vertices of the prefabs converted to the coordinate type of the
+    // build
+    std::vector<LineVertex> convertedPrefabVertices;
+
+    /**
+     * @brief Checks the header and locates the sections of the file.
+     *
+     * @return True if the layout of the file is valid, false otherwise.
+     */
+    bool readSections();
+
+    /**
+     * @brief Locates the records of a section.
+     *
+     * @tparam T The type of the records.
+     * @param section The entry of the section.
+     * @param records The first record of the section.
+     * @param count The number of records of the section.
+     * @return True if the section lies within the file, false otherwise.
+     */
+    template <typename T>
+    bool readSection(const BinaryMapFormat::Section& section,
+                     const T*& records, size_t& count);
+
+    /**
+     * @brief Converts the records of a vertex section written in the other
+     * coordinate type into LineVertex records.
+     *
+     * @tparam T The type of the records.
+     * @param section The entry of the section.
+     * @param converted Set to the converted records.
+     * @param vertices Set to the first converted record.
+     * @param count Set to the number of records of the section.
+     * @return True if the section lies within the file and every coordinate
+     * fits the coordinate type, false otherwise.
+     */
+    template <typename T>
+    bool convertVertices(const BinaryMapFormat::Section& section,
+                         std::vector<LineVertex>& converted,
+                         const LineVertex*& vertices, size_t& count);
+
+    /**
+     * @brief Splits the prefab element sections into the arrays of each
+     * prefab.
+     *
+     * @param records The record of each prefab.
+     * @param count The number of prefabs.
+     * @param elements The elements of every prefab, one after another.
+     * @return True if the records account for every element, false
+     * otherwise.
+     */
+    bool readPrefabs(const BinaryMapFormat::PrefabRecord* records,
+                     size_t count, const MapArrays& elements);
+};
\ No newline at end of file
@@ -0,0 +1,410 @@
+#include "BinaryMapWriter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+#include "../map/MapFragment.h"
+#include "../utils/macros.h"
+
+using namespace BinaryMapFormat;
+
+/**
+ * @brief Rounds an offset up to the alignment of the sections.
+ *
+ * @param offset The offset.
+ * @return The aligned offset.
+ */
+static uint64_t alignOffset(uint64_t offset)
+{
+    return (offset + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+}
+
+bool BinaryMapWriter::write(const MapStore& store, const std::string& path,
+                            bool preserveIndices, uint64_t revision)
+{
+    if (!isHostLittleEndian())
+    {
+        LOG_WARN("Binary maps can only be written on little-endian hosts");
+        return false;
+    }
+
+    const std::vector<LineVertex>& vertices = store.getVertexPositions();
+    const std::vector<Line>& lines = store.getLines();
+    const std::vector<Side>& sides = store.getSides();
+    const std::vector<Sector>& sectors = store.getSectors();
+    const std::vector<PrefabInstance>& instances = store.getInstances();
+
+    std::vector<MapArrays> prefabs;
+    getPrefabArrays(store.getPrefabs(), prefabs);
+
+    MapArrays layout;
+    layout.vertexCount = vertices.size();
+    layout.lineCount = lines.size();
+    layout.sideCount = sides.size();
+    layout.sectorCount = sectors.size();
+    layout.prefabs = prefabs.data();
+    layout.prefabCount = prefabs.size();
+    layout.instanceCount = instances.size();
+
+    std::string tempPath = path + ".tmp";
+    std::ofstream stream;
+    if (!begin(stream, tempPath, layout, preserveIndices)) return false;
+
+    writeAligned(stream, vertices.data(), vertices.size() * sizeof(LineVertex));
+
+    if (preserveIndices)
+    {
+        // The references are already the indices listed in the file
+        writeAligned(stream, lines.data(), lines.size() * sizeof(Line));
+        writeAligned(stream, sides.data(), sides.size() * sizeof(Side));
+        writeAligned(stream, sectors.data(), sectors.size() * sizeof(Sector));
+        writeAligned(stream, &revision, sizeof(uint64_t));
+        writePrefabs(stream, prefabs.data(), prefabs.size());
+        writeAligned(stream, instances.data(),
+                     instances.size() * sizeof(PrefabInstance));
+
+        const std::vector<uint32_t>* indices[] = {
+            &store.getVertexIndices(), &store.getLineIndices(),
+            &store.getSideIndices(), &store.getSectorIndices(),
+            &store.getInstanceIndices()};
+        for (const std::vector<uint32_t>* section : indices)
+            writeAligned(stream, section->data(),
+                         section->size() * sizeof(uint32_t));
+
+        return finish(stream, tempPath, path);
+    }
+
+    vertexRemap.build(store.getVertexIndices());
+    sideRemap.build(store.getSideIndices());
+    sectorRemap.build(store.getSectorIndices());
+
+    // Rewrite the references of the lines to positions in the file
+    lineChunk.resize(std::min(lines.size(), CHUNK_SIZE));
+    for (size_t first = 0; first < lines.size(); first += CHUNK_SIZE)
+    {
+        size_t count = std::min(lines.size() - first, CHUNK_SIZE);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Line& line = lines[first + i];
+            lineChunk[i] = Line(vertexRemap.get(line.startVertex),
+                                vertexRemap.get(line.endVertex),
+                                sideRemap.get(line.front),
+                                sideRemap.get(line.back));
+        }
+
+        stream.write(reinterpret_cast<const char*>(lineChunk.data()),
+                     count * sizeof(Line));
+    }
+    writeAligned(stream, nullptr, lines.size() * sizeof(Line));
+
+    sideChunk.resize(std::min(sides.size(), CHUNK_SIZE));
+    for (size_t first = 0; first < sides.size(); first += CHUNK_SIZE)
+    {
+        size_t count = std::min(sides.size() - first, CHUNK_SIZE);
+        for (size_t i = 0; i < count; ++i)
+            sideChunk[i] = Side(sectorRemap.get(sides[first + i].sector));
+
+        stream.write(reinterpret_cast<const char*>(sideChunk.data()),
+                     count * sizeof(Side));
+    }
+    writeAligned(stream, nullptr, sides.size() * sizeof(Side));
+
+    writeAligned(stream, sectors.data(), sectors.size() * sizeof(Sector));
+    writeAligned(stream, &revision, sizeof(uint64_t));
+
+    // Instances refer to prefabs by position, which is also their index
+    writePrefabs(stream, prefabs.data(), prefabs.size());
+    writeAligned(stream, instances.data(),
+                 instances.size() * sizeof(PrefabInstance));
+
+    return finish(stream, tempPath, path);
+}
+
+bool BinaryMapWriter::write(const MapSnapshot& snapshot,
+                            const std::string& path, uint64_t revision)
+{
+    if (!isHostLittleEndian())
+    {
+        LOG_WARN("Binary maps can only be written on little-endian hosts");
+        return false;
+    }
+
+    const CowArray<LineVertex>& vertices = snapshot.getVertices();
+    const CowArray<Line>& lines = snapshot.getLines();
+    const CowArray<Side>& sides = snapshot.getSides();
+    const CowArray<Sector>& sectors = snapshot.getSectors();
+    const CowArray<PrefabInstance>& instances = snapshot.getInstances();
+
+    std::vector<MapArrays> prefabs;
+    getPrefabArrays(snapshot.getPrefabs(), prefabs);
+
+    MapArrays layout;
+    layout.vertexCount = vertices.size();
+    layout.lineCount = lines.size();
+    layout.sideCount = sides.size();
+    layout.sectorCount = sectors.size();
+    layout.prefabs = prefabs.data();
+    layout.prefabCount = prefabs.size();
+    layout.instanceCount = instances.size();
+
+    std::string tempPath = path + ".tmp";
+    std::ofstream stream;
+    if (!begin(stream, tempPath, layout, true)) return false;
+
+    // The chunks are sparse, so gather the stored elements before writing
+    writeValues(stream, vertices);
+    writeValues(stream, lines);
+    writeValues(stream, sides);
+    writeValues(stream, sectors);
+    writeAligned(stream, &revision, sizeof(uint64_t));
+    writePrefabs(stream, prefabs.data(), prefabs.size());
+    writeValues(stream, instances);
+
+    writeIndices(stream, vertices);
+    writeIndices(stream, lines);
+    writeIndices(stream, sides);
+    writeIndices(stream, sectors);
+    writeIndices(stream, instances);
+
+    return finish(stream, tempPath, path);
+}
+
+bool BinaryMapWriter::write(const MapArrays& arrays, const std::string& path,
+                            uint64_t revision)
+{
+    if (!isHostLittleEndian())
+    {
+        LOG_WARN("Binary maps can only be written on little-endian hosts");
+        return false;
+    }
+
+    // Empty arrays may have no index array even when the others do
+    bool preserveIndices = arrays.vertexIndices || arrays.lineIndices ||
+                           arrays.sideIndices || arrays.sectorIndices ||
+                           arrays.instanceIndices;
+
+    std::string tempPath = path + ".tmp";
+    std::ofstream stream;
+    if (!begin(stream, tempPath, arrays, preserveIndices)) return false;
+
+    writeAligned(stream, arrays.vertices,
+                 arrays.vertexCount * sizeof(LineVertex));
+    writeAligned(stream, arrays.lines, arrays.lineCount * sizeof(Line));
+    writeAligned(stream, arrays.sides, arrays.sideCount * sizeof(Side));
+    writeAligned(stream, arrays.sectors, arrays.sectorCount * sizeof(Sector));
+    writeAligned(stream, &revision, sizeof(uint64_t));
+    writePrefabs(stream, arrays.prefabs, arrays.prefabCount);
+    writeAligned(stream, arrays.instances,
+                 arrays.instanceCount * sizeof(PrefabInstance));
+
+    if (preserveIndices)
+    {
+        writeAligned(stream, arrays.vertexIndices,
+                     arrays.vertexCount * sizeof(uint32_t));
+        writeAligned(stream, arrays.lineIndices,
+                     arrays.lineCount * sizeof(uint32_t));
+        writeAligned(stream, arrays.sideIndices,
+                     arrays.sideCount * sizeof(uint32_t));
+        writeAligned(stream, arrays.sectorIndices,
+                     arrays.sectorCount * sizeof(uint32_t));
+        writeAligned(stream, arrays.instanceIndices,
+                     arrays.instanceCount * sizeof(uint32_t));
+    }
+
+    return finish(stream, tempPath, path);
+}
+
+bool BinaryMapWriter::begin(std::ofstream& stream, const std::string& tempPath,
+                            const MapArrays& layout, bool preserveIndices)
+{
+    // The elements of the prefabs share one section per element type
+    MapArrays prefabTotals;
+    for (size_t i = 0; i < layout.prefabCount; ++i)
+    {
+        prefabTotals.vertexCount += layout.prefabs[i].vertexCount;
+        prefabTotals.lineCount += layout.prefabs[i].lineCount;
+        prefabTotals.sideCount += layout.prefabs[i].sideCount;
+        prefabTotals.sectorCount += layout.prefabs[i].sectorCount;
+    }
+
+    // Lay the sections out one after another behind the section table
+    Section sections[] = {
+        {NATIVE_VERTEX_SECTION, sizeof(LineVertex), 0, layout.vertexCount},
+        {LINE_SECTION, sizeof(Line), 0, layout.lineCount},
+        {SIDE_SECTION, sizeof(Side), 0, layout.sideCount},
+        {SECTOR_SECTION, sizeof(Sector), 0, layout.sectorCount},
+        {REVISION_SECTION, sizeof(uint64_t), 0, 1},
+        {PREFAB_SECTION, sizeof(PrefabRecord), 0, layout.prefabCount},
+        {NATIVE_PREFAB_VERTEX_SECTION, sizeof(LineVertex), 0,
+         prefabTotals.vertexCount},
+        {PREFAB_LINE_SECTION, sizeof(Line), 0, prefabTotals.lineCount},
+        {PREFAB_SIDE_SECTION, sizeof(Side), 0, prefabTotals.sideCount},
+        {PREFAB_SECTOR_SECTION, sizeof(Sector), 0, prefabTotals.sectorCount},
+        {INSTANCE_SECTION, sizeof(PrefabInstance), 0, layout.instanceCount},
+        {VERTEX_INDEX_SECTION, sizeof(uint32_t), 0, layout.vertexCount},
+        {LINE_INDEX_SECTION, sizeof(uint32_t), 0, layout.lineCount},
+        {SIDE_INDEX_SECTION, sizeof(uint32_t), 0, layout.sideCount},
+        {SECTOR_INDEX_SECTION, sizeof(uint32_t), 0, layout.sectorCount},
+        {INSTANCE_INDEX_SECTION, sizeof(uint32_t), 0, layout.instanceCount},
+    };
+
+    // The index sections come last so that they can be left out
+    uint16_t sectionCount = sizeof(sections) / sizeof(Section);
+    if (!preserveIndices) sectionCount -= 5;
+
+    uint64_t offset =
+        alignOffset(sizeof(Header) + sectionCount * sizeof(Section));
+    for (uint16_t i = 0; i < sectionCount; ++i)
+    {
+        sections[i].offset = offset;
+        offset = alignOffset(offset + sections[i].stride * sections[i].count);
+    }
+
+    Header header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.sectionCount = sectionCount;
+
+    stream.open(tempPath, std::ios::binary | std::ios::trunc);
+    if (!stream)
+    {
+        LOG_WARN("Failed to open file: %s", tempPath.c_str());
+        return false;
+    }
+
+    writeAligned(stream, &header, sizeof(Header));
+    writeAligned(stream, sections, sectionCount * sizeof(Section));
+
+    return true;
+}
+
+bool BinaryMapWriter::finish(std::ofstream& stream, const std::string& tempPath,
+                             const std::string& path)
+{
+    stream.close();
+    if (!stream)
+    {
+        LOG_WARN("Failed to write file: %s", tempPath.c_str());
+        return false;
+    }
+
+    // Replace the destination only once the new file is complete
+    std::error_code error;
+    std::filesystem::rename(tempPath, path, error);
+    if (error)
+    {
+        LOG_WARN("Failed to replace file: %s", path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+void BinaryMapWriter::writePrefabs(std::ofstream& stream,
+                                   const MapArrays* prefabs,
+                                   size_t prefabCount)
+{
+    std::vector<PrefabRecord> records(prefabCount);
+    for (size_t i = 0; i < prefabCount; ++i)
+    {
+        const MapArrays& prefab = prefabs[i];
+        records[i] = {static_cast<uint32_t>(prefab.vertexCount),
+                      static_cast<uint32_t>(prefab.lineCount),
+                      static_cast<uint32_t>(prefab.sideCount),
+                      static_cast<uint32_t>(prefab.sectorCount)};
+    }
+    writeAligned(stream, records.data(), prefabCount * sizeof(PrefabRecord));
+
+    writePrefabArrays(stream, prefabs, prefabCount, &MapArrays::vertices,
+                      &MapArrays::vertexCount);
+    writePrefabArrays(stream, prefabs, prefabCount, &MapArrays::lines,
+                      &MapArrays::lineCount);
+    writePrefabArrays(stream, prefabs, prefabCount, &MapArrays::sides,
+                      &MapArrays::sideCount);
+    writePrefabArrays(stream, prefabs, prefabCount, &MapArrays::sectors,
+                      &MapArrays::sectorCount);
+}
+
+template <typename T>
+void BinaryMapWriter::writePrefabArrays(std::ofstream& stream,
+                                        const MapArrays* prefabs,
+                                        size_t prefabCount,
+                                        const T* MapArrays::*records,
+                                        size_t MapArrays::*count)
+{
+    size_t size = 0;
+    for (size_t i = 0; i < prefabCount; ++i)
+    {
+        size_t bytes = prefabs[i].*count * sizeof(T);
+        stream.write(reinterpret_cast<const char*>(prefabs[i].*records),
+                     bytes);
+        size += bytes;
+    }
+
+    writeAligned(stream, nullptr, size);
+}
+
+void BinaryMapWriter::getPrefabArrays(
+    const std::vector<std::shared_ptr<const MapFragment>>& fragments,
+    std::vector<MapArrays>& prefabs)
+{
+    prefabs.clear();
+    for (const std::shared_ptr<const MapFragment>& fragment : fragments)
+        prefabs.push_back(fragment->getArrays());
+}
+
+template <typename T>
+void BinaryMapWriter::writeValues(std::ofstream& stream,
+                                  const CowArray<T>& array)
+{
+    std::vector<T> chunk;
+    chunk.reserve(CHUNK_SIZE);
+
+    array.forEach(
+        [&](size_t index, const T& value)
+        {
+            chunk.push_back(value);
+            if (chunk.size() < CHUNK_SIZE) return;
+
+            stream.write(reinterpret_cast<const char*>(chunk.data()),
+                         chunk.size() * sizeof(T));
+            chunk.clear();
+        });
+
+    stream.write(reinterpret_cast<const char*>(chunk.data()),
+                 chunk.size() * sizeof(T));
+    writeAligned(stream, nullptr, array.size() * sizeof(T));
+}
+
+template <typename T>
+void BinaryMapWriter::writeIndices(std::ofstream& stream,
+                                   const CowArray<T>& array)
+{
+    std::vector<uint32_t> chunk;
+    chunk.reserve(CHUNK_SIZE);
+
+    array.forEach(
+        [&](size_t index, const T& value)
+        {
+            chunk.push_back(static_cast<uint32_t>(index));
+            if (chunk.size() < CHUNK_SIZE) return;
+
+            stream.write(reinterpret_cast<const char*>(chunk.data()),
+                         chunk.size() * sizeof(uint32_t));
+            chunk.clear();
+        });
+
+    stream.write(reinterpret_cast<const char*>(chunk.data()),
+                 chunk.size() * sizeof(uint32_t));
+    writeAligned(stream, nullptr, array.size() * sizeof(uint32_t));
+}
+
+void BinaryMapWriter::writeAligned(std::ofstream& stream, const void* data,
+                                   size_t size)
+{
+    if (data) stream.write(static_cast<const char*>(data), size);
+
+    static const char padding[SECTION_ALIGNMENT] = {};
+    stream.write(padding, alignOffset(size) - size);
+}
\ No newline at end of file
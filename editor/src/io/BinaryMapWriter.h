@@ -0,0 +1,186 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../map/CowArray.h"
+#include "../map/MapArrays.h"
+#include "../map/MapSnapshot.h"
+#include "../map/MapStore.h"
+#include "BinaryMapFormat.h"
+#include "IndexRemap.h"
+
+/**
+ * @brief A class that writes maps in the binary map format.
+ *
+ * This class writes the dense arrays of a map store as the sections of a
+ * binary map file. Vertices and sectors are written straight from the store,
+ * while lines and sides are written in chunks with their references rewritten
+ * from slot indices to positions in the file, unless the indices are preserved,
+ * in which case every section is written straight from the store along with
+ * the slot indices of the elements. The file is written next to its
+ * destination and moved into place once complete, so an interrupted save never
+ * leaves a truncated map behind. The scratch buffers are kept between calls.
+ * Snapshots are always written with their indices, gathering the stored
+ * elements of each chunk before writing them, and bare arrays are written
+ * as they are. The prefabs and their instances are written along with the
+ * elements.
+ */
+class BinaryMapWriter
+{
+public:
+    /**
+     * @brief Writes the elements of a store to the specified file.
+     *
+     * @param store The elements of the map.
+     * @param path The path of the file.
+     * @param preserveIndices Whether to write the slot index of each element
+     * so that loading the file restores the same indices. Defaults to false.
+     * @param revision The revision of the map to record. Defaults to 0.
+     * @return True if the file was written, false otherwise.
+     */
+    bool write(const MapStore& store, const std::string& path,
+               bool preserveIndices = false, uint64_t revision = 0);
+
+    /**
+     * @brief Writes the elements of a snapshot to the specified file,
+     * preserving their indices.
+     *
+     * Only the snapshot is read, so it can be written on a worker thread
+     * while the map it was taken from is edited.
+     *
+     * @param snapshot The elements of the map.
+     * @param path The path of the file.
+     * @param revision The revision of the map to record.
+     * @return True if the file was written, false otherwise.
+     */
+    bool write(const MapSnapshot& snapshot, const std::string& path,
+               uint64_t revision);
+
+    /**
+     * @brief Writes arrays to the specified file as they are, along with
+     * their index arrays if they have them.
+     *
+     * The references of the arrays are written unchanged, so they must
+     * either all be positions in the arrays or all be listed indices.
+     *
+     * @param arrays The elements of the map.
+     * @param path The path of the file.
+     * @param revision The revision of the map to record.
+     * @return True if the file was written, false otherwise.
+     */
+    bool write(const MapArrays& arrays, const std::string& path,
+               uint64_t revision);
+
+private:
+    // The number of records rewritten per write
+    static constexpr size_t CHUNK_SIZE = 16384;
+
+    // The position in the file of each vertex slot
+    IndexRemap vertexRemap;
+    // The position in the file of each side slot
+    IndexRemap sideRemap;
+    // The position in the file of each sector slot
+    IndexRemap sectorRemap;
+    // The buffer holding rewritten lines
+    std::vector<Line> lineChunk;
+    // The buffer holding rewritten sides
+    std::vector<Side> sideChunk;
+
+    /**
+     * @brief Opens a file and writes its header and section table.
+     *
+     * @param stream The stream to open.
+     * @param tempPath The path to write the file to.
+     * @param layout The arrays to lay the sections out for, of which only
+     * the counts and the prefabs are read.
+     * @param preserveIndices Whether the file has index sections.
+     * @return True if the file was opened, false otherwise.
+     */
+    static bool begin(std::ofstream& stream, const std::string& tempPath,
+                      const MapArrays& layout, bool preserveIndices);
+
+    /**
+     * @brief Writes the prefab section and the prefab element sections.
+     *
+     * @param stream The stream to write to.
+     * @param prefabs The geometry of each prefab.
+     * @param prefabCount The number of prefabs.
+     */
+    static void writePrefabs(std::ofstream& stream, const MapArrays* prefabs,
+                             size_t prefabCount);
+
+    /**
+     * @brief Writes one array of every prefab, one after another, as a
+     * section.
+     *
+     * @tparam T The type of the records.
+     * @param stream The stream to write to.
+     * @param prefabs The geometry of each prefab.
+     * @param prefabCount The number of prefabs.
+     * @param records The member holding the records of a prefab.
+     * @param count The member holding the number of records of a prefab.
+     */
+    template <typename T>
+    static void writePrefabArrays(std::ofstream& stream,
+                                  const MapArrays* prefabs, size_t prefabCount,
+                                  const T* MapArrays::*records,
+                                  size_t MapArrays::*count);
+
+    /**
+     * @brief Gets the arrays of the geometry of each prefab.
+     *
+     * @param fragments The geometry of each prefab.
+     * @param prefabs Set to the arrays of each prefab, which point into the
+     * geometry.
+     */
+    static void getPrefabArrays(
+        const std::vector<std::shared_ptr<const MapFragment>>& fragments,
+        std::vector<MapArrays>& prefabs);
+
+    /**
+     * @brief Closes a written file and moves it into place.
+     *
+     * @param stream The stream of the written file.
+     * @param tempPath The path the file was written to.
+     * @param path The path of the destination.
+     * @return True if the file was written and moved, false otherwise.
+     */
+    static bool finish(std::ofstream& stream, const std::string& tempPath,
+                       const std::string& path);
+
+    /**
+     * @brief Writes the elements of a copy-on-write array as a section.
+     *
+     * @tparam T The type of the elements.
+     * @param stream The stream to write to.
+     * @param array The elements.
+     */
+    template <typename T>
+    static void writeValues(std::ofstream& stream, const CowArray<T>& array);
+
+    /**
+     * @brief Writes the indices of the elements of a copy-on-write array as
+     * an index section.
+     *
+     * @tparam T The type of the elements.
+     * @param stream The stream to write to.
+     * @param array The elements.
+     */
+    template <typename T>
+    static void writeIndices(std::ofstream& stream, const CowArray<T>& array);
+
+    /**
+     * @brief Writes records followed by the padding that aligns the next
+     * section.
+     *
+     * @param stream The stream to write to.
+     * @param data The records.
+     * @param size The size of the records in bytes.
+     */
+    static void writeAligned(std::ofstream& stream, const void* data,
+                             size_t size);
+};
\ No newline at end of file
@@ -0,0 +1,353 @@
+#include "EditJournal.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <type_traits>
+
+#include "../map/Map.h"
+#include "../utils/macros.h"
+#include "BinaryMapReader.h"
+#include "MappedFile.h"
+
+// Commands are written to the journal byte for byte
+static_assert(std::is_trivially_copyable<MapCommand>::value,
+              "MapCommand must be trivially copyable");
+
+EditJournal::~EditJournal() { close(); }
+
+bool EditJournal::open(Map& map, const std::string& basePath)
+{
+    close();
+
+    this->basePath = basePath;
+    journalPath = basePath + ".journal";
+    oldJournalPath = journalPath + ".old";
+
+    isRecovering = true;
+    bool recovered = recover(map);
+    isRecovering = false;
+
+    // Leave inconsistent files untouched rather than overwrite them
+    if (!recovered)
+    {
+        LOG_WARN("Failed to recover map: %s", basePath.c_str());
+        return false;
+    }
+
+    mirror.assign(map.getStore());
+
+    // Never append after a batch that may have been torn
+    return rebase(map.getStore());
+}
+
+void EditJournal::close()
+{
+    flush();
+    waitForCompaction();
+    file.close();
+    pending.clear();
+}
+
+void EditJournal::update(const MapStore& store)
+{
+    if (!isOpen()) return;
+
+    if (compactionDone && compactionThread.joinable()) waitForCompaction();
+
+    auto now = std::chrono::steady_clock::now();
+    if (!pending.empty() && (pending.size() >= MAX_BATCH_SIZE ||
+                             now - pendingSince >= SYNC_INTERVAL))
+        flush();
+
+    if (!isOpen() || compactionThread.joinable()) return;
+
+    bool hasEdits = file.getSize() > sizeof(Header);
+    if (file.getSize() >= compactionSize ||
+        (hasEdits && now - journalSince >= AUTOSAVE_INTERVAL))
+        compact(store);
+}
+
+bool EditJournal::flush()
+{
+    if (pending.empty() || !isOpen()) return true;
+
+    BatchHeader header;
+    header.count = static_cast<uint32_t>(pending.size());
+
+    size_t commandBytes = pending.size() * sizeof(MapCommand);
+    batch.resize(sizeof(BatchHeader) + commandBytes);
+    std::memcpy(batch.data() + sizeof(BatchHeader), pending.data(),
+                commandBytes);
+    header.checksum =
+        getChecksum(batch.data() + sizeof(BatchHeader), commandBytes);
+    std::memcpy(batch.data(), &header, sizeof(BatchHeader));
+
+    pending.clear();
+
+    // One flush makes the whole batch durable
+    if (!file.append(batch.data(), batch.size()) || !file.sync())
+    {
+        // Later batches would be unreachable behind a partial one
+        LOG_WARN("Failed to write journal: %s", journalPath.c_str());
+        file.close();
+        return false;
+    }
+
+    return true;
+}
+
+void EditJournal::onPrefabAdded(int prefab, const MapStore& store)
+{
+    if (isRecovering || !isOpen()) return;
+
+    // Only the base holds prefabs, so it must hold the prefab before any
+    // journaled instance of it
+    mirror.addPrefab(store.getPrefab(prefab));
+    rebase(store);
+}
+
+void EditJournal::onMapLoaded(const MapStore& store)
+{
+    if (isRecovering || !isOpen()) return;
+
+    // The journaled edits belong to the previous map
+    pending.clear();
+    mirror.assign(store);
+    rebase(store);
+}
+
+void EditJournal::record(const MapCommand& command)
+{
+    if (isRecovering || !isOpen()) return;
+
+    mirror.apply(command);
+
+    if (pending.empty()) pendingSince = std::chrono::steady_clock::now();
+
+    // Only the final position of a dragged vertex needs to be replayed
+    if (command.type == MapCommandType::MOVE_VERTEX && !pending.empty())
+    {
+        MapCommand& last = pending.back();
+        if (last.index == command.index &&
+            (last.type == MapCommandType::MOVE_VERTEX ||
+             last.type == MapCommandType::ADD_VERTEX))
+        {
+            last.payload.vertex.to = command.payload.vertex.to;
+            return;
+        }
+    }
+
+    pending.push_back(command);
+}
+
+bool EditJournal::recover(Map& map)
+{
+    uint64_t expected = 0;
+
+    std::error_code error;
+    if (std::filesystem::exists(basePath, error))
+    {
+        BinaryMapReader reader;
+        if (!reader.open(basePath)) return false;
+
+        map.load(reader.getArrays());
+        expected = reader.getRevision();
+    }
+
+    revision = expected;
+
+    // The old journal is left behind by an unfinished compaction
+    return replay(map, oldJournalPath, expected) &&
+           replay(map, journalPath, expected);
+}
+
+bool EditJournal::replay(Map& map, const std::string& path,
+                         uint64_t& expected)
+{
+    std::error_code error;
+    if (!std::filesystem::exists(path, error)) return true;
+
+    // A journal without a header was never written to
+    MappedFile journal;
+    if (!journal.open(path) || journal.getSize() < sizeof(Header))
+        return true;
+
+    Header header;
+    std::memcpy(&header, journal.getData(), sizeof(Header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header.version != VERSION || header.commandSize != sizeof(MapCommand))
+    {
+        LOG_WARN("Skipped unreadable journal: %s", path.c_str());
+        return true;
+    }
+
+    revision = std::max(revision, header.revision);
+
+    // Older journals were folded into the base
+    if (header.revision < expected) return true;
+
+    if (header.revision > expected)
+    {
+        LOG_WARN("Journal does not follow its base: %s", path.c_str());
+        return false;
+    }
+
+    const unsigned char* data = journal.getData();
+    size_t size = journal.getSize();
+    size_t offset = sizeof(Header);
+
+    while (size - offset >= sizeof(BatchHeader))
+    {
+        BatchHeader batchHeader;
+        std::memcpy(&batchHeader, data + offset, sizeof(BatchHeader));
+
+        // Compare counts rather than byte sizes so that the check cannot
+        // overflow
+        size_t available = size - offset - sizeof(BatchHeader);
+        if (batchHeader.count > available / sizeof(MapCommand)) break;
+
+        const unsigned char* commands = data + offset + sizeof(BatchHeader);
+        size_t commandBytes = batchHeader.count * sizeof(MapCommand);
+        if (getChecksum(commands, commandBytes) != batchHeader.checksum) break;
+
+        for (uint32_t i = 0; i < batchHeader.count; ++i)
+        {
+            MapCommand command;
+            std::memcpy(&command, commands + i * sizeof(MapCommand),
+                        sizeof(MapCommand));
+            command.apply(map);
+        }
+
+        offset += sizeof(BatchHeader) + commandBytes;
+    }
+
+    if (offset != size)
+        LOG_WARN("Discarded a torn batch at the end of journal: %s",
+                 path.c_str());
+
+    ++expected;
+    return true;
+}
+
+bool EditJournal::rebase(const MapStore& store)
+{
+    waitForCompaction();
+    flush();
+
+    uint64_t newRevision = revision + 1;
+    if (!baseWriter.write(store, basePath, true, newRevision) ||
+        !AppendFile::syncFile(basePath))
+    {
+        LOG_WARN("Failed to write journal base: %s", basePath.c_str());
+        compactionSize = file.getSize() + COMPACTION_THRESHOLD;
+        return false;
+    }
+
+    // The new base holds every journaled edit
+    file.close();
+    std::error_code error;
+    std::filesystem::remove(oldJournalPath, error);
+
+    return startJournal(newRevision);
+}
+
+void EditJournal::compact(const MapStore& store)
+{
+    waitForCompaction();
+
+    // The old journal of a failed compaction would be overwritten
+    if (!compactionSucceeded)
+    {
+        compactionSucceeded = rebase(store);
+        return;
+    }
+
+    if (!flush()) return;
+    file.close();
+
+    std::error_code error;
+    std::filesystem::rename(journalPath, oldJournalPath, error);
+    if (error)
+    {
+        LOG_WARN("Failed to move journal: %s", journalPath.c_str());
+        file.open(journalPath, false);
+        compactionSize = file.getSize() + COMPACTION_THRESHOLD;
+        return;
+    }
+
+    uint64_t newRevision = revision + 1;
+    if (!startJournal(newRevision)) return;
+
+    // The snapshot holds exactly the edits of the old journal, and shares
+    // its chunks with the mirror until they are next edited
+    auto start = std::chrono::steady_clock::now();
+    MapSnapshot snapshot = mirror;
+
+    compactionDone = false;
+    compactionThread = std::thread(
+        [this, snapshot = std::move(snapshot), newRevision]()
+        {
+            compactionSucceeded =
+                baseWriter.write(snapshot, basePath, newRevision) &&
+                AppendFile::syncFile(basePath);
+
+            if (compactionSucceeded)
+            {
+                std::error_code error;
+                std::filesystem::remove(oldJournalPath, error);
+            }
+
+            compactionDone = true;
+        });
+
+    lastPauseTime = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    LOG_INFO("Autosaving map in the background after a %.3f ms pause",
+             lastPauseTime.count() / 1000.0);
+}
+
+void EditJournal::waitForCompaction()
+{
+    if (!compactionThread.joinable()) return;
+
+    compactionThread.join();
+
+    if (!compactionSucceeded)
+        LOG_WARN("Failed to compact journal: %s", journalPath.c_str());
+}
+
+bool EditJournal::startJournal(uint64_t newRevision)
+{
+    Header header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.commandSize = sizeof(MapCommand);
+    header.revision = newRevision;
+
+    if (!file.open(journalPath, true) ||
+        !file.append(&header, sizeof(Header)) || !file.sync())
+    {
+        LOG_WARN("Failed to start journal: %s", journalPath.c_str());
+        file.close();
+        return false;
+    }
+
+    revision = newRevision;
+    compactionSize = COMPACTION_THRESHOLD;
+    journalSince = std::chrono::steady_clock::now();
+
+    return true;
+}
+
+uint32_t EditJournal::getChecksum(const unsigned char* data, size_t size)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
\ No newline at end of file
@@ -0,0 +1,280 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../map/MapCommand.h"
+#include "../map/MapCommandRecorder.h"
+#include "../map/MapSnapshot.h"
+#include "../map/MapStore.h"
+#include "AppendFile.h"
+#include "BinaryMapWriter.h"
+
+class Map;
+
+/**
+ * @brief A class that keeps a map on disk as a base file and a journal of the
+ * edits made since.
+ *
+ * The base is a binary map file that preserves element indices, and the
+ * journal is an append-only file of the MapCommands recorded from the map.
+ * Commands are buffered and appended in checksummed batches, each followed by
+ * a single flush to the storage device, so the cost of persisting an edit is
+ * proportional to the edit rather than to the map.
+ *
+ * Once the journal grows past a threshold, or holds edits older than the
+ * autosave interval, it is compacted: the journal is moved aside and a new one
+ * is started, and a worker thread folds a snapshot of the map into a new base
+ * before removing the old journal. The snapshot is taken from a copy-on-write
+ * copy of the map that the journal keeps up to date, so the main thread only
+ * pauses to copy its chunk pointers. Every base and
+ * journal carries a revision, so a crash at any point leaves files from which
+ * the map can be recovered by loading the base and replaying the journals
+ * that follow it. A batch torn by a crash fails its checksum and ends the
+ * replay. Adding a prefab writes a new base at once, since prefabs are not
+ * commands and the instances journaled after it could not be replayed onto a
+ * base without it.
+ */
+class EditJournal : public MapCommandRecorder
+{
+public:
+    // The longest time an edit is buffered before it is flushed
+    static constexpr std::chrono::milliseconds SYNC_INTERVAL{250};
+    // The number of buffered commands that forces a flush
+    static constexpr size_t MAX_BATCH_SIZE = 4096;
+    // The size of the journal in bytes that triggers a compaction
+    static constexpr uint64_t COMPACTION_THRESHOLD = 16 * 1024 * 1024;
+    // The longest time journaled edits wait to be folded into the base
+    static constexpr std::chrono::seconds AUTOSAVE_INTERVAL{60};
+
+    /**
+     * @brief Constructs a new EditJournal object with no files open.
+     */
+    EditJournal() = default;
+
+    /**
+     * @brief Destroys the EditJournal object, flushing the buffered edits and
+     * waiting for a running compaction.
+     */
+    ~EditJournal();
+
+    EditJournal(const EditJournal&) = delete;
+    EditJournal& operator=(const EditJournal&) = delete;
+
+    /**
+     * @brief Recovers a map from the specified base and its journals, then
+     * starts journaling its edits.
+     *
+     * The map is loaded from the base and the journals are replayed onto it.
+     * If there is no base, the map is left as it is. The recovered map is
+     * then written as a new base, so journaling starts from an empty journal.
+     * Edits reported while recovering are not journaled.
+     *
+     * @param map The map to recover into.
+     * @param basePath The path of the base file. The journals are kept next
+     * to it.
+     * @return True if the files could be recovered and journaling started,
+     * false otherwise.
+     */
+    bool open(Map& map, const std::string& basePath);
+
+    /**
+     * @brief Flushes the buffered edits, waits for a running compaction and
+     * closes the journal.
+     */
+    void close();
+
+    /**
+     * @brief Checks if edits are being journaled.
+     *
+     * @return True if a journal is open, false otherwise.
+     */
+    inline bool isOpen() const { return file.isOpen(); }
+
+    /**
+     * @brief Flushes the buffered edits if they are due, and compacts the
+     * journal if it has grown past the threshold or the autosave interval has
+     * elapsed.
+     *
+     * This method is meant to be called once per frame.
+     *
+     * @param store The elements of the journaled map.
+     */
+    void update(const MapStore& store);
+
+    /**
+     * @brief Appends the buffered edits to the journal and flushes them to
+     * the storage device.
+     *
+     * @return True if the edits are durable, false otherwise.
+     */
+    bool flush();
+
+    /**
+     * @brief Gets the revision of the journal.
+     *
+     * @return The revision, which increases with every compaction.
+     */
+    inline uint64_t getRevision() const { return revision; }
+
+    /**
+     * @brief Gets the time the main thread paused to start the last
+     * compaction.
+     *
+     * @return The pause time.
+     */
+    inline std::chrono::microseconds getLastPauseTime() const
+    {
+        return lastPauseTime;
+    }
+
+    void onPrefabAdded(int prefab, const MapStore& store) override;
+
+    void onMapLoaded(const MapStore& store) override;
+
+private:
+    // The magic bytes at the start of every journal
+    static constexpr char MAGIC[4] = {'D', 'V', 'J', 'L'};
+    // The current version of the journal format
+    static constexpr uint16_t VERSION = 1;
+
+    /**
+     * @brief A struct representing the header of a journal.
+     */
+    struct Header
+    {
+        // The magic bytes
+        char magic[4];
+        // The version of the format
+        uint16_t version;
+        // The size of a command in bytes
+        uint16_t commandSize;
+        // The revision of the base the journal applies to
+        uint64_t revision;
+    };
+
+    /**
+     * @brief A struct representing the header of a batch of commands.
+     */
+    struct BatchHeader
+    {
+        // The number of commands in the batch
+        uint32_t count;
+        // The checksum of the commands
+        uint32_t checksum;
+    };
+
+    // The path of the base file
+    std::string basePath;
+    // The path of the journal being appended to
+    std::string journalPath;
+    // The path of the journal being folded into a new base
+    std::string oldJournalPath;
+    // The journal being appended to
+    AppendFile file;
+    // The revision of the journal being appended to
+    uint64_t revision = 0;
+    // The commands waiting to be appended
+    std::vector<MapCommand> pending;
+    // The time the oldest waiting command was recorded
+    std::chrono::steady_clock::time_point pendingSince;
+    // The bytes of the batch being appended
+    std::vector<unsigned char> batch;
+    // Whether edits are being replayed into the map
+    bool isRecovering = false;
+    // The copy of the map that compactions are taken from
+    MapSnapshot mirror;
+    // The time the current journal was started
+    std::chrono::steady_clock::time_point journalSince;
+    // The time the main thread paused to start the last compaction
+    std::chrono::microseconds lastPauseTime{0};
+    // The writer used by the compaction thread
+    BinaryMapWriter baseWriter;
+    // The thread folding the old journal into a new base
+    std::thread compactionThread;
+    // Whether the compaction thread has finished
+    std::atomic<bool> compactionDone{true};
+    // Whether the last compaction wrote its base
+    bool compactionSucceeded = true;
+    // The size of the journal at which the next compaction is attempted
+    uint64_t compactionSize = COMPACTION_THRESHOLD;
+
+    /**
+     * @brief Applies a command to the copy of the map and buffers it until
+     * the next flush.
+     *
+     * Consecutive moves of the same vertex are merged into one command.
+     *
+     * @param command The command to buffer.
+     */
+    void record(const MapCommand& command) override;
+
+    /**
+     * @brief Loads the base and replays the journals that follow it.
+     *
+     * @param map The map to recover into.
+     * @return True if the files were consistent, false otherwise.
+     */
+    bool recover(Map& map);
+
+    /**
+     * @brief Replays a journal if it applies to the expected revision.
+     *
+     * Journals of older revisions are skipped. Replay stops at the first
+     * incomplete or corrupt batch.
+     *
+     * @param map The map to replay into.
+     * @param path The path of the journal.
+     * @param expected The revision the next journal must apply to, which is
+     * advanced past a replayed journal.
+     * @return False if the journal applies to a later revision, which means
+     * edits are missing, true otherwise.
+     */
+    bool replay(Map& map, const std::string& path, uint64_t& expected);
+
+    /**
+     * @brief Writes the store as a new base and starts an empty journal.
+     *
+     * If the base cannot be written, journaling continues in the current
+     * journal.
+     *
+     * @param store The elements of the map.
+     * @return True if the new base was written, false otherwise.
+     */
+    bool rebase(const MapStore& store);
+
+    /**
+     * @brief Moves the journal aside and folds it into a new base on the
+     * compaction thread.
+     *
+     * @param store The elements of the map, which are only read if the
+     * previous compaction failed.
+     */
+    void compact(const MapStore& store);
+
+    /**
+     * @brief Waits for a running compaction to finish.
+     */
+    void waitForCompaction();
+
+    /**
+     * @brief Starts an empty journal.
+     *
+     * @param newRevision The revision of the base the journal applies to.
+     * @return True if the journal was started, false otherwise.
+     */
+    bool startJournal(uint64_t newRevision);
+
+    /**
+     * @brief Computes the FNV-1a checksum of bytes.
+     *
+     * @param data The bytes.
+     * @param size The number of bytes.
+     * @return The checksum.
+     */
+    static uint32_t getChecksum(const unsigned char* data, size_t size);
+};
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief A class mapping the slot indices of a slot map to their position in
+ * dense order.
+ *
+ * Map files refer to elements by their position in the file, which is their
+ * dense position in the store, while the store refers to them by slot index.
+ * Writers use this class to rewrite references on the way out.
+ */
+class IndexRemap
+{
+public:
+    /**
+     * @brief Builds the mapping from the slot indices in dense order.
+     *
+     * @param indices The slot indices in dense order.
+     */
+    void build(const std::vector<uint32_t>& indices)
+    {
+        uint32_t slotCount = 0;
+        for (uint32_t index : indices)
+            slotCount = std::max(slotCount, index + 1);
+
+        positions.assign(slotCount, -1);
+        for (size_t i = 0; i < indices.size(); ++i) positions[indices[i]] = i;
+    }
+
+    /**
+     * @brief Gets the position of a slot.
+     *
+     * @param index The slot index, or -1 for none.
+     * @return The position of the slot, or -1 for none.
+     */
+    inline int get(int index) const
+    {
+        return index < 0 ? -1 : positions[index];
+    }
+
+private:
+    // The position of each slot, -1 for free slots
+    std::vector<int> positions;
+};
\ No newline at end of file
@@ -0,0 +1,1326 @@
+#include "MapStreamer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+
+#include "../map/Map.h"
+#include "../map/MapFragment.h"
+#include "../utils/macros.h"
+#include "BinaryMapFormat.h"
+#include "BinaryMapReader.h"
+
+// The records of a manifest are written byte for byte
+static_assert(std::is_trivially_copyable<Sector>::value,
+              "Sector must be trivially copyable");
+
+/**
+ * @brief Sets the global index of a slot, growing the table as needed.
+ *
+ * @param ids The global index of each slot.
+ * @param slots The slot of each global index.
+ * @param slot The slot.
+ * @param id The global index.
+ */
+static void bindId(std::vector<int>& ids, std::unordered_map<int, int>& slots,
+                   int slot, int id)
+{
+    if (ids.size() <= static_cast<size_t>(slot)) ids.resize(slot + 1, -1);
+    ids[slot] = id;
+    slots[id] = slot;
+}
+
+/**
+ * @brief Sets an entry of a table indexed by slot, growing the table as
+ * needed.
+ *
+ * @param table The table.
+ * @param slot The slot.
+ * @param value The value of the entry.
+ */
+static void setEntry(std::vector<int>& table, int slot, int value)
+{
+    if (table.size() <= static_cast<size_t>(slot)) table.resize(slot + 1, -1);
+    table[slot] = value;
+}
+
+/**
+ * @brief Clears the global index of a slot.
+ *
+ * @param ids The global index of each slot.
+ * @param slots The slot of each global index, or null if there is none.
+ * @param slot The slot.
+ * @return The global index the slot had, or -1 if it had none.
+ */
+static int releaseId(std::vector<int>& ids, std::unordered_map<int, int>* slots,
+                     int slot)
+{
+    if (ids.size() <= static_cast<size_t>(slot)) return -1;
+
+    int id = ids[slot];
+    ids[slot] = -1;
+    if (slots && id != -1) slots->erase(id);
+    return id;
+}
+
+/**
+ * @brief Finds the slot of a global index.
+ *
+ * @param slots The slot of each global index.
+ * @param id The global index, or -1 for none.
+ * @return The slot, or -1 if the index is not resident.
+ */
+static int findSlot(const std::unordered_map<int, int>& slots, int id)
+{
+    if (id == -1) return -1;
+
+    auto it = slots.find(id);
+    return it == slots.end() ? -1 : it->second;
+}
+
+/**
+ * @brief Adds to the reference count of a slot, growing the table as needed.
+ *
+ * @param counts The reference count of each slot.
+ * @param slot The slot, or -1 for none.
+ * @param delta The amount to add.
+ */
+static void addRef(std::vector<int>& counts, int slot, int delta)
+{
+    if (slot == -1) return;
+
+    if (counts.size() <= static_cast<size_t>(slot))
+        counts.resize(slot + 1, 0);
+    counts[slot] += delta;
+}
+
+/**
+ * @brief Adds a slot to a list of slots, recording its position in the list.
+ *
+ * @param list The list.
+ * @param positions The position of each slot in its list.
+ * @param slot The slot.
+ */
+static void addToList(std::vector<int>& list, std::vector<int>& positions,
+                      int slot)
+{
+    setEntry(positions, slot, static_cast<int>(list.size()));
+    list.push_back(slot);
+}
+
+/**
+ * @brief Removes a slot from a list of slots by moving the last slot of the
+ * list into its place.
+ *
+ * @param list The list, which must hold the slot.
+ * @param positions The position of each slot in its list.
+ * @param slot The slot.
+ */
+static void removeFromList(std::vector<int>& list, std::vector<int>& positions,
+                           int slot)
+{
+    int position = positions[slot];
+    int last = list.back();
+    list[position] = last;
+    positions[last] = position;
+    list.pop_back();
+    positions[slot] = -1;
+}
+
+/**
+ * @brief Sorts slots and removes the duplicates.
+ *
+ * @param slots The slots.
+ */
+static void sortUnique(std::vector<int>& slots)
+{
+    std::sort(slots.begin(), slots.end());
+    slots.erase(std::unique(slots.begin(), slots.end()), slots.end());
+}
+
+MapArrays MapStreamer::ChunkData::getArrays() const
+{
+    MapArrays arrays;
+    arrays.vertices = vertices.data();
+    arrays.vertexCount = vertices.size();
+    arrays.lines = lines.data();
+    arrays.lineCount = lines.size();
+    arrays.sides = sides.data();
+    arrays.sideCount = sides.size();
+    arrays.sectors = sectors.data();
+    arrays.sectorCount = sectors.size();
+    arrays.vertexIndices = vertexIds.data();
+    arrays.lineIndices = lineIds.data();
+    arrays.sideIndices = sideIds.data();
+    arrays.sectorIndices = sectorIds.data();
+    return arrays;
+}
+
+bool MapStreamer::ChunkData::assign(const MapArrays& arrays)
+{
+    // Files without elements are written without index sections
+    bool hasIndices = arrays.vertexIndices && arrays.lineIndices &&
+                      arrays.sideIndices && arrays.sectorIndices;
+    bool isEmpty = arrays.vertexCount == 0 && arrays.lineCount == 0 &&
+                   arrays.sideCount == 0 && arrays.sectorCount == 0;
+    if (!hasIndices && !isEmpty) return false;
+
+    vertices.assign(arrays.vertices, arrays.vertices + arrays.vertexCount);
+    lines.assign(arrays.lines, arrays.lines + arrays.lineCount);
+    sides.assign(arrays.sides, arrays.sides + arrays.sideCount);
+    sectors.assign(arrays.sectors, arrays.sectors + arrays.sectorCount);
+    vertexIds.assign(arrays.vertexIndices,
+                     arrays.vertexIndices + arrays.vertexCount);
+    lineIds.assign(arrays.lineIndices, arrays.lineIndices + arrays.lineCount);
+    sideIds.assign(arrays.sideIndices, arrays.sideIndices + arrays.sideCount);
+    sectorIds.assign(arrays.sectorIndices,
+                     arrays.sectorIndices + arrays.sectorCount);
+    return true;
+}
+
+void MapStreamer::PrefabData::assign(const MapStore& store)
+{
+    prefabs = store.getPrefabs();
+    prefabArrays.clear();
+    for (const std::shared_ptr<const MapFragment>& prefab : prefabs)
+        prefabArrays.push_back(prefab->getArrays());
+
+    instances = store.getInstances();
+    instanceIds = store.getInstanceIndices();
+}
+
+MapArrays MapStreamer::PrefabData::getArrays() const
+{
+    MapArrays arrays;
+    arrays.prefabs = prefabArrays.data();
+    arrays.prefabCount = prefabArrays.size();
+    arrays.instances = instances.data();
+    arrays.instanceCount = instances.size();
+    arrays.instanceIndices = instanceIds.data();
+    return arrays;
+}
+
+MapStreamer::MapStreamer() : loader(1) {}
+
+MapStreamer::~MapStreamer() { close(); }
+
+bool MapStreamer::build(const MapStore& store, const std::string& directory,
+                        float chunkSize)
+{
+    ASSERT(chunkSize > 0.0f);
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error)
+    {
+        LOG_WARN("Failed to create directory: %s", directory.c_str());
+        return false;
+    }
+
+    MapStreamer streamer;
+    streamer.directory = directory;
+    streamer.chunkSize = chunkSize;
+    streamer.nextVertexId = static_cast<int>(store.getVertexSlotCount());
+    streamer.nextLineId = static_cast<int>(store.getLineSlotCount());
+    streamer.nextSideId = static_cast<int>(store.getSideSlotCount());
+    streamer.nextSectorId = static_cast<int>(store.getSectorSlotCount());
+
+    // The global indices are the slot indices of the store
+    std::vector<int>* tables[] = {&streamer.vertexIds, &streamer.lineIds,
+                                  &streamer.sideIds, &streamer.sectorIds};
+    int counts[] = {streamer.nextVertexId, streamer.nextLineId,
+                    streamer.nextSideId, streamer.nextSectorId};
+    for (int i = 0; i < 4; ++i)
+    {
+        tables[i]->resize(counts[i]);
+        for (int slot = 0; slot < counts[i]; ++slot) (*tables[i])[slot] = slot;
+    }
+
+    // Sort the lines by the chunk holding their midpoint
+    std::vector<std::vector<int>> chunkLines;
+    std::vector<std::vector<int>> chunkVertices;
+    const std::vector<Line>& lines = store.getLines();
+    const std::vector<uint32_t>& lineIndices = store.getLineIndices();
+    for (size_t i = 0; i < lines.size(); ++i)
+    {
+        const LineVertex& start = store.getVertex(lines[i].startVertex);
+        const LineVertex& end = store.getVertex(lines[i].endVertex);
+        glm::vec2 midpoint = {(start.x + end.x) * 0.5f,
+                              (start.y + end.y) * 0.5f};
+
+        size_t chunk = streamer.getChunk(streamer.getCell(midpoint));
+        chunkLines.resize(streamer.chunks.size());
+        chunkLines[chunk].push_back(lineIndices[i]);
+    }
+
+    const std::vector<LineVertex>& positions = store.getVertexPositions();
+    const std::vector<uint32_t>& vertexIndices = store.getVertexIndices();
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        if (store.getVertexRefCount(vertexIndices[i]) > 0) continue;
+
+        size_t chunk = streamer.getChunk(
+            streamer.getCell({positions[i].x, positions[i].y}));
+        chunkVertices.resize(streamer.chunks.size());
+        chunkVertices[chunk].push_back(vertexIndices[i]);
+    }
+
+    chunkLines.resize(streamer.chunks.size());
+    chunkVertices.resize(streamer.chunks.size());
+
+    BinaryMapWriter writer;
+    ChunkData data;
+    bool isWritten = true;
+    for (size_t i = 0; i < streamer.chunks.size(); ++i)
+    {
+        Chunk& chunk = streamer.chunks[i];
+        streamer.gatherChunk(store, chunkLines[i], chunkVertices[i], chunk,
+                             data);
+        chunk.state = ChunkState::UNLOADED;
+        chunk.hasFile = writer.write(data.getArrays(),
+                                     streamer.getChunkPath(chunk.cell), 0);
+        isWritten &= chunk.hasFile;
+    }
+
+    // The prefabs and instances are kept whole rather than in chunks
+    if (store.getPrefabCount() > 0)
+    {
+        PrefabData prefabs;
+        prefabs.assign(store);
+        isWritten &=
+            writer.write(prefabs.getArrays(), streamer.getPrefabsPath(), 0);
+    }
+
+    std::string manifestPath =
+        (std::filesystem::path(directory) / MANIFEST_NAME).string();
+    return writeFile(manifestPath, streamer.encodeManifest()) && isWritten;
+}
+
+bool MapStreamer::open(Map& map, const std::string& directory)
+{
+    close();
+
+    this->directory = directory;
+    std::string manifestPath =
+        (std::filesystem::path(directory) / MANIFEST_NAME).string();
+    if (!readManifest(manifestPath))
+    {
+        LOG_WARN("Failed to read chunked map: %s", directory.c_str());
+        reset();
+        return false;
+    }
+
+    // A chunked map without prefabs has no file for them
+    std::string prefabsPath = getPrefabsPath();
+    BinaryMapReader reader;
+    std::error_code error;
+    if (std::filesystem::exists(prefabsPath, error) &&
+        !reader.open(prefabsPath))
+    {
+        LOG_WARN("Failed to read chunked map: %s", directory.c_str());
+        reset();
+        return false;
+    }
+
+    MapArrays prefabs;
+    prefabs.prefabs = reader.getArrays().prefabs;
+    prefabs.prefabCount = reader.getArrays().prefabCount;
+    prefabs.instances = reader.getArrays().instances;
+    prefabs.instanceCount = reader.getArrays().instanceCount;
+    prefabs.instanceIndices = reader.getArrays().instanceIndices;
+
+    // Empty the map, which no longer matches any chunk, but for the prefabs
+    // and instances, which are never paged
+    isPaging = true;
+    map.load(prefabs);
+    isPaging = false;
+
+    this->map = &map;
+    map.addListener(this);
+
+    LOG_INFO("Opened chunked map %s with %zu chunks", directory.c_str(),
+             chunks.size());
+    return true;
+}
+
+bool MapStreamer::close()
+{
+    if (!map) return true;
+
+    // Chunks that own edits must hold their stored elements before they are
+    // written
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        if (chunks[i].isDirty && chunks[i].state == ChunkState::UNLOADED &&
+            chunks[i].isReadable)
+            requestLoad(i);
+    }
+
+    loader.wait();
+    applyResults(chunks.size());
+
+    bool isWritten = flush();
+
+    map->removeListener(this);
+    map = nullptr;
+    reset();
+
+    return isWritten;
+}
+
+bool MapStreamer::update(glm::vec2 viewMin, glm::vec2 viewMax)
+{
+    if (!map) return false;
+
+    ++updateCount;
+    glm::vec2 min = viewMin - margin;
+    glm::vec2 max = viewMax + margin;
+
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        Chunk& chunk = chunks[i];
+        bool isInView = chunk.min.x <= max.x && chunk.max.x >= min.x &&
+                        chunk.min.y <= max.y && chunk.max.y >= min.y;
+
+        // Chunks owning edits are read so that the edits can be written
+        bool ownsEdits = chunk.isDirty && chunk.state == ChunkState::UNLOADED;
+        if (!isInView && !ownsEdits) continue;
+
+        chunk.lastViewed = updateCount;
+        if (chunk.state == ChunkState::UNLOADED && chunk.isReadable)
+            requestLoad(i);
+    }
+
+    bool isPaged = applyResults(MAX_LOADS_PER_UPDATE);
+    isPaged |= evictOverBudget();
+
+    bool hasEdits = isManifestDirty;
+    for (const Chunk& chunk : chunks)
+        hasEdits |= chunk.isDirty && chunk.state == ChunkState::RESIDENT;
+
+    if (hasEdits &&
+        std::chrono::steady_clock::now() - dirtySince >= WRITE_BACK_INTERVAL)
+        writeBack();
+
+    return isPaged;
+}
+
+bool MapStreamer::flush()
+{
+    if (!map) return true;
+
+    writeBack();
+    loader.wait();
+
+    std::lock_guard<std::mutex> lock(resultMutex);
+    bool isWritten = failedWrites.empty() && !hasFailedPrefabWrite;
+    for (int chunk : failedWrites)
+    {
+        LOG_WARN("Failed to write chunk: %s",
+                 getChunkPath(chunks[chunk].cell).c_str());
+        if (chunks[chunk].state == ChunkState::RESIDENT) markDirty(chunk);
+    }
+    failedWrites.clear();
+
+    if (hasFailedPrefabWrite)
+    {
+        LOG_WARN("Failed to write prefabs: %s", getPrefabsPath().c_str());
+        arePrefabsDirty = true;
+        markManifestDirty();
+        hasFailedPrefabWrite = false;
+    }
+
+    return isWritten;
+}
+
+size_t MapStreamer::getResidentBytes() const
+{
+    size_t bytes = 0;
+    for (const Chunk& chunk : chunks)
+    {
+        if (chunk.state == ChunkState::RESIDENT) bytes += getChunkBytes(chunk);
+    }
+
+    return bytes;
+}
+
+int MapStreamer::getResidentChunkCount() const
+{
+    return static_cast<int>(
+        std::count_if(chunks.begin(), chunks.end(), [](const Chunk& chunk)
+                      { return chunk.state == ChunkState::RESIDENT; }));
+}
+
+void MapStreamer::onVertexAdded(int vertex, glm::vec2 position)
+{
+    setVertexChunk(vertex, getChunk(getCell(position)));
+    if (isPaging) return;
+
+    bindId(vertexIds, vertexSlots, vertex, nextVertexId++);
+
+    // The vertex belongs to the chunk holding it until a line uses it
+    markDirty(vertexChunks[vertex]);
+}
+
+void MapStreamer::onVertexRemoved(int vertex, glm::vec2 position)
+{
+    releaseId(vertexIds, &vertexSlots, vertex);
+    if (!isPaging) markDirty(vertexChunks[vertex]);
+
+    setVertexChunk(vertex, -1);
+}
+
+void MapStreamer::onVertexMoved(int vertex, glm::vec2 from, glm::vec2 to)
+{
+    int previous = vertexChunks[vertex];
+    setVertexChunk(vertex, getChunk(getCell(to)));
+    if (isPaging) return;
+
+    // Chunks that are not resident may hold the vertex too
+    vertexOverrides[vertexIds[vertex]] = to;
+    markManifestDirty();
+
+    if (map->getStore().getVertexRefCount(vertex) == 0)
+    {
+        markDirty(previous);
+        markDirty(vertexChunks[vertex]);
+    }
+
+    for (int line : map->getTopology().getIncidentLines(vertex))
+        markDirty(lineChunks[line]);
+}
+
+void MapStreamer::onLineAdded(int index, const Line& line)
+{
+    addRef(sideRefCounts, line.front, 1);
+    addRef(sideRefCounts, line.back, 1);
+    if (line.front != -1) setEntry(sideLines, line.front, index);
+    if (line.back != -1) setEntry(sideLines, line.back, index);
+
+    if (isPaging) return;
+
+    setEntry(lineIds, index, nextLineId++);
+    setLineChunk(index, getLineOwner(line));
+    markDirty(lineChunks[index]);
+
+    // A vertex that had no lines is no longer stored by the chunk holding it
+    const MapStore& store = map->getStore();
+    for (int vertex : {line.startVertex, line.endVertex})
+    {
+        if (store.getVertexRefCount(vertex) == 1)
+            markDirty(vertexChunks[vertex]);
+    }
+}
+
+void MapStreamer::onLineRemoved(int index, const Line& line)
+{
+    addRef(sideRefCounts, line.front, -1);
+    addRef(sideRefCounts, line.back, -1);
+    releaseId(lineIds, nullptr, index);
+
+    if (!isPaging)
+    {
+        markDirty(lineChunks[index]);
+
+        // A vertex left without lines is stored by the chunk holding it
+        const MapStore& store = map->getStore();
+        for (int vertex : {line.startVertex, line.endVertex})
+        {
+            if (store.getVertexRefCount(vertex) == 0)
+                markDirty(vertexChunks[vertex]);
+        }
+    }
+
+    setLineChunk(index, -1);
+}
+
+void MapStreamer::onLineChanged(int index, const Line& from, const Line& to)
+{
+    addRef(sideRefCounts, from.front, -1);
+    addRef(sideRefCounts, from.back, -1);
+    addRef(sideRefCounts, to.front, 1);
+    addRef(sideRefCounts, to.back, 1);
+    if (to.front != -1) setEntry(sideLines, to.front, index);
+    if (to.back != -1) setEntry(sideLines, to.back, index);
+
+    if (!isPaging) markDirty(lineChunks[index]);
+}
+
+void MapStreamer::onSideAdded(int index, const Side& side)
+{
+    setEntry(sideRefCounts, index, 0);
+    setEntry(sideLines, index, -1);
+    addRef(sectorRefCounts, side.sector, 1);
+
+    if (!isPaging) bindId(sideIds, sideSlots, index, nextSideId++);
+}
+
+void MapStreamer::onSideRemoved(int index, const Side& side)
+{
+    addRef(sectorRefCounts, side.sector, -1);
+    releaseId(sideIds, &sideSlots, index);
+}
+
+void MapStreamer::onSideChanged(int index, const Side& from, const Side& to)
+{
+    addRef(sectorRefCounts, from.sector, -1);
+    addRef(sectorRefCounts, to.sector, 1);
+    if (isPaging) return;
+
+    // A side is stored by the chunk of the line using it
+    int line = sideLines[index];
+    if (line != -1 && map->getStore().hasLine(line))
+        markDirty(lineChunks[line]);
+}
+
+void MapStreamer::onSectorAdded(int index, const Sector& sector)
+{
+    setEntry(sectorRefCounts, index, 0);
+
+    if (!isPaging) bindId(sectorIds, sectorSlots, index, nextSectorId++);
+}
+
+void MapStreamer::onSectorRemoved(int index, const Sector& sector)
+{
+    int id = releaseId(sectorIds, &sectorSlots, index);
+    if (isPaging) return;
+
+    // Chunks that are not resident may hold the sector too
+    removedSectors.insert(id);
+    sectorOverrides.erase(id);
+    markManifestDirty();
+}
+
+void MapStreamer::onSectorChanged(int index, const Sector& from,
+                                  const Sector& to)
+{
+    if (isPaging) return;
+
+    sectorOverrides[sectorIds[index]] = to;
+    markManifestDirty();
+}
+
+void MapStreamer::onPrefabAdded(int prefab, const MapStore& store)
+{
+    // The prefabs are written back along with the manifest
+    arePrefabsDirty = true;
+    markManifestDirty();
+}
+
+void MapStreamer::onInstanceAdded(int index, const PrefabInstance& instance)
+{
+    arePrefabsDirty = true;
+    markManifestDirty();
+}
+
+void MapStreamer::onInstanceRemoved(int index, const PrefabInstance& instance)
+{
+    arePrefabsDirty = true;
+    markManifestDirty();
+}
+
+void MapStreamer::onMapLoaded(const MapStore& store)
+{
+    // The chunks would no longer match the map
+    ASSERT(isPaging);
+}
+
+glm::ivec2 MapStreamer::getCell(glm::vec2 position) const
+{
+    return glm::ivec2(std::floor(position.x / chunkSize),
+                      std::floor(position.y / chunkSize));
+}
+
+uint64_t MapStreamer::getKey(glm::ivec2 cell)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(cell.x)) << 32) |
+           static_cast<uint32_t>(cell.y);
+}
+
+std::string MapStreamer::getChunkPath(glm::ivec2 cell) const
+{
+    std::string name =
+        std::to_string(cell.x) + "_" + std::to_string(cell.y) + ".dvmap";
+    return (std::filesystem::path(directory) / name).string();
+}
+
+std::string MapStreamer::getPrefabsPath() const
+{
+    return (std::filesystem::path(directory) / PREFABS_NAME).string();
+}
+
+int MapStreamer::findChunk(glm::ivec2 cell) const
+{
+    auto it = chunkIndices.find(getKey(cell));
+    return it == chunkIndices.end() ? -1 : it->second;
+}
+
+int MapStreamer::getChunk(glm::ivec2 cell)
+{
+    int index = findChunk(cell);
+    if (index != -1) return index;
+
+    Chunk chunk;
+    chunk.cell = cell;
+    chunk.min = glm::vec2(cell) * chunkSize;
+    chunk.max = glm::vec2(cell + 1) * chunkSize;
+    chunk.lastViewed = updateCount;
+
+    index = static_cast<int>(chunks.size());
+    chunks.push_back(chunk);
+    chunkIndices[getKey(cell)] = index;
+    return index;
+}
+
+size_t MapStreamer::getChunkBytes(const Chunk& chunk)
+{
+    return chunk.vertexCount * VERTEX_BYTES + chunk.lineCount * LINE_BYTES +
+           chunk.sideCount * SIDE_BYTES + chunk.sectorCount * SECTOR_BYTES;
+}
+
+void MapStreamer::setLineChunk(int line, int chunk)
+{
+    if (lineChunks.size() > static_cast<size_t>(line) &&
+        lineChunks[line] != -1)
+        removeFromList(chunks[lineChunks[line]].lines, linePositions, line);
+
+    setEntry(lineChunks, line, chunk);
+    if (chunk != -1) addToList(chunks[chunk].lines, linePositions, line);
+}
+
+void MapStreamer::setVertexChunk(int vertex, int chunk)
+{
+    if (vertexChunks.size() > static_cast<size_t>(vertex) &&
+        vertexChunks[vertex] != -1)
+        removeFromList(chunks[vertexChunks[vertex]].vertices, vertexPositions,
+                       vertex);
+
+    setEntry(vertexChunks, vertex, chunk);
+    if (chunk != -1) addToList(chunks[chunk].vertices, vertexPositions, vertex);
+}
+
+std::vector<int> MapStreamer::getDanglingVertices(int chunk) const
+{
+    const MapStore& store = map->getStore();
+
+    std::vector<int> vertices;
+    for (int vertex : chunks[chunk].vertices)
+    {
+        if (store.getVertexRefCount(vertex) == 0) vertices.push_back(vertex);
+    }
+
+    return vertices;
+}
+
+int MapStreamer::getLineOwner(const Line& line)
+{
+    const LineVertex& startVertex = map->getStore().getVertex(line.startVertex);
+    const LineVertex& endVertex = map->getStore().getVertex(line.endVertex);
+    glm::vec2 start = {startVertex.x, startVertex.y};
+    glm::vec2 end = {endVertex.x, endVertex.y};
+
+    int owner = getChunk(getCell((start + end) * 0.5f));
+    if (chunks[owner].state == ChunkState::RESIDENT) return owner;
+
+    for (glm::vec2 position : {start, end})
+    {
+        int chunk = findChunk(getCell(position));
+        if (chunk != -1 && chunks[chunk].state == ChunkState::RESIDENT)
+            return chunk;
+    }
+
+    // The chunk is read and written by a later update
+    return owner;
+}
+
+void MapStreamer::markDirty(int chunk)
+{
+    if (chunk == -1 || chunks[chunk].isDirty) return;
+
+    bool hasEdits = isManifestDirty;
+    for (const Chunk& other : chunks) hasEdits |= other.isDirty;
+    if (!hasEdits) dirtySince = std::chrono::steady_clock::now();
+
+    chunks[chunk].isDirty = true;
+}
+
+void MapStreamer::markManifestDirty()
+{
+    if (isManifestDirty) return;
+
+    bool hasEdits = false;
+    for (const Chunk& chunk : chunks) hasEdits |= chunk.isDirty;
+    if (!hasEdits) dirtySince = std::chrono::steady_clock::now();
+
+    isManifestDirty = true;
+}
+
+void MapStreamer::requestLoad(int chunk)
+{
+    Chunk& data = chunks[chunk];
+    if (!data.hasFile)
+    {
+        data.state = ChunkState::RESIDENT;
+        return;
+    }
+
+    data.state = ChunkState::LOADING;
+    std::string path = getChunkPath(data.cell);
+    loader.submit(
+        [this, chunk, path]()
+        {
+            LoadResult result;
+            result.chunk = chunk;
+
+            BinaryMapReader reader;
+            result.isRead = reader.open(path) &&
+                            result.data.assign(reader.getArrays());
+
+            std::lock_guard<std::mutex> lock(resultMutex);
+            loadResults.push_back(std::move(result));
+        });
+}
+
+bool MapStreamer::applyResults(size_t maxLoads)
+{
+    std::vector<LoadResult> results;
+    {
+        std::lock_guard<std::mutex> lock(resultMutex);
+        size_t count = std::min(maxLoads, loadResults.size());
+        std::move(loadResults.begin(), loadResults.begin() + count,
+                  std::back_inserter(results));
+        loadResults.erase(loadResults.begin(), loadResults.begin() + count);
+
+        for (int chunk : failedWrites)
+        {
+            LOG_WARN("Failed to write chunk: %s",
+                     getChunkPath(chunks[chunk].cell).c_str());
+            if (chunks[chunk].state == ChunkState::RESIDENT) markDirty(chunk);
+        }
+        failedWrites.clear();
+
+        if (hasFailedPrefabWrite)
+        {
+            LOG_WARN("Failed to write prefabs: %s", getPrefabsPath().c_str());
+            arePrefabsDirty = true;
+            markManifestDirty();
+            hasFailedPrefabWrite = false;
+        }
+    }
+
+    bool isPaged = false;
+    for (const LoadResult& result : results)
+    {
+        Chunk& chunk = chunks[result.chunk];
+        if (!result.isRead)
+        {
+            // Never write over a file that could not be read
+            LOG_WARN("Failed to read chunk: %s",
+                     getChunkPath(chunk.cell).c_str());
+            chunk.state = ChunkState::UNLOADED;
+            chunk.isReadable = false;
+            continue;
+        }
+
+        applyLoad(result.chunk, result.data);
+        isPaged = true;
+    }
+
+    return isPaged;
+}
+
+void MapStreamer::applyLoad(int chunk, const ChunkData& data)
+{
+    isPaging = true;
+
+    for (size_t i = 0; i < data.sectors.size(); ++i)
+    {
+        int id = data.sectorIds[i];
+        if (sectorSlots.count(id) > 0 || removedSectors.count(id) > 0)
+            continue;
+
+        auto edited = sectorOverrides.find(id);
+        int slot = map->addSector(
+            edited == sectorOverrides.end() ? data.sectors[i] : edited->second);
+        bindId(sectorIds, sectorSlots, slot, id);
+    }
+
+    for (size_t i = 0; i < data.sides.size(); ++i)
+    {
+        int id = data.sideIds[i];
+        if (sideSlots.count(id) > 0) continue;
+
+        int sector = findSlot(sectorSlots, data.sides[i].sector);
+        int slot = map->addSide(Side(sector));
+        bindId(sideIds, sideSlots, slot, id);
+    }
+
+    for (size_t i = 0; i < data.vertices.size(); ++i)
+    {
+        int id = data.vertexIds[i];
+        if (vertexSlots.count(id) > 0) continue;
+
+        auto moved = vertexOverrides.find(id);
+        glm::vec2 position =
+            moved == vertexOverrides.end()
+                ? glm::vec2(data.vertices[i].x, data.vertices[i].y)
+                : moved->second;
+        int slot = map->addVertex(position.x, position.y);
+        bindId(vertexIds, vertexSlots, slot, id);
+    }
+
+    for (size_t i = 0; i < data.lines.size(); ++i)
+    {
+        const Line& line = data.lines[i];
+        int startVertex = findSlot(vertexSlots, line.startVertex);
+        int endVertex = findSlot(vertexSlots, line.endVertex);
+        ASSERT(startVertex != -1 && endVertex != -1);
+
+        int slot = map->addLine(startVertex, endVertex);
+        int front = findSlot(sideSlots, line.front);
+        int back = findSlot(sideSlots, line.back);
+        if (front != -1 || back != -1) map->setLineSides(slot, front, back);
+
+        setEntry(lineIds, slot, data.lineIds[i]);
+        setLineChunk(slot, chunk);
+    }
+
+    isPaging = false;
+
+    Chunk& loaded = chunks[chunk];
+    loaded.state = ChunkState::RESIDENT;
+    loaded.vertexCount = static_cast<uint32_t>(data.vertices.size());
+    loaded.lineCount = static_cast<uint32_t>(data.lines.size());
+    loaded.sideCount = static_cast<uint32_t>(data.sides.size());
+    loaded.sectorCount = static_cast<uint32_t>(data.sectors.size());
+}
+
+bool MapStreamer::evictOverBudget()
+{
+    bool isEvicted = false;
+    size_t bytes = getResidentBytes();
+    while (bytes > memoryBudget)
+    {
+        // Chunks in view were viewed in this update
+        int oldest = -1;
+        for (size_t i = 0; i < chunks.size(); ++i)
+        {
+            const Chunk& chunk = chunks[i];
+            if (chunk.state != ChunkState::RESIDENT ||
+                chunk.lastViewed == updateCount)
+                continue;
+
+            if (oldest == -1 || chunk.lastViewed < chunks[oldest].lastViewed)
+                oldest = static_cast<int>(i);
+        }
+
+        if (oldest == -1) break;
+
+        bytes -= getChunkBytes(chunks[oldest]);
+        evict(oldest);
+        isEvicted = true;
+    }
+
+    return isEvicted;
+}
+
+void MapStreamer::evict(int chunk)
+{
+    if (chunks[chunk].isDirty) writeChunks({chunk});
+
+    // Removing the elements shrinks the lists of the chunk, so they are
+    // copied first
+    const MapStore& store = map->getStore();
+    std::vector<int> lines = chunks[chunk].lines;
+
+    // Vertices without lines belong to the chunk holding them
+    std::vector<int> vertices = getDanglingVertices(chunk);
+
+    isPaging = true;
+
+    std::vector<int> sides;
+    for (int index : lines)
+    {
+        const Line& line = store.getLine(index);
+        vertices.push_back(line.startVertex);
+        vertices.push_back(line.endVertex);
+        if (line.front != -1) sides.push_back(line.front);
+        if (line.back != -1) sides.push_back(line.back);
+        map->removeLine(index);
+    }
+
+    // Keep the elements still used by other resident chunks
+    sortUnique(vertices);
+    for (int vertex : vertices)
+    {
+        if (store.getVertexRefCount(vertex) == 0) map->removeVertex(vertex);
+    }
+
+    sortUnique(sides);
+    std::vector<int> sectors;
+    for (int side : sides)
+    {
+        if (!store.hasSide(side) || sideRefCounts[side] > 0) continue;
+
+        int sector = store.getSide(side).sector;
+        if (sector != -1) sectors.push_back(sector);
+        map->removeSide(side);
+    }
+
+    sortUnique(sectors);
+    for (int sector : sectors)
+    {
+        if (store.hasSector(sector) && sectorRefCounts[sector] == 0)
+            map->removeSector(sector);
+    }
+
+    isPaging = false;
+
+    chunks[chunk].state = ChunkState::UNLOADED;
+}
+
+void MapStreamer::writeChunks(const std::vector<int>& indices)
+{
+    if (indices.empty()) return;
+
+    const MapStore& store = map->getStore();
+    for (int index : indices)
+    {
+        // Sort the lines so that the file does not depend on the order of
+        // the edits
+        Chunk& chunk = chunks[index];
+        std::vector<int> lines = chunk.lines;
+        std::sort(lines.begin(), lines.end());
+
+        auto data = std::make_shared<ChunkData>();
+        gatherChunk(store, lines, getDanglingVertices(index), chunk, *data);
+        chunk.hasFile = true;
+        chunk.isDirty = false;
+
+        std::string path = getChunkPath(chunk.cell);
+        uint64_t version = revision;
+        loader.submit(
+            [this, index, path, data, version]()
+            {
+                if (writer.write(data->getArrays(), path, version)) return;
+
+                std::lock_guard<std::mutex> lock(resultMutex);
+                failedWrites.push_back(index);
+            });
+    }
+}
+
+void MapStreamer::writeBack()
+{
+    ++revision;
+
+    std::vector<int> dirty;
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        if (chunks[i].isDirty && chunks[i].state == ChunkState::RESIDENT)
+            dirty.push_back(i);
+    }
+    writeChunks(dirty);
+
+    if (arePrefabsDirty)
+    {
+        auto prefabs = std::make_shared<PrefabData>();
+        prefabs->assign(map->getStore());
+        std::string prefabsPath = getPrefabsPath();
+        uint64_t version = revision;
+        loader.submit(
+            [this, prefabsPath, prefabs, version]()
+            {
+                if (writer.write(prefabs->getArrays(), prefabsPath, version))
+                    return;
+
+                std::lock_guard<std::mutex> lock(resultMutex);
+                hasFailedPrefabWrite = true;
+            });
+        arePrefabsDirty = false;
+    }
+
+    // The manifest lists the chunks written above, so it is written after
+    // them
+    std::string path =
+        (std::filesystem::path(directory) / MANIFEST_NAME).string();
+    auto bytes = std::make_shared<std::vector<char>>(encodeManifest());
+    loader.submit(
+        [this, path, bytes]()
+        {
+            if (writeFile(path, *bytes)) return;
+
+            LOG_WARN("Failed to write manifest: %s", path.c_str());
+        });
+    isManifestDirty = false;
+}
+
+void MapStreamer::gatherChunk(const MapStore& store,
+                              const std::vector<int>& lines,
+                              const std::vector<int>& danglingVertices,
+                              Chunk& chunk, ChunkData& data) const
+{
+    std::vector<int> vertices = danglingVertices;
+    std::vector<int> sides;
+    for (int index : lines)
+    {
+        const Line& line = store.getLine(index);
+        vertices.push_back(line.startVertex);
+        vertices.push_back(line.endVertex);
+        if (line.front != -1) sides.push_back(line.front);
+        if (line.back != -1) sides.push_back(line.back);
+    }
+    sortUnique(vertices);
+    sortUnique(sides);
+
+    std::vector<int> sectors;
+    for (int side : sides)
+    {
+        int sector = store.getSide(side).sector;
+        if (sector != -1) sectors.push_back(sector);
+    }
+    sortUnique(sectors);
+
+    data = ChunkData();
+    chunk.min = glm::vec2(chunk.cell) * chunkSize;
+    chunk.max = glm::vec2(chunk.cell + 1) * chunkSize;
+
+    for (int vertex : vertices)
+    {
+        const LineVertex& position = store.getVertex(vertex);
+        data.vertices.push_back(position);
+        data.vertexIds.push_back(vertexIds[vertex]);
+
+        glm::vec2 point = {position.x, position.y};
+        chunk.min = glm::min(chunk.min, point);
+        chunk.max = glm::max(chunk.max, point);
+    }
+
+    // Rewrite the references from slots to global indices
+    for (int index : lines)
+    {
+        const Line& line = store.getLine(index);
+        data.lines.push_back(
+            Line(vertexIds[line.startVertex], vertexIds[line.endVertex],
+                 line.front == -1 ? -1 : sideIds[line.front],
+                 line.back == -1 ? -1 : sideIds[line.back]));
+        data.lineIds.push_back(lineIds[index]);
+    }
+
+    for (int side : sides)
+    {
+        int sector = store.getSide(side).sector;
+        data.sides.push_back(Side(sector == -1 ? -1 : sectorIds[sector]));
+        data.sideIds.push_back(sideIds[side]);
+    }
+
+    for (int sector : sectors)
+    {
+        data.sectors.push_back(store.getSector(sector));
+        data.sectorIds.push_back(sectorIds[sector]);
+    }
+
+    chunk.vertexCount = static_cast<uint32_t>(data.vertices.size());
+    chunk.lineCount = static_cast<uint32_t>(data.lines.size());
+    chunk.sideCount = static_cast<uint32_t>(data.sides.size());
+    chunk.sectorCount = static_cast<uint32_t>(data.sectors.size());
+}
+
+bool MapStreamer::readManifest(const std::string& path)
+{
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream) return false;
+
+    ManifestHeader header;
+    stream.read(reinterpret_cast<char*>(&header), sizeof(ManifestHeader));
+    if (!stream || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header.version != VERSION || !(header.chunkSize > 0.0f) ||
+        !BinaryMapFormat::isHostLittleEndian())
+        return false;
+
+    chunkSize = header.chunkSize;
+    margin = chunkSize / 2.0f;
+    revision = header.revision;
+    nextVertexId = header.nextVertexId;
+    nextLineId = header.nextLineId;
+    nextSideId = header.nextSideId;
+    nextSectorId = header.nextSectorId;
+
+    for (uint32_t i = 0; i < header.chunkCount; ++i)
+    {
+        ChunkRecord record;
+        stream.read(reinterpret_cast<char*>(&record), sizeof(ChunkRecord));
+        if (!stream) return false;
+
+        Chunk& chunk = chunks[getChunk({record.x, record.y})];
+        chunk.min = {record.minX, record.minY};
+        chunk.max = {record.maxX, record.maxY};
+        chunk.vertexCount = record.vertexCount;
+        chunk.lineCount = record.lineCount;
+        chunk.sideCount = record.sideCount;
+        chunk.sectorCount = record.sectorCount;
+        chunk.state = ChunkState::UNLOADED;
+        chunk.hasFile = true;
+    }
+
+    for (uint32_t i = 0; i < header.vertexOverrideCount; ++i)
+    {
+        VertexOverride record;
+        stream.read(reinterpret_cast<char*>(&record), sizeof(VertexOverride));
+        if (!stream) return false;
+
+        vertexOverrides[record.vertex] = {record.x, record.y};
+    }
+
+    for (uint32_t i = 0; i < header.sectorOverrideCount; ++i)
+    {
+        SectorOverride record;
+        stream.read(reinterpret_cast<char*>(&record), sizeof(SectorOverride));
+        if (!stream) return false;
+
+        sectorOverrides[record.sector] = record.value;
+    }
+
+    for (uint32_t i = 0; i < header.removedSectorCount; ++i)
+    {
+        int32_t sector;
+        stream.read(reinterpret_cast<char*>(&sector), sizeof(int32_t));
+        if (!stream) return false;
+
+        removedSectors.insert(sector);
+    }
+
+    return true;
+}
+
+std::vector<char> MapStreamer::encodeManifest() const
+{
+    std::vector<ChunkRecord> records;
+    for (const Chunk& chunk : chunks)
+    {
+        // Chunks without files have nothing to read
+        if (!chunk.hasFile) continue;
+
+        ChunkRecord record = {};
+        record.x = chunk.cell.x;
+        record.y = chunk.cell.y;
+        record.minX = chunk.min.x;
+        record.minY = chunk.min.y;
+        record.maxX = chunk.max.x;
+        record.maxY = chunk.max.y;
+        record.vertexCount = chunk.vertexCount;
+        record.lineCount = chunk.lineCount;
+        record.sideCount = chunk.sideCount;
+        record.sectorCount = chunk.sectorCount;
+        records.push_back(record);
+    }
+
+    ManifestHeader header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.revision = revision;
+    header.chunkSize = chunkSize;
+    header.chunkCount = static_cast<uint32_t>(records.size());
+    header.nextVertexId = nextVertexId;
+    header.nextLineId = nextLineId;
+    header.nextSideId = nextSideId;
+    header.nextSectorId = nextSectorId;
+    header.vertexOverrideCount = static_cast<uint32_t>(vertexOverrides.size());
+    header.sectorOverrideCount = static_cast<uint32_t>(sectorOverrides.size());
+    header.removedSectorCount = static_cast<uint32_t>(removedSectors.size());
+
+    std::vector<char> bytes;
+
+    // Appends the bytes of a record
+    auto append = [&bytes](const void* data, size_t size)
+    {
+        const char* begin = static_cast<const char*>(data);
+        bytes.insert(bytes.end(), begin, begin + size);
+    };
+
+    append(&header, sizeof(ManifestHeader));
+    append(records.data(), records.size() * sizeof(ChunkRecord));
+
+    for (const auto& [vertex, position] : vertexOverrides)
+    {
+        VertexOverride record = {vertex, position.x, position.y};
+        append(&record, sizeof(VertexOverride));
+    }
+
+    for (const auto& [sector, value] : sectorOverrides)
+    {
+        SectorOverride record = {sector, value};
+        append(&record, sizeof(SectorOverride));
+    }
+
+    for (int sector : removedSectors)
+    {
+        int32_t record = sector;
+        append(&record, sizeof(int32_t));
+    }
+
+    return bytes;
+}
+
+bool MapStreamer::writeFile(const std::string& path,
+                            const std::vector<char>& bytes)
+{
+    std::string tempPath = path + ".tmp";
+    std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+    stream.write(bytes.data(), bytes.size());
+    stream.close();
+    if (!stream)
+    {
+        LOG_WARN("Failed to write file: %s", tempPath.c_str());
+        return false;
+    }
+
+    // Replace the destination only once the new file is complete
+    std::error_code error;
+    std::filesystem::rename(tempPath, path, error);
+    if (error)
+    {
+        LOG_WARN("Failed to replace file: %s", path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+void MapStreamer::reset()
+{
+    chunks.clear();
+    chunkIndices.clear();
+    updateCount = 0;
+    revision = 0;
+    isManifestDirty = false;
+    arePrefabsDirty = false;
+    nextVertexId = nextLineId = nextSideId = nextSectorId = 0;
+    vertexIds.clear();
+    lineIds.clear();
+    sideIds.clear();
+    sectorIds.clear();
+    vertexSlots.clear();
+    sideSlots.clear();
+    sectorSlots.clear();
+    lineChunks.clear();
+    linePositions.clear();
+    vertexChunks.clear();
+    vertexPositions.clear();
+    sideLines.clear();
+    sideRefCounts.clear();
+    sectorRefCounts.clear();
+    vertexOverrides.clear();
+    sectorOverrides.clear();
+    removedSectors.clear();
+
+    std::lock_guard<std::mutex> lock(resultMutex);
+    loadResults.clear();
+    failedWrites.clear();
+    hasFailedPrefabWrite = false;
+}
\ No newline at end of file
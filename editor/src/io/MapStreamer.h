@@ -0,0 +1,769 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "../map/MapArrays.h"
+#include "../map/MapListener.h"
+#include "../map/MapStore.h"
+#include "../utils/ThreadPool.h"
+#include "BinaryMapWriter.h"
+
+class Map;
+
+/**
+ * @brief A class that keeps a map too large for memory on disk as square
+ * chunks of world space, and pages the chunks around the view in and out of a
+ * Map.
+ *
+ * A chunked map is a directory holding a manifest and one binary map file per
+ * chunk. Each line belongs to the chunk holding its midpoint, and the file of
+ * the chunk holds its lines along with their vertices, sides and sectors, so
+ * vertices and sectors shared by lines of different chunks are stored by each
+ * of them. Vertices without lines belong to the chunk holding them. Every
+ * element keeps a global index across the whole map, which the files
+ * preserve, while the Map holds only the resident chunks under indices of its
+ * own.
+ *
+ * Chunks whose bounds overlap the view, grown by a margin, are read on a
+ * loader thread and added to the map a few per update. Once the estimated
+ * memory of the resident chunks passes the budget, the chunks out of view are
+ * evicted, least recently viewed first. Edits mark the chunks they touch as
+ * dirty, and dirty chunks are gathered on the main thread and written on the
+ * loader thread once the write-back interval has elapsed or when they are
+ * evicted. The thread runs its jobs in order, so a chunk read after being
+ * evicted sees its last write. Since chunks that are not resident may hold
+ * copies of moved vertices and edited sectors, the latest values of those are
+ * kept in the manifest and override the stored copies as chunks are read.
+ *
+ * Paging edits the map through its usual methods, so listeners such as the
+ * render cache follow it. Loading a chunk only adds elements and evicting one
+ * only removes its own, so the other elements keep their indices, but a slot
+ * freed by an eviction or an edit may be reused by the next chunk. Recorded
+ * histories and selections must drop what refers to the slots paging touched.
+ *
+ * The prefabs of the map and their instances are never paged: they stay in
+ * the map while it is open, and are kept in a binary map file of their own
+ * that is written back along with the manifest.
+ */
+class MapStreamer : public MapListener
+{
+public:
+    // The default side length of a chunk in world units
+    static constexpr float DEFAULT_CHUNK_SIZE = 4096.0f;
+    // The default memory budget of the resident chunks in bytes
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = 512 * 1024 * 1024;
+    // The longest time edits wait to be written back
+    static constexpr std::chrono::seconds WRITE_BACK_INTERVAL{5};
+    // The most chunks added to the map per update, which bounds the time
+    // an update spends paging
+    static constexpr int MAX_LOADS_PER_UPDATE = 2;
+
+    /**
+     * @brief Constructs a new MapStreamer object with no chunked map open.
+     */
+    MapStreamer();
+
+    /**
+     * @brief Destroys the MapStreamer object, writing back the edits of the
+     * open chunked map.
+     */
+    ~MapStreamer();
+
+    MapStreamer(const MapStreamer&) = delete;
+    MapStreamer& operator=(const MapStreamer&) = delete;
+
+    /**
+     * @brief Splits the elements of a store into chunks and writes them as a
+     * chunked map.
+     *
+     * The global indices of the elements are their slot indices in the
+     * store.
+     *
+     * @param store The elements of the map.
+     * @param directory The directory to write the chunked map to, which is
+     * created if needed.
+     * @param chunkSize The side length of a chunk in world units. Defaults to
+     * DEFAULT_CHUNK_SIZE.
+     * @return True if every chunk and the manifest were written, false
+     * otherwise.
+     */
+    static bool build(const MapStore& store, const std::string& directory,
+                      float chunkSize = DEFAULT_CHUNK_SIZE);
+
+    /**
+     * @brief Opens a chunked map, closing the previous one, and starts
+     * paging it into the specified map.
+     *
+     * The map is emptied, and its chunks are only added by later updates.
+     * The streamer adds itself to the listeners of the map.
+     *
+     * @param map The map to page the chunks into.
+     * @param directory The directory of the chunked map.
+     * @return True if the manifest was read, false otherwise, in which case
+     * the map is left as it is.
+     */
+    bool open(Map& map, const std::string& directory);
+
+    /**
+     * @brief Writes back every edit and stops paging the chunked map.
+     *
+     * Chunks that own edits but were never read are read first, so that
+     * their files keep their elements. The map keeps its elements, and the
+     * streamer removes itself from its listeners.
+     *
+     * @return True if every edit was written, false otherwise.
+     */
+    bool close();
+
+    /**
+     * @brief Checks if a chunked map is open.
+     *
+     * @return True if a chunked map is open, false otherwise.
+     */
+    inline bool isOpen() const { return map != nullptr; }
+
+    /**
+     * @brief Pages chunks in and out of the map for the current view, and
+     * writes back the edits that are due.
+     *
+     * This method is meant to be called once per frame, outside of any
+     * recorded edit.
+     *
+     * @param viewMin The minimum corner of the view in world space.
+     * @param viewMax The maximum corner of the view in world space.
+     * @return True if elements were added to or removed from the map, false
+     * otherwise.
+     */
+    bool update(glm::vec2 viewMin, glm::vec2 viewMax);
+
+    /**
+     * @brief Writes the dirty resident chunks and the manifest, and waits
+     * for the writes to finish.
+     *
+     * Edits owned by chunks that are still being read are written by a later
+     * update, once the chunks are resident.
+     *
+     * @return True if every write succeeded, false otherwise.
+     */
+    bool flush();
+
+    /**
+     * @brief Gets the memory budget of the resident chunks.
+     *
+     * @return The budget in bytes.
+     */
+    inline size_t getMemoryBudget() const { return memoryBudget; }
+
+    /**
+     * @brief Sets the memory budget of the resident chunks.
+     *
+     * Chunks in view are never evicted, so the budget can be exceeded when
+     * the view covers more than it allows.
+     *
+     * @param bytes The budget in bytes.
+     */
+    inline void setMemoryBudget(size_t bytes) { memoryBudget = bytes; }
+
+    /**
+     * @brief Gets the distance the view is grown by when choosing the chunks
+     * to page in.
+     *
+     * @return The margin in world units.
+     */
+    inline float getMargin() const { return margin; }
+
+    /**
+     * @brief Sets the distance the view is grown by when choosing the chunks
+     * to page in.
+     *
+     * @param margin The margin in world units.
+     */
+    inline void setMargin(float margin) { this->margin = margin; }
+
+    /**
+     * @brief Gets the estimated memory used by the resident chunks.
+     *
+     * @return The estimate in bytes.
+     */
+    size_t getResidentBytes() const;
+
+    /**
+     * @brief Gets the number of resident chunks.
+     *
+     * @return The number of resident chunks.
+     */
+    int getResidentChunkCount() const;
+
+    /**
+     * @brief Gets the number of chunks of the open chunked map.
+     *
+     * @return The number of chunks.
+     */
+    inline int getChunkCount() const { return static_cast<int>(chunks.size()); }
+
+    void onVertexAdded(int vertex, glm::vec2 position) override;
+
+    void onVertexRemoved(int vertex, glm::vec2 position) override;
+
+    void onVertexMoved(int vertex, glm::vec2 from, glm::vec2 to) override;
+
+    void onLineAdded(int index, const Line& line) override;
+
+    void onLineRemoved(int index, const Line& line) override;
+
+    void onLineChanged(int index, const Line& from, const Line& to) override;
+
+    void onSideAdded(int index, const Side& side) override;
+
+    void onSideRemoved(int index, const Side& side) override;
+
+    void onSideChanged(int index, const Side& from, const Side& to) override;
+
+    void onSectorAdded(int index, const Sector& sector) override;
+
+    void onSectorRemoved(int index, const Sector& sector) override;
+
+    void onSectorChanged(int index, const Sector& from,
+                         const Sector& to) override;
+
+    void onPrefabAdded(int prefab, const MapStore& store) override;
+
+    void onInstanceAdded(int index, const PrefabInstance& instance) override;
+
+    void onInstanceRemoved(int index,
+                           const PrefabInstance& instance) override;
+
+    void onMapLoaded(const MapStore& store) override;
+
+private:
+    // The magic bytes at the start of every manifest
+    static constexpr char MAGIC[4] = {'D', 'V', 'C', 'K'};
+    // The current version of the manifest format
+    static constexpr uint16_t VERSION = 1;
+    // The name of the manifest in the directory of a chunked map
+    static constexpr const char* MANIFEST_NAME = "manifest";
+    // The name of the file holding the prefabs and instances in the
+    // directory of a chunked map
+    static constexpr const char* PREFABS_NAME = "prefabs.dvmap";
+    // The estimated memory of a resident vertex in bytes, which covers the
+    // store, the topology, the spatial grid, the render cache and the tables
+    // of the streamer
+    static constexpr size_t VERTEX_BYTES = 96;
+    // The estimated memory of a resident line in bytes
+    static constexpr size_t LINE_BYTES = 160;
+    // The estimated memory of a resident side in bytes
+    static constexpr size_t SIDE_BYTES = 32;
+    // The estimated memory of a resident sector in bytes
+    static constexpr size_t SECTOR_BYTES = 48;
+
+    /**
+     * @brief An enum class representing whether a chunk is in the map.
+     */
+    enum class ChunkState
+    {
+        UNLOADED,
+        LOADING,
+        RESIDENT
+    };
+
+    /**
+     * @brief A struct representing a chunk of the map.
+     */
+    struct Chunk
+    {
+        // The cell of the chunk, in chunk sizes from the origin
+        glm::ivec2 cell;
+        // The minimum corner of the cell and the elements of the chunk
+        glm::vec2 min;
+        // The maximum corner of the cell and the elements of the chunk
+        glm::vec2 max;
+        // The number of vertices in the file of the chunk
+        uint32_t vertexCount = 0;
+        // The number of lines in the file of the chunk
+        uint32_t lineCount = 0;
+        // The number of sides in the file of the chunk
+        uint32_t sideCount = 0;
+        // The number of sectors in the file of the chunk
+        uint32_t sectorCount = 0;
+        // Whether the chunk is in the map
+        ChunkState state = ChunkState::RESIDENT;
+        // Whether the chunk has a file
+        bool hasFile = false;
+        // Whether the file of the chunk could be read when last tried
+        bool isReadable = true;
+        // Whether the chunk has edits that were not written
+        bool isDirty = false;
+        // The update in which the chunk was last in view
+        uint64_t lastViewed = 0;
+        // The slots of the resident lines the chunk owns
+        std::vector<int> lines;
+        // The slots of the resident vertices in the cell of the chunk
+        std::vector<int> vertices;
+    };
+
+    /**
+     * @brief A struct holding the elements of a chunk under their global
+     * indices, as read from or written to its file.
+     */
+    struct ChunkData
+    {
+        // The positions of the vertices
+        std::vector<LineVertex> vertices;
+        // The lines
+        std::vector<Line> lines;
+        // The sides
+        std::vector<Side> sides;
+        // The sectors
+        std::vector<Sector> sectors;
+        // The global index of each vertex
+        std::vector<uint32_t> vertexIds;
+        // The global index of each line
+        std::vector<uint32_t> lineIds;
+        // The global index of each side
+        std::vector<uint32_t> sideIds;
+        // The global index of each sector
+        std::vector<uint32_t> sectorIds;
+
+        /**
+         * @brief Gets the arrays of the elements.
+         *
+         * @return The arrays, which point into the vectors.
+         */
+        MapArrays getArrays() const;
+
+        /**
+         * @brief Copies the elements of arrays with index arrays.
+         *
+         * @param arrays The arrays.
+         * @return True if the arrays have index arrays or no elements, false
+         * otherwise.
+         */
+        bool assign(const MapArrays& arrays);
+    };
+
+    /**
+     * @brief A struct holding copies of the prefabs and instances of the map,
+     * to be written by the loader thread.
+     */
+    struct PrefabData
+    {
+        // The geometry of each prefab, which is shared with the map
+        std::vector<std::shared_ptr<const MapFragment>> prefabs;
+        // The arrays of each prefab, which point into the geometry
+        std::vector<MapArrays> prefabArrays;
+        // The instances of the prefabs
+        std::vector<PrefabInstance> instances;
+        // The index of each instance
+        std::vector<uint32_t> instanceIds;
+
+        /**
+         * @brief Copies the prefabs and instances of a store.
+         *
+         * @param store The store.
+         */
+        void assign(const MapStore& store);
+
+        /**
+         * @brief Gets the arrays of the prefabs and instances.
+         *
+         * @return The arrays, which point into the vectors.
+         */
+        MapArrays getArrays() const;
+    };
+
+    /**
+     * @brief A struct representing a chunk read by the loader thread.
+     */
+    struct LoadResult
+    {
+        // The index of the chunk
+        int chunk;
+        // Whether the file of the chunk was read
+        bool isRead;
+        // The elements of the chunk
+        ChunkData data;
+    };
+
+    /**
+     * @brief A struct representing the header of a manifest.
+     */
+    struct ManifestHeader
+    {
+        // The magic bytes
+        char magic[4];
+        // The version of the format
+        uint16_t version;
+        // Unused, to align the fields that follow
+        uint16_t reserved;
+        // The number of write-backs made to the chunked map
+        uint64_t revision;
+        // The side length of a chunk in world units
+        float chunkSize;
+        // The number of chunk records
+        uint32_t chunkCount;
+        // The global index given to the next new vertex
+        int32_t nextVertexId;
+        // The global index given to the next new line
+        int32_t nextLineId;
+        // The global index given to the next new side
+        int32_t nextSideId;
+        // The global index given to the next new sector
+        int32_t nextSectorId;
+        // The number of moved vertex records
+        uint32_t vertexOverrideCount;
+        // The number of edited sector records
+        uint32_t sectorOverrideCount;
+        // The number of removed sector records
+        uint32_t removedSectorCount;
+    };
+
+    /**
+     * @brief A struct representing a chunk in a manifest.
+     */
+    struct ChunkRecord
+    {
+        // The cell of the chunk
+        int32_t x, y;
+        // The minimum corner of the chunk
+        float minX, minY;
+        // The maximum corner of the chunk
+        float maxX, maxY;
+        // The number of elements in the file of the chunk
+        uint32_t vertexCount, lineCount, sideCount, sectorCount;
+    };
+
+    /**
+     * @brief A struct representing the latest position of a moved vertex in
+     * a manifest.
+     */
+    struct VertexOverride
+    {
+        // The global index of the vertex
+        int32_t vertex;
+        // The position of the vertex
+        float x, y;
+    };
+
+    /**
+     * @brief A struct representing the latest value of an edited sector in a
+     * manifest.
+     */
+    struct SectorOverride
+    {
+        // The global index of the sector
+        int32_t sector;
+        // The value of the sector
+        Sector value;
+    };
+
+    // The map the chunks are paged into, or null if no chunked map is open
+    Map* map = nullptr;
+    // The directory of the open chunked map
+    std::string directory;
+    // The side length of a chunk in world units
+    float chunkSize = DEFAULT_CHUNK_SIZE;
+    // The distance the view is grown by when choosing the chunks to page in
+    float margin = DEFAULT_CHUNK_SIZE / 2.0f;
+    // The memory budget of the resident chunks in bytes
+    size_t memoryBudget = DEFAULT_MEMORY_BUDGET;
+    // The chunks of the map
+    std::vector<Chunk> chunks;
+    // The index of each chunk, by the key of its cell
+    std::unordered_map<uint64_t, int> chunkIndices;
+    // The number of updates made since the map was opened
+    uint64_t updateCount = 0;
+    // The number of write-backs made to the chunked map
+    uint64_t revision = 0;
+    // Whether the manifest has changes that were not written
+    bool isManifestDirty = false;
+    // Whether the prefabs or instances have changes that were not written
+    bool arePrefabsDirty = false;
+    // The time the oldest unwritten edit was made
+    std::chrono::steady_clock::time_point dirtySince;
+    // Whether the streamer is adding or removing chunks, so that the edits
+    // it makes are not treated as the user's
+    bool isPaging = false;
+
+    // The global index given to the next new vertex
+    int nextVertexId = 0;
+    // The global index given to the next new line
+    int nextLineId = 0;
+    // The global index given to the next new side
+    int nextSideId = 0;
+    // The global index given to the next new sector
+    int nextSectorId = 0;
+    // The global index of each vertex slot of the map, or -1 if it is free
+    std::vector<int> vertexIds;
+    // The global index of each line slot of the map, or -1 if it is free
+    std::vector<int> lineIds;
+    // The global index of each side slot of the map, or -1 if it is free
+    std::vector<int> sideIds;
+    // The global index of each sector slot of the map, or -1 if it is free
+    std::vector<int> sectorIds;
+    // The slot of each resident vertex, by global index
+    std::unordered_map<int, int> vertexSlots;
+    // The slot of each resident side, by global index
+    std::unordered_map<int, int> sideSlots;
+    // The slot of each resident sector, by global index
+    std::unordered_map<int, int> sectorSlots;
+    // The chunk owning each line slot of the map, or -1 if it is free
+    std::vector<int> lineChunks;
+    // The position of each line slot of the map in the list of its chunk
+    std::vector<int> linePositions;
+    // The chunk whose cell holds each vertex slot of the map, or -1 if it is
+    // free
+    std::vector<int> vertexChunks;
+    // The position of each vertex slot of the map in the list of its chunk
+    std::vector<int> vertexPositions;
+    // The last line to use each side slot of the map
+    std::vector<int> sideLines;
+    // The number of resident lines using each side slot of the map
+    std::vector<int> sideRefCounts;
+    // The number of resident sides using each sector slot of the map
+    std::vector<int> sectorRefCounts;
+    // The latest position of each vertex moved since the map was built
+    std::unordered_map<int, glm::vec2> vertexOverrides;
+    // The latest value of each sector edited since the map was built
+    std::unordered_map<int, Sector> sectorOverrides;
+    // The global indices of the sectors removed since the map was built
+    std::unordered_set<int> removedSectors;
+
+    // The writer used by the loader thread
+    BinaryMapWriter writer;
+    // The mutex guarding the results of the loader thread
+    std::mutex resultMutex;
+    // The chunks read by the loader thread and not yet added to the map
+    std::vector<LoadResult> loadResults;
+    // The chunks the loader thread failed to write
+    std::vector<int> failedWrites;
+    // Whether the loader thread failed to write the prefabs
+    bool hasFailedPrefabWrite = false;
+    // The thread reading and writing chunks, declared last so that it stops
+    // before the members it uses are destroyed
+    ThreadPool loader;
+
+    /**
+     * @brief Gets the cell holding a position.
+     *
+     * @param position The position.
+     * @return The cell.
+     */
+    glm::ivec2 getCell(glm::vec2 position) const;
+
+    /**
+     * @brief Gets the key of a cell in the chunk table.
+     *
+     * @param cell The cell.
+     * @return The key.
+     */
+    static uint64_t getKey(glm::ivec2 cell);
+
+    /**
+     * @brief Gets the path of the file of a chunk.
+     *
+     * @param cell The cell of the chunk.
+     * @return The path.
+     */
+    std::string getChunkPath(glm::ivec2 cell) const;
+
+    /**
+     * @brief Gets the path of the file holding the prefabs and instances.
+     *
+     * @return The path.
+     */
+    std::string getPrefabsPath() const;
+
+    /**
+     * @brief Finds the chunk of a cell.
+     *
+     * @param cell The cell.
+     * @return The index of the chunk, or -1 if the cell has none.
+     */
+    int findChunk(glm::ivec2 cell) const;
+
+    /**
+     * @brief Gets the chunk of a cell, adding an empty resident chunk if the
+     * cell has none.
+     *
+     * @param cell The cell.
+     * @return The index of the chunk.
+     */
+    int getChunk(glm::ivec2 cell);
+
+    /**
+     * @brief Gets the estimated memory of a chunk once resident.
+     *
+     * @param chunk The chunk.
+     * @return The estimate in bytes.
+     */
+    static size_t getChunkBytes(const Chunk& chunk);
+
+    /**
+     * @brief Gets the chunk a new line belongs to.
+     *
+     * This is the chunk holding the midpoint of the line, unless that chunk
+     * is not resident, in which case a resident chunk holding one of its
+     * vertices is preferred, so that the line can be written without
+     * reading the chunk first.
+     *
+     * @param line The line.
+     * @return The index of the chunk.
+     */
+    int getLineOwner(const Line& line);
+
+    /**
+     * @brief Sets the chunk owning a line slot, moving the slot from the
+     * list of its previous chunk.
+     *
+     * @param line The slot of the line.
+     * @param chunk The index of the chunk, or -1 if the slot was freed.
+     */
+    void setLineChunk(int line, int chunk);
+
+    /**
+     * @brief Sets the chunk whose cell holds a vertex slot, moving the slot
+     * from the list of its previous chunk.
+     *
+     * @param vertex The slot of the vertex.
+     * @param chunk The index of the chunk, or -1 if the slot was freed.
+     */
+    void setVertexChunk(int vertex, int chunk);
+
+    /**
+     * @brief Gets the resident vertices without lines that a chunk holds.
+     *
+     * @param chunk The index of the chunk.
+     * @return The slots of the vertices.
+     */
+    std::vector<int> getDanglingVertices(int chunk) const;
+
+    /**
+     * @brief Marks a chunk as having edits that were not written.
+     *
+     * @param chunk The index of the chunk, or -1 for none.
+     */
+    void markDirty(int chunk);
+
+    /**
+     * @brief Marks the manifest as having changes that were not written.
+     */
+    void markManifestDirty();
+
+    /**
+     * @brief Reads a chunk on the loader thread, or makes it resident at
+     * once if it has no file.
+     *
+     * @param chunk The index of the chunk.
+     */
+    void requestLoad(int chunk);
+
+    /**
+     * @brief Adds the chunks read by the loader thread to the map, and marks
+     * the chunks it failed to write as dirty again.
+     *
+     * @param maxLoads The most chunks to add.
+     * @return True if elements were added to the map, false otherwise.
+     */
+    bool applyResults(size_t maxLoads);
+
+    /**
+     * @brief Adds the elements of a chunk to the map, skipping those that
+     * are already resident through other chunks.
+     *
+     * @param chunk The index of the chunk.
+     * @param data The elements of the chunk.
+     */
+    void applyLoad(int chunk, const ChunkData& data);
+
+    /**
+     * @brief Evicts the chunks out of view, least recently viewed first,
+     * until the resident chunks fit the memory budget.
+     *
+     * @return True if elements were removed from the map, false otherwise.
+     */
+    bool evictOverBudget();
+
+    /**
+     * @brief Writes a chunk if it is dirty, then removes its elements from
+     * the map, except those still used by other resident chunks.
+     *
+     * @param chunk The index of the chunk.
+     */
+    void evict(int chunk);
+
+    /**
+     * @brief Gathers resident chunks on the main thread and writes them on
+     * the loader thread.
+     *
+     * Gathering a chunk takes time proportional to its own elements, while
+     * encoding and writing its file are left to the loader thread.
+     *
+     * @param indices The indices of the chunks.
+     */
+    void writeChunks(const std::vector<int>& indices);
+
+    /**
+     * @brief Writes every dirty resident chunk, the prefabs if they changed
+     * and the manifest.
+     */
+    void writeBack();
+
+    /**
+     * @brief Gathers the elements of a chunk under their global indices.
+     *
+     * The vertices, sides and sectors are those used by the lines, along
+     * with the vertices without lines. The bounds and counts of the chunk
+     * are updated to match.
+     *
+     * @param store The elements of the map.
+     * @param lines The slots of the lines of the chunk.
+     * @param danglingVertices The slots of the vertices without lines that
+     * the chunk holds.
+     * @param chunk The chunk.
+     * @param data The gathered elements.
+     */
+    void gatherChunk(const MapStore& store, const std::vector<int>& lines,
+                     const std::vector<int>& danglingVertices, Chunk& chunk,
+                     ChunkData& data) const;
+
+    /**
+     * @brief Reads the manifest of a chunked map.
+     *
+     * @param path The path of the manifest.
+     * @return True if the manifest is valid, false otherwise.
+     */
+    bool readManifest(const std::string& path);
+
+    /**
+     * @brief Encodes the manifest of the open chunked map.
+     *
+     * @return The bytes of the manifest.
+     */
+    std::vector<char> encodeManifest() const;
+
+    /**
+     * @brief Writes bytes to a file next to its destination and moves it
+     * into place once complete.
+     *
+     * @param path The path of the file.
+     * @param bytes The bytes.
+     * @return True if the file was written, false otherwise.
+     */
+    static bool writeFile(const std::string& path,
+                          const std::vector<char>& bytes);
+
+    /**
+     * @brief Forgets the chunks and the global indices of the open chunked
+     * map.
+     */
+    void reset();
+};
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "../utils/macros.h"
+
+MappedFile::~MappedFile() { close(); }
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path)
+{
+    close();
+
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                              nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        LOG_WARN("Failed to open file: %s", path.c_str());
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        LOG_WARN("Failed to map empty file: %s", path.c_str());
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping =
+        CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)
+                         : nullptr;
+    if (!view)
+    {
+        LOG_WARN("Failed to map file: %s", path.c_str());
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    fileHandle = file;
+    mappingHandle = mapping;
+    data = static_cast<const unsigned char*>(view);
+    size = static_cast<size_t>(fileSize.QuadPart);
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (data) UnmapViewOfFile(data);
+    if (mappingHandle) CloseHandle(mappingHandle);
+    if (fileHandle) CloseHandle(fileHandle);
+
+    data = nullptr;
+    size = 0;
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path)
+{
+    close();
+
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file == -1)
+    {
+        LOG_WARN("Failed to open file: %s", path.c_str());
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(file, &status) == -1 || status.st_size == 0)
+    {
+        LOG_WARN("Failed to map empty file: %s", path.c_str());
+        ::close(file);
+        return false;
+    }
+
+    void* view = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+
+    // The mapping keeps its own reference to the file
+    ::close(file);
+
+    if (view == MAP_FAILED)
+    {
+        LOG_WARN("Failed to map file: %s", path.c_str());
+        return false;
+    }
+
+    // The file is read front to back
+    madvise(view, status.st_size, MADV_SEQUENTIAL);
+
+    data = static_cast<const unsigned char*>(view);
+    size = static_cast<size_t>(status.st_size);
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (data) munmap(const_cast<unsigned char*>(data), size);
+
+    data = nullptr;
+    size = 0;
+}
+
+#endif
\ No newline at end of file
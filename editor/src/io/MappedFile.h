@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief A class representing a read-only memory mapping of a file.
+ *
+ * The contents of the file are mapped into the address space of the process,
+ * so they can be read in place without copying them into a buffer first. The
+ * mapping is released when the object is destroyed or closed.
+ */
+class MappedFile
+{
+public:
+    /**
+     * @brief Constructs a new MappedFile object with no file mapped.
+     */
+    MappedFile() = default;
+
+    /**
+     * @brief Destroys the MappedFile object and releases the mapping.
+     */
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Maps the specified file, releasing the previous mapping.
+     *
+     * @param path The path of the file.
+     * @return True if the file was mapped, false otherwise.
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Releases the mapping.
+     */
+    void close();
+
+    /**
+     * @brief Checks if a file is mapped.
+     *
+     * @return True if a file is mapped, false otherwise.
+     */
+    inline bool isOpen() const { return data != nullptr; }
+
+    /**
+     * @brief Gets the contents of the file.
+     *
+     * The contents are aligned to at least a page boundary.
+     *
+     * @return The first byte of the file.
+     */
+    inline const unsigned char* getData() const { return data; }
+
+    /**
+     * @brief Gets the size of the file.
+     *
+     * @return The size of the file in bytes.
+     */
+    inline size_t getSize() const { return size; }
+
+private:
+    // The mapped contents of the file
+    const unsigned char* data = nullptr;
+    // The size of the file in bytes
+    size_t size = 0;
+#ifdef _WIN32
+    // The handle of the file
+    void* fileHandle = nullptr;
+    // The handle of the file mapping
+    void* mappingHandle = nullptr;
+#endif
+};
\ No newline at end of file
@@ -0,0 +1,494 @@
+#include "UdmfParser.h"
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define UDMF_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// The fields of each element that must be present
+static constexpr uint32_t VERTEX_REQUIRED = 0b11;
+static constexpr uint32_t LINEDEF_REQUIRED = 0b11;
+
+/**
+ * @brief Checks if a character starts a token that affects block structure.
+ *
+ * @param c The character.
+ * @return True if the character is a brace, a quote or a slash.
+ */
+static inline bool isStructural(char c)
+{
+    return c == '{' || c == '}' || c == '"' || c == '/';
+}
+
+/**
+ * @brief Checks if a character can be part of an identifier.
+ *
+ * Unlike std::isalnum, this does not consult the locale.
+ *
+ * @param c The character.
+ * @return True if the character is an ASCII letter, digit or underscore.
+ */
+static inline bool isIdentifierChar(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           (c >= '0' && c <= '9') || c == '_';
+}
+
+/**
+ * @brief Gets the index of the lowest set bit of a non-zero mask.
+ *
+ * @param mask The mask.
+ * @return The index of the lowest set bit.
+ */
+static inline int countTrailingZeros(uint32_t mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+/**
+ * @brief Finds the next structural character.
+ *
+ * @param pos The first character to test.
+ * @param end One past the last character to test.
+ * @return The structural character, or end if there is none.
+ */
+static const char* findStructural(const char* pos, const char* end)
+{
+#ifdef UDMF_USE_SSE2
+    const __m128i openBrace = _mm_set1_epi8('{');
+    const __m128i closeBrace = _mm_set1_epi8('}');
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i slash = _mm_set1_epi8('/');
+
+    while (end - pos >= 16)
+    {
+        __m128i chunk =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+        __m128i hits = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, openBrace),
+                         _mm_cmpeq_epi8(chunk, closeBrace)),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                         _mm_cmpeq_epi8(chunk, slash)));
+
+        uint32_t mask = _mm_movemask_epi8(hits);
+        if (mask) return pos + countTrailingZeros(mask);
+
+        pos += 16;
+    }
+#endif
+
+    while (pos < end && !isStructural(*pos)) ++pos;
+    return pos;
+}
+
+/**
+ * @brief Gets the offset of a position from the start of a text.
+ *
+ * @param begin The first character of the text.
+ * @param pos The position.
+ * @return The offset of the position.
+ */
+static inline size_t offset(const char* begin, const char* pos)
+{
+    return static_cast<size_t>(pos - begin);
+}
+
+/**
+ * @brief Skips a quoted string.
+ *
+ * @param pos The opening quote.
+ * @param end One past the last character of the text.
+ * @return One past the closing quote, or nullptr if the string is not closed.
+ */
+static const char* skipString(const char* pos, const char* end)
+{
+    for (++pos; pos < end; ++pos)
+    {
+        if (*pos == '\\')
+            ++pos;
+        else if (*pos == '"')
+            return pos + 1;
+    }
+
+    return nullptr;
+}
+
+/**
+ * @brief Skips a comment.
+ *
+ * @param pos The slash that may start the comment.
+ * @param end One past the last character of the text.
+ * @return One past the comment, one past the slash if it does not start a
+ * comment, or nullptr if a block comment is not closed.
+ */
+static const char* skipComment(const char* pos, const char* end)
+{
+    if (end - pos < 2) return pos + 1;
+
+    if (pos[1] == '/')
+    {
+        const void* newline = std::memchr(pos, '\n', end - pos);
+        return newline ? static_cast<const char*>(newline) + 1 : end;
+    }
+
+    if (pos[1] == '*')
+    {
+        for (pos += 2; end - pos >= 2; ++pos)
+            if (pos[0] == '*' && pos[1] == '/') return pos + 2;
+
+        return nullptr;
+    }
+
+    return pos + 1;
+}
+
+bool UdmfParser::parse(MapData& data)
+{
+    while (true)
+    {
+        if (!skipWhitespace()) return false;
+        if (pos == end) return true;
+
+        std::string_view name;
+        if (!readIdentifier(name)) return false;
+        if (!skipWhitespace()) return false;
+
+        if (pos < end && *pos == '{')
+        {
+            ++pos;
+            if (!parseBlock(getBlockType(name), data)) return false;
+        }
+        else if (pos < end && *pos == '=')
+        {
+            // Global assignments, such as the namespace, are not used
+            ++pos;
+            if (!skipWhitespace() || !skipValue() || !expect(';'))
+                return false;
+        }
+        else
+        {
+            return fail("Expected '{' or '='");
+        }
+    }
+}
+
+void UdmfParser::findSplits(const char* begin, const char* end, size_t count,
+                            std::vector<const char*>& splits)
+{
+    splits.clear();
+    splits.push_back(begin);
+
+    size_t size = end - begin;
+    size_t next = 1;
+    int depth = 0;
+    const char* pos = findStructural(begin, end);
+
+    while (pos && pos < end && next < count)
+    {
+        switch (*pos)
+        {
+            case '{':
+                ++depth;
+                ++pos;
+                break;
+            case '}':
+                --depth;
+                ++pos;
+
+                // Split after the first block that ends past the target
+                if (depth == 0 && offset(begin, pos) >= size * next / count)
+                {
+                    splits.push_back(pos);
+                    while (next < count &&
+                           offset(begin, pos) >= size * next / count)
+                        ++next;
+                }
+                break;
+            case '"':
+                pos = skipString(pos, end);
+                break;
+            default:
+                pos = skipComment(pos, end);
+                break;
+        }
+
+        // Malformed text is reported by the parser of its range
+        if (pos) pos = findStructural(pos, end);
+    }
+
+    if (splits.back() != end) splits.push_back(end);
+}
+
+bool UdmfParser::parseBlock(BlockType type, MapData& data)
+{
+    switch (type)
+    {
+        case BlockType::VERTEX:
+            data.vertices.emplace_back();
+            break;
+        case BlockType::LINEDEF:
+            data.lines.emplace_back();
+            break;
+        case BlockType::SIDEDEF:
+            data.sides.emplace_back();
+            break;
+        case BlockType::SECTOR:
+            data.sectors.emplace_back();
+            break;
+        case BlockType::UNKNOWN:
+            break;
+    }
+
+    // The required fields that have been read
+    uint32_t found = 0;
+
+    while (true)
+    {
+        if (!skipWhitespace()) return false;
+        if (pos == end) return fail("Unterminated block");
+        if (*pos == '}') break;
+
+        std::string_view key;
+        if (!readIdentifier(key) || !expect('=') || !skipWhitespace())
+            return false;
+
+        bool valid;
+        switch (type)
+        {
+            case BlockType::VERTEX:
+            {
+                // Read into a float, since the coordinates may be
+                // fixed-point numbers
+                LineVertex& vertex = data.vertices.back();
+                float value = 0.0f;
+                if (key == "x")
+                {
+                    valid = readCoordinate(value);
+                    vertex.x = MapCoord(value);
+                    found |= 1;
+                }
+                else if (key == "y")
+                {
+                    valid = readCoordinate(value);
+                    vertex.y = MapCoord(value);
+                    found |= 2;
+                }
+                else
+                {
+                    valid = skipValue();
+                }
+                break;
+            }
+            case BlockType::LINEDEF:
+            {
+                Line& line = data.lines.back();
+                if (key == "v1")
+                {
+                    valid = readInt(line.startVertex);
+                    found |= 1;
+                }
+                else if (key == "v2")
+                {
+                    valid = readInt(line.endVertex);
+                    found |= 2;
+                }
+                else if (key == "sidefront")
+                {
+                    valid = readInt(line.front);
+                }
+                else if (key == "sideback")
+                {
+                    valid = readInt(line.back);
+                }
+                else
+                {
+                    valid = skipValue();
+                }
+                break;
+            }
+            case BlockType::SIDEDEF:
+            {
+                Side& side = data.sides.back();
+                if (key == "sector")
+                    valid = readInt(side.sector);
+                else
+                    valid = skipValue();
+                break;
+            }
+            case BlockType::SECTOR:
+            {
+                Sector& sector = data.sectors.back();
+                if (key == "heightfloor")
+                    valid = readFloat(sector.floorHeight);
+                else if (key == "heightceiling")
+                    valid = readFloat(sector.ceilingHeight);
+                else if (key == "lightlevel")
+                    valid = readInt(sector.lightLevel);
+                else
+                    valid = skipValue();
+                break;
+            }
+            default:
+                valid = skipValue();
+                break;
+        }
+
+        if (!valid || !expect(';')) return false;
+    }
+
+    if (type == BlockType::VERTEX && found != VERTEX_REQUIRED)
+        return fail("Vertex is missing a coordinate");
+
+    if (type == BlockType::LINEDEF && found != LINEDEF_REQUIRED)
+        return fail("Linedef is missing a vertex");
+
+    ++pos;
+    return true;
+}
+
+bool UdmfParser::skipWhitespace()
+{
+    while (pos < end)
+    {
+        char c = *pos;
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r')
+        {
+            ++pos;
+        }
+        else if (c == '/' && end - pos >= 2 && (pos[1] == '/' || pos[1] == '*'))
+        {
+            const char* next = skipComment(pos, end);
+            if (!next) return fail("Unterminated comment");
+
+            pos = next;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool UdmfParser::readIdentifier(std::string_view& identifier)
+{
+    const char* start = pos;
+
+    while (pos < end && isIdentifierChar(*pos)) ++pos;
+
+    if (pos == start || (*start >= '0' && *start <= '9'))
+    {
+        pos = start;
+        return fail("Expected an identifier");
+    }
+
+    identifier = std::string_view(start, pos - start);
+    return true;
+}
+
+bool UdmfParser::expect(char c)
+{
+    if (!skipWhitespace()) return false;
+
+    if (pos == end || *pos != c)
+    {
+        switch (c)
+        {
+            case '=':
+                return fail("Expected '='");
+            case ';':
+                return fail("Expected ';'");
+            default:
+                return fail("Unexpected character");
+        }
+    }
+
+    ++pos;
+    return true;
+}
+
+bool UdmfParser::readInt(int& value)
+{
+    // std::from_chars does not accept a leading plus sign
+    if (pos < end && *pos == '+') ++pos;
+
+    std::from_chars_result result = std::from_chars(pos, end, value);
+    if (result.ec != std::errc()) return fail("Expected an integer");
+
+    pos = result.ptr;
+    return true;
+}
+
+bool UdmfParser::readFloat(float& value)
+{
+    if (pos < end && *pos == '+') ++pos;
+
+    std::from_chars_result result = std::from_chars(pos, end, value);
+    if (result.ec != std::errc()) return fail("Expected a number");
+
+    pos = result.ptr;
+    return true;
+}
+
+bool UdmfParser::readCoordinate(float& value)
+{
+    if (!readFloat(value)) return false;
+
+    // Coordinates past the fixed-point range would be clamped onto each other
+    if (!isMapCoordInRange(value))
+        return fail("Coordinate outside the range of map coordinates");
+
+    return true;
+}
+
+bool UdmfParser::skipValue()
+{
+    if (pos < end && *pos == '"')
+    {
+        const char* next = skipString(pos, end);
+        if (!next) return fail("Unterminated string");
+
+        pos = next;
+        return true;
+    }
+
+    // Numbers and keywords run up to the terminating semicolon
+    const char* start = pos;
+    while (pos < end && *pos != ';' && *pos != ' ' && *pos != '\t' &&
+           *pos != '\n' && *pos != '\r')
+        ++pos;
+
+    if (pos == start) return fail("Expected a value");
+    return true;
+}
+
+bool UdmfParser::fail(const char* message)
+{
+    error = message;
+    return false;
+}
+
+UdmfParser::BlockType UdmfParser::getBlockType(std::string_view name)
+{
+    if (name == "vertex") return BlockType::VERTEX;
+    if (name == "linedef") return BlockType::LINEDEF;
+    if (name == "sidedef") return BlockType::SIDEDEF;
+    if (name == "sector") return BlockType::SECTOR;
+    return BlockType::UNKNOWN;
+}
\ No newline at end of file
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include "../map/MapData.h"
+
+/**
+ * @brief A class that parses UDMF-style text maps.
+ *
+ * The text is a sequence of global assignments and blocks of assignments:
+ *
+ *     namespace = "dungeonventure";
+ *     vertex { x = 0.0; y = 64.0; }
+ *     linedef { v1 = 0; v2 = 1; sidefront = 0; }
+ *     sidedef { sector = 0; }
+ *     sector { heightfloor = 0.0; heightceiling = 128.0; lightlevel = 255; }
+ *
+ * Elements are numbered by their order of appearance among the blocks of
+ * their type. Line comments, block comments, unknown keys and unknown blocks
+ * are skipped. Omitted fields take the defaults of the map components, except
+ * for the coordinates of a vertex and the vertices of a line, which are
+ * required.
+ *
+ * The parser works directly on the text, which is usually a mapped file, and
+ * only allocates to grow the element arrays. Numbers are converted with
+ * std::from_chars. A range made of whole top-level blocks can be parsed on
+ * its own, so a large text can be split with findSplits and parsed on several
+ * threads.
+ */
+class UdmfParser
+{
+public:
+    /**
+     * @brief Constructs a new UdmfParser object over a range of text.
+     *
+     * @param begin The first character of the range.
+     * @param end One past the last character of the range.
+     */
+    UdmfParser(const char* begin, const char* end) : pos(begin), end(end) {}
+
+    /**
+     * @brief Parses the range, appending its elements to the specified data.
+     *
+     * @param data The data to append to.
+     * @return True if the range was parsed, false if it is malformed.
+     */
+    bool parse(MapData& data);
+
+    /**
+     * @brief Gets the description of the parse error.
+     *
+     * @return The error message, or nullptr if there was no error.
+     */
+    inline const char* getError() const { return error; }
+
+    /**
+     * @brief Gets the position of the parse error.
+     *
+     * @return The character at which the error was found.
+     */
+    inline const char* getErrorPosition() const { return pos; }
+
+    /**
+     * @brief Splits a text into ranges of whole top-level blocks.
+     *
+     * The split points are found in a single pass that only stops at braces,
+     * quotes and slashes, which are located 16 bytes at a time with SSE2 where
+     * it is available.
+     *
+     * @param begin The first character of the text.
+     * @param end One past the last character of the text.
+     * @param count The number of ranges to aim for.
+     * @param splits The boundaries of the ranges, from begin to end. There
+     * may be fewer ranges than requested.
+     */
+    static void findSplits(const char* begin, const char* end, size_t count,
+                           std::vector<const char*>& splits);
+
+private:
+    // The types of block the parser understands
+    enum class BlockType
+    {
+        VERTEX,
+        LINEDEF,
+        SIDEDEF,
+        SECTOR,
+        UNKNOWN
+    };
+
+    // The current position
+    const char* pos;
+    // One past the last character of the range
+    const char* end;
+    // The description of the parse error
+    const char* error = nullptr;
+
+    /**
+     * @brief Parses the assignments of a block up to its closing brace.
+     *
+     * @param type The type of the block.
+     * @param data The data to append the element of the block to.
+     * @return True if the block was parsed, false otherwise.
+     */
+    bool parseBlock(BlockType type, MapData& data);
+
+    /**
+     * @brief Skips whitespace and comments.
+     *
+     * @return True if the skipped text is well formed, false if a block
+     * comment is not terminated.
+     */
+    bool skipWhitespace();
+
+    /**
+     * @brief Reads an identifier.
+     *
+     * @param identifier The identifier.
+     * @return True if an identifier was read, false otherwise.
+     */
+    bool readIdentifier(std::string_view& identifier);
+
+    /**
+     * @brief Reads the specified character, after any whitespace.
+     *
+     * @param c The expected character.
+     * @return True if the character was read, false otherwise.
+     */
+    bool expect(char c);
+
+    /**
+     * @brief Reads an integer value.
+     *
+     * @param value The value.
+     * @return True if a value was read, false otherwise.
+     */
+    bool readInt(int& value);
+
+    /**
+     * @brief Reads a floating-point value.
+     *
+     * @param value The value.
+     * @return True if a value was read, false otherwise.
+     */
+    bool readFloat(float& value);
+
+    /**
+     * @brief Reads a vertex coordinate, which must fit the coordinate type.
+     *
+     * @param value The value.
+     * @return True if a value in range was read, false otherwise.
+     */
+    bool readCoordinate(float& value);
+
+    /**
+     * @brief Skips a value of any type.
+     *
+     * @return True if a value was skipped, false otherwise.
+     */
+    bool skipValue();
+
+    /**
+     * @brief Records a parse error at the current position.
+     *
+     * @param message The description of the error.
+     * @return False, so that the result can be returned directly.
+     */
+    bool fail(const char* message);
+
+    /**
+     * @brief Gets the type of a block from its name.
+     *
+     * @param name The name of the block.
+     * @return The type of the block.
+     */
+    static BlockType getBlockType(std::string_view name);
+};
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "UdmfReader.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "../utils/macros.h"
+#include "MappedFile.h"
+#include "UdmfParser.h"
+
+/**
+ * @brief Appends the elements of one array to another.
+ *
+ * @param to The array to append to.
+ * @param from The array to append.
+ */
+template <typename T>
+static void append(std::vector<T>& to, const std::vector<T>& from)
+{
+    to.insert(to.end(), from.begin(), from.end());
+}
+
+bool UdmfReader::open(const std::string& path)
+{
+    MappedFile file;
+    if (!file.open(path)) return false;
+
+    if (!parse(reinterpret_cast<const char*>(file.getData()), file.getSize()))
+    {
+        LOG_WARN("Invalid text map: %s", path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool UdmfReader::parse(const char* text, size_t size)
+{
+    data.clear();
+
+    size_t threadCount = std::max<size_t>(
+        1, std::min<size_t>(std::thread::hardware_concurrency(),
+                            size / MIN_BYTES_PER_THREAD));
+
+    std::vector<const char*> splits;
+    UdmfParser::findSplits(text, text + size, threadCount, splits);
+
+    std::vector<UdmfParser> parsers;
+    for (size_t i = 0; i + 1 < splits.size(); ++i)
+        parsers.emplace_back(splits[i], splits[i + 1]);
+
+    // The first range is parsed straight into the result on this thread
+    std::vector<MapData> chunks(parsers.size());
+    std::vector<char> results(parsers.size(), false);
+    std::vector<std::thread> threads;
+
+    for (size_t i = 1; i < parsers.size(); ++i)
+        threads.emplace_back([&, i]()
+                             { results[i] = parsers[i].parse(chunks[i]); });
+
+    if (!parsers.empty()) results[0] = parsers[0].parse(data);
+
+    for (std::thread& thread : threads) thread.join();
+
+    for (size_t i = 0; i < parsers.size(); ++i)
+    {
+        if (results[i]) continue;
+
+        const char* position = parsers[i].getErrorPosition();
+        LOG_WARN("%s at line %td", parsers[i].getError(),
+                 std::count(text, position, '\n') + 1);
+        data.clear();
+        return false;
+    }
+
+    for (size_t i = 1; i < chunks.size(); ++i)
+    {
+        append(data.vertices, chunks[i].vertices);
+        append(data.lines, chunks[i].lines);
+        append(data.sides, chunks[i].sides);
+        append(data.sectors, chunks[i].sectors);
+    }
+
+    if (!data.getArrays().hasValidReferences())
+    {
+        LOG_WARN("Text map refers to missing elements");
+        data.clear();
+        return false;
+    }
+
+    return true;
+}
\ No newline at end of file
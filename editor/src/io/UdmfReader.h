@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "../map/MapData.h"
+
+/**
+ * @brief A class that reads UDMF-style text maps.
+ *
+ * This class memory-maps a text map and parses it with UdmfParser. Large
+ * texts are split at top-level block boundaries and the ranges are parsed on
+ * separate threads, each into its own arrays, which are then concatenated in
+ * order so that elements keep their numbering. The references of the result
+ * are checked before it is exposed.
+ */
+class UdmfReader
+{
+public:
+    /**
+     * @brief Reads the specified file.
+     *
+     * @param path The path of the file.
+     * @return True if the file is a valid text map, false otherwise.
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Parses a text map held in memory.
+     *
+     * @param text The text.
+     * @param size The size of the text in bytes.
+     * @return True if the text is a valid text map, false otherwise.
+     */
+    bool parse(const char* text, size_t size);
+
+    /**
+     * @brief Gets the arrays of the map that was read.
+     *
+     * @return The arrays, valid until the next read.
+     */
+    inline MapArrays getArrays() const { return data.getArrays(); }
+
+private:
+    // The number of bytes below which a text is parsed on one thread
+    static constexpr size_t MIN_BYTES_PER_THREAD = 4 << 20;
+
+    // The elements of the map
+    MapData data;
+};
\ No newline at end of file
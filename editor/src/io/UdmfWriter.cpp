@@ -0,0 +1,138 @@
+#include "UdmfWriter.h"
+
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+
+#include "../utils/macros.h"
+
+bool UdmfWriter::write(const MapStore& store, const std::string& path)
+{
+    vertexRemap.build(store.getVertexIndices());
+    sideRemap.build(store.getSideIndices());
+    sectorRemap.build(store.getSectorIndices());
+
+    std::string tempPath = path + ".tmp";
+    stream.open(tempPath, std::ios::binary | std::ios::trunc);
+    if (!stream)
+    {
+        LOG_WARN("Failed to open file: %s", tempPath.c_str());
+        return false;
+    }
+
+    buffer.resize(BUFFER_SIZE);
+    used = 0;
+
+    append("namespace = \"dungeonventure\";\n");
+
+    for (const LineVertex& vertex : store.getVertexPositions())
+    {
+        append("\nvertex\n{\n");
+        appendField("x", vertex.x);
+        appendField("y", vertex.y);
+        append("}\n");
+    }
+
+    const Line defaultLine;
+    for (const Line& line : store.getLines())
+    {
+        append("\nlinedef\n{\n");
+        appendField("v1", vertexRemap.get(line.startVertex));
+        appendField("v2", vertexRemap.get(line.endVertex));
+        if (line.front != defaultLine.front)
+            appendField("sidefront", sideRemap.get(line.front));
+        if (line.back != defaultLine.back)
+            appendField("sideback", sideRemap.get(line.back));
+        append("}\n");
+    }
+
+    const Side defaultSide;
+    for (const Side& side : store.getSides())
+    {
+        append("\nsidedef\n{\n");
+        if (side.sector != defaultSide.sector)
+            appendField("sector", sectorRemap.get(side.sector));
+        append("}\n");
+    }
+
+    const Sector defaultSector;
+    for (const Sector& sector : store.getSectors())
+    {
+        append("\nsector\n{\n");
+        if (sector.floorHeight != defaultSector.floorHeight)
+            appendField("heightfloor", sector.floorHeight);
+        if (sector.ceilingHeight != defaultSector.ceilingHeight)
+            appendField("heightceiling", sector.ceilingHeight);
+        if (sector.lightLevel != defaultSector.lightLevel)
+            appendField("lightlevel", sector.lightLevel);
+        append("}\n");
+    }
+
+    flush();
+    stream.close();
+    if (!stream)
+    {
+        LOG_WARN("Failed to write file: %s", tempPath.c_str());
+        return false;
+    }
+
+    // Replace the destination only once the new file is complete
+    std::error_code error;
+    std::filesystem::rename(tempPath, path, error);
+    if (error)
+    {
+        LOG_WARN("Failed to replace file: %s", path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+void UdmfWriter::append(std::string_view text)
+{
+    reserve(text.size());
+    std::memcpy(buffer.data() + used, text.data(), text.size());
+    used += text.size();
+}
+
+void UdmfWriter::appendField(std::string_view key, int value)
+{
+    append(key);
+    append(" = ");
+
+    reserve(NUMBER_SIZE);
+    char* last = buffer.data() + buffer.size();
+    used = std::to_chars(buffer.data() + used, last, value).ptr - buffer.data();
+
+    append(";\n");
+}
+
+void UdmfWriter::appendField(std::string_view key, float value)
+{
+    append(key);
+    append(" = ");
+
+    reserve(NUMBER_SIZE);
+    char* first = buffer.data() + used;
+    char* last = std::to_chars(first, buffer.data() + buffer.size(), value).ptr;
+    used = last - buffer.data();
+
+    // Integral values are written without a fraction, which would read back
+    // as integers
+    if (!std::memchr(first, '.', last - first) &&
+        !std::memchr(first, 'e', last - first))
+        append(".0");
+
+    append(";\n");
+}
+
+void UdmfWriter::reserve(size_t size)
+{
+    if (buffer.size() - used < size) flush();
+}
+
+void UdmfWriter::flush()
+{
+    stream.write(buffer.data(), used);
+    used = 0;
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../map/MapStore.h"
+#include "IndexRemap.h"
+
+/**
+ * @brief A class that writes maps as UDMF-style text.
+ *
+ * This class writes every element of a map store as a block of the text
+ * format read by UdmfParser, with references rewritten to the position of the
+ * element in the file. Fields that hold their default value are omitted.
+ * Output is formatted with std::to_chars straight into a fixed buffer that is
+ * flushed to the file when full, so no field allocates. The file is written
+ * next to its destination and moved into place once complete.
+ */
+class UdmfWriter
+{
+public:
+    /**
+     * @brief Writes the elements of a store to the specified file.
+     *
+     * @param store The elements of the map.
+     * @param path The path of the file.
+     * @return True if the file was written, false otherwise.
+     */
+    bool write(const MapStore& store, const std::string& path);
+
+private:
+    // The size of the output buffer
+    static constexpr size_t BUFFER_SIZE = 1 << 16;
+    // The space left free for a single number
+    static constexpr size_t NUMBER_SIZE = 32;
+
+    // The position in the file of each vertex slot
+    IndexRemap vertexRemap;
+    // The position in the file of each side slot
+    IndexRemap sideRemap;
+    // The position in the file of each sector slot
+    IndexRemap sectorRemap;
+    // The output buffer
+    std::vector<char> buffer;
+    // The number of bytes in the output buffer
+    size_t used = 0;
+    // The file being written
+    std::ofstream stream;
+
+    /**
+     * @brief Appends text to the output.
+     *
+     * @param text The text, which must fit in the buffer.
+     */
+    void append(std::string_view text);
+
+    /**
+     * @brief Appends an integer field to the output.
+     *
+     * @param key The key of the field.
+     * @param value The value of the field.
+     */
+    void appendField(std::string_view key, int value);
+
+    /**
+     * @brief Appends a floating-point field to the output.
+     *
+     * The value is written in its shortest form that reads back exactly, and
+     * always with a decimal point.
+     *
+     * @param key The key of the field.
+     * @param value The value of the field.
+     */
+    void appendField(std::string_view key, float value);
+
+    /**
+     * @brief Makes room in the buffer, flushing it if needed.
+     *
+     * @param size The number of bytes needed.
+     */
+    void reserve(size_t size);
+
+    /**
+     * @brief Writes the buffer to the file.
+     */
+    void flush();
+};
\ No newline at end of file
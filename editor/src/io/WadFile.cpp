@@ -0,0 +1,91 @@
+#include "WadFile.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "../utils/macros.h"
+#include "WadFormat.h"
+
+using namespace WadFormat;
+
+bool WadFile::open(const std::string& path)
+{
+    close();
+
+    if (!file.open(path)) return false;
+
+    const unsigned char* data = file.getData();
+    size_t size = file.getSize();
+
+    if (size < HEADER_SIZE || (std::memcmp(data, "IWAD", 4) != 0 &&
+                               std::memcmp(data, "PWAD", 4) != 0))
+    {
+        LOG_WARN("Not a WAD file: %s", path.c_str());
+        close();
+        return false;
+    }
+
+    // Compare counts rather than byte sizes so that the check cannot overflow
+    uint32_t lumpCount = readInt32(data + 4);
+    uint32_t directoryOffset = readInt32(data + 8);
+    if (directoryOffset > size ||
+        lumpCount > (size - directoryOffset) / DIRECTORY_ENTRY_SIZE)
+    {
+        LOG_WARN("Invalid WAD directory: %s", path.c_str());
+        close();
+        return false;
+    }
+
+    lumps.resize(lumpCount);
+    for (uint32_t i = 0; i < lumpCount; ++i)
+    {
+        const unsigned char* entry =
+            data + directoryOffset + i * DIRECTORY_ENTRY_SIZE;
+
+        Lump& lump = lumps[i];
+        lump.offset = static_cast<uint32_t>(readInt32(entry));
+        lump.size = static_cast<uint32_t>(readInt32(entry + 4));
+
+        // Names are padded with zeros up to eight characters
+        const char* name = reinterpret_cast<const char*>(entry + 8);
+        lump.name = std::string_view(
+            name, std::find(name, name + NAME_SIZE, '\0') - name);
+
+        if (lump.offset > size || lump.size > size - lump.offset)
+        {
+            LOG_WARN("Lump %u lies outside of the WAD: %s", i, path.c_str());
+            close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void WadFile::close()
+{
+    lumps.clear();
+    file.close();
+}
+
+int WadFile::findLump(std::string_view name, size_t first, size_t last) const
+{
+    last = std::min(last, lumps.size());
+
+    for (size_t i = first; i < last; ++i)
+        if (lumps[i].name == name) return i;
+
+    return -1;
+}
+
+std::vector<int> WadFile::findMaps() const
+{
+    std::vector<int> maps;
+
+    // A map marker is followed by the things of the map, while text-format
+    // maps are followed by a TEXTMAP lump instead
+    for (size_t i = 0; i + 1 < lumps.size(); ++i)
+        if (lumps[i + 1].name == "THINGS") maps.push_back(i);
+
+    return maps;
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "MappedFile.h"
+
+/**
+ * @brief A class that reads the lump directory of a WAD file.
+ *
+ * This class memory-maps a WAD file and checks its directory, after which the
+ * contents of every lump can be read in place from the mapping.
+ */
+class WadFile
+{
+public:
+    /**
+     * @brief Opens the specified file, closing the previous one.
+     *
+     * @param path The path of the file.
+     * @return True if the file is a valid WAD, false otherwise.
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Closes the file.
+     */
+    void close();
+
+    /**
+     * @brief Gets the number of lumps.
+     *
+     * @return The number of lumps.
+     */
+    inline size_t getLumpCount() const { return lumps.size(); }
+
+    /**
+     * @brief Gets the name of a lump.
+     *
+     * @param lump The index of the lump.
+     * @return The name of the lump, without its padding.
+     */
+    inline std::string_view getLumpName(size_t lump) const
+    {
+        return lumps[lump].name;
+    }
+
+    /**
+     * @brief Gets the contents of a lump.
+     *
+     * @param lump The index of the lump.
+     * @return The first byte of the lump.
+     */
+    inline const unsigned char* getLumpData(size_t lump) const
+    {
+        return file.getData() + lumps[lump].offset;
+    }
+
+    /**
+     * @brief Gets the size of a lump.
+     *
+     * @param lump The index of the lump.
+     * @return The size of the lump in bytes.
+     */
+    inline size_t getLumpSize(size_t lump) const { return lumps[lump].size; }
+
+    /**
+     * @brief Finds a lump by name.
+     *
+     * @param name The name of the lump.
+     * @param first The index of the first lump to search. Defaults to 0.
+     * @param last One past the index of the last lump to search. Defaults to
+     * the number of lumps.
+     * @return The index of the first matching lump, or -1 if there is none.
+     */
+    int findLump(std::string_view name, size_t first = 0,
+                 size_t last = static_cast<size_t>(-1)) const;
+
+    /**
+     * @brief Finds the markers of the binary-format maps of the file.
+     *
+     * @return The indices of the marker lumps, in directory order.
+     */
+    std::vector<int> findMaps() const;
+
+private:
+    /**
+     * @brief A struct representing an entry of the lump directory.
+     */
+    struct Lump
+    {
+        // The name of the lump
+        std::string_view name;
+        // The offset of the lump from the start of the file
+        size_t offset;
+        // The size of the lump in bytes
+        size_t size;
+    };
+
+    // The mapped file
+    MappedFile file;
+    // The lump directory
+    std::vector<Lump> lumps;
+};
\ No newline at end of file
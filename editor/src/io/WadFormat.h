@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief The layout of Doom WAD files.
+ *
+ * A WAD file is little-endian and made of a header, the lump contents and a
+ * directory of lumps. A map is a marker lump, named after the map, followed
+ * by the lumps holding its elements. The records of these lumps are packed,
+ * so they are decoded field by field at the byte offsets below rather than
+ * through structs, which also keeps decoding independent of the host byte
+ * order.
+ */
+namespace WadFormat
+{
+    // The size of the file header
+    static constexpr size_t HEADER_SIZE = 12;
+    // The size of a directory entry
+    static constexpr size_t DIRECTORY_ENTRY_SIZE = 16;
+    // The maximum length of a lump name
+    static constexpr size_t NAME_SIZE = 8;
+    // The side index meaning that a line has no side
+    static constexpr uint16_t NO_SIDE = 0xFFFF;
+    // The largest number of vertices or sides a map can reference
+    static constexpr size_t MAX_ELEMENTS = 0xFFFF;
+
+    // The size of a VERTEXES record: x, y
+    static constexpr size_t VERTEX_SIZE = 4;
+    // The size of a Doom LINEDEFS record: v1, v2, flags, special, tag,
+    // front, back
+    static constexpr size_t LINEDEF_SIZE = 14;
+    // The size of a Hexen LINEDEFS record: v1, v2, flags, special, args[5],
+    // front, back
+    static constexpr size_t HEXEN_LINEDEF_SIZE = 16;
+    // The size of a SIDEDEFS record: x offset, y offset, upper, lower and
+    // middle textures, sector
+    static constexpr size_t SIDEDEF_SIZE = 30;
+    // The offset of the sector in a SIDEDEFS record
+    static constexpr size_t SIDEDEF_SECTOR = 28;
+    // The size of a SECTORS record: floor, ceiling, floor and ceiling
+    // flats, light, special, tag
+    static constexpr size_t SECTOR_SIZE = 26;
+    // The offset of the light level in a SECTORS record
+    static constexpr size_t SECTOR_LIGHT = 20;
+
+    /**
+     * @brief Reads a little-endian 16-bit unsigned integer.
+     *
+     * @param data The first byte.
+     * @return The value.
+     */
+    inline uint16_t readUint16(const unsigned char* data)
+    {
+        return static_cast<uint16_t>(data[0] | data[1] << 8);
+    }
+
+    /**
+     * @brief Reads a little-endian 16-bit signed integer.
+     *
+     * @param data The first byte.
+     * @return The value.
+     */
+    inline int16_t readInt16(const unsigned char* data)
+    {
+        return static_cast<int16_t>(readUint16(data));
+    }
+
+    /**
+     * @brief Reads a little-endian 32-bit signed integer.
+     *
+     * @param data The first byte.
+     * @return The value.
+     */
+    inline int32_t readInt32(const unsigned char* data)
+    {
+        return static_cast<int32_t>(
+            static_cast<uint32_t>(data[0]) |
+            static_cast<uint32_t>(data[1]) << 8 |
+            static_cast<uint32_t>(data[2]) << 16 |
+            static_cast<uint32_t>(data[3]) << 24);
+    }
+
+    /**
+     * @brief Writes a little-endian 16-bit integer.
+     *
+     * @param data The first byte.
+     * @param value The value.
+     */
+    inline void writeInt16(unsigned char* data, int value)
+    {
+        data[0] = static_cast<unsigned char>(value);
+        data[1] = static_cast<unsigned char>(value >> 8);
+    }
+
+    /**
+     * @brief Writes a little-endian 32-bit integer.
+     *
+     * @param data The first byte.
+     * @param value The value.
+     */
+    inline void writeInt32(unsigned char* data, uint32_t value)
+    {
+        data[0] = static_cast<unsigned char>(value);
+        data[1] = static_cast<unsigned char>(value >> 8);
+        data[2] = static_cast<unsigned char>(value >> 16);
+        data[3] = static_cast<unsigned char>(value >> 24);
+    }
+}  // namespace WadFormat
\ No newline at end of file
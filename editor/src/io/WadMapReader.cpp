@@ -0,0 +1,91 @@
+#include "WadMapReader.h"
+
+#include "../utils/macros.h"
+#include "WadFormat.h"
+
+using namespace WadFormat;
+
+bool WadMapReader::read(const WadFile& wad, int marker)
+{
+    data.clear();
+
+    std::string_view name = wad.getLumpName(marker);
+    size_t first = marker + 1;
+    size_t last = first + MAX_MAP_LUMPS;
+    int vertexLump = wad.findLump("VERTEXES", first, last);
+    int lineLump = wad.findLump("LINEDEFS", first, last);
+    int sideLump = wad.findLump("SIDEDEFS", first, last);
+    int sectorLump = wad.findLump("SECTORS", first, last);
+
+    if (vertexLump == -1 || lineLump == -1 || sideLump == -1 ||
+        sectorLump == -1)
+    {
+        LOG_WARN("Map %.*s is missing lumps", static_cast<int>(name.size()),
+                 name.data());
+        return false;
+    }
+
+    // Hexen maps carry scripts, and their lines carry arguments
+    bool isHexen = wad.findLump("BEHAVIOR", first, last) != -1;
+    size_t lineSize = isHexen ? HEXEN_LINEDEF_SIZE : LINEDEF_SIZE;
+
+    const unsigned char* records = wad.getLumpData(vertexLump);
+    size_t count = wad.getLumpSize(vertexLump) / VERTEX_SIZE;
+    // 16-bit coordinates are within the range of any coordinate type
+    data.vertices.resize(count);
+    for (size_t i = 0; i < count; ++i, records += VERTEX_SIZE)
+        data.vertices[i] =
+            LineVertex(readInt16(records), readInt16(records + 2));
+
+    records = wad.getLumpData(lineLump);
+    count = wad.getLumpSize(lineLump) / lineSize;
+    data.lines.reserve(count);
+    size_t dropped = 0;
+    for (size_t i = 0; i < count; ++i, records += lineSize)
+    {
+        uint16_t startVertex = readUint16(records);
+        uint16_t endVertex = readUint16(records + 2);
+        uint16_t front = readUint16(records + lineSize - 4);
+        uint16_t back = readUint16(records + lineSize - 2);
+
+        if (startVertex == endVertex)
+        {
+            ++dropped;
+            continue;
+        }
+
+        data.lines.emplace_back(startVertex, endVertex,
+                                front == NO_SIDE ? -1 : front,
+                                back == NO_SIDE ? -1 : back);
+    }
+
+    records = wad.getLumpData(sideLump);
+    count = wad.getLumpSize(sideLump) / SIDEDEF_SIZE;
+    data.sides.resize(count);
+    for (size_t i = 0; i < count; ++i, records += SIDEDEF_SIZE)
+    {
+        uint16_t sector = readUint16(records + SIDEDEF_SECTOR);
+        data.sides[i] = Side(sector == NO_SIDE ? -1 : sector);
+    }
+
+    records = wad.getLumpData(sectorLump);
+    count = wad.getLumpSize(sectorLump) / SECTOR_SIZE;
+    data.sectors.resize(count);
+    for (size_t i = 0; i < count; ++i, records += SECTOR_SIZE)
+        data.sectors[i] = Sector(readInt16(records), readInt16(records + 2),
+                                 readInt16(records + SECTOR_LIGHT));
+
+    if (dropped > 0)
+        LOG_WARN("Dropped %zu zero-length lines from map %.*s", dropped,
+                 static_cast<int>(name.size()), name.data());
+
+    if (!data.getArrays().hasValidReferences())
+    {
+        LOG_WARN("Map %.*s refers to missing elements",
+                 static_cast<int>(name.size()), name.data());
+        data.clear();
+        return false;
+    }
+
+    return true;
+}
\ No newline at end of file
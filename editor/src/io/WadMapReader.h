@@ -0,0 +1,40 @@
+#pragma once
+
+#include "../map/MapData.h"
+#include "WadFile.h"
+
+/**
+ * @brief A class that decodes the maps of WAD files.
+ *
+ * This class decodes the VERTEXES, LINEDEFS, SIDEDEFS and SECTORS lumps of a
+ * binary-format map straight from the mapped file into the map arrays, one
+ * field at a time and without intermediate records. Both the Doom and the
+ * Hexen line layouts are understood. Lines that start and end at the same
+ * vertex cannot be represented in the editor and are dropped.
+ */
+class WadMapReader
+{
+public:
+    /**
+     * @brief Decodes a map of a WAD file.
+     *
+     * @param wad The WAD file.
+     * @param marker The index of the marker lump of the map.
+     * @return True if the map was decoded, false if it is malformed.
+     */
+    bool read(const WadFile& wad, int marker);
+
+    /**
+     * @brief Gets the arrays of the map that was read.
+     *
+     * @return The arrays, valid until the next read.
+     */
+    inline MapArrays getArrays() const { return data.getArrays(); }
+
+private:
+    // The largest number of lumps that make up a map after its marker
+    static constexpr int MAX_MAP_LUMPS = 11;
+
+    // The elements of the map
+    MapData data;
+};
\ No newline at end of file
@@ -0,0 +1,178 @@
+#include "WadWriter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+
+#include "../utils/macros.h"
+#include "WadFormat.h"
+
+using namespace WadFormat;
+
+/**
+ * @brief Writes a lump name padded with zeros.
+ *
+ * @param data The first byte of the name.
+ * @param name The name, at most eight characters long.
+ */
+static void writeName(unsigned char* data, std::string_view name)
+{
+    std::memset(data, 0, NAME_SIZE);
+    std::memcpy(data, name.data(), std::min(name.size(), NAME_SIZE));
+}
+
+bool WadWriter::write(const MapStore& store, const std::string& path,
+                      std::string_view mapName)
+{
+    // Side indices are 16 bits wide, with the largest meaning none
+    if (store.getVertexCount() > MAX_ELEMENTS ||
+        store.getSideCount() >= MAX_ELEMENTS ||
+        store.getSectorCount() > MAX_ELEMENTS)
+    {
+        LOG_WARN("Map has too many elements for the WAD format");
+        return false;
+    }
+
+    vertexRemap.build(store.getVertexIndices());
+    sideRemap.build(store.getSideIndices());
+    sectorRemap.build(store.getSectorIndices());
+
+    std::string tempPath = path + ".tmp";
+    stream.open(tempPath, std::ios::binary | std::ios::trunc);
+    if (!stream)
+    {
+        LOG_WARN("Failed to open file: %s", tempPath.c_str());
+        return false;
+    }
+
+    // The header is completed once the directory offset is known
+    unsigned char header[HEADER_SIZE] = {'P', 'W', 'A', 'D'};
+    stream.write(reinterpret_cast<const char*>(header), HEADER_SIZE);
+    offset = HEADER_SIZE;
+    directory.clear();
+
+    bool clamped = false;
+
+    lump.clear();
+    writeLump(mapName);
+    writeLump("THINGS");
+
+    const std::vector<Line>& lines = store.getLines();
+    lump.assign(lines.size() * LINEDEF_SIZE, 0);
+    for (size_t i = 0; i < lines.size(); ++i)
+    {
+        const Line& line = lines[i];
+        unsigned char* record = lump.data() + i * LINEDEF_SIZE;
+
+        // Lines without a back side block movement, and the others are
+        // two-sided
+        writeInt16(record, vertexRemap.get(line.startVertex));
+        writeInt16(record + 2, vertexRemap.get(line.endVertex));
+        writeInt16(record + 4, line.back == -1 ? 0x0001 : 0x0004);
+        writeInt16(record + 10, line.front == -1 ? NO_SIDE
+                                                 : sideRemap.get(line.front));
+        writeInt16(record + 12,
+                   line.back == -1 ? NO_SIDE : sideRemap.get(line.back));
+    }
+    writeLump("LINEDEFS");
+
+    const std::vector<Side>& sides = store.getSides();
+    lump.assign(sides.size() * SIDEDEF_SIZE, 0);
+    for (size_t i = 0; i < sides.size(); ++i)
+    {
+        unsigned char* record = lump.data() + i * SIDEDEF_SIZE;
+        writeName(record + 4, "-");
+        writeName(record + 12, "-");
+        writeName(record + 20, "-");
+        writeInt16(record + SIDEDEF_SECTOR,
+                   sides[i].sector == -1 ? NO_SIDE
+                                         : sectorRemap.get(sides[i].sector));
+    }
+    writeLump("SIDEDEFS");
+
+    const std::vector<LineVertex>& vertices = store.getVertexPositions();
+    lump.resize(vertices.size() * VERTEX_SIZE);
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        unsigned char* record = lump.data() + i * VERTEX_SIZE;
+        writeInt16(record, toFixed16(vertices[i].x, clamped));
+        writeInt16(record + 2, toFixed16(vertices[i].y, clamped));
+    }
+    writeLump("VERTEXES");
+
+    lump.clear();
+    writeLump("SEGS");
+    writeLump("SSECTORS");
+    writeLump("NODES");
+
+    const std::vector<Sector>& sectors = store.getSectors();
+    lump.assign(sectors.size() * SECTOR_SIZE, 0);
+    for (size_t i = 0; i < sectors.size(); ++i)
+    {
+        unsigned char* record = lump.data() + i * SECTOR_SIZE;
+        writeInt16(record, toFixed16(sectors[i].floorHeight, clamped));
+        writeInt16(record + 2, toFixed16(sectors[i].ceilingHeight, clamped));
+        writeName(record + 4, "FLOOR4_8");
+        writeName(record + 12, "CEIL3_5");
+        writeInt16(record + SECTOR_LIGHT, sectors[i].lightLevel);
+    }
+    writeLump("SECTORS");
+
+    lump.clear();
+    writeLump("REJECT");
+    writeLump("BLOCKMAP");
+
+    if (clamped) LOG_WARN("Coordinates were clamped to the WAD range");
+
+    stream.write(reinterpret_cast<const char*>(directory.data()),
+                 directory.size());
+
+    writeInt32(header + 4, directory.size() / DIRECTORY_ENTRY_SIZE);
+    writeInt32(header + 8, offset);
+    stream.seekp(0);
+    stream.write(reinterpret_cast<const char*>(header), HEADER_SIZE);
+
+    stream.close();
+    if (!stream)
+    {
+        LOG_WARN("Failed to write file: %s", tempPath.c_str());
+        return false;
+    }
+
+    // Replace the destination only once the new file is complete
+    std::error_code error;
+    std::filesystem::rename(tempPath, path, error);
+    if (error)
+    {
+        LOG_WARN("Failed to replace file: %s", path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+void WadWriter::writeLump(std::string_view name)
+{
+    stream.write(reinterpret_cast<const char*>(lump.data()), lump.size());
+
+    unsigned char entry[DIRECTORY_ENTRY_SIZE];
+    writeInt32(entry, lump.empty() ? 0 : offset);
+    writeInt32(entry + 4, lump.size());
+    writeName(entry + 8, name);
+    directory.insert(directory.end(), entry, entry + DIRECTORY_ENTRY_SIZE);
+
+    offset += lump.size();
+}
+
+int WadWriter::toFixed16(float value, bool& clamped)
+{
+    float rounded = std::round(value);
+    if (rounded < -32768.0f || rounded > 32767.0f)
+    {
+        clamped = true;
+        return static_cast<int>(std::clamp(rounded, -32768.0f, 32767.0f));
+    }
+
+    return static_cast<int>(rounded);
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../map/MapStore.h"
+#include "IndexRemap.h"
+
+/**
+ * @brief A class that writes maps as Doom WAD files.
+ *
+ * This class writes a PWAD holding a single map in the Doom binary format,
+ * with the lumps in their usual order. Coordinates and heights are rounded to
+ * the 16-bit integers of the format. The editor has no textures or node
+ * builder yet, so sides are written without textures, sectors with stock
+ * flats, and the things, nodes, reject and blockmap lumps are left empty for
+ * a node builder to fill.
+ */
+class WadWriter
+{
+public:
+    /**
+     * @brief Writes the elements of a store to the specified file.
+     *
+     * @param store The elements of the map.
+     * @param path The path of the file.
+     * @param mapName The name of the map marker. Defaults to MAP01.
+     * @return True if the file was written, false if the map does not fit
+     * the format or the file could not be written.
+     */
+    bool write(const MapStore& store, const std::string& path,
+               std::string_view mapName = "MAP01");
+
+private:
+    // The position in the file of each vertex slot
+    IndexRemap vertexRemap;
+    // The position in the file of each side slot
+    IndexRemap sideRemap;
+    // The position in the file of each sector slot
+    IndexRemap sectorRemap;
+    // The encoded contents of the lump being written
+    std::vector<unsigned char> lump;
+    // The lump directory
+    std::vector<unsigned char> directory;
+    // The offset of the next lump from the start of the file
+    uint32_t offset = 0;
+    // The file being written
+    std::ofstream stream;
+
+    /**
+     * @brief Writes the encoded lump and adds it to the directory.
+     *
+     * @param name The name of the lump.
+     */
+    void writeLump(std::string_view name);
+
+    /**
+     * @brief Rounds a coordinate to the 16-bit integers of the format.
+     *
+     * @param value The coordinate.
+     * @param clamped Set to true if the coordinate is out of range.
+     * @return The rounded and clamped coordinate.
+     */
+    static int toFixed16(float value, bool& clamped);
+};
\ No newline at end of file
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief A sparse array stored in fixed-size chunks that are shared between
+ * copies until written.
+ *
+ * Copying the array copies one pointer per chunk, and writing an element
+ * clones its chunk first if another copy still refers to it. This makes a
+ * copy a cheap snapshot that can be read on another thread while the original
+ * keeps being written: only the chunks written after the copy are duplicated.
+ * Each copy must only be used by one thread at a time.
+ *
+ * @tparam T The type of the elements, which must be default constructible.
+ */
+template <typename T>
+class CowArray
+{
+public:
+    // The number of elements per chunk
+    static constexpr size_t CHUNK_SIZE = 4096;
+
+    /**
+     * @brief Checks if an element is stored at the specified index.
+     *
+     * @param index The index.
+     * @return True if an element is stored, false otherwise.
+     */
+    inline bool has(size_t index) const
+    {
+        size_t chunk = index / CHUNK_SIZE;
+        return chunk < chunks.size() && chunks[chunk] &&
+               chunks[chunk]->live.test(index % CHUNK_SIZE);
+    }
+
+    /**
+     * @brief Gets the element stored at the specified index.
+     *
+     * @param index The index, at which an element must be stored.
+     * @return The element.
+     */
+    inline const T& get(size_t index) const
+    {
+        return chunks[index / CHUNK_SIZE]->values[index % CHUNK_SIZE];
+    }
+
+    /**
+     * @brief Stores an element at the specified index, replacing the element
+     * stored there.
+     *
+     * @param index The index.
+     * @param value The element.
+     */
+    void set(size_t index, const T& value)
+    {
+        Chunk& chunk = getMutableChunk(index / CHUNK_SIZE);
+        size_t offset = index % CHUNK_SIZE;
+
+        if (!chunk.live.test(offset)) ++count;
+        chunk.live.set(offset);
+        chunk.values[offset] = value;
+    }
+
+    /**
+     * @brief Removes the element stored at the specified index, if any.
+     *
+     * @param index The index.
+     */
+    void erase(size_t index)
+    {
+        if (!has(index)) return;
+
+        Chunk& chunk = getMutableChunk(index / CHUNK_SIZE);
+        chunk.live.reset(index % CHUNK_SIZE);
+        --count;
+    }
+
+    /**
+     * @brief Removes every element.
+     *
+     * The chunks are released rather than written, so copies are unaffected.
+     */
+    void clear()
+    {
+        chunks.clear();
+        count = 0;
+    }
+
+    /**
+     * @brief Gets the number of stored elements.
+     *
+     * @return The number of stored elements.
+     */
+    inline size_t size() const { return count; }
+
+    /**
+     * @brief Calls a function on every stored element in index order.
+     *
+     * @tparam Func The type of the function, called with the index and the
+     * element.
+     * @param func The function.
+     */
+    template <typename Func>
+    void forEach(Func func) const
+    {
+        for (size_t i = 0; i < chunks.size(); ++i)
+        {
+            if (!chunks[i]) continue;
+
+            const Chunk& chunk = *chunks[i];
+            for (size_t offset = 0; offset < CHUNK_SIZE; ++offset)
+            {
+                if (chunk.live.test(offset))
+                    func(i * CHUNK_SIZE + offset, chunk.values[offset]);
+            }
+        }
+    }
+
+private:
+    /**
+     * @brief A struct representing a chunk of elements.
+     */
+    struct Chunk
+    {
+        // The elements of the chunk
+        std::array<T, CHUNK_SIZE> values;
+        // Whether each element of the chunk is stored
+        std::bitset<CHUNK_SIZE> live;
+    };
+
+    // The chunks, which are null until an element is stored in them
+    std::vector<std::shared_ptr<Chunk>> chunks;
+    // The number of stored elements
+    size_t count = 0;
+
+    /**
+     * @brief Gets a chunk that only this array refers to, creating or
+     * cloning it if needed.
+     *
+     * Copies are only made on the thread that writes the array, so a chunk
+     * that is not shared cannot become shared while it is written.
+     *
+     * @param index The index of the chunk.
+     * @return The chunk.
+     */
+    Chunk& getMutableChunk(size_t index)
+    {
+        if (index >= chunks.size()) chunks.resize(index + 1);
+
+        std::shared_ptr<Chunk>& chunk = chunks[index];
+        if (!chunk)
+            chunk = std::make_shared<Chunk>();
+        else if (chunk.use_count() > 1)
+            chunk = std::make_shared<Chunk>(*chunk);
+        else
+            // Order the write after the reads of a copy released elsewhere
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+        return *chunk;
+    }
+};
\ No newline at end of file
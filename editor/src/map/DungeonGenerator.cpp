@@ -0,0 +1,587 @@
+#include "DungeonGenerator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+
+#include "../utils/macros.h"
+
+DungeonGenerator::DungeonGenerator(ThreadPool& pool) : pool(pool) {}
+
+int DungeonGenerator::getMaxSize(float tileSize)
+{
+    // The far corner of the map lies at the size times the tile size
+    double size = std::floor(static_cast<double>(MAX_MAP_COORD) / tileSize);
+    return static_cast<int>(std::clamp<double>(size, MIN_SIZE, INT_MAX));
+}
+
+const MapData& DungeonGenerator::generate(const DungeonSettings& settings)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    // Vertices past the range of fixed-point coordinates would be clamped
+    // onto each other
+    int maxSize = getMaxSize(settings.tileSize);
+    if (settings.width > maxSize || settings.height > maxSize)
+        LOG_WARN("Maps of more than %d tiles across do not fit the range of "
+                 "map coordinates",
+                 maxSize);
+
+    this->settings = settings;
+    this->settings.width = std::clamp(settings.width, MIN_SIZE, maxSize);
+    this->settings.height = std::clamp(settings.height, MIN_SIZE, maxSize);
+    int width = this->settings.width;
+    int height = this->settings.height;
+
+    // Regions are between one and two region sizes wide, so every region
+    // has room for a BSP split or a cave
+    regionColumns = std::max(width / REGION_SIZE, 1);
+    regionRows = std::max(height / REGION_SIZE, 1);
+    regions.assign(regionColumns * regionRows, Region());
+    for (int y = 0; y < regionRows; ++y)
+    {
+        for (int x = 0; x < regionColumns; ++x)
+        {
+            regions[y * regionColumns + x].bounds = {
+                getRegionStart(x, width, regionColumns),
+                getRegionStart(y, height, regionRows),
+                getRegionStart(x + 1, width, regionColumns),
+                getRegionStart(y + 1, height, regionRows)};
+        }
+    }
+
+    tiles.assign(static_cast<size_t>(width) * height, WALL);
+    pool.forEachChunk(regions.size(), 1,
+                      [this](size_t chunk, size_t begin, size_t end)
+                      {
+                          for (size_t i = begin; i < end; ++i)
+                              generateRegion(i);
+                      });
+
+    // Number the sectors region by region
+    data.sectors.clear();
+    for (Region& region : regions)
+    {
+        region.firstSector = data.sectors.size();
+        data.sectors.insert(data.sectors.end(), region.sectors.begin(),
+                            region.sectors.end());
+    }
+
+    pool.forEachChunk(
+        regions.size(), 1,
+        [this, width](size_t chunk, size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const Rect& bounds = regions[i].bounds;
+                for (int y = bounds.y0; y < bounds.y1; ++y)
+                {
+                    for (int x = bounds.x0; x < bounds.x1; ++x)
+                    {
+                        int& tile = tiles[y * width + x];
+                        if (tile != WALL) tile += regions[i].firstSector;
+                    }
+                }
+            }
+        });
+
+    // Count the elements of each chunk of rows, then turn the counts into
+    // offsets so that the chunks can be written in parallel
+    size_t rowCount = height + 1;
+    chunkCounts.assign(ThreadPool::getChunkCount(rowCount, ROW_CHUNK_SIZE),
+                       ChunkCounts());
+    pool.forEachChunk(rowCount, ROW_CHUNK_SIZE,
+                      [this](size_t chunk, size_t begin, size_t end)
+                      { countChunk(chunk, begin, end); });
+
+    ChunkCounts total;
+    for (ChunkCounts& counts : chunkCounts)
+    {
+        ChunkCounts offsets = total;
+        total.vertices += counts.vertices;
+        total.lines += counts.lines;
+        total.sides += counts.sides;
+        counts = offsets;
+    }
+
+    data.vertices.resize(total.vertices);
+    data.lines.resize(total.lines);
+    data.sides.resize(total.sides);
+    pointVertices.resize(static_cast<size_t>(width + 1) * (height + 1));
+
+    pool.forEachChunk(rowCount, ROW_CHUNK_SIZE,
+                      [this](size_t chunk, size_t begin, size_t end)
+                      { writeVertices(chunk, begin, end); });
+
+    // Lines end at vertices of other chunks, so they are written once every
+    // vertex is
+    pool.forEachChunk(rowCount, ROW_CHUNK_SIZE,
+                      [this](size_t chunk, size_t begin, size_t end)
+                      { writeLines(chunk, begin, end); });
+
+    lastTime = std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - start)
+                   .count();
+
+    return data;
+}
+
+uint64_t DungeonGenerator::mix(uint64_t key)
+{
+    key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ull;
+    key = (key ^ (key >> 27)) * 0x94d049bb133111ebull;
+    return key ^ (key >> 31);
+}
+
+int DungeonGenerator::getRegionStart(int index, int size, int count)
+{
+    return static_cast<int>(static_cast<int64_t>(size) * index / count);
+}
+
+void DungeonGenerator::generateRegion(int index)
+{
+    Region& region = regions[index];
+    int width = region.bounds.x1 - region.bounds.x0;
+    int height = region.bounds.y1 - region.bounds.y0;
+    Rect bounds = {0, 0, width, height};
+
+    // The sequence of a region only depends on the seed and its index
+    Random random = {settings.seed + mix(2 * static_cast<uint64_t>(index))};
+
+    std::vector<glm::ivec2> doors;
+    getDoors(index, doors);
+
+    std::vector<int> kinds(width * height, WALL);
+    if (settings.style == DungeonStyle::ROOMS)
+        generateRooms(bounds, doors, random, kinds);
+    else
+        generateCaves(bounds, doors, random, kinds);
+
+    std::vector<int> labels;
+    std::vector<int> labelKinds;
+    labelComponents(width, height, kinds, labels, labelKinds);
+
+    region.sectors.clear();
+    for (int kind : labelKinds)
+    {
+        if (kind == CORRIDOR)
+            region.sectors.emplace_back(0.0f, 96.0f, 160);
+        else if (settings.style == DungeonStyle::ROOMS)
+            region.sectors.emplace_back(0.0f, 8.0f * random.nextInt(14, 24),
+                                        random.nextInt(160, 255));
+        else
+            region.sectors.emplace_back(0.0f, 8.0f * random.nextInt(16, 32),
+                                        random.nextInt(96, 192));
+    }
+
+    for (int y = 0; y < height; ++y)
+    {
+        int* row = &tiles[(region.bounds.y0 + y) * settings.width +
+                          region.bounds.x0];
+        std::copy(labels.begin() + y * width, labels.begin() + (y + 1) * width,
+                  row);
+    }
+}
+
+void DungeonGenerator::getDoors(int index, std::vector<glm::ivec2>& doors) const
+{
+    const Rect& bounds = regions[index].bounds;
+    int column = index % regionColumns;
+    int row = index / regionColumns;
+    int width = bounds.x1 - bounds.x0;
+    int height = bounds.y1 - bounds.y0;
+
+    // Both regions of an edge derive its door from the seed and the edge, so
+    // their corridors meet
+    auto getOffset = [this](int edge, int length)
+    {
+        uint64_t key = mix(2 * static_cast<uint64_t>(edge) + 1);
+        return 2 + static_cast<int>(mix(settings.seed + key) % (length - 4));
+    };
+
+    if (column + 1 < regionColumns)
+        doors.push_back({width - 1, getOffset(2 * index, height)});
+    if (column > 0)
+        doors.push_back({0, getOffset(2 * (index - 1), height)});
+    if (row + 1 < regionRows)
+        doors.push_back({getOffset(2 * index + 1, width), height - 1});
+    if (row > 0)
+        doors.push_back(
+            {getOffset(2 * (index - regionColumns) + 1, width), 0});
+}
+
+void DungeonGenerator::generateRooms(const Rect& bounds,
+                                     const std::vector<glm::ivec2>& doors,
+                                     Random& random,
+                                     std::vector<int>& kinds) const
+{
+    std::vector<Rect> rooms;
+    partition(bounds, bounds.x1, random, kinds, rooms);
+    if (rooms.empty()) return;
+
+    // Join each door to the nearest room
+    for (glm::ivec2 door : doors)
+    {
+        glm::ivec2 nearest;
+        int nearestDistance = -1;
+        for (const Rect& room : rooms)
+        {
+            glm::ivec2 center = {(room.x0 + room.x1) / 2,
+                                 (room.y0 + room.y1) / 2};
+            int distance =
+                std::abs(center.x - door.x) + std::abs(center.y - door.y);
+            if (nearestDistance == -1 || distance < nearestDistance)
+            {
+                nearest = center;
+                nearestDistance = distance;
+            }
+        }
+
+        carve(door, nearest, bounds.x1, CORRIDOR, random, kinds);
+    }
+}
+
+int DungeonGenerator::partition(const Rect& leaf, int width, Random& random,
+                                std::vector<int>& kinds,
+                                std::vector<Rect>& rooms) const
+{
+    int leafWidth = leaf.x1 - leaf.x0;
+    int leafHeight = leaf.y1 - leaf.y0;
+    bool canSplitX = leafWidth >= 2 * MIN_LEAF_SIZE;
+    bool canSplitY = leafHeight >= 2 * MIN_LEAF_SIZE;
+
+    if (canSplitX || canSplitY)
+    {
+        // Split across the longer side
+        Rect first = leaf, second = leaf;
+        if (canSplitX && (!canSplitY || leafWidth >= leafHeight))
+        {
+            first.x1 = second.x0 = random.nextInt(
+                leaf.x0 + MIN_LEAF_SIZE, leaf.x1 - MIN_LEAF_SIZE);
+        }
+        else
+        {
+            first.y1 = second.y0 = random.nextInt(
+                leaf.y0 + MIN_LEAF_SIZE, leaf.y1 - MIN_LEAF_SIZE);
+        }
+
+        int firstRoom = partition(first, width, random, kinds, rooms);
+        int secondRoom = partition(second, width, random, kinds, rooms);
+        if (firstRoom == -1 || secondRoom == -1)
+            return firstRoom != -1 ? firstRoom : secondRoom;
+
+        const Rect& a = rooms[firstRoom];
+        const Rect& b = rooms[secondRoom];
+        carve({(a.x0 + a.x1) / 2, (a.y0 + a.y1) / 2},
+              {(b.x0 + b.x1) / 2, (b.y0 + b.y1) / 2}, width, CORRIDOR, random,
+              kinds);
+
+        return random.nextInt(0, 1) ? firstRoom : secondRoom;
+    }
+
+    // Keep a wall around the room inside its leaf
+    if (leafWidth - 2 < MIN_ROOM_SIZE || leafHeight - 2 < MIN_ROOM_SIZE)
+        return -1;
+
+    int roomWidth = random.nextInt(MIN_ROOM_SIZE, leafWidth - 2);
+    int roomHeight = random.nextInt(MIN_ROOM_SIZE, leafHeight - 2);
+    Rect room;
+    room.x0 = random.nextInt(leaf.x0 + 1, leaf.x1 - 1 - roomWidth);
+    room.y0 = random.nextInt(leaf.y0 + 1, leaf.y1 - 1 - roomHeight);
+    room.x1 = room.x0 + roomWidth;
+    room.y1 = room.y0 + roomHeight;
+
+    rooms.push_back(room);
+    int kind = rooms.size();
+    for (int y = room.y0; y < room.y1; ++y)
+        std::fill(kinds.begin() + y * width + room.x0,
+                  kinds.begin() + y * width + room.x1, kind);
+
+    return rooms.size() - 1;
+}
+
+void DungeonGenerator::generateCaves(const Rect& bounds,
+                                     const std::vector<glm::ivec2>& doors,
+                                     Random& random,
+                                     std::vector<int>& kinds) const
+{
+    const int floor = 1;
+    int width = bounds.x1;
+    int height = bounds.y1;
+
+    // Seed the cave with noise inside a border of walls
+    for (int y = 1; y < height - 1; ++y)
+    {
+        for (int x = 1; x < width - 1; ++x)
+        {
+            if (random.nextInt(0, 99) >= CAVE_WALL_CHANCE)
+                kinds[y * width + x] = floor;
+        }
+    }
+
+    // A tile becomes a wall when most of its neighbourhood is walls
+    std::vector<int> next(kinds.size());
+    for (int step = 0; step < CAVE_STEPS; ++step)
+    {
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                int wallCount = 0;
+                for (int dy = -1; dy <= 1; ++dy)
+                {
+                    for (int dx = -1; dx <= 1; ++dx)
+                    {
+                        int nx = x + dx, ny = y + dy;
+                        if (nx <= 0 || ny <= 0 || nx >= width - 1 ||
+                            ny >= height - 1 || kinds[ny * width + nx] == WALL)
+                            ++wallCount;
+                    }
+                }
+
+                next[y * width + x] = wallCount >= 5 ? WALL : floor;
+            }
+        }
+
+        kinds.swap(next);
+    }
+
+    // Keep only the largest cave
+    std::vector<int> labels;
+    std::vector<int> labelKinds;
+    labelComponents(width, height, kinds, labels, labelKinds);
+
+    std::vector<int> sizes(labelKinds.size(), 0);
+    for (int label : labels)
+    {
+        if (label != WALL) ++sizes[label];
+    }
+
+    int largest = std::max_element(sizes.begin(), sizes.end()) - sizes.begin();
+    for (size_t i = 0; i < kinds.size(); ++i)
+        kinds[i] = !sizes.empty() && labels[i] == largest ? floor : WALL;
+
+    if (sizes.empty())
+    {
+        for (int y = height / 2 - 1; y <= height / 2 + 1; ++y)
+            for (int x = width / 2 - 1; x <= width / 2 + 1; ++x)
+                kinds[y * width + x] = floor;
+    }
+
+    // Tunnel from each door to the nearest tile of the cave
+    for (glm::ivec2 door : doors)
+    {
+        glm::ivec2 nearest = door;
+        int nearestDistance = -1;
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                if (kinds[y * width + x] == WALL) continue;
+
+                int distance = std::abs(x - door.x) + std::abs(y - door.y);
+                if (nearestDistance == -1 || distance < nearestDistance)
+                {
+                    nearest = {x, y};
+                    nearestDistance = distance;
+                }
+            }
+        }
+
+        carve(door, nearest, width, floor, random, kinds);
+    }
+}
+
+void DungeonGenerator::carve(glm::ivec2 from, glm::ivec2 to, int width,
+                             int kind, Random& random, std::vector<int>& kinds)
+{
+    auto carveTile = [&](int x, int y)
+    {
+        int& tile = kinds[y * width + x];
+        if (tile == WALL) tile = kind;
+    };
+
+    // Turn at one of the two corners of the bounding box
+    glm::ivec2 corner = random.nextInt(0, 1) ? glm::ivec2(to.x, from.y)
+                                             : glm::ivec2(from.x, to.y);
+
+    for (int x = std::min(from.x, corner.x); x <= std::max(from.x, corner.x);
+         ++x)
+        carveTile(x, from.y);
+    for (int y = std::min(from.y, corner.y); y <= std::max(from.y, corner.y);
+         ++y)
+        carveTile(from.x, y);
+    for (int x = std::min(corner.x, to.x); x <= std::max(corner.x, to.x); ++x)
+        carveTile(x, to.y);
+    for (int y = std::min(corner.y, to.y); y <= std::max(corner.y, to.y); ++y)
+        carveTile(to.x, y);
+}
+
+void DungeonGenerator::labelComponents(int width, int height,
+                                       const std::vector<int>& kinds,
+                                       std::vector<int>& labels,
+                                       std::vector<int>& labelKinds)
+{
+    labels.assign(kinds.size(), WALL);
+    labelKinds.clear();
+
+    std::vector<int> stack;
+    for (size_t start = 0; start < kinds.size(); ++start)
+    {
+        if (kinds[start] == WALL || labels[start] != WALL) continue;
+
+        // Flood the tiles of the same kind
+        int label = labelKinds.size();
+        int kind = kinds[start];
+        labelKinds.push_back(kind);
+        labels[start] = label;
+        stack.push_back(start);
+
+        while (!stack.empty())
+        {
+            int tile = stack.back();
+            stack.pop_back();
+
+            int x = tile % width, y = tile / width;
+            int neighbours[] = {x > 0 ? tile - 1 : -1,
+                                x + 1 < width ? tile + 1 : -1,
+                                y > 0 ? tile - width : -1,
+                                y + 1 < height ? tile + width : -1};
+
+            for (int neighbour : neighbours)
+            {
+                if (neighbour == -1 || kinds[neighbour] != kind ||
+                    labels[neighbour] != WALL)
+                    continue;
+
+                labels[neighbour] = label;
+                stack.push_back(neighbour);
+            }
+        }
+    }
+}
+
+bool DungeonGenerator::isVertex(int x, int y) const
+{
+    int a = getTile(x - 1, y - 1), b = getTile(x, y - 1);
+    int c = getTile(x - 1, y), d = getTile(x, y);
+
+    bool right = b != d, left = a != c;
+    bool up = c != d, down = a != b;
+
+    // A line running straight through the point only needs a vertex where it
+    // meets another line
+    if (left && right && !up && !down) return false;
+    if (up && down && !left && !right) return false;
+
+    return left || right || up || down;
+}
+
+void DungeonGenerator::countChunk(size_t chunk, size_t begin, size_t end)
+{
+    ChunkCounts& counts = chunkCounts[chunk];
+
+    for (int y = begin; y < static_cast<int>(end); ++y)
+    {
+        for (int x = 0; x <= settings.width; ++x)
+        {
+            if (!isVertex(x, y)) continue;
+
+            ++counts.vertices;
+
+            // A line has a side in every sector next to it
+            if (hasRightEdge(x, y))
+            {
+                ++counts.lines;
+                counts.sides += (getTile(x, y - 1) != WALL) +
+                                (getTile(x, y) != WALL);
+            }
+
+            if (hasUpEdge(x, y))
+            {
+                ++counts.lines;
+                counts.sides += (getTile(x - 1, y) != WALL) +
+                                (getTile(x, y) != WALL);
+            }
+        }
+    }
+}
+
+void DungeonGenerator::writeVertices(size_t chunk, size_t begin, size_t end)
+{
+    size_t vertex = chunkCounts[chunk].vertices;
+    size_t pointWidth = settings.width + 1;
+
+    for (int y = begin; y < static_cast<int>(end); ++y)
+    {
+        for (int x = 0; x <= settings.width; ++x)
+        {
+            if (!isVertex(x, y)) continue;
+
+            pointVertices[y * pointWidth + x] = vertex;
+            data.vertices[vertex++] =
+                LineVertex(x * settings.tileSize, y * settings.tileSize);
+        }
+    }
+}
+
+void DungeonGenerator::writeLines(size_t chunk, size_t begin, size_t end)
+{
+    size_t line = chunkCounts[chunk].lines;
+    size_t side = chunkCounts[chunk].sides;
+    size_t pointWidth = settings.width + 1;
+
+    // Lines have their front side in a sector, which is on their right
+    auto addLine = [&](int start, int end, int front, int back)
+    {
+        int frontSide = side;
+        data.sides[side++] = Side(front);
+
+        int backSide = -1;
+        if (back != WALL)
+        {
+            backSide = side;
+            data.sides[side++] = Side(back);
+        }
+
+        data.lines[line++] = Line(start, end, frontSide, backSide);
+    };
+
+    for (int y = begin; y < static_cast<int>(end); ++y)
+    {
+        for (int x = 0; x <= settings.width; ++x)
+        {
+            if (!isVertex(x, y)) continue;
+
+            int vertex = pointVertices[y * pointWidth + x];
+
+            if (hasRightEdge(x, y))
+            {
+                int endX = x + 1;
+                while (!isVertex(endX, y)) ++endX;
+                int endVertex = pointVertices[y * pointWidth + endX];
+
+                int below = getTile(x, y - 1), above = getTile(x, y);
+                if (below != WALL)
+                    addLine(vertex, endVertex, below, above);
+                else
+                    addLine(endVertex, vertex, above, WALL);
+            }
+
+            if (hasUpEdge(x, y))
+            {
+                int endY = y + 1;
+                while (!isVertex(x, endY)) ++endY;
+                int endVertex = pointVertices[endY * pointWidth + x];
+
+                int left = getTile(x - 1, y), right = getTile(x, y);
+                if (right != WALL)
+                    addLine(vertex, endVertex, right, left);
+                else
+                    addLine(endVertex, vertex, left, WALL);
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,396 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "../utils/ThreadPool.h"
+#include "MapData.h"
+
+/**
+ * @brief An enum representing the kinds of maps the dungeon generator makes.
+ */
+enum class DungeonStyle : uint8_t
+{
+    // Rooms partitioned by a BSP tree and joined by corridors
+    ROOMS,
+    // Caves grown by a cellular automaton
+    CAVES
+};
+
+/**
+ * @brief A struct holding the settings of a generated dungeon.
+ */
+struct DungeonSettings
+{
+    // The seed the whole map is derived from
+    uint64_t seed = 1;
+    // The kind of map to generate
+    DungeonStyle style = DungeonStyle::ROOMS;
+    // The width of the map in tiles
+    int width = 128;
+    // The height of the map in tiles
+    int height = 128;
+    // The side length of a tile in world units
+    float tileSize = 40.0f;
+};
+
+/**
+ * @brief A class that generates dungeon maps from a seed.
+ *
+ * The map is laid out on a grid of tiles split into regions, and each region
+ * is generated on its own, with a random generator seeded from the map seed
+ * and the index of the region. Neighbouring regions are joined by corridors
+ * through doors whose positions are derived from the seed alone, so regions
+ * can be generated on any number of threads in any order. Every connected
+ * group of tiles of a room, corridor or cave becomes a sector.
+ *
+ * The lines are then traced along the edges between tiles of different
+ * sectors, merging straight runs into single lines. Tracing is split into
+ * chunks of rows that are counted, given their offsets in the arrays and then
+ * written, so the output is the same byte for byte whatever the number of
+ * threads. Every line has its front side in a sector, and the lines between
+ * two sectors have a back side in the other one.
+ */
+class DungeonGenerator
+{
+public:
+    // The smallest width and height of a map in tiles
+    static constexpr int MIN_SIZE = 16;
+
+    /**
+     * @brief Constructs a new DungeonGenerator object.
+     *
+     * @param pool The thread pool the generation runs on.
+     */
+    explicit DungeonGenerator(ThreadPool& pool);
+
+    DungeonGenerator(const DungeonGenerator&) = delete;
+    DungeonGenerator& operator=(const DungeonGenerator&) = delete;
+
+    /**
+     * @brief Gets the largest width and height of a map in tiles whose
+     * vertices fit the range of map coordinates.
+     *
+     * @param tileSize The side length of a tile in world units.
+     * @return The largest size.
+     */
+    static int getMaxSize(float tileSize);
+
+    /**
+     * @brief Generates a map.
+     *
+     * @param settings The settings of the map. Sizes below the minimum size
+     * are raised to it, and sizes above the maximum size are lowered to it
+     * with a warning.
+     * @return The elements of the map, which refer to each other by position.
+     * The data is reused by the next call.
+     */
+    const MapData& generate(const DungeonSettings& settings);
+
+    /**
+     * @brief Gets the elements of the last generated map.
+     *
+     * @return The elements.
+     */
+    inline const MapData& getData() const { return data; }
+
+    /**
+     * @brief Gets the time the last generation took.
+     *
+     * @return The time in milliseconds.
+     */
+    inline double getLastTime() const { return lastTime; }
+
+private:
+    // The target width and height of a region in tiles
+    static constexpr int REGION_SIZE = 64;
+    // The number of rows of grid points traced per chunk
+    static constexpr size_t ROW_CHUNK_SIZE = 32;
+    // The smallest width and height of a BSP leaf in tiles
+    static constexpr int MIN_LEAF_SIZE = 10;
+    // The smallest width and height of a room in tiles
+    static constexpr int MIN_ROOM_SIZE = 4;
+    // The chance in percent that a cave tile starts as a wall
+    static constexpr int CAVE_WALL_CHANCE = 45;
+    // The number of steps the cave automaton runs for
+    static constexpr int CAVE_STEPS = 4;
+    // The kind or label of a wall tile
+    static constexpr int WALL = -1;
+    // The kind of a corridor tile, while rooms and caves count up from 1
+    static constexpr int CORRIDOR = 0;
+
+    /**
+     * @brief A struct representing a deterministic random number generator.
+     *
+     * The generator is a SplitMix64 sequence, so it produces the same numbers
+     * on every platform.
+     */
+    struct Random
+    {
+        // The state of the generator
+        uint64_t state;
+
+        /**
+         * @brief Gets the next number of the sequence.
+         *
+         * @return The number.
+         */
+        inline uint64_t next() { return mix(state += 0x9e3779b97f4a7c15ull); }
+
+        /**
+         * @brief Gets a number in a range.
+         *
+         * @param min The smallest number.
+         * @param max The largest number, which must not be below the smallest.
+         * @return The number.
+         */
+        inline int nextInt(int min, int max)
+        {
+            return min + static_cast<int>(next() % (max - min + 1));
+        }
+    };
+
+    /**
+     * @brief A struct representing a rectangle of tiles.
+     */
+    struct Rect
+    {
+        // The first column
+        int x0;
+        // The first row
+        int y0;
+        // One past the last column
+        int x1;
+        // One past the last row
+        int y1;
+    };
+
+    /**
+     * @brief A struct representing a region of the map being generated.
+     */
+    struct Region
+    {
+        // The tiles of the region
+        Rect bounds;
+        // The sectors of the region, by local label
+        std::vector<Sector> sectors;
+        // The index of the first sector of the region in the map
+        int firstSector = 0;
+    };
+
+    /**
+     * @brief A struct representing the number of elements traced by a chunk
+     * of rows, which becomes their offset once summed.
+     */
+    struct ChunkCounts
+    {
+        // The number of vertices
+        size_t vertices = 0;
+        // The number of lines
+        size_t lines = 0;
+        // The number of sides
+        size_t sides = 0;
+    };
+
+    // The thread pool the generation runs on
+    ThreadPool& pool;
+    // The elements of the last generated map
+    MapData data;
+    // The time the last generation took in milliseconds
+    double lastTime = 0.0;
+    // The settings of the map being generated
+    DungeonSettings settings;
+    // The number of columns of regions
+    int regionColumns = 0;
+    // The number of rows of regions
+    int regionRows = 0;
+    // The regions, row by row
+    std::vector<Region> regions;
+    // The sector of each tile row by row, or WALL
+    std::vector<int> tiles;
+    // The vertex at each grid point row by row, where there is one
+    std::vector<uint32_t> pointVertices;
+    // The counts, then the offsets, of the elements of each chunk of rows
+    std::vector<ChunkCounts> chunkCounts;
+
+    /**
+     * @brief Gets a number that depends on every bit of a key.
+     *
+     * @param key The key.
+     * @return The number.
+     */
+    static uint64_t mix(uint64_t key);
+
+    /**
+     * @brief Gets the first column or row of a region.
+     *
+     * @param index The column or row of the region, or the number of regions
+     * to get the size of the map.
+     * @param size The width or height of the map.
+     * @param count The number of columns or rows of regions.
+     * @return The first column or row.
+     */
+    static int getRegionStart(int index, int size, int count);
+
+    /**
+     * @brief Generates the tiles of a region and labels its sectors.
+     *
+     * @param index The index of the region.
+     */
+    void generateRegion(int index);
+
+    /**
+     * @brief Gets the tiles of a region next to the doors to its
+     * neighbours.
+     *
+     * @param index The index of the region.
+     * @param doors Set to the door tiles, relative to the region.
+     */
+    void getDoors(int index, std::vector<glm::ivec2>& doors) const;
+
+    /**
+     * @brief Fills a region with rooms partitioned by a BSP tree and joined by
+     * corridors.
+     *
+     * @param bounds The size of the region, relative to itself.
+     * @param doors The door tiles of the region.
+     * @param random The random generator of the region.
+     * @param kinds The kind of each tile, which start as walls.
+     */
+    void generateRooms(const Rect& bounds, const std::vector<glm::ivec2>& doors,
+                       Random& random, std::vector<int>& kinds) const;
+
+    /**
+     * @brief Splits a BSP leaf until it is small enough, places a room in
+     * each final leaf and joins the rooms of sibling leaves.
+     *
+     * @param leaf The tiles of the leaf.
+     * @param width The width of the region.
+     * @param random The random generator of the region.
+     * @param kinds The kind of each tile.
+     * @param rooms The rooms placed so far, extended with the new rooms.
+     * @return The index of a room of the leaf, or -1 if it has none.
+     */
+    int partition(const Rect& leaf, int width, Random& random,
+                  std::vector<int>& kinds, std::vector<Rect>& rooms) const;
+
+    /**
+     * @brief Fills a region with a cave grown by a cellular automaton.
+     *
+     * Only the largest connected cave is kept, and the doors are tunnelled
+     * to it.
+     *
+     * @param bounds The size of the region, relative to itself.
+     * @param doors The door tiles of the region.
+     * @param random The random generator of the region.
+     * @param kinds The kind of each tile.
+     */
+    void generateCaves(const Rect& bounds, const std::vector<glm::ivec2>& doors,
+                       Random& random, std::vector<int>& kinds) const;
+
+    /**
+     * @brief Carves an L-shaped corridor through the walls between two tiles.
+     *
+     * @param from The first tile.
+     * @param to The last tile.
+     * @param width The width of the region.
+     * @param kind The kind given to the carved tiles.
+     * @param random The random generator of the region.
+     * @param kinds The kind of each tile.
+     */
+    static void carve(glm::ivec2 from, glm::ivec2 to, int width, int kind,
+                      Random& random, std::vector<int>& kinds);
+
+    /**
+     * @brief Gives the same label to the 4-connected tiles of the same kind.
+     *
+     * @param width The width of the region.
+     * @param height The height of the region.
+     * @param kinds The kind of each tile.
+     * @param labels Set to the label of each tile, or WALL.
+     * @param labelKinds Set to the kind of each label.
+     */
+    static void labelComponents(int width, int height,
+                                const std::vector<int>& kinds,
+                                std::vector<int>& labels,
+                                std::vector<int>& labelKinds);
+
+    /**
+     * @brief Gets the sector of a tile.
+     *
+     * @param x The column of the tile.
+     * @param y The row of the tile.
+     * @return The sector, or WALL if the tile is a wall or outside the map.
+     */
+    inline int getTile(int x, int y) const
+    {
+        if (x < 0 || y < 0 || x >= settings.width || y >= settings.height)
+            return WALL;
+        return tiles[y * settings.width + x];
+    }
+
+    /**
+     * @brief Checks if a line runs right from a grid point.
+     *
+     * @param x The column of the point.
+     * @param y The row of the point.
+     * @return True if the tiles below and above the edge differ.
+     */
+    inline bool hasRightEdge(int x, int y) const
+    {
+        return getTile(x, y - 1) != getTile(x, y);
+    }
+
+    /**
+     * @brief Checks if a line runs up from a grid point.
+     *
+     * @param x The column of the point.
+     * @param y The row of the point.
+     * @return True if the tiles left and right of the edge differ.
+     */
+    inline bool hasUpEdge(int x, int y) const
+    {
+        return getTile(x - 1, y) != getTile(x, y);
+    }
+
+    /**
+     * @brief Checks if a grid point is a vertex, which is where lines meet
+     * unless they continue straight between the same sectors.
+     *
+     * @param x The column of the point.
+     * @param y The row of the point.
+     * @return True if the point is a vertex.
+     */
+    bool isVertex(int x, int y) const;
+
+    /**
+     * @brief Counts the vertices, lines and sides traced from a chunk of
+     * rows of grid points.
+     *
+     * @param chunk The index of the chunk.
+     * @param begin The first row.
+     * @param end One past the last row.
+     */
+    void countChunk(size_t chunk, size_t begin, size_t end);
+
+    /**
+     * @brief Writes the vertices of a chunk of rows of grid points.
+     *
+     * @param chunk The index of the chunk.
+     * @param begin The first row.
+     * @param end One past the last row.
+     */
+    void writeVertices(size_t chunk, size_t begin, size_t end);
+
+    /**
+     * @brief Writes the lines and sides that start in a chunk of rows of grid
+     * points.
+     *
+     * @param chunk The index of the chunk.
+     * @param begin The first row.
+     * @param end One past the last row.
+     */
+    void writeLines(size_t chunk, size_t begin, size_t end);
+};
\ No newline at end of file
@@ -0,0 +1,249 @@
+#include "EditHistory.h"
+
+#include "../utils/macros.h"
+#include "Map.h"
+
+/**
+ * @brief Gets the type of the element edited by a command.
+ *
+ * @param type The type of the command.
+ * @return The type of the element.
+ */
+static ElementType getElementType(MapCommandType type)
+{
+    switch (type)
+    {
+        case MapCommandType::ADD_VERTEX:
+        case MapCommandType::REMOVE_VERTEX:
+        case MapCommandType::MOVE_VERTEX:
+            return ElementType::VERTEX;
+        case MapCommandType::ADD_LINE:
+        case MapCommandType::REMOVE_LINE:
+        case MapCommandType::CHANGE_LINE:
+            return ElementType::LINE;
+        case MapCommandType::ADD_SIDE:
+        case MapCommandType::REMOVE_SIDE:
+        case MapCommandType::CHANGE_SIDE:
+            return ElementType::SIDE;
+        default:
+            return ElementType::SECTOR;
+    }
+}
+
+void EditHistory::beginTransaction() { ++depth; }
+
+void EditHistory::endTransaction()
+{
+    ASSERT(depth > 0);
+
+    if (--depth == 0) commit();
+}
+
+bool EditHistory::undo(Map& map)
+{
+    if (!canUndo()) return false;
+
+    std::vector<MapCommand> transaction = std::move(undoStack.back());
+    undoStack.pop_back();
+
+    isReplaying = true;
+    for (auto it = transaction.rbegin(); it != transaction.rend(); ++it)
+        it->revert(map);
+    isReplaying = false;
+
+    redoStack.push_back(std::move(transaction));
+    return true;
+}
+
+bool EditHistory::redo(Map& map)
+{
+    if (!canRedo()) return false;
+
+    std::vector<MapCommand> transaction = std::move(redoStack.back());
+    redoStack.pop_back();
+
+    isReplaying = true;
+    for (const MapCommand& command : transaction) command.apply(map);
+    isReplaying = false;
+
+    undoStack.push_back(std::move(transaction));
+    return true;
+}
+
+void EditHistory::clear()
+{
+    undoStack.clear();
+    redoStack.clear();
+    pending.clear();
+    memoryUsage = 0;
+}
+
+void EditHistory::suspend()
+{
+    ASSERT(depth == 0 && !isSuspended);
+
+    isSuspended = true;
+}
+
+void EditHistory::resume()
+{
+    ASSERT(isSuspended);
+
+    isSuspended = false;
+
+    // Undoing reaches a transaction only through the newer ones, so the
+    // older transactions go with the newest one that must be dropped
+    for (size_t i = undoStack.size(); i-- > 0;)
+    {
+        if (!refersToSuspendedEdits(undoStack[i])) continue;
+
+        for (size_t j = 0; j <= i; ++j) memoryUsage -= getSize(undoStack[j]);
+        undoStack.erase(undoStack.begin(), undoStack.begin() + i + 1);
+        break;
+    }
+
+    // The next transaction to redo is the last one
+    for (size_t i = redoStack.size(); i-- > 0;)
+    {
+        if (!refersToSuspendedEdits(redoStack[i])) continue;
+
+        for (size_t j = 0; j <= i; ++j) memoryUsage -= getSize(redoStack[j]);
+        redoStack.erase(redoStack.begin(), redoStack.begin() + i + 1);
+        break;
+    }
+
+    for (std::unordered_set<int>& indices : suspendedEdits) indices.clear();
+}
+
+void EditHistory::setMemoryBudget(size_t budget)
+{
+    memoryBudget = budget;
+    evict();
+}
+
+void EditHistory::onVertexMoved(int vertex, glm::vec2 from, glm::vec2 to)
+{
+    if (isReplaying) return;
+
+    // Merge a drag into the command that added or last moved the vertex
+    if (depth > 0 && !pending.empty())
+    {
+        MapCommand& last = pending.back();
+        if (last.index == vertex && (last.type == MapCommandType::MOVE_VERTEX ||
+                                     last.type == MapCommandType::ADD_VERTEX))
+        {
+            last.payload.vertex.to = to;
+            return;
+        }
+    }
+
+    MapCommandRecorder::onVertexMoved(vertex, from, to);
+}
+
+void EditHistory::onMapLoaded(const MapStore& store)
+{
+    // The recorded indices refer to the elements of the previous map
+    clear();
+}
+
+void EditHistory::record(const MapCommand& command)
+{
+    // Commands applied by undo and redo are already in the history
+    if (isReplaying) return;
+
+    if (isSuspended)
+    {
+        suspendedEdits[static_cast<size_t>(getElementType(command.type))]
+            .insert(command.index);
+        return;
+    }
+
+    pending.push_back(command);
+    if (depth == 0) commit();
+}
+
+bool EditHistory::refersToSuspendedEdits(
+    const std::vector<MapCommand>& transaction) const
+{
+    // Checks if an element was edited while the history was suspended
+    auto isEdited = [this](ElementType type, int index)
+    {
+        return index != -1 &&
+               suspendedEdits[static_cast<size_t>(type)].count(index) > 0;
+    };
+
+    // Checks if a line references such an element
+    auto isLineAffected = [&isEdited](const Line& line)
+    {
+        return isEdited(ElementType::VERTEX, line.startVertex) ||
+               isEdited(ElementType::VERTEX, line.endVertex) ||
+               isEdited(ElementType::SIDE, line.front) ||
+               isEdited(ElementType::SIDE, line.back);
+    };
+
+    for (const MapCommand& command : transaction)
+    {
+        // Paging never touches the instances of prefabs
+        if (command.type == MapCommandType::ADD_INSTANCE ||
+            command.type == MapCommandType::REMOVE_INSTANCE)
+            continue;
+
+        if (isEdited(getElementType(command.type), command.index)) return true;
+
+        // Additions record only the new value and removals the old one
+        MapCommandType type = command.type;
+        bool hasFrom = type != MapCommandType::ADD_LINE &&
+                       type != MapCommandType::ADD_SIDE;
+        bool hasTo = type != MapCommandType::REMOVE_LINE &&
+                     type != MapCommandType::REMOVE_SIDE;
+
+        const MapCommand::Payload& payload = command.payload;
+        switch (getElementType(type))
+        {
+            case ElementType::LINE:
+                if ((hasFrom && isLineAffected(payload.line.from)) ||
+                    (hasTo && isLineAffected(payload.line.to)))
+                    return true;
+                break;
+            case ElementType::SIDE:
+                if ((hasFrom &&
+                     isEdited(ElementType::SECTOR, payload.side.from.sector)) ||
+                    (hasTo &&
+                     isEdited(ElementType::SECTOR, payload.side.to.sector)))
+                    return true;
+                break;
+            default:
+                break;
+        }
+    }
+
+    return false;
+}
+
+void EditHistory::commit()
+{
+    if (pending.empty()) return;
+
+    // A new edit makes the undone transactions unreachable
+    for (const std::vector<MapCommand>& transaction : redoStack)
+        memoryUsage -= getSize(transaction);
+    redoStack.clear();
+
+    // Drop the slack left by growing the transaction
+    std::vector<MapCommand> transaction(pending.begin(), pending.end());
+    pending.clear();
+
+    memoryUsage += getSize(transaction);
+    undoStack.push_back(std::move(transaction));
+
+    evict();
+}
+
+void EditHistory::evict()
+{
+    while (memoryUsage > memoryBudget && undoStack.size() > 1)
+    {
+        memoryUsage -= getSize(undoStack.front());
+        undoStack.pop_front();
+    }
+}
\ No newline at end of file
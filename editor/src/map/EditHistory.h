@@ -0,0 +1,205 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <deque>
+#include <unordered_set>
+#include <vector>
+
+#include "MapCommand.h"
+#include "MapCommandRecorder.h"
+#include "MapElement.h"
+
+class Map;
+
+/**
+ * @brief A class that records the edits made to a map for undo and redo.
+ *
+ * This class listens to a map and records every primitive edit as a
+ * MapCommand. Edits made between beginTransaction and endTransaction are
+ * grouped into one transaction that is undone and redone as a whole; edits
+ * made outside of a transaction form a transaction of their own. Undoing
+ * reverts the commands of the last transaction in reverse order, so the cost
+ * of an undo is proportional to the size of the edit rather than the size of
+ * the map.
+ *
+ * Consecutive moves of the same vertex are merged into one command, and the
+ * oldest transactions are evicted once the history exceeds its memory budget.
+ *
+ * Edits that are not the user's, such as chunks paged in and out of the map,
+ * are made with the history suspended. They are not recorded, but the slots
+ * they touch may since hold other elements, so the transactions referring to
+ * those slots are dropped when the history resumes.
+ */
+class EditHistory : public MapCommandRecorder
+{
+public:
+    // The default memory budget of the history in bytes
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = 64 * 1024 * 1024;
+
+    /**
+     * @brief Constructs a new EditHistory object.
+     *
+     * @param memoryBudget The number of bytes the history may use before old
+     * transactions are evicted. Defaults to DEFAULT_MEMORY_BUDGET.
+     */
+    explicit EditHistory(size_t memoryBudget = DEFAULT_MEMORY_BUDGET)
+        : memoryBudget(memoryBudget)
+    {
+    }
+
+    /**
+     * @brief Starts a transaction.
+     *
+     * Transactions may be nested, in which case only the outermost one is
+     * recorded.
+     */
+    void beginTransaction();
+
+    /**
+     * @brief Ends the current transaction.
+     *
+     * Ending the outermost transaction commits its edits to the history, or
+     * discards it if it has no edits.
+     */
+    void endTransaction();
+
+    /**
+     * @brief Reverts the last transaction.
+     *
+     * @param map The map the transaction was recorded from.
+     * @return True if a transaction was reverted, false otherwise.
+     */
+    bool undo(Map& map);
+
+    /**
+     * @brief Reapplies the last reverted transaction.
+     *
+     * @param map The map the transaction was recorded from.
+     * @return True if a transaction was reapplied, false otherwise.
+     */
+    bool redo(Map& map);
+
+    /**
+     * @brief Checks if there is a transaction to undo.
+     *
+     * @return True if undo would do something, false otherwise.
+     */
+    inline bool canUndo() const { return depth == 0 && !undoStack.empty(); }
+
+    /**
+     * @brief Checks if there is a transaction to redo.
+     *
+     * @return True if redo would do something, false otherwise.
+     */
+    inline bool canRedo() const { return depth == 0 && !redoStack.empty(); }
+
+    /**
+     * @brief Removes every transaction from the history.
+     */
+    void clear();
+
+    /**
+     * @brief Stops recording edits until resume is called.
+     *
+     * No transaction may be open.
+     */
+    void suspend();
+
+    /**
+     * @brief Resumes recording edits.
+     *
+     * The transactions referring to an element added, removed or changed
+     * while the history was suspended are dropped, along with the older
+     * transactions to undo and the later transactions to redo, which can
+     * only be replayed after them.
+     */
+    void resume();
+
+    /**
+     * @brief Gets the number of bytes used by the history.
+     *
+     * @return The memory usage of the history.
+     */
+    inline size_t getMemoryUsage() const { return memoryUsage; }
+
+    /**
+     * @brief Sets the number of bytes the history may use.
+     *
+     * @param budget The memory budget in bytes.
+     */
+    void setMemoryBudget(size_t budget);
+
+    void onVertexMoved(int vertex, glm::vec2 from, glm::vec2 to) override;
+
+    void onMapLoaded(const MapStore& store) override;
+
+private:
+    // The number of element types
+    static constexpr size_t ELEMENT_TYPE_COUNT = 4;
+
+    // The transactions that can be undone, oldest first
+    std::deque<std::vector<MapCommand>> undoStack;
+    // The transactions that can be redone, most recently undone last
+    std::vector<std::vector<MapCommand>> redoStack;
+    // The commands of the open transaction
+    std::vector<MapCommand> pending;
+    // The nesting depth of the open transaction
+    int depth = 0;
+    // Whether the history is applying commands itself
+    bool isReplaying = false;
+    // Whether edits are made without being recorded
+    bool isSuspended = false;
+    // The indices of the elements edited while the history was suspended, by
+    // element type
+    std::array<std::unordered_set<int>, ELEMENT_TYPE_COUNT> suspendedEdits;
+    // The number of bytes used by the recorded transactions
+    size_t memoryUsage = 0;
+    // The number of bytes the history may use
+    size_t memoryBudget;
+
+    /**
+     * @brief Records a command in the open transaction.
+     *
+     * If no transaction is open, the command is committed on its own.
+     *
+     * @param command The command to record.
+     */
+    void record(const MapCommand& command) override;
+
+    /**
+     * @brief Checks if a transaction refers to an element edited while the
+     * history was suspended.
+     *
+     * @param transaction The transaction.
+     * @return True if a command of the transaction edits or references such
+     * an element, false otherwise.
+     */
+    bool refersToSuspendedEdits(
+        const std::vector<MapCommand>& transaction) const;
+
+    /**
+     * @brief Commits the open transaction to the undo stack.
+     */
+    void commit();
+
+    /**
+     * @brief Evicts the oldest transactions until the history fits in its
+     * memory budget.
+     *
+     * The most recent transaction is always kept.
+     */
+    void evict();
+
+    /**
+     * @brief Gets the number of bytes used by a transaction.
+     *
+     * @param transaction The transaction.
+     * @return The memory usage of the transaction.
+     */
+    static inline size_t getSize(const std::vector<MapCommand>& transaction)
+    {
+        return sizeof(transaction) +
+               transaction.capacity() * sizeof(MapCommand);
+    }
+};
\ No newline at end of file
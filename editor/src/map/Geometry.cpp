@@ -0,0 +1,149 @@
+#include "Geometry.h"
+
+#include <cmath>
+#include <limits>
+
+/**
+ * @brief Adds two doubles exactly.
+ *
+ * @param a The first double.
+ * @param b The second double.
+ * @param error Set to the rounding error of the sum, so that the sum plus the
+ * error is exactly a + b.
+ * @return The rounded sum.
+ */
+static double twoSum(double a, double b, double& error)
+{
+    double sum = a + b;
+    double bVirtual = sum - a;
+    double aVirtual = sum - bVirtual;
+    error = (a - aVirtual) + (b - bVirtual);
+    return sum;
+}
+
+/**
+ * @brief Gets the sign of the exact sum of doubles.
+ *
+ * The doubles are accumulated into a nonoverlapping expansion, whose sign is
+ * the sign of its largest nonzero component.
+ *
+ * @param terms The doubles.
+ * @param count The number of doubles.
+ * @return 1 if the sum is positive, -1 if it is negative and 0 if it is zero.
+ */
+static int getExactSign(const double* terms, int count)
+{
+    // An expansion of n terms needs at most n components
+    double expansion[8];
+    int size = 0;
+
+    for (int i = 0; i < count; ++i)
+    {
+        double carry = terms[i];
+        for (int j = 0; j < size; ++j)
+            carry = twoSum(carry, expansion[j], expansion[j]);
+        expansion[size++] = carry;
+    }
+
+    for (int i = size - 1; i >= 0; --i)
+    {
+        if (expansion[i] > 0.0) return 1;
+        if (expansion[i] < 0.0) return -1;
+    }
+
+    return 0;
+}
+
+int Geometry::orient(glm::vec2 a, glm::vec2 b, glm::vec2 c)
+{
+    double ax = a.x, ay = a.y, bx = b.x, by = b.y, cx = c.x, cy = c.y;
+
+    double left = (ax - cx) * (by - cy);
+    double right = (ay - cy) * (bx - cx);
+    double det = left - right;
+
+    // Shewchuk's error bound for the determinant evaluated in doubles
+    constexpr double EPSILON = std::numeric_limits<double>::epsilon() / 2.0;
+    constexpr double ERROR_BOUND = (3.0 + 16.0 * EPSILON) * EPSILON;
+    double bound = ERROR_BOUND * (std::abs(left) + std::abs(right));
+    if (det > bound) return 1;
+    if (det < -bound) return -1;
+
+    // The product of two floats is exact in a double, so expanding the
+    // determinant into such products makes it an exact sum
+    double terms[] = {ax * by, -ax * cy, -cx * by, -ay * bx, ay * cx, cy * bx};
+    return getExactSign(terms, 6);
+}
+
+Geometry::ContactType Geometry::getContact(glm::vec2 a, glm::vec2 b,
+                                           glm::vec2 c, glm::vec2 d,
+                                           glm::dvec2& point)
+{
+    // Points have no interior to touch
+    if (a == b || c == d) return ContactType::NONE;
+
+    int abc = orient(a, b, c);
+    int abd = orient(a, b, d);
+
+    if (abc == 0 && abd == 0)
+    {
+        // Compare the collinear segments along their longer axis
+        int axis = std::abs(b.x - a.x) >= std::abs(b.y - a.y) ? 0 : 1;
+        float low = std::max(std::min(a[axis], b[axis]),
+                             std::min(c[axis], d[axis]));
+        float high = std::min(std::max(a[axis], b[axis]),
+                              std::max(c[axis], d[axis]));
+
+        // Segments that meet at a single point share an endpoint
+        if (low >= high) return ContactType::NONE;
+
+        // The overlap starts at a if it lies on the other segment, and
+        // otherwise at the end of the other segment closest to a
+        glm::vec2 start = a;
+        if (a[axis] < low || a[axis] > high)
+        {
+            float distanceC = glm::distance(a, c);
+            float distanceD = glm::distance(a, d);
+            start = distanceC <= distanceD ? c : d;
+        }
+
+        point = start;
+        return ContactType::OVERLAPPING;
+    }
+
+    int cda = orient(c, d, a);
+    int cdb = orient(c, d, b);
+
+    // Either segment lies strictly on one side of the other's line
+    if (abc * abd > 0 || cda * cdb > 0) return ContactType::NONE;
+
+    if (abc != 0 && abd != 0 && cda != 0 && cdb != 0)
+    {
+        glm::dvec2 start = a, direction = glm::dvec2(b) - start;
+        glm::dvec2 otherStart = c, otherDirection = glm::dvec2(d) - otherStart;
+        glm::dvec2 offset = otherStart - start;
+
+        double denominator = direction.x * otherDirection.y -
+                             direction.y * otherDirection.x;
+        double t =
+            (offset.x * otherDirection.y - offset.y * otherDirection.x) /
+            denominator;
+
+        point = start + t * direction;
+        return ContactType::CROSSING;
+    }
+
+    // An endpoint on the other segment, unless the endpoints coincide
+    if (abc == 0 && c != a && c != b)
+        point = c;
+    else if (abd == 0 && d != a && d != b)
+        point = d;
+    else if (cda == 0 && a != c && a != d)
+        point = a;
+    else if (cdb == 0 && b != c && b != d)
+        point = b;
+    else
+        return ContactType::NONE;
+
+    return ContactType::TOUCHING;
+}
\ No newline at end of file
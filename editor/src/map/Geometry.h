@@ -0,0 +1,57 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+/**
+ * @brief Geometric predicates on the positions of map elements.
+ *
+ * The predicates are exact for any float coordinates: they are evaluated in
+ * double precision with an error bound, and only fall back to exact
+ * arithmetic on floating-point expansions when the rounded result is too
+ * close to zero to trust. This keeps their answers consistent with each other
+ * at any scale, so that a crossing reported from one line is also reported
+ * from the other.
+ */
+namespace Geometry
+{
+    /**
+     * @brief An enum class representing how two segments touch.
+     */
+    enum class ContactType
+    {
+        // The segments do not touch, or only share an endpoint
+        NONE,
+        // The interiors of the segments cross at a single point
+        CROSSING,
+        // An endpoint of one segment lies in the interior of the other
+        TOUCHING,
+        // The segments are collinear and share more than a point
+        OVERLAPPING
+    };
+
+    /**
+     * @brief Gets the orientation of three points.
+     *
+     * @param a The first point.
+     * @param b The second point.
+     * @param c The third point.
+     * @return 1 if the points turn counter-clockwise, -1 if they turn
+     * clockwise and 0 if they are collinear.
+     */
+    int orient(glm::vec2 a, glm::vec2 b, glm::vec2 c);
+
+    /**
+     * @brief Classifies the contact between two segments.
+     *
+     * @param a The start of the first segment.
+     * @param b The end of the first segment.
+     * @param c The start of the second segment.
+     * @param d The end of the second segment.
+     * @param point Set to the contact point: the crossing, rounded to double
+     * precision, the touching endpoint, or the end of the overlap nearest to
+     * a. Left unchanged if the segments do not touch.
+     * @return The type of the contact.
+     */
+    ContactType getContact(glm::vec2 a, glm::vec2 b, glm::vec2 c, glm::vec2 d,
+                           glm::dvec2& point);
+}  // namespace Geometry
\ No newline at end of file
@@ -0,0 +1,227 @@
+#include "IntersectionSweep.h"
+
+#include <algorithm>
+#include <iterator>
+
+using Geometry::ContactType;
+
+IntersectionSweep::IntersectionSweep() : status(EntryOrder{this}) {}
+
+const std::vector<LinePair>& IntersectionSweep::findPairs(
+    const MapStore& store)
+{
+    const std::vector<Line>& lines = store.getLines();
+    const std::vector<uint32_t>& lineIndices = store.getLineIndices();
+
+    segments.clear();
+    segments.reserve(lines.size());
+    reported.clear();
+    pairs.clear();
+
+    for (size_t i = 0; i < lines.size(); ++i)
+    {
+        const LineVertex& start = store.getVertex(lines[i].startVertex);
+        const LineVertex& end = store.getVertex(lines[i].endVertex);
+        glm::vec2 left = {start.x, start.y}, right = {end.x, end.y};
+
+        // Lines without length cannot touch anything
+        if (left == right) continue;
+
+        if (right.x < left.x || (right.x == left.x && right.y < left.y))
+            std::swap(left, right);
+
+        int segment = static_cast<int>(segments.size());
+        segments.push_back({left, right, static_cast<int>(lineIndices[i])});
+        events.push({left, EventType::START, segment, -1});
+        events.push({right, EventType::END, segment, -1});
+    }
+
+    positions.assign(segments.size(), status.end());
+
+    while (!events.empty())
+    {
+        Event event = events.top();
+        events.pop();
+        sweepPosition = event.position;
+
+        switch (event.type)
+        {
+            case EventType::END:
+                remove(event.first);
+                break;
+            case EventType::CROSSING:
+                swap(event.first, event.second);
+                break;
+            case EventType::START:
+                insert(event.first);
+                break;
+        }
+    }
+
+    std::sort(pairs.begin(), pairs.end(),
+              [](const LinePair& a, const LinePair& b)
+              {
+                  return a.first != b.first ? a.first < b.first
+                                            : a.second < b.second;
+              });
+
+    return pairs;
+}
+
+bool IntersectionSweep::EventOrder::operator()(const Event& a,
+                                               const Event& b) const
+{
+    if (a.position.x != b.position.x) return a.position.x > b.position.x;
+    if (a.position.y != b.position.y) return a.position.y > b.position.y;
+    if (a.type != b.type) return a.type > b.type;
+    if (a.first != b.first) return a.first > b.first;
+    return a.second > b.second;
+}
+
+bool IntersectionSweep::EntryOrder::operator()(const Entry& a,
+                                               const Entry& b) const
+{
+    // Segments already in the sweep are never compared with each other
+    if (b.segment == sweep->entering && a.segment != b.segment)
+        return sweep->isBelowEntering(a.segment);
+
+    if (a.segment == sweep->entering && a.segment != b.segment)
+        return !sweep->isBelowEntering(b.segment);
+
+    return a.segment < b.segment;
+}
+
+bool IntersectionSweep::isBelowEntering(int segment) const
+{
+    const Segment& other = segments[segment];
+    const Segment& entered = segments[entering];
+
+    // Segments through the left end are ordered by where they go next
+    int side = Geometry::orient(other.left, other.right, entered.left);
+    if (side == 0)
+        side = Geometry::orient(other.left, other.right, entered.right);
+
+    // Collinear segments are ordered by index
+    return side != 0 ? side > 0 : segment < entering;
+}
+
+void IntersectionSweep::insert(int segment)
+{
+    entering = segment;
+    Status::iterator position = status.insert(Entry{segment}).first;
+    entering = -1;
+    positions[segment] = position;
+
+    testThrough(position, segments[segment].left);
+
+    if (position != status.begin())
+        testNeighbours(std::prev(position), position);
+
+    Status::iterator next = std::next(position);
+    if (next != status.end()) testNeighbours(position, next);
+}
+
+void IntersectionSweep::remove(int segment)
+{
+    Status::iterator position = positions[segment];
+    testThrough(position, segments[segment].right);
+
+    Status::iterator next = status.erase(position);
+    positions[segment] = status.end();
+
+    // The segments around the removed one become neighbours
+    if (next != status.begin() && next != status.end())
+        testNeighbours(std::prev(next), next);
+}
+
+void IntersectionSweep::swap(int lower, int upper)
+{
+    // A crossing scheduled twice is only handled once
+    Status::iterator position = positions[lower];
+    if (position == status.end()) return;
+
+    Status::iterator next = std::next(position);
+    if (next == status.end() || next->segment != upper) return;
+
+    position->segment = upper;
+    next->segment = lower;
+    positions[upper] = position;
+    positions[lower] = next;
+
+    if (position != status.begin())
+        testNeighbours(std::prev(position), position);
+
+    Status::iterator after = std::next(next);
+    if (after != status.end()) testNeighbours(next, after);
+}
+
+void IntersectionSweep::testThrough(Status::iterator position, glm::vec2 point)
+{
+    int segment = position->segment;
+
+    // The segments through a point are contiguous in the order
+    for (Status::iterator other = position; other != status.begin();)
+    {
+        --other;
+        const Segment& below = segments[other->segment];
+        if (Geometry::orient(below.left, below.right, point) != 0) break;
+
+        glm::dvec2 contact;
+        const Segment& current = segments[segment];
+        ContactType type = Geometry::getContact(
+            current.left, current.right, below.left, below.right, contact);
+        if (type != ContactType::NONE) report(segment, other->segment, type);
+    }
+
+    for (Status::iterator other = std::next(position); other != status.end();
+         ++other)
+    {
+        const Segment& above = segments[other->segment];
+        if (Geometry::orient(above.left, above.right, point) != 0) break;
+
+        glm::dvec2 contact;
+        const Segment& current = segments[segment];
+        ContactType type = Geometry::getContact(
+            current.left, current.right, above.left, above.right, contact);
+        if (type != ContactType::NONE) report(segment, other->segment, type);
+    }
+}
+
+void IntersectionSweep::testNeighbours(Status::iterator lower,
+                                       Status::iterator upper)
+{
+    const Segment& below = segments[lower->segment];
+    const Segment& above = segments[upper->segment];
+
+    glm::dvec2 contact;
+    ContactType type = Geometry::getContact(below.left, below.right,
+                                            above.left, above.right, contact);
+    if (type == ContactType::NONE) return;
+
+    report(lower->segment, upper->segment, type);
+
+    // The crossing is ahead if the lower segment ends above the upper one,
+    // which is decided exactly rather than from the rounded crossing
+    if (type != ContactType::CROSSING ||
+        Geometry::orient(above.left, above.right, below.right) <= 0)
+        return;
+
+    // A crossing rounded behind the sweep is handled right away
+    if (contact.x < sweepPosition.x ||
+        (contact.x == sweepPosition.x && contact.y < sweepPosition.y))
+        contact = sweepPosition;
+
+    events.push({contact, EventType::CROSSING, lower->segment, upper->segment});
+}
+
+void IntersectionSweep::report(int a, int b, ContactType type)
+{
+    int first = std::min(segments[a].line, segments[b].line);
+    int second = std::max(segments[a].line, segments[b].line);
+
+    uint64_t key = static_cast<uint64_t>(first) << 32 |
+                   static_cast<uint32_t>(second);
+    if (!reported.insert(key).second) return;
+
+    pairs.push_back({first, second, type});
+}
\ No newline at end of file
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <queue>
+#include <set>
+#include <unordered_set>
+#include <vector>
+
+#include "Geometry.h"
+#include "MapStore.h"
+
+/**
+ * @brief A struct representing two lines that touch.
+ */
+struct LinePair
+{
+    // The index of the first line, which is the lower of the two
+    int first;
+    // The index of the second line
+    int second;
+    // How the lines touch
+    Geometry::ContactType type;
+};
+
+/**
+ * @brief A class that finds every pair of touching lines of a map with a
+ * Bentley-Ottmann sweep.
+ *
+ * A vertical line is swept from left to right over the lines of the map while
+ * the lines it crosses are kept in vertical order, and only lines that become
+ * neighbours in that order are tested against each other. This finds all k
+ * touching pairs of n lines in O((n + k) log n) time, which makes it suitable
+ * to validate a whole imported map.
+ *
+ * The order is never recomputed from rounded crossing points: lines are
+ * placed with exact orientation tests when they enter the sweep, and swapped
+ * when they cross. Whether a crossing is still ahead of the sweep is decided
+ * exactly as well, so the rounded position of a crossing only affects when
+ * the swap happens, not whether it does.
+ */
+class IntersectionSweep
+{
+public:
+    /**
+     * @brief Constructs a new IntersectionSweep object.
+     */
+    IntersectionSweep();
+
+    IntersectionSweep(const IntersectionSweep&) = delete;
+    IntersectionSweep& operator=(const IntersectionSweep&) = delete;
+
+    /**
+     * @brief Finds every pair of lines that cross, overlap or where the end
+     * of one line lies inside another.
+     *
+     * Lines that only share an end are not reported.
+     *
+     * @param store The elements of the map.
+     * @return The pairs, sorted by their line indices. The vector is reused
+     * by the next call.
+     */
+    const std::vector<LinePair>& findPairs(const MapStore& store);
+
+private:
+    /**
+     * @brief An enum class representing the type of an event, in the order
+     * in which events at the same point are handled.
+     */
+    enum class EventType
+    {
+        // A line leaves the sweep
+        END,
+        // Two neighbouring lines cross
+        CROSSING,
+        // A line enters the sweep
+        START
+    };
+
+    /**
+     * @brief A struct representing a point at which the sweep must stop.
+     */
+    struct Event
+    {
+        // The position of the event
+        glm::dvec2 position;
+        // The type of the event
+        EventType type;
+        // The line of the event, or the lower line of a crossing
+        int first;
+        // The upper line of a crossing, or -1
+        int second;
+    };
+
+    /**
+     * @brief A struct that orders events so that the earliest is on top of a
+     * priority queue.
+     */
+    struct EventOrder
+    {
+        /**
+         * @brief Checks if an event is handled after another.
+         *
+         * @param a The first event.
+         * @param b The second event.
+         * @return True if a is handled after b, false otherwise.
+         */
+        bool operator()(const Event& a, const Event& b) const;
+    };
+
+    /**
+     * @brief A struct representing a line with its ends in sweep order.
+     */
+    struct Segment
+    {
+        // The end the sweep reaches first
+        glm::vec2 left;
+        // The end the sweep reaches last
+        glm::vec2 right;
+        // The index of the line
+        int line;
+    };
+
+    /**
+     * @brief A struct representing a position in the vertical order of the
+     * sweep.
+     *
+     * The segment is mutable so that crossing segments can swap positions
+     * without being reinserted.
+     */
+    struct Entry
+    {
+        // The segment at the position
+        mutable int segment;
+    };
+
+    /**
+     * @brief A struct that orders the segment entering the sweep against the
+     * segments already in it.
+     */
+    struct EntryOrder
+    {
+        // The sweep whose segments are ordered
+        const IntersectionSweep* sweep;
+
+        /**
+         * @brief Checks if an entry lies below another.
+         *
+         * @param a The first entry.
+         * @param b The second entry.
+         * @return True if a lies below b, false otherwise.
+         */
+        bool operator()(const Entry& a, const Entry& b) const;
+    };
+
+    // The type of the vertical order of the sweep
+    using Status = std::set<Entry, EntryOrder>;
+
+    // The segments of the lines
+    std::vector<Segment> segments;
+    // The events not yet handled
+    std::priority_queue<Event, std::vector<Event>, EventOrder> events;
+    // The segments crossed by the sweep, from bottom to top
+    Status status;
+    // The position of each segment in the vertical order
+    std::vector<Status::iterator> positions;
+    // The segment being inserted, or -1
+    int entering = -1;
+    // The position of the event being handled
+    glm::dvec2 sweepPosition;
+    // The keys of the pairs already reported
+    std::unordered_set<uint64_t> reported;
+    // The reported pairs
+    std::vector<LinePair> pairs;
+
+    /**
+     * @brief Compares a segment in the sweep with the entering segment.
+     *
+     * @param segment The index of the segment.
+     * @return True if the segment lies below the entering segment just after
+     * its left end, false otherwise.
+     */
+    bool isBelowEntering(int segment) const;
+
+    /**
+     * @brief Adds a segment to the vertical order at its left end.
+     *
+     * @param segment The index of the segment.
+     */
+    void insert(int segment);
+
+    /**
+     * @brief Removes a segment from the vertical order at its right end.
+     *
+     * @param segment The index of the segment.
+     */
+    void remove(int segment);
+
+    /**
+     * @brief Swaps two crossing segments if they are still neighbours in
+     * their order before the crossing.
+     *
+     * @param lower The index of the lower segment.
+     * @param upper The index of the upper segment.
+     */
+    void swap(int lower, int upper);
+
+    /**
+     * @brief Tests a segment against its neighbours that pass through a
+     * point.
+     *
+     * Several segments may pass through an end of a segment, and only two of
+     * them can be its neighbours, so the others are found by walking the
+     * order while segments contain the point.
+     *
+     * @param position The position of the segment in the order.
+     * @param point The point.
+     */
+    void testThrough(Status::iterator position, glm::vec2 point);
+
+    /**
+     * @brief Tests two neighbouring segments, reporting them if they touch
+     * and scheduling their crossing if it is ahead of the sweep.
+     *
+     * @param lower The position of the lower segment.
+     * @param upper The position of the upper segment.
+     */
+    void testNeighbours(Status::iterator lower, Status::iterator upper);
+
+    /**
+     * @brief Reports a pair of segments unless it was already reported.
+     *
+     * @param a The index of the first segment.
+     * @param b The index of the second segment.
+     * @param type How the segments touch.
+     */
+    void report(int a, int b, Geometry::ContactType type);
+};
\ No newline at end of file
@@ -0,0 +1,494 @@
+#include "Map.h"
+
+#include <utility>
+
+#include "../utils/macros.h"
+
+void Map::addListener(MapListener* listener) { listeners.push_back(listener); }
+
+void Map::removeListener(MapListener* listener)
+{
+    listeners.erase(std::remove(listeners.begin(), listeners.end(), listener),
+                    listeners.end());
+}
+
+int Map::addVertex(float x, float y)
+{
+    ASSERT(isInRange({x, y}));
+
+    int vertex = store.addVertex(x, y);
+    vertexGrid.insert(vertex, {x, y}, {x, y});
+
+    notify([&](MapListener& listener)
+           { listener.onVertexAdded(vertex, {x, y}); });
+
+    return vertex;
+}
+
+void Map::insertVertex(int vertex, glm::vec2 position)
+{
+    ASSERT(isInRange(position));
+
+    store.insertVertex(vertex, position.x, position.y);
+    vertexGrid.insert(vertex, position, position);
+
+    notify([&](MapListener& listener)
+           { listener.onVertexAdded(vertex, position); });
+}
+
+void Map::removeVertex(int vertex)
+{
+    ASSERT(store.hasVertex(vertex));
+    ASSERT(store.getVertexRefCount(vertex) == 0);
+
+    glm::vec2 position = getPosition(vertex);
+    vertexGrid.remove(vertex, position, position);
+    store.removeVertex(vertex);
+
+    notify([&](MapListener& listener)
+           { listener.onVertexRemoved(vertex, position); });
+}
+
+void Map::moveVertex(int vertex, glm::vec2 position)
+{
+    ASSERT(store.hasVertex(vertex));
+    ASSERT(isInRange(position));
+
+    glm::vec2 from = getPosition(vertex);
+    if (from == position) return;
+
+    // The angles and bounds of the lines change with their end
+    std::vector<int> lines = topology.getIncidentLines(vertex);
+    for (int line : lines) unlinkLine(line);
+
+    vertexGrid.remove(vertex, from, from);
+    store.setVertex(vertex, position.x, position.y);
+    vertexGrid.insert(vertex, position, position);
+
+    for (int line : lines) linkLine(line);
+
+    notify([&](MapListener& listener)
+           { listener.onVertexMoved(vertex, from, position); });
+}
+
+int Map::addLine(int startVertex, int endVertex)
+{
+    int index = store.addLine(startVertex, endVertex);
+    linkLine(index);
+
+    const Line& line = store.getLine(index);
+    notify([&](MapListener& listener) { listener.onLineAdded(index, line); });
+
+    return index;
+}
+
+void Map::insertLine(int index, const Line& line)
+{
+    store.insertLine(index, line);
+    linkLine(index);
+
+    notify([&](MapListener& listener) { listener.onLineAdded(index, line); });
+}
+
+void Map::removeLine(int index)
+{
+    ASSERT(store.hasLine(index));
+
+    Line line = store.getLine(index);
+    unlinkLine(index);
+    store.removeLine(index);
+
+    notify([&](MapListener& listener) { listener.onLineRemoved(index, line); });
+}
+
+void Map::setLineSides(int index, int front, int back)
+{
+    ASSERT(store.hasLine(index));
+
+    Line from = store.getLine(index);
+    store.setLineSides(index, front, back);
+    topology.setSide(MapTopology::getHalfEdge(index), front);
+    topology.setSide(MapTopology::getHalfEdge(index, true), back);
+
+    const Line& to = store.getLine(index);
+    notify([&](MapListener& listener)
+           { listener.onLineChanged(index, from, to); });
+}
+
+int Map::addSide(const Side& side)
+{
+    int index = store.addSide(side);
+
+    notify([&](MapListener& listener) { listener.onSideAdded(index, side); });
+
+    return index;
+}
+
+void Map::insertSide(int index, const Side& side)
+{
+    store.insertSide(index, side);
+
+    notify([&](MapListener& listener) { listener.onSideAdded(index, side); });
+}
+
+void Map::removeSide(int index)
+{
+    ASSERT(store.hasSide(index));
+
+    Side side = store.getSide(index);
+    store.removeSide(index);
+
+    notify([&](MapListener& listener) { listener.onSideRemoved(index, side); });
+}
+
+void Map::setSide(int index, const Side& side)
+{
+    ASSERT(store.hasSide(index));
+
+    Side from = store.getSide(index);
+    store.getSide(index) = side;
+
+    notify([&](MapListener& listener)
+           { listener.onSideChanged(index, from, side); });
+}
+
+int Map::addSector(const Sector& sector)
+{
+    int index = store.addSector(sector);
+
+    notify([&](MapListener& listener)
+           { listener.onSectorAdded(index, sector); });
+
+    return index;
+}
+
+void Map::insertSector(int index, const Sector& sector)
+{
+    store.insertSector(index, sector);
+
+    notify([&](MapListener& listener)
+           { listener.onSectorAdded(index, sector); });
+}
+
+void Map::removeSector(int index)
+{
+    ASSERT(store.hasSector(index));
+
+    Sector sector = store.getSector(index);
+    store.removeSector(index);
+
+    notify([&](MapListener& listener)
+           { listener.onSectorRemoved(index, sector); });
+}
+
+void Map::setSector(int index, const Sector& sector)
+{
+    ASSERT(store.hasSector(index));
+
+    Sector from = store.getSector(index);
+    store.getSector(index) = sector;
+
+    notify([&](MapListener& listener)
+           { listener.onSectorChanged(index, from, sector); });
+}
+
+int Map::addPrefab(std::shared_ptr<const MapFragment> fragment)
+{
+    int prefab = store.addPrefab(std::move(fragment));
+
+    notify([&](MapListener& listener)
+           { listener.onPrefabAdded(prefab, store); });
+
+    return prefab;
+}
+
+int Map::addInstance(int prefab, glm::vec2 position)
+{
+    PrefabInstance instance = {prefab, position};
+    int index = store.addInstance(instance);
+
+    notify([&](MapListener& listener)
+           { listener.onInstanceAdded(index, instance); });
+
+    return index;
+}
+
+void Map::insertInstance(int index, const PrefabInstance& instance)
+{
+    store.insertInstance(index, instance);
+
+    notify([&](MapListener& listener)
+           { listener.onInstanceAdded(index, instance); });
+}
+
+void Map::removeInstance(int index)
+{
+    ASSERT(store.hasInstance(index));
+
+    PrefabInstance instance = store.getInstance(index);
+    store.removeInstance(index);
+
+    notify([&](MapListener& listener)
+           { listener.onInstanceRemoved(index, instance); });
+}
+
+void Map::load(const MapArrays& arrays)
+{
+    store.assign(arrays);
+    topology.build(store);
+    vertexGrid.clear();
+    lineGrid.clear();
+
+    const std::vector<LineVertex>& positions = store.getVertexPositions();
+    const std::vector<uint32_t>& vertexIndices = store.getVertexIndices();
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        glm::vec2 position = {positions[i].x, positions[i].y};
+        vertexGrid.insert(vertexIndices[i], position, position);
+    }
+
+    const std::vector<Line>& lines = store.getLines();
+    const std::vector<uint32_t>& lineIndices = store.getLineIndices();
+    for (size_t i = 0; i < lines.size(); ++i)
+    {
+        const LineVertex& start = store.getVertex(lines[i].startVertex);
+        const LineVertex& end = store.getVertex(lines[i].endVertex);
+        lineGrid.insert(lineIndices[i],
+                        {std::min(start.x, end.x), std::min(start.y, end.y)},
+                        {std::max(start.x, end.x), std::max(start.y, end.y)});
+    }
+
+    notify([&](MapListener& listener) { listener.onMapLoaded(store); });
+}
+
+void Map::append(const MapArrays& arrays, glm::vec2 offset,
+                 AppendedElements& added)
+{
+    store.append(arrays, offset, added);
+
+    for (int sector : added.sectors)
+    {
+        const Sector& data = store.getSector(sector);
+        notify([&](MapListener& listener)
+               { listener.onSectorAdded(sector, data); });
+    }
+
+    for (int side : added.sides)
+    {
+        const Side& data = store.getSide(side);
+        notify([&](MapListener& listener)
+               { listener.onSideAdded(side, data); });
+    }
+
+    for (int vertex : added.vertices)
+    {
+        glm::vec2 position = getPosition(vertex);
+        vertexGrid.insert(vertex, position, position);
+
+        notify([&](MapListener& listener)
+               { listener.onVertexAdded(vertex, position); });
+    }
+
+    for (int line : added.lines)
+    {
+        linkLine(line);
+
+        const Line& data = store.getLine(line);
+        notify([&](MapListener& listener)
+               { listener.onLineAdded(line, data); });
+    }
+}
+
+void Map::deleteVertex(int vertex)
+{
+    ASSERT(store.hasVertex(vertex));
+
+    std::vector<int> lines = topology.getIncidentLines(vertex);
+    for (int line : lines) deleteLine(line);
+
+    // A vertex without lines is not freed by deleting its lines
+    if (store.hasVertex(vertex)) removeVertex(vertex);
+}
+
+void Map::deleteLine(int index)
+{
+    ASSERT(store.hasLine(index));
+
+    Line line = store.getLine(index);
+    removeLine(index);
+
+    if (store.getVertexRefCount(line.startVertex) == 0)
+        removeVertex(line.startVertex);
+
+    if (store.getVertexRefCount(line.endVertex) == 0)
+        removeVertex(line.endVertex);
+}
+
+void Map::deleteAll()
+{
+    // Remove the last element of each array, so that no element is moved,
+    // and the lines before the vertices and sides they refer to
+    while (store.getInstanceCount() > 0)
+        removeInstance(store.getInstanceIndices().back());
+
+    while (store.getLineCount() > 0)
+        removeLine(store.getLineIndices().back());
+
+    while (store.getVertexCount() > 0)
+        removeVertex(store.getVertexIndices().back());
+
+    while (store.getSideCount() > 0)
+        removeSide(store.getSideIndices().back());
+
+    while (store.getSectorCount() > 0)
+        removeSector(store.getSectorIndices().back());
+}
+
+int Map::findVertex(glm::vec2 position, float threshold) const
+{
+    int index = -1;
+
+    // Only test the vertices in the cells around the position
+    glm::vec2 extent = {threshold, threshold};
+    vertexGrid.query(position - extent, position + extent,
+                     [&](uint32_t vertex)
+                     {
+                         if (glm::distance(position, getPosition(vertex)) >
+                             threshold)
+                             return true;
+
+                         index = vertex;
+                         return false;
+                     });
+
+    return index;
+}
+
+int Map::findLine(glm::vec2 position, float threshold) const
+{
+    int index = -1;
+
+    // Only test the lines whose bounding boxes share a cell with the position
+    glm::vec2 extent = {threshold, threshold};
+    lineGrid.query(position - extent, position + extent,
+                   [&](uint32_t line)
+                   {
+                       if (getLineDistance(line, position) > threshold)
+                           return true;
+
+                       index = line;
+                       return false;
+                   });
+
+    return index;
+}
+
+void Map::findIntersections(glm::vec2 start, glm::vec2 end,
+                            std::vector<LineIntersection>& intersections) const
+{
+    intersections.clear();
+
+    glm::dvec2 origin = start;
+    glm::dvec2 direction = glm::dvec2(end) - origin;
+    double lengthSquared = glm::dot(direction, direction);
+
+    lineGrid.query(
+        glm::min(start, end), glm::max(start, end),
+        [&](uint32_t index)
+        {
+            const Line& line = store.getLine(index);
+            glm::dvec2 point;
+            Geometry::ContactType type = Geometry::getContact(
+                start, end, getPosition(line.startVertex),
+                getPosition(line.endVertex), point);
+            if (type == Geometry::ContactType::NONE) return true;
+
+            double t = lengthSquared > 0.0
+                           ? glm::dot(point - origin, direction) / lengthSquared
+                           : 0.0;
+            intersections.push_back({static_cast<int>(index), type,
+                                     glm::vec2(point), static_cast<float>(t)});
+            return true;
+        });
+
+    std::sort(intersections.begin(), intersections.end(),
+              [](const LineIntersection& a, const LineIntersection& b)
+              { return a.t < b.t; });
+}
+
+int Map::splitLine(int index, int vertex)
+{
+    ASSERT(store.hasLine(index));
+    ASSERT(store.hasVertex(vertex));
+
+    Line line = store.getLine(index);
+
+    // Reinsert the first half so that the line keeps its index
+    removeLine(index);
+    insertLine(index, Line(line.startVertex, vertex, line.front, line.back));
+
+    // Copy the sides, since adding a side may move the stored ones
+    int front = -1, back = -1;
+    if (line.front != -1) front = addSide(Side(store.getSide(line.front)));
+    if (line.back != -1) back = addSide(Side(store.getSide(line.back)));
+
+    int second = addLine(vertex, line.endVertex);
+    if (front != -1 || back != -1) setLineSides(second, front, back);
+
+    return second;
+}
+
+float Map::getLineDistance(int index, glm::vec2 position) const
+{
+    const Line& line = store.getLine(index);
+    glm::vec2 startVertex = getPosition(line.startVertex);
+    glm::vec2 endVertex = getPosition(line.endVertex);
+
+    glm::vec2 startToEnd = endVertex - startVertex;
+    glm::vec2 startToCursor = position - startVertex;
+
+    // Calculate the scalar projection of the cursor onto the line
+    float scalar =
+        glm::dot(startToCursor, startToEnd) / glm::dot(startToEnd, startToEnd);
+
+    // Clamp scalar to [0, 1] so that the projection is on the line
+    scalar = glm::clamp(scalar, 0.0f, 1.0f);
+
+    // Calculate the vector projection of the cursor onto the line
+    glm::vec2 projection = startVertex + scalar * startToEnd;
+
+    return glm::distance(position, projection);
+}
+
+void Map::getLineBounds(int index, glm::vec2& min, glm::vec2& max) const
+{
+    const Line& line = store.getLine(index);
+    glm::vec2 start = getPosition(line.startVertex);
+    glm::vec2 end = getPosition(line.endVertex);
+
+    min = glm::min(start, end);
+    max = glm::max(start, end);
+}
+
+void Map::linkLine(int index)
+{
+    const Line& line = store.getLine(index);
+    topology.addLine(index, line.startVertex, line.endVertex,
+                     getPosition(line.startVertex),
+                     getPosition(line.endVertex));
+    topology.setSide(MapTopology::getHalfEdge(index), line.front);
+    topology.setSide(MapTopology::getHalfEdge(index, true), line.back);
+
+    glm::vec2 min, max;
+    getLineBounds(index, min, max);
+    lineGrid.insert(index, min, max);
+}
+
+void Map::unlinkLine(int index)
+{
+    glm::vec2 min, max;
+    getLineBounds(index, min, max);
+    lineGrid.remove(index, min, max);
+
+    topology.removeLine(index);
+}
\ No newline at end of file
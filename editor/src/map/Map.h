@@ -0,0 +1,450 @@
+#pragma once
+
+#include <algorithm>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "Geometry.h"
+#include "MapListener.h"
+#include "MapStore.h"
+#include "MapTopology.h"
+#include "SpatialGrid.h"
+
+/**
+ * @brief A struct representing a line touched by a segment.
+ */
+struct LineIntersection
+{
+    // The index of the touched line
+    int line;
+    // How the segment touches the line
+    Geometry::ContactType type;
+    // The first point the segment shares with the line
+    glm::vec2 position;
+    // The fraction of the segment at which the contact lies
+    float t;
+};
+
+/**
+ * @brief A class representing an editable map.
+ *
+ * This class owns the elements of the map, their half-edge topology and the
+ * spatial indices over vertices and lines, and keeps the three consistent
+ * through every edit. Each primitive edit, including stamping and removing
+ * prefab instances, is reported to the registered listeners, which is how
+ * the render cache and the edit history follow the map. The class has no
+ * graphics dependency, so tools that do not open a window can use it as well.
+ */
+class Map
+{
+public:
+    /**
+     * @brief Registers a listener that is notified of every edit.
+     *
+     * The listener must outlive the map or be removed before it is destroyed.
+     *
+     * @param listener The listener.
+     */
+    void addListener(MapListener* listener);
+
+    /**
+     * @brief Unregisters a listener.
+     *
+     * @param listener The listener.
+     */
+    void removeListener(MapListener* listener);
+
+    /**
+     * @brief Checks if a position can be stored as it is.
+     *
+     * Fixed-point coordinates saturate at the ends of their range, so a
+     * vertex past it would be clamped onto the vertices already there.
+     * Positions are checked before they are edited into the map.
+     *
+     * @param position The position.
+     * @return True if both coordinates are in range, false otherwise.
+     */
+    static inline bool isInRange(glm::vec2 position)
+    {
+        return isMapCoordInRange(position.x) && isMapCoordInRange(position.y);
+    }
+
+    /**
+     * @brief Adds a vertex at the specified position.
+     *
+     * @param x The x coordinate of the vertex.
+     * @param y The y coordinate of the vertex, which must be in range along
+     * with x.
+     * @return The index of the vertex.
+     */
+    int addVertex(float x, float y);
+
+    /**
+     * @brief Adds a vertex at the specified free index.
+     *
+     * This method restores a removed vertex under its previous index.
+     *
+     * @param vertex The index of the vertex, which must be free.
+     * @param position The position of the vertex, which must be in range.
+     */
+    void insertVertex(int vertex, glm::vec2 position);
+
+    /**
+     * @brief Removes a vertex that no line uses.
+     *
+     * @param vertex The index of the vertex.
+     */
+    void removeVertex(int vertex);
+
+    /**
+     * @brief Moves a vertex and the ends of its lines.
+     *
+     * @param vertex The index of the vertex.
+     * @param position The new position of the vertex, which must be in range.
+     */
+    void moveVertex(int vertex, glm::vec2 position);
+
+    /**
+     * @brief Adds a line between the specified vertices.
+     *
+     * @param startVertex The index of the start vertex.
+     * @param endVertex The index of the end vertex.
+     * @return The index of the line.
+     */
+    int addLine(int startVertex, int endVertex);
+
+    /**
+     * @brief Adds a line at the specified free index.
+     *
+     * This method restores a removed line, including its sides, under its
+     * previous index.
+     *
+     * @param index The index of the line, which must be free.
+     * @param line The line to restore.
+     */
+    void insertLine(int index, const Line& line);
+
+    /**
+     * @brief Removes a line.
+     *
+     * The vertices of the line are kept, even if no other line uses them.
+     *
+     * @param index The index of the line.
+     */
+    void removeLine(int index);
+
+    /**
+     * @brief Sets the sides of a line.
+     *
+     * @param index The index of the line.
+     * @param front The index of the front side, or -1 for none.
+     * @param back The index of the back side, or -1 for none.
+     */
+    void setLineSides(int index, int front, int back);
+
+    /**
+     * @brief Adds a side.
+     *
+     * @param side The side to add.
+     * @return The index of the side.
+     */
+    int addSide(const Side& side);
+
+    /**
+     * @brief Adds a side at the specified free index.
+     *
+     * @param index The index of the side, which must be free.
+     * @param side The side to add.
+     */
+    void insertSide(int index, const Side& side);
+
+    /**
+     * @brief Removes a side.
+     *
+     * @param index The index of the side.
+     */
+    void removeSide(int index);
+
+    /**
+     * @brief Sets the properties of a side.
+     *
+     * @param index The index of the side.
+     * @param side The new properties of the side.
+     */
+    void setSide(int index, const Side& side);
+
+    /**
+     * @brief Adds a sector.
+     *
+     * @param sector The sector to add.
+     * @return The index of the sector.
+     */
+    int addSector(const Sector& sector);
+
+    /**
+     * @brief Adds a sector at the specified free index.
+     *
+     * @param index The index of the sector, which must be free.
+     * @param sector The sector to add.
+     */
+    void insertSector(int index, const Sector& sector);
+
+    /**
+     * @brief Removes a sector.
+     *
+     * @param index The index of the sector.
+     */
+    void removeSector(int index);
+
+    /**
+     * @brief Sets the properties of a sector.
+     *
+     * @param index The index of the sector.
+     * @param sector The new properties of the sector.
+     */
+    void setSector(int index, const Sector& sector);
+
+    /**
+     * @brief Adds a prefab.
+     *
+     * @param fragment The geometry of the prefab, which must hold lines.
+     * @return The index of the prefab.
+     */
+    int addPrefab(std::shared_ptr<const MapFragment> fragment);
+
+    /**
+     * @brief Stamps an instance of a prefab.
+     *
+     * @param prefab The index of the prefab.
+     * @param position The position of the minimum corner of the prefab.
+     * @return The index of the instance.
+     */
+    int addInstance(int prefab, glm::vec2 position);
+
+    /**
+     * @brief Adds an instance of a prefab at the specified free index.
+     *
+     * This method restores a removed instance under its previous index.
+     *
+     * @param index The index of the instance, which must be free.
+     * @param instance The instance to restore.
+     */
+    void insertInstance(int index, const PrefabInstance& instance);
+
+    /**
+     * @brief Removes an instance of a prefab.
+     *
+     * @param index The index of the instance.
+     */
+    void removeInstance(int index);
+
+    /**
+     * @brief Replaces every element, prefab and instance of the map with the
+     * contents of flat arrays.
+     *
+     * The arrays are copied in bulk and the topology and spatial indices are
+     * rebuilt, after which the listeners are notified with onMapLoaded.
+     *
+     * @param arrays The arrays, whose cross-references must be in range.
+     */
+    void load(const MapArrays& arrays);
+
+    /**
+     * @brief Adds copies of the elements of flat arrays, moved by an offset.
+     *
+     * The elements are stored in bulk, with no lookups of existing elements,
+     * and then linked and reported to the listeners one by one, sectors and
+     * sides first, so that the addition can be undone and replayed.
+     *
+     * @param arrays The arrays, which refer to each other by position.
+     * @param offset The offset added to the positions of the vertices.
+     * @param added Set to the indices the elements were stored at.
+     */
+    void append(const MapArrays& arrays, glm::vec2 offset,
+                AppendedElements& added);
+
+    /**
+     * @brief Deletes a vertex along with its lines.
+     *
+     * Vertices left without lines by the deletion are deleted as well.
+     *
+     * @param vertex The index of the vertex.
+     */
+    void deleteVertex(int vertex);
+
+    /**
+     * @brief Deletes a line.
+     *
+     * Vertices left without lines by the deletion are deleted as well.
+     *
+     * @param index The index of the line.
+     */
+    void deleteLine(int index);
+
+    /**
+     * @brief Deletes every element and instance of the map.
+     *
+     * Unlike loading empty arrays, the elements are removed and reported to
+     * the listeners one by one, so that the deletion can be undone and
+     * replayed. The prefabs are kept.
+     */
+    void deleteAll();
+
+    /**
+     * @brief Gets the index of the vertex within a threshold of a position.
+     *
+     * @param position The position.
+     * @param threshold The distance within which to search. Defaults to 0.
+     * @return The index of the vertex, or -1 if no vertex is found.
+     */
+    int findVertex(glm::vec2 position, float threshold = 0.0f) const;
+
+    /**
+     * @brief Gets the index of the line within a threshold of a position.
+     *
+     * @param position The position.
+     * @param threshold The distance within which to search. Defaults to 0.
+     * @return The index of the line, or -1 if no line is found.
+     */
+    int findLine(glm::vec2 position, float threshold = 0.0f) const;
+
+    /**
+     * @brief Finds the lines touched by a segment.
+     *
+     * Only the lines whose bounding boxes share a cell with the segment are
+     * tested, and they are tested exactly. Lines that only share an end with
+     * the segment are not reported.
+     *
+     * @param start The start of the segment.
+     * @param end The end of the segment.
+     * @param intersections Set to the touched lines, sorted from the start of
+     * the segment to its end.
+     */
+    void findIntersections(glm::vec2 start, glm::vec2 end,
+                           std::vector<LineIntersection>& intersections) const;
+
+    /**
+     * @brief Splits a line in two at a vertex.
+     *
+     * The line keeps its index and its sides and ends at the vertex, and a new
+     * line with copies of its sides runs from the vertex to its old end.
+     *
+     * @param index The index of the line.
+     * @param vertex The index of the vertex to split at.
+     * @return The index of the new line.
+     */
+    int splitLine(int index, int vertex);
+
+    /**
+     * @brief Gets the distance from a position to a line.
+     *
+     * @param index The index of the line.
+     * @param position The position.
+     * @return The distance to the closest point of the line.
+     */
+    float getLineDistance(int index, glm::vec2 position) const;
+
+    /**
+     * @brief Gets the bounding box of a line.
+     *
+     * @param index The index of the line.
+     * @param min The minimum corner of the bounding box.
+     * @param max The maximum corner of the bounding box.
+     */
+    void getLineBounds(int index, glm::vec2& min, glm::vec2& max) const;
+
+    /**
+     * @brief Calls a function for the vertices that may lie in a box.
+     *
+     * @tparam Func A callable taking a vertex index and returning a bool,
+     * false to stop the query.
+     * @param min The minimum corner of the box.
+     * @param max The maximum corner of the box.
+     * @param func The function to call for each candidate.
+     */
+    template <typename Func>
+    void queryVertices(glm::vec2 min, glm::vec2 max, Func func) const
+    {
+        vertexGrid.query(min, max, func);
+    }
+
+    /**
+     * @brief Calls a function for the lines whose bounding boxes may overlap
+     * a box.
+     *
+     * @tparam Func A callable taking a line index and returning a bool, false
+     * to stop the query.
+     * @param min The minimum corner of the box.
+     * @param max The maximum corner of the box.
+     * @param func The function to call for each candidate.
+     */
+    template <typename Func>
+    void queryLines(glm::vec2 min, glm::vec2 max, Func func) const
+    {
+        lineGrid.query(min, max, func);
+    }
+
+    /**
+     * @brief Gets the elements of the map.
+     *
+     * @return The store of the map.
+     */
+    inline const MapStore& getStore() const { return store; }
+
+    /**
+     * @brief Gets the half-edge topology of the map.
+     *
+     * @return The topology of the map.
+     */
+    inline const MapTopology& getTopology() const { return topology; }
+
+private:
+    // The elements of the map
+    MapStore store;
+    // The half-edge topology of the lines
+    MapTopology topology;
+    // The spatial index of the vertices
+    SpatialGrid vertexGrid;
+    // The spatial index of the lines' bounding boxes
+    SpatialGrid lineGrid;
+    // The listeners notified of every edit
+    std::vector<MapListener*> listeners;
+
+    /**
+     * @brief Gets the position of a vertex.
+     *
+     * @param vertex The index of the vertex.
+     * @return The position of the vertex.
+     */
+    inline glm::vec2 getPosition(int vertex) const
+    {
+        const LineVertex& position = store.getVertex(vertex);
+        return {position.x, position.y};
+    }
+
+    /**
+     * @brief Adds a stored line to the topology and the spatial index.
+     *
+     * @param index The index of the line.
+     */
+    void linkLine(int index);
+
+    /**
+     * @brief Removes a stored line from the topology and the spatial index.
+     *
+     * @param index The index of the line.
+     */
+    void unlinkLine(int index);
+
+    /**
+     * @brief Calls a function on every listener.
+     *
+     * @tparam Func A callable taking a MapListener reference.
+     * @param func The function to call.
+     */
+    template <typename Func>
+    void notify(Func func)
+    {
+        for (MapListener* listener : listeners) func(*listener);
+    }
+};
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include "MapArrays.h"
+
+#include <climits>
+#include <vector>
+
+/**
+ * @brief Marks the indices listed for an element type.
+ *
+ * @param indices The index of each element, or nullptr.
+ * @param count The number of elements.
+ * @param present The marks, indexed by element index.
+ * @return False if an index is listed twice or does not fit an int, true
+ * otherwise.
+ */
+static bool markIndices(const uint32_t* indices, size_t count,
+                        std::vector<bool>& present)
+{
+    if (!indices) return true;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint32_t index = indices[i];
+        if (index >= INT_MAX) return false;
+
+        if (index >= present.size()) present.resize(index + 1, false);
+        if (present[index]) return false;
+        present[index] = true;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Checks if an index refers to an element.
+ *
+ * @param index The index.
+ * @param count The number of elements.
+ * @param indices The index of each element, or nullptr to index by position.
+ * @param present The marks of the listed indices.
+ * @return True if the index refers to an element, false otherwise.
+ */
+static bool refersTo(int index, size_t count, const uint32_t* indices,
+                     const std::vector<bool>& present)
+{
+    // Compare as unsigned so that negative indices are out of range
+    if (!indices) return static_cast<uint32_t>(index) < count;
+    return static_cast<uint32_t>(index) < present.size() && present[index];
+}
+
+bool MapArrays::hasValidReferences() const
+{
+    std::vector<bool> vertexPresent, linePresent, sidePresent, sectorPresent;
+    if (!markIndices(vertexIndices, vertexCount, vertexPresent) ||
+        !markIndices(lineIndices, lineCount, linePresent) ||
+        !markIndices(sideIndices, sideCount, sidePresent) ||
+        !markIndices(sectorIndices, sectorCount, sectorPresent))
+        return false;
+
+    for (size_t i = 0; i < lineCount; ++i)
+    {
+        const Line& line = lines[i];
+        if (!refersTo(line.startVertex, vertexCount, vertexIndices,
+                      vertexPresent) ||
+            !refersTo(line.endVertex, vertexCount, vertexIndices,
+                      vertexPresent) ||
+            line.startVertex == line.endVertex ||
+            (line.front != -1 &&
+             !refersTo(line.front, sideCount, sideIndices, sidePresent)) ||
+            (line.back != -1 &&
+             !refersTo(line.back, sideCount, sideIndices, sidePresent)))
+            return false;
+    }
+
+    for (size_t i = 0; i < sideCount; ++i)
+    {
+        int sector = sides[i].sector;
+        if (sector != -1 &&
+            !refersTo(sector, sectorCount, sectorIndices, sectorPresent))
+            return false;
+    }
+
+    for (size_t i = 0; i < prefabCount; ++i)
+    {
+        const MapArrays& prefab = prefabs[i];
+        if (prefab.lineCount == 0 || prefab.prefabCount != 0 ||
+            prefab.instanceCount != 0 || prefab.vertexIndices ||
+            prefab.lineIndices || prefab.sideIndices || prefab.sectorIndices ||
+            !prefab.hasValidReferences())
+            return false;
+    }
+
+    std::vector<bool> instancePresent;
+    if (!markIndices(instanceIndices, instanceCount, instancePresent))
+        return false;
+
+    for (size_t i = 0; i < instanceCount; ++i)
+    {
+        // Prefabs are never removed, so they are always indexed by position
+        if (static_cast<uint32_t>(instances[i].prefab) >= prefabCount)
+            return false;
+    }
+
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../map_components/Line.h"
+#include "../map_components/LineVertex.h"
+#include "../map_components/PrefabInstance.h"
+#include "../map_components/Sector.h"
+#include "../map_components/Side.h"
+
+/**
+ * @brief A struct referring to the elements of a map as flat arrays.
+ *
+ * By default the arrays are indexed densely: lines refer to vertices and
+ * sides, and sides refer to sectors, by their position in these arrays. If
+ * index arrays are given, each element takes the index listed for it instead,
+ * and the references use those indices, which lets a map with free slots be
+ * restored exactly. The struct does not own the arrays, which usually live in
+ * a memory-mapped file.
+ *
+ * The arrays may also hold the prefabs of the map, each as arrays of its own
+ * that refer to each other by position, and the instances of the prefabs,
+ * which refer to a prefab by its position among them.
+ */
+struct MapArrays
+{
+    // The positions of the vertices
+    const LineVertex* vertices = nullptr;
+    // The number of vertices
+    size_t vertexCount = 0;
+    // The lines
+    const Line* lines = nullptr;
+    // The number of lines
+    size_t lineCount = 0;
+    // The sides
+    const Side* sides = nullptr;
+    // The number of sides
+    size_t sideCount = 0;
+    // The sectors
+    const Sector* sectors = nullptr;
+    // The number of sectors
+    size_t sectorCount = 0;
+    // The index of each vertex, or nullptr to index by position
+    const uint32_t* vertexIndices = nullptr;
+    // The index of each line, or nullptr to index by position
+    const uint32_t* lineIndices = nullptr;
+    // The index of each side, or nullptr to index by position
+    const uint32_t* sideIndices = nullptr;
+    // The index of each sector, or nullptr to index by position
+    const uint32_t* sectorIndices = nullptr;
+    // The geometry of each prefab
+    const MapArrays* prefabs = nullptr;
+    // The number of prefabs
+    size_t prefabCount = 0;
+    // The instances of the prefabs
+    const PrefabInstance* instances = nullptr;
+    // The number of instances
+    size_t instanceCount = 0;
+    // The index of each instance, or nullptr to index by position
+    const uint32_t* instanceIndices = nullptr;
+
+    /**
+     * @brief Checks that every cross-reference of the arrays refers to an
+     * element, that no index is listed twice and that no line starts and ends
+     * at the same vertex. Each prefab must hold lines, with no index arrays
+     * and no prefabs of its own.
+     *
+     * @return True if the references are valid, false otherwise.
+     */
+    bool hasValidReferences() const;
+};
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include "MapCommand.h"
+
+#include "Map.h"
+
+void MapCommand::apply(Map& map) const
+{
+    switch (type)
+    {
+        case MapCommandType::ADD_VERTEX:
+            map.insertVertex(index, payload.vertex.to);
+            break;
+        case MapCommandType::REMOVE_VERTEX:
+            map.removeVertex(index);
+            break;
+        case MapCommandType::MOVE_VERTEX:
+            map.moveVertex(index, payload.vertex.to);
+            break;
+        case MapCommandType::ADD_LINE:
+            map.insertLine(index, payload.line.to);
+            break;
+        case MapCommandType::REMOVE_LINE:
+            map.removeLine(index);
+            break;
+        case MapCommandType::CHANGE_LINE:
+            map.setLineSides(index, payload.line.to.front,
+                             payload.line.to.back);
+            break;
+        case MapCommandType::ADD_SIDE:
+            map.insertSide(index, payload.side.to);
+            break;
+        case MapCommandType::REMOVE_SIDE:
+            map.removeSide(index);
+            break;
+        case MapCommandType::CHANGE_SIDE:
+            map.setSide(index, payload.side.to);
+            break;
+        case MapCommandType::ADD_SECTOR:
+            map.insertSector(index, payload.sector.to);
+            break;
+        case MapCommandType::REMOVE_SECTOR:
+            map.removeSector(index);
+            break;
+        case MapCommandType::CHANGE_SECTOR:
+            map.setSector(index, payload.sector.to);
+            break;
+        case MapCommandType::ADD_INSTANCE:
+            map.insertInstance(index, payload.instance.to);
+            break;
+        case MapCommandType::REMOVE_INSTANCE:
+            map.removeInstance(index);
+            break;
+    }
+}
+
+void MapCommand::revert(Map& map) const
+{
+    switch (type)
+    {
+        case MapCommandType::ADD_VERTEX:
+            map.removeVertex(index);
+            break;
+        case MapCommandType::REMOVE_VERTEX:
+            map.insertVertex(index, payload.vertex.from);
+            break;
+        case MapCommandType::MOVE_VERTEX:
+            map.moveVertex(index, payload.vertex.from);
+            break;
+        case MapCommandType::ADD_LINE:
+            map.removeLine(index);
+            break;
+        case MapCommandType::REMOVE_LINE:
+            map.insertLine(index, payload.line.from);
+            break;
+        case MapCommandType::CHANGE_LINE:
+            map.setLineSides(index, payload.line.from.front,
+                             payload.line.from.back);
+            break;
+        case MapCommandType::ADD_SIDE:
+            map.removeSide(index);
+            break;
+        case MapCommandType::REMOVE_SIDE:
+            map.insertSide(index, payload.side.from);
+            break;
+        case MapCommandType::CHANGE_SIDE:
+            map.setSide(index, payload.side.from);
+            break;
+        case MapCommandType::ADD_SECTOR:
+            map.removeSector(index);
+            break;
+        case MapCommandType::REMOVE_SECTOR:
+            map.insertSector(index, payload.sector.from);
+            break;
+        case MapCommandType::CHANGE_SECTOR:
+            map.setSector(index, payload.sector.from);
+            break;
+        case MapCommandType::ADD_INSTANCE:
+            map.removeInstance(index);
+            break;
+        case MapCommandType::REMOVE_INSTANCE:
+            map.insertInstance(index, payload.instance.from);
+            break;
+    }
+}
\ No newline at end of file
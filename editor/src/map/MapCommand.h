@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "../map_components/Line.h"
+#include "../map_components/PrefabInstance.h"
+#include "../map_components/Sector.h"
+#include "../map_components/Side.h"
+
+class Map;
+
+/**
+ * @brief An enum class that represents the kind of a primitive map edit.
+ */
+enum class MapCommandType : uint8_t
+{
+    ADD_VERTEX,
+    REMOVE_VERTEX,
+    MOVE_VERTEX,
+    ADD_LINE,
+    REMOVE_LINE,
+    CHANGE_LINE,
+    ADD_SIDE,
+    REMOVE_SIDE,
+    CHANGE_SIDE,
+    ADD_SECTOR,
+    REMOVE_SECTOR,
+    CHANGE_SECTOR,
+    ADD_INSTANCE,
+    REMOVE_INSTANCE
+};
+
+/**
+ * @brief A struct holding the value of an element before and after an edit.
+ *
+ * @tparam T The type of the value.
+ */
+template <typename T>
+struct MapDelta
+{
+    // The value before the edit
+    T from;
+    // The value after the edit
+    T to;
+};
+
+/**
+ * @brief A struct representing a single reversible edit of the map.
+ *
+ * A command records one primitive edit together with the state needed to
+ * apply and revert it, and nothing else: additions keep the added value,
+ * removals keep the removed value and changes keep both values. Commands are
+ * fixed-size values, so a transaction of any size is a single array and
+ * reverting it never copies the map.
+ */
+struct MapCommand
+{
+    // The kind of the edit
+    MapCommandType type;
+    // The index of the edited element
+    int index;
+
+    /**
+     * @brief A union holding the delta of the edited element type.
+     */
+    union Payload
+    {
+        // The position of a vertex
+        MapDelta<glm::vec2> vertex;
+        // The value of a line
+        MapDelta<Line> line;
+        // The value of a side
+        MapDelta<Side> side;
+        // The value of a sector
+        MapDelta<Sector> sector;
+        // The value of a prefab instance
+        MapDelta<PrefabInstance> instance;
+
+        /**
+         * @brief Constructs a new Payload object holding a vertex delta.
+         */
+        Payload() : vertex() {}
+    } payload;
+
+    /**
+     * @brief Applies the edit to a map.
+     *
+     * @param map The map, which must be in the state before the edit.
+     */
+    void apply(Map& map) const;
+
+    /**
+     * @brief Reverts the edit on a map.
+     *
+     * @param map The map, which must be in the state after the edit.
+     */
+    void revert(Map& map) const;
+};
\ No newline at end of file
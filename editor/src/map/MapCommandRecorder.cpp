@@ -0,0 +1,105 @@
+#include "MapCommandRecorder.h"
+
+void MapCommandRecorder::onVertexAdded(int vertex, glm::vec2 position)
+{
+    MapCommand command = makeCommand(MapCommandType::ADD_VERTEX, vertex);
+    command.payload.vertex.to = position;
+    record(command);
+}
+
+void MapCommandRecorder::onVertexRemoved(int vertex, glm::vec2 position)
+{
+    MapCommand command = makeCommand(MapCommandType::REMOVE_VERTEX, vertex);
+    command.payload.vertex.from = position;
+    record(command);
+}
+
+void MapCommandRecorder::onVertexMoved(int vertex, glm::vec2 from,
+                                       glm::vec2 to)
+{
+    MapCommand command = makeCommand(MapCommandType::MOVE_VERTEX, vertex);
+    command.payload.vertex = {from, to};
+    record(command);
+}
+
+void MapCommandRecorder::onLineAdded(int index, const Line& line)
+{
+    MapCommand command = makeCommand(MapCommandType::ADD_LINE, index);
+    command.payload.line.to = line;
+    record(command);
+}
+
+void MapCommandRecorder::onLineRemoved(int index, const Line& line)
+{
+    MapCommand command = makeCommand(MapCommandType::REMOVE_LINE, index);
+    command.payload.line.from = line;
+    record(command);
+}
+
+void MapCommandRecorder::onLineChanged(int index, const Line& from,
+                                       const Line& to)
+{
+    MapCommand command = makeCommand(MapCommandType::CHANGE_LINE, index);
+    command.payload.line = {from, to};
+    record(command);
+}
+
+void MapCommandRecorder::onSideAdded(int index, const Side& side)
+{
+    MapCommand command = makeCommand(MapCommandType::ADD_SIDE, index);
+    command.payload.side.to = side;
+    record(command);
+}
+
+void MapCommandRecorder::onSideRemoved(int index, const Side& side)
+{
+    MapCommand command = makeCommand(MapCommandType::REMOVE_SIDE, index);
+    command.payload.side.from = side;
+    record(command);
+}
+
+void MapCommandRecorder::onSideChanged(int index, const Side& from,
+                                       const Side& to)
+{
+    MapCommand command = makeCommand(MapCommandType::CHANGE_SIDE, index);
+    command.payload.side = {from, to};
+    record(command);
+}
+
+void MapCommandRecorder::onSectorAdded(int index, const Sector& sector)
+{
+    MapCommand command = makeCommand(MapCommandType::ADD_SECTOR, index);
+    command.payload.sector.to = sector;
+    record(command);
+}
+
+void MapCommandRecorder::onSectorRemoved(int index, const Sector& sector)
+{
+    MapCommand command = makeCommand(MapCommandType::REMOVE_SECTOR, index);
+    command.payload.sector.from = sector;
+    record(command);
+}
+
+void MapCommandRecorder::onSectorChanged(int index, const Sector& from,
+                                         const Sector& to)
+{
+    MapCommand command = makeCommand(MapCommandType::CHANGE_SECTOR, index);
+    command.payload.sector = {from, to};
+    record(command);
+}
+
+void MapCommandRecorder::onInstanceAdded(int index,
+                                         const PrefabInstance& instance)
+{
+    MapCommand command = makeCommand(MapCommandType::ADD_INSTANCE, index);
+    command.payload.instance.to = instance;
+    record(command);
+}
+
+void MapCommandRecorder::onInstanceRemoved(int index,
+                                           const PrefabInstance& instance)
+{
+    MapCommand command = makeCommand(MapCommandType::REMOVE_INSTANCE, index);
+    command.payload.instance.from = instance;
+    record(command);
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "MapCommand.h"
+#include "MapListener.h"
+
+/**
+ * @brief A base class for listeners that record the edits made to a map as
+ * MapCommands.
+ *
+ * This class turns every primitive edit reported by a map into a command
+ * holding the index of the edited element and its value before and after the
+ * edit, and hands it to record. Applying the recorded commands in order to
+ * the map they were recorded from replays the edits.
+ */
+class MapCommandRecorder : public MapListener
+{
+public:
+    void onVertexAdded(int vertex, glm::vec2 position) override;
+
+    void onVertexRemoved(int vertex, glm::vec2 position) override;
+
+    void onVertexMoved(int vertex, glm::vec2 from, glm::vec2 to) override;
+
+    void onLineAdded(int index, const Line& line) override;
+
+    void onLineRemoved(int index, const Line& line) override;
+
+    void onLineChanged(int index, const Line& from, const Line& to) override;
+
+    void onSideAdded(int index, const Side& side) override;
+
+    void onSideRemoved(int index, const Side& side) override;
+
+    void onSideChanged(int index, const Side& from, const Side& to) override;
+
+    void onSectorAdded(int index, const Sector& sector) override;
+
+    void onSectorRemoved(int index, const Sector& sector) override;
+
+    void onSectorChanged(int index, const Sector& from,
+                         const Sector& to) override;
+
+    void onInstanceAdded(int index, const PrefabInstance& instance) override;
+
+    void onInstanceRemoved(int index,
+                           const PrefabInstance& instance) override;
+
+protected:
+    /**
+     * @brief Records a command.
+     *
+     * @param command The command describing the edit.
+     */
+    virtual void record(const MapCommand& command) = 0;
+
+    /**
+     * @brief Creates a command with the specified type and index.
+     *
+     * @param type The type of the command.
+     * @param index The index of the edited element.
+     * @return The command.
+     */
+    static inline MapCommand makeCommand(MapCommandType type, int index)
+    {
+        MapCommand command;
+        command.type = type;
+        command.index = index;
+        return command;
+    }
+};
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+
+#include "MapArrays.h"
+
+/**
+ * @brief A struct owning the elements of a map as flat arrays.
+ *
+ * This is the owning counterpart of MapArrays, filled by the readers of
+ * formats whose records cannot be used in place.
+ */
+struct MapData
+{
+    // The positions of the vertices
+    std::vector<LineVertex> vertices;
+    // The lines
+    std::vector<Line> lines;
+    // The sides
+    std::vector<Side> sides;
+    // The sectors
+    std::vector<Sector> sectors;
+
+    /**
+     * @brief Gets a view of the arrays.
+     *
+     * @return The arrays, valid until the data is modified.
+     */
+    inline MapArrays getArrays() const
+    {
+        MapArrays arrays;
+        arrays.vertices = vertices.data();
+        arrays.vertexCount = vertices.size();
+        arrays.lines = lines.data();
+        arrays.lineCount = lines.size();
+        arrays.sides = sides.data();
+        arrays.sideCount = sides.size();
+        arrays.sectors = sectors.data();
+        arrays.sectorCount = sectors.size();
+        return arrays;
+    }
+
+    /**
+     * @brief Removes every element.
+     */
+    inline void clear()
+    {
+        vertices.clear();
+        lines.clear();
+        sides.clear();
+        sectors.clear();
+    }
+};
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief An enum class that represents the type of a map element.
+ */
+enum class ElementType : uint8_t
+{
+    VERTEX,
+    LINE,
+    SIDE,
+    SECTOR
+};
+
+/**
+ * @brief A struct referring to a single element of the map.
+ *
+ * This struct identifies an element by its type and its index in the store
+ * of that type, so that behaviour such as selection and deletion can be
+ * dispatched on the type instead of being stored with each element. The
+ * generation of the slot is recorded as well, so a reference to a removed
+ * element is not mistaken for a later element that reuses its index.
+ */
+struct MapElement
+{
+    // The type of the element
+    ElementType type;
+    // The index of the element in the store of its type
+    int index;
+    // The generation of the element's slot
+    uint32_t generation = 0;
+
+    /**
+     * @brief Checks if two MapElement objects refer to the same element.
+     *
+     * @param other The other MapElement object to compare.
+     * @return True if the elements are the same, false otherwise.
+     */
+    bool operator==(const MapElement& other) const
+    {
+        return type == other.type && index == other.index &&
+               generation == other.generation;
+    }
+};
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include "MapFragment.h"
+
+#include <limits>
+#include <unordered_map>
+
+/**
+ * @brief Gets the position of an element in a fragment, adding it if it has
+ * not been copied yet.
+ *
+ * @param positions The position of each copied element, by index.
+ * @param index The index of the element in the map.
+ * @param elements The copied elements.
+ * @param element The element to copy if it is new.
+ * @return The position of the element in the fragment.
+ */
+template <typename T>
+static int copyElement(std::unordered_map<int, int>& positions, int index,
+                       std::vector<T>& elements, const T& element)
+{
+    auto result = positions.emplace(index, static_cast<int>(elements.size()));
+    if (result.second) elements.push_back(element);
+
+    return result.first->second;
+}
+
+MapFragment::MapFragment(const MapStore& store, const std::vector<int>& lines)
+{
+    std::unordered_map<int, int> vertexPositions, linePositions,
+        sidePositions, sectorPositions;
+
+    // Gets the position of a side, copying it and its sector if needed
+    auto copySide = [&](int side)
+    {
+        if (side == -1) return -1;
+
+        int sector = store.getSide(side).sector;
+        if (sector != -1)
+            sector = copyElement(sectorPositions, sector, data.sectors,
+                                 store.getSector(sector));
+
+        return copyElement(sidePositions, side, data.sides, Side(sector));
+    };
+
+    for (int index : lines)
+    {
+        if (!linePositions.emplace(index, data.lines.size()).second) continue;
+
+        const Line& line = store.getLine(index);
+        int startVertex = copyElement(vertexPositions, line.startVertex,
+                                      data.vertices,
+                                      store.getVertex(line.startVertex));
+        int endVertex =
+            copyElement(vertexPositions, line.endVertex, data.vertices,
+                        store.getVertex(line.endVertex));
+
+        data.lines.emplace_back(startVertex, endVertex, copySide(line.front),
+                                copySide(line.back));
+    }
+
+    fitToOrigin();
+}
+
+MapFragment::MapFragment(const MapArrays& arrays)
+{
+    data.vertices.assign(arrays.vertices,
+                         arrays.vertices + arrays.vertexCount);
+    data.lines.assign(arrays.lines, arrays.lines + arrays.lineCount);
+    data.sides.assign(arrays.sides, arrays.sides + arrays.sideCount);
+    data.sectors.assign(arrays.sectors, arrays.sectors + arrays.sectorCount);
+
+    fitToOrigin();
+}
+
+void MapFragment::fitToOrigin()
+{
+    if (data.vertices.empty()) return;
+
+    glm::vec2 min(std::numeric_limits<float>::max());
+    glm::vec2 max(std::numeric_limits<float>::lowest());
+    for (const LineVertex& vertex : data.vertices)
+    {
+        min = glm::min(min, glm::vec2(vertex.x, vertex.y));
+        max = glm::max(max, glm::vec2(vertex.x, vertex.y));
+    }
+
+    // Make the vertices relative to the corner of their bounding box
+    for (LineVertex& vertex : data.vertices)
+        vertex = LineVertex(vertex.x - min.x, vertex.y - min.y);
+
+    size = max - min;
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "MapArrays.h"
+#include "MapData.h"
+#include "MapStore.h"
+
+/**
+ * @brief A class holding a copy of some lines of a map along with their
+ * vertices, sides and sectors.
+ *
+ * The elements refer to each other by position, like the arrays read from a
+ * map file, and the vertices are relative to the minimum corner of their
+ * bounding box, so the fragment can be appended anywhere in a map. A fragment
+ * is never modified once copied, so the clipboard and every instance of a
+ * prefab can share one.
+ */
+class MapFragment
+{
+public:
+    /**
+     * @brief Constructs a new MapFragment object holding copies of lines.
+     *
+     * @param store The elements of the map.
+     * @param lines The indices of the lines to copy. Lines listed twice are
+     * copied once.
+     */
+    MapFragment(const MapStore& store, const std::vector<int>& lines);
+
+    /**
+     * @brief Constructs a new MapFragment object holding copies of arrays,
+     * such as those of a prefab read from a map file.
+     *
+     * @param arrays The arrays, which refer to each other by position.
+     */
+    explicit MapFragment(const MapArrays& arrays);
+
+    /**
+     * @brief Gets a view of the elements of the fragment.
+     *
+     * @return The arrays, which refer to each other by position.
+     */
+    inline MapArrays getArrays() const { return data.getArrays(); }
+
+    /**
+     * @brief Gets the elements of the fragment.
+     *
+     * @return The elements.
+     */
+    inline const MapData& getData() const { return data; }
+
+    /**
+     * @brief Gets the size of the bounding box of the vertices.
+     *
+     * @return The size, whose minimum corner is the origin of the fragment.
+     */
+    inline glm::vec2 getSize() const { return size; }
+
+    /**
+     * @brief Checks if the fragment holds no lines.
+     *
+     * @return True if the fragment is empty, false otherwise.
+     */
+    inline bool isEmpty() const { return data.lines.empty(); }
+
+private:
+    // The elements of the fragment
+    MapData data;
+    // The size of the bounding box of the vertices
+    glm::vec2 size = {0.0f, 0.0f};
+
+    /**
+     * @brief Moves the vertices so that the minimum corner of their bounding
+     * box is the origin, and sets the size.
+     */
+    void fitToOrigin();
+};
\ No newline at end of file
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "../map_components/Line.h"
+#include "../map_components/PrefabInstance.h"
+#include "../map_components/Sector.h"
+#include "../map_components/Side.h"
+
+class MapStore;
+
+/**
+ * @brief An interface for objects that follow the edits made to a map.
+ *
+ * A Map calls its listeners after every primitive edit has been applied, with
+ * enough information to reverse the edit: removals report the removed element
+ * and changes report both the old and the new value. Compound edits, such as
+ * removing a vertex along with its lines, are reported as the sequence of
+ * primitive edits they are made of. Every method does nothing by default, so
+ * listeners only override the edits they care about.
+ */
+class MapListener
+{
+public:
+    virtual ~MapListener() = default;
+
+    /**
+     * @brief Called after a vertex is added.
+     *
+     * @param vertex The index of the vertex.
+     * @param position The position of the vertex.
+     */
+    virtual void onVertexAdded(int vertex, glm::vec2 position) {}
+
+    /**
+     * @brief Called after a vertex is removed.
+     *
+     * @param vertex The index of the vertex.
+     * @param position The position the vertex had.
+     */
+    virtual void onVertexRemoved(int vertex, glm::vec2 position) {}
+
+    /**
+     * @brief Called after a vertex is moved.
+     *
+     * @param vertex The index of the vertex.
+     * @param from The previous position of the vertex.
+     * @param to The new position of the vertex.
+     */
+    virtual void onVertexMoved(int vertex, glm::vec2 from, glm::vec2 to) {}
+
+    /**
+     * @brief Called after a line is added.
+     *
+     * @param index The index of the line.
+     * @param line The line.
+     */
+    virtual void onLineAdded(int index, const Line& line) {}
+
+    /**
+     * @brief Called after a line is removed.
+     *
+     * @param index The index of the line.
+     * @param line The line that was removed.
+     */
+    virtual void onLineRemoved(int index, const Line& line) {}
+
+    /**
+     * @brief Called after the sides of a line change.
+     *
+     * @param index The index of the line.
+     * @param from The line before the change.
+     * @param to The line after the change.
+     */
+    virtual void onLineChanged(int index, const Line& from, const Line& to) {}
+
+    /**
+     * @brief Called after a side is added.
+     *
+     * @param index The index of the side.
+     * @param side The side.
+     */
+    virtual void onSideAdded(int index, const Side& side) {}
+
+    /**
+     * @brief Called after a side is removed.
+     *
+     * @param index The index of the side.
+     * @param side The side that was removed.
+     */
+    virtual void onSideRemoved(int index, const Side& side) {}
+
+    /**
+     * @brief Called after the properties of a side change.
+     *
+     * @param index The index of the side.
+     * @param from The side before the change.
+     * @param to The side after the change.
+     */
+    virtual void onSideChanged(int index, const Side& from, const Side& to) {}
+
+    /**
+     * @brief Called after a sector is added.
+     *
+     * @param index The index of the sector.
+     * @param sector The sector.
+     */
+    virtual void onSectorAdded(int index, const Sector& sector) {}
+
+    /**
+     * @brief Called after a sector is removed.
+     *
+     * @param index The index of the sector.
+     * @param sector The sector that was removed.
+     */
+    virtual void onSectorRemoved(int index, const Sector& sector) {}
+
+    /**
+     * @brief Called after the properties of a sector change.
+     *
+     * @param index The index of the sector.
+     * @param from The sector before the change.
+     * @param to The sector after the change.
+     */
+    virtual void onSectorChanged(int index, const Sector& from,
+                                 const Sector& to)
+    {
+    }
+
+    /**
+     * @brief Called after a prefab is added.
+     *
+     * Prefabs are never modified or removed, so adding one is not an edit
+     * that can be undone, and listeners read the prefab from the store.
+     *
+     * @param prefab The index of the prefab.
+     * @param store The elements of the map, which hold the prefab.
+     */
+    virtual void onPrefabAdded(int prefab, const MapStore& store) {}
+
+    /**
+     * @brief Called after an instance of a prefab is added.
+     *
+     * @param index The index of the instance.
+     * @param instance The instance.
+     */
+    virtual void onInstanceAdded(int index, const PrefabInstance& instance) {}
+
+    /**
+     * @brief Called after an instance of a prefab is removed.
+     *
+     * @param index The index of the instance.
+     * @param instance The instance that was removed.
+     */
+    virtual void onInstanceRemoved(int index, const PrefabInstance& instance)
+    {
+    }
+
+    /**
+     * @brief Called after every element of the map is replaced at once, such
+     * as when a map is loaded.
+     *
+     * No other edit is reported for the replacement, so listeners that mirror
+     * the map rebuild themselves from the store.
+     *
+     * @param store The elements of the map.
+     */
+    virtual void onMapLoaded(const MapStore& store) {}
+};
\ No newline at end of file
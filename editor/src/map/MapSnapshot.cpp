@@ -0,0 +1,82 @@
+#include "MapSnapshot.h"
+
+#include <utility>
+
+void MapSnapshot::assign(const MapStore& store)
+{
+    assignColumn(store.getVertexIndices(), store.getVertexPositions(),
+                 vertices);
+    assignColumn(store.getLineIndices(), store.getLines(), lines);
+    assignColumn(store.getSideIndices(), store.getSides(), sides);
+    assignColumn(store.getSectorIndices(), store.getSectors(), sectors);
+    assignColumn(store.getInstanceIndices(), store.getInstances(), instances);
+    prefabs = store.getPrefabs();
+}
+
+void MapSnapshot::addPrefab(std::shared_ptr<const MapFragment> fragment)
+{
+    prefabs.push_back(std::move(fragment));
+}
+
+void MapSnapshot::apply(const MapCommand& command)
+{
+    const MapCommand::Payload& payload = command.payload;
+
+    switch (command.type)
+    {
+        case MapCommandType::ADD_VERTEX:
+        case MapCommandType::MOVE_VERTEX:
+            vertices.set(command.index, LineVertex(payload.vertex.to.x,
+                                                   payload.vertex.to.y));
+            break;
+        case MapCommandType::REMOVE_VERTEX:
+            vertices.erase(command.index);
+            break;
+        case MapCommandType::ADD_LINE:
+        case MapCommandType::CHANGE_LINE:
+            lines.set(command.index, payload.line.to);
+            break;
+        case MapCommandType::REMOVE_LINE:
+            lines.erase(command.index);
+            break;
+        case MapCommandType::ADD_SIDE:
+        case MapCommandType::CHANGE_SIDE:
+            sides.set(command.index, payload.side.to);
+            break;
+        case MapCommandType::REMOVE_SIDE:
+            sides.erase(command.index);
+            break;
+        case MapCommandType::ADD_SECTOR:
+        case MapCommandType::CHANGE_SECTOR:
+            sectors.set(command.index, payload.sector.to);
+            break;
+        case MapCommandType::REMOVE_SECTOR:
+            sectors.erase(command.index);
+            break;
+        case MapCommandType::ADD_INSTANCE:
+            instances.set(command.index, payload.instance.to);
+            break;
+        case MapCommandType::REMOVE_INSTANCE:
+            instances.erase(command.index);
+            break;
+    }
+}
+
+void MapSnapshot::clear()
+{
+    vertices.clear();
+    lines.clear();
+    sides.clear();
+    sectors.clear();
+    prefabs.clear();
+    instances.clear();
+}
+
+template <typename T>
+void MapSnapshot::assignColumn(const std::vector<uint32_t>& indices,
+                               const std::vector<T>& values,
+                               CowArray<T>& array)
+{
+    array.clear();
+    for (size_t i = 0; i < values.size(); ++i) array.set(indices[i], values[i]);
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "../map_components/Line.h"
+#include "../map_components/LineVertex.h"
+#include "../map_components/PrefabInstance.h"
+#include "../map_components/Sector.h"
+#include "../map_components/Side.h"
+#include "CowArray.h"
+#include "MapCommand.h"
+#include "MapStore.h"
+
+/**
+ * @brief A class holding a copy of the elements of a map in copy-on-write
+ * chunks.
+ *
+ * The copy is kept up to date by applying the commands recorded from the map,
+ * and elements keep the indices they have in the map. Copying a MapSnapshot
+ * takes time proportional to the number of chunks rather than the number of
+ * elements, so a copy can be taken on the main thread without a noticeable
+ * pause and then serialised on a worker thread while editing continues. The
+ * geometry of the prefabs is never modified, so it is shared with the map
+ * rather than copied.
+ */
+class MapSnapshot
+{
+public:
+    /**
+     * @brief Replaces the elements with those of a store.
+     *
+     * @param store The store to copy.
+     */
+    void assign(const MapStore& store);
+
+    /**
+     * @brief Adds a prefab added to the map.
+     *
+     * @param fragment The geometry of the prefab.
+     */
+    void addPrefab(std::shared_ptr<const MapFragment> fragment);
+
+    /**
+     * @brief Applies an edit recorded from the map.
+     *
+     * @param command The command describing the edit.
+     */
+    void apply(const MapCommand& command);
+
+    /**
+     * @brief Removes every element.
+     */
+    void clear();
+
+    /**
+     * @brief Gets the vertex positions, indexed by vertex index.
+     *
+     * @return The vertex positions.
+     */
+    inline const CowArray<LineVertex>& getVertices() const { return vertices; }
+
+    /**
+     * @brief Gets the lines, indexed by line index.
+     *
+     * @return The lines.
+     */
+    inline const CowArray<Line>& getLines() const { return lines; }
+
+    /**
+     * @brief Gets the sides, indexed by side index.
+     *
+     * @return The sides.
+     */
+    inline const CowArray<Side>& getSides() const { return sides; }
+
+    /**
+     * @brief Gets the sectors, indexed by sector index.
+     *
+     * @return The sectors.
+     */
+    inline const CowArray<Sector>& getSectors() const { return sectors; }
+
+    /**
+     * @brief Gets the geometry of each prefab.
+     *
+     * @return The geometry of each prefab, by index.
+     */
+    inline const std::vector<std::shared_ptr<const MapFragment>>& getPrefabs()
+        const
+    {
+        return prefabs;
+    }
+
+    /**
+     * @brief Gets the instances of the prefabs, indexed by instance index.
+     *
+     * @return The instances.
+     */
+    inline const CowArray<PrefabInstance>& getInstances() const
+    {
+        return instances;
+    }
+
+private:
+    // The vertex positions
+    CowArray<LineVertex> vertices;
+    // The lines
+    CowArray<Line> lines;
+    // The sides
+    CowArray<Side> sides;
+    // The sectors
+    CowArray<Sector> sectors;
+    // The geometry of each prefab
+    std::vector<std::shared_ptr<const MapFragment>> prefabs;
+    // The instances of the prefabs
+    CowArray<PrefabInstance> instances;
+
+    /**
+     * @brief Copies a column of a store into an array.
+     *
+     * @tparam T The type of the elements.
+     * @param indices The index of each element of the column.
+     * @param values The column.
+     * @param array The array to copy into.
+     */
+    template <typename T>
+    static void assignColumn(const std::vector<uint32_t>& indices,
+                             const std::vector<T>& values,
+                             CowArray<T>& array);
+};
\ No newline at end of file
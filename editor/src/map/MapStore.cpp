@@ -0,0 +1,238 @@
+#include "MapStore.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "../utils/macros.h"
+#include "MapFragment.h"
+
+int MapStore::addVertex(float x, float y)
+{
+    return vertices.insert(LineVertex(x, y), 0);
+}
+
+void MapStore::insertVertex(int vertex, float x, float y)
+{
+    ASSERT(vertex >= 0 && !hasVertex(vertex));
+
+    vertices.insertAt(vertex, LineVertex(x, y), 0);
+}
+
+void MapStore::removeVertex(int vertex)
+{
+    ASSERT(hasVertex(vertex));
+
+    vertices.erase(vertex);
+}
+
+int MapStore::addLine(int startVertex, int endVertex)
+{
+    ASSERT(hasVertex(startVertex));
+    ASSERT(hasVertex(endVertex));
+
+    ++vertices.get<VERTEX_REF_COUNT>(startVertex);
+    ++vertices.get<VERTEX_REF_COUNT>(endVertex);
+
+    return lines.insert(Line(startVertex, endVertex));
+}
+
+void MapStore::insertLine(int index, const Line& line)
+{
+    ASSERT(index >= 0 && !hasLine(index));
+    ASSERT(hasVertex(line.startVertex));
+    ASSERT(hasVertex(line.endVertex));
+
+    ++vertices.get<VERTEX_REF_COUNT>(line.startVertex);
+    ++vertices.get<VERTEX_REF_COUNT>(line.endVertex);
+
+    lines.insertAt(index, line);
+}
+
+void MapStore::removeLine(int line)
+{
+    ASSERT(hasLine(line));
+
+    const Line& removed = lines.get<LINE_DATA>(line);
+    --vertices.get<VERTEX_REF_COUNT>(removed.startVertex);
+    --vertices.get<VERTEX_REF_COUNT>(removed.endVertex);
+
+    lines.erase(line);
+}
+
+int MapStore::addPrefab(std::shared_ptr<const MapFragment> fragment)
+{
+    ASSERT(fragment && !fragment->isEmpty());
+
+    prefabs.push_back(std::move(fragment));
+    return static_cast<int>(prefabs.size()) - 1;
+}
+
+int MapStore::addInstance(const PrefabInstance& instance)
+{
+    ASSERT(instance.prefab >= 0 &&
+           instance.prefab < static_cast<int>(prefabs.size()));
+
+    return instances.insert(instance);
+}
+
+void MapStore::insertInstance(int index, const PrefabInstance& instance)
+{
+    ASSERT(index >= 0 && !hasInstance(index));
+    ASSERT(instance.prefab >= 0 &&
+           instance.prefab < static_cast<int>(prefabs.size()));
+
+    instances.insertAt(index, instance);
+}
+
+void MapStore::removeInstance(int index)
+{
+    ASSERT(hasInstance(index));
+
+    instances.erase(index);
+}
+
+void MapStore::bakeInstances()
+{
+    AppendedElements added;
+    for (const PrefabInstance& instance : getInstances())
+        append(prefabs[instance.prefab]->getArrays(), instance.position,
+               added);
+
+    instances.clear();
+}
+
+void MapStore::assign(const MapArrays& arrays)
+{
+    vertices.reset(arrays.vertexCount, arrays.vertexIndices);
+    lines.reset(arrays.lineCount, arrays.lineIndices);
+    sides.reset(arrays.sideCount, arrays.sideIndices);
+    sectors.reset(arrays.sectorCount, arrays.sectorIndices);
+
+    std::copy_n(arrays.vertices, arrays.vertexCount,
+                vertices.getColumn<VERTEX_POSITION>().begin());
+    std::copy_n(arrays.lines, arrays.lineCount,
+                lines.getColumn<LINE_DATA>().begin());
+    std::copy_n(arrays.sides, arrays.sideCount, sides.getColumn<0>().begin());
+    std::copy_n(arrays.sectors, arrays.sectorCount,
+                sectors.getColumn<0>().begin());
+
+    prefabs.clear();
+    for (size_t i = 0; i < arrays.prefabCount; ++i)
+        prefabs.push_back(std::make_shared<MapFragment>(arrays.prefabs[i]));
+
+    instances.reset(arrays.instanceCount, arrays.instanceIndices);
+    std::copy_n(arrays.instances, arrays.instanceCount,
+                instances.getColumn<0>().begin());
+
+    if (arrays.vertexIndices)
+    {
+        for (size_t i = 0; i < arrays.lineCount; ++i)
+        {
+            ++vertices.get<VERTEX_REF_COUNT>(arrays.lines[i].startVertex);
+            ++vertices.get<VERTEX_REF_COUNT>(arrays.lines[i].endVertex);
+        }
+        return;
+    }
+
+    // Slot and dense indices are equal after a reset without indices
+    std::vector<unsigned int>& refCounts =
+        vertices.getColumn<VERTEX_REF_COUNT>();
+    for (size_t i = 0; i < arrays.lineCount; ++i)
+    {
+        ++refCounts[arrays.lines[i].startVertex];
+        ++refCounts[arrays.lines[i].endVertex];
+    }
+}
+
+void MapStore::append(const MapArrays& arrays, glm::vec2 offset,
+                      AppendedElements& added)
+{
+    ASSERT(!arrays.vertexIndices && !arrays.lineIndices &&
+           !arrays.sideIndices && !arrays.sectorIndices);
+
+    vertices.reserveAdditional(arrays.vertexCount);
+    lines.reserveAdditional(arrays.lineCount);
+    sides.reserveAdditional(arrays.sideCount);
+    sectors.reserveAdditional(arrays.sectorCount);
+
+    added.sectors.resize(arrays.sectorCount);
+    for (size_t i = 0; i < arrays.sectorCount; ++i)
+        added.sectors[i] = sectors.insert(arrays.sectors[i]);
+
+    added.sides.resize(arrays.sideCount);
+    for (size_t i = 0; i < arrays.sideCount; ++i)
+    {
+        int sector = arrays.sides[i].sector;
+        added.sides[i] =
+            sides.insert(Side(sector == -1 ? -1 : added.sectors[sector]));
+    }
+
+    added.vertices.resize(arrays.vertexCount);
+    for (size_t i = 0; i < arrays.vertexCount; ++i)
+    {
+        const LineVertex& vertex = arrays.vertices[i];
+        LineVertex position(vertex.x + offset.x, vertex.y + offset.y);
+        added.vertices[i] = vertices.insert(position, 0);
+    }
+
+    added.lines.resize(arrays.lineCount);
+    for (size_t i = 0; i < arrays.lineCount; ++i)
+    {
+        const Line& line = arrays.lines[i];
+        int startVertex = added.vertices[line.startVertex];
+        int endVertex = added.vertices[line.endVertex];
+
+        ++vertices.get<VERTEX_REF_COUNT>(startVertex);
+        ++vertices.get<VERTEX_REF_COUNT>(endVertex);
+
+        added.lines[i] = lines.insert(
+            Line(startVertex, endVertex,
+                 line.front == -1 ? -1 : added.sides[line.front],
+                 line.back == -1 ? -1 : added.sides[line.back]));
+    }
+}
+
+MapElement MapStore::getElement(ElementType type, int index) const
+{
+    SlotHandle handle;
+
+    switch (type)
+    {
+        case ElementType::VERTEX:
+            handle = vertices.getHandle(index);
+            break;
+        case ElementType::LINE:
+            handle = lines.getHandle(index);
+            break;
+        case ElementType::SIDE:
+            handle = sides.getHandle(index);
+            break;
+        case ElementType::SECTOR:
+            handle = sectors.getHandle(index);
+            break;
+    }
+
+    return {type, static_cast<int>(handle.index), handle.generation};
+}
+
+bool MapStore::contains(MapElement element) const
+{
+    if (element.index < 0) return false;
+
+    SlotHandle handle = {static_cast<uint32_t>(element.index),
+                         element.generation};
+
+    switch (element.type)
+    {
+        case ElementType::VERTEX:
+            return vertices.contains(handle);
+        case ElementType::LINE:
+            return lines.contains(handle);
+        case ElementType::SIDE:
+            return sides.contains(handle);
+        case ElementType::SECTOR:
+            return sectors.contains(handle);
+    }
+
+    return false;
+}
\ No newline at end of file
@@ -0,0 +1,634 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+#include "../map_components/Line.h"
+#include "../map_components/LineVertex.h"
+#include "../map_components/PrefabInstance.h"
+#include "../map_components/Sector.h"
+#include "../map_components/Side.h"
+#include "MapArrays.h"
+#include "MapElement.h"
+#include "SlotMap.h"
+
+class MapFragment;
+
+/**
+ * @brief A struct holding the indices that appended elements were stored at.
+ */
+struct AppendedElements
+{
+    // The index of each appended vertex, by position in the arrays
+    std::vector<int> vertices;
+    // The index of each appended line, by position in the arrays
+    std::vector<int> lines;
+    // The index of each appended side, by position in the arrays
+    std::vector<int> sides;
+    // The index of each appended sector, by position in the arrays
+    std::vector<int> sectors;
+};
+
+/**
+ * @brief A structure-of-arrays store for the elements of the map.
+ *
+ * This class keeps vertices, lines, sides and sectors in generational slot
+ * maps. Each property of an element lives in its own densely packed array
+ * (vertex positions and vertex reference counts), so scans over a single
+ * property touch only that property and never visit removed elements.
+ * Elements are addressed by slot index, which is stable while the element
+ * lives, and MapElement handles carry the slot generation so that stale
+ * references can be detected.
+ *
+ * The store also holds the prefabs of the map, whose geometry is shared and
+ * never modified, and the instances stamped from them. Prefabs are never
+ * removed, so an instance can always refer to its prefab by position.
+ */
+class MapStore
+{
+public:
+    /**
+     * @brief Adds a vertex at the specified position.
+     *
+     * @param x The x coordinate of the vertex.
+     * @param y The y coordinate of the vertex.
+     * @return The index of the vertex.
+     */
+    int addVertex(float x, float y);
+
+    /**
+     * @brief Adds a vertex at the specified free index.
+     *
+     * This method restores a removed vertex under its previous index.
+     *
+     * @param vertex The index of the vertex, which must be free.
+     * @param x The x coordinate of the vertex.
+     * @param y The y coordinate of the vertex.
+     */
+    void insertVertex(int vertex, float x, float y);
+
+    /**
+     * @brief Moves the vertex at the specified index.
+     *
+     * @param vertex The index of the vertex.
+     * @param x The new x coordinate of the vertex.
+     * @param y The new y coordinate of the vertex.
+     */
+    inline void setVertex(int vertex, float x, float y)
+    {
+        vertices.get<VERTEX_POSITION>(vertex) = LineVertex(x, y);
+    }
+
+    /**
+     * @brief Removes the vertex at the specified index.
+     *
+     * @param vertex The index of the vertex.
+     */
+    void removeVertex(int vertex);
+
+    /**
+     * @brief Checks if the specified vertex exists.
+     *
+     * @param vertex The index of the vertex.
+     * @return True if the vertex exists, false otherwise.
+     */
+    inline bool hasVertex(int vertex) const
+    {
+        return vertex >= 0 && vertices.contains(vertex);
+    }
+
+    /**
+     * @brief Gets the vertex at the specified index.
+     *
+     * @param vertex The index of the vertex.
+     * @return The vertex.
+     */
+    inline const LineVertex& getVertex(int vertex) const
+    {
+        return vertices.get<VERTEX_POSITION>(vertex);
+    }
+
+    /**
+     * @brief Gets the number of vertices.
+     *
+     * @return The number of vertices.
+     */
+    inline int getVertexCount() const { return vertices.size(); }
+
+    /**
+     * @brief Gets the number of vertex slots, including free ones.
+     *
+     * @return The number of vertex slots.
+     */
+    inline size_t getVertexSlotCount() const
+    {
+        return vertices.getSlotCount();
+    }
+
+    /**
+     * @brief Gets the positions of the vertices in dense order.
+     *
+     * @return The positions of the vertices.
+     */
+    inline const std::vector<LineVertex>& getVertexPositions() const
+    {
+        return vertices.getColumn<VERTEX_POSITION>();
+    }
+
+    /**
+     * @brief Gets the indices of the vertices in dense order.
+     *
+     * @return The indices of the vertices.
+     */
+    inline const std::vector<uint32_t>& getVertexIndices() const
+    {
+        return vertices.getSlotIndices();
+    }
+
+    /**
+     * @brief Gets the number of lines that use the specified vertex.
+     *
+     * @param vertex The index of the vertex.
+     * @return The reference count of the vertex.
+     */
+    inline unsigned int getVertexRefCount(int vertex) const
+    {
+        return vertices.get<VERTEX_REF_COUNT>(vertex);
+    }
+
+    /**
+     * @brief Adds a line between the specified vertices.
+     *
+     * This method also adds a reference to both vertices.
+     *
+     * @param startVertex The index of the start vertex.
+     * @param endVertex The index of the end vertex.
+     * @return The index of the line.
+     */
+    int addLine(int startVertex, int endVertex);
+
+    /**
+     * @brief Adds a line at the specified free index.
+     *
+     * This method restores a removed line, including its sides, under its
+     * previous index. It also adds a reference to both vertices.
+     *
+     * @param index The index of the line, which must be free.
+     * @param line The line to restore.
+     */
+    void insertLine(int index, const Line& line);
+
+    /**
+     * @brief Sets the sides of the line at the specified index.
+     *
+     * @param line The index of the line.
+     * @param front The index of the front side, or -1 for none.
+     * @param back The index of the back side, or -1 for none.
+     */
+    inline void setLineSides(int line, int front, int back)
+    {
+        Line& data = lines.get<LINE_DATA>(line);
+        data.front = front;
+        data.back = back;
+    }
+
+    /**
+     * @brief Removes the line at the specified index.
+     *
+     * This method also releases the references the line holds on its
+     * vertices. Vertices are not removed when their count drops to zero.
+     *
+     * @param line The index of the line.
+     */
+    void removeLine(int line);
+
+    /**
+     * @brief Checks if the specified line exists.
+     *
+     * @param line The index of the line.
+     * @return True if the line exists, false otherwise.
+     */
+    inline bool hasLine(int line) const
+    {
+        return line >= 0 && lines.contains(line);
+    }
+
+    /**
+     * @brief Gets the line at the specified index.
+     *
+     * @param line The index of the line.
+     * @return The line.
+     */
+    inline const Line& getLine(int line) const
+    {
+        return lines.get<LINE_DATA>(line);
+    }
+
+    /**
+     * @brief Gets the number of lines.
+     *
+     * @return The number of lines.
+     */
+    inline int getLineCount() const { return lines.size(); }
+
+    /**
+     * @brief Gets the number of line slots, including free ones.
+     *
+     * @return The number of line slots.
+     */
+    inline size_t getLineSlotCount() const { return lines.getSlotCount(); }
+
+    /**
+     * @brief Gets the lines in dense order.
+     *
+     * @return The lines.
+     */
+    inline const std::vector<Line>& getLines() const
+    {
+        return lines.getColumn<LINE_DATA>();
+    }
+
+    /**
+     * @brief Gets the indices of the lines in dense order.
+     *
+     * @return The indices of the lines.
+     */
+    inline const std::vector<uint32_t>& getLineIndices() const
+    {
+        return lines.getSlotIndices();
+    }
+
+    /**
+     * @brief Adds a side.
+     *
+     * @param side The side to add.
+     * @return The index of the side.
+     */
+    inline int addSide(const Side& side) { return sides.insert(side); }
+
+    /**
+     * @brief Adds a side at the specified free index.
+     *
+     * @param index The index of the side, which must be free.
+     * @param side The side to add.
+     */
+    inline void insertSide(int index, const Side& side)
+    {
+        sides.insertAt(index, side);
+    }
+
+    /**
+     * @brief Removes the side at the specified index.
+     *
+     * @param side The index of the side.
+     */
+    inline void removeSide(int side) { sides.erase(side); }
+
+    /**
+     * @brief Checks if the specified side exists.
+     *
+     * @param side The index of the side.
+     * @return True if the side exists, false otherwise.
+     */
+    inline bool hasSide(int side) const
+    {
+        return side >= 0 && sides.contains(side);
+    }
+
+    /**
+     * @brief Gets the side at the specified index.
+     *
+     * @param side The index of the side.
+     * @return The side.
+     */
+    inline Side& getSide(int side) { return sides.get<0>(side); }
+
+    /**
+     * @brief Gets the side at the specified index.
+     *
+     * @param side The index of the side.
+     * @return The side.
+     */
+    inline const Side& getSide(int side) const { return sides.get<0>(side); }
+
+    /**
+     * @brief Gets the number of sides.
+     *
+     * @return The number of sides.
+     */
+    inline int getSideCount() const { return sides.size(); }
+
+    /**
+     * @brief Gets the number of side slots, including free ones.
+     *
+     * @return The number of side slots.
+     */
+    inline size_t getSideSlotCount() const { return sides.getSlotCount(); }
+
+    /**
+     * @brief Gets the sides in dense order.
+     *
+     * @return The sides.
+     */
+    inline const std::vector<Side>& getSides() const
+    {
+        return sides.getColumn<0>();
+    }
+
+    /**
+     * @brief Gets the indices of the sides in dense order.
+     *
+     * @return The indices of the sides.
+     */
+    inline const std::vector<uint32_t>& getSideIndices() const
+    {
+        return sides.getSlotIndices();
+    }
+
+    /**
+     * @brief Adds a sector.
+     *
+     * @param sector The sector to add.
+     * @return The index of the sector.
+     */
+    inline int addSector(const Sector& sector)
+    {
+        return sectors.insert(sector);
+    }
+
+    /**
+     * @brief Adds a sector at the specified free index.
+     *
+     * @param index The index of the sector, which must be free.
+     * @param sector The sector to add.
+     */
+    inline void insertSector(int index, const Sector& sector)
+    {
+        sectors.insertAt(index, sector);
+    }
+
+    /**
+     * @brief Removes the sector at the specified index.
+     *
+     * @param sector The index of the sector.
+     */
+    inline void removeSector(int sector) { sectors.erase(sector); }
+
+    /**
+     * @brief Checks if the specified sector exists.
+     *
+     * @param sector The index of the sector.
+     * @return True if the sector exists, false otherwise.
+     */
+    inline bool hasSector(int sector) const
+    {
+        return sector >= 0 && sectors.contains(sector);
+    }
+
+    /**
+     * @brief Gets the sector at the specified index.
+     *
+     * @param sector The index of the sector.
+     * @return The sector.
+     */
+    inline Sector& getSector(int sector) { return sectors.get<0>(sector); }
+
+    /**
+     * @brief Gets the sector at the specified index.
+     *
+     * @param sector The index of the sector.
+     * @return The sector.
+     */
+    inline const Sector& getSector(int sector) const
+    {
+        return sectors.get<0>(sector);
+    }
+
+    /**
+     * @brief Gets the number of sectors.
+     *
+     * @return The number of sectors.
+     */
+    inline int getSectorCount() const { return sectors.size(); }
+
+    /**
+     * @brief Gets the number of sector slots, including free ones.
+     *
+     * @return The number of sector slots.
+     */
+    inline size_t getSectorSlotCount() const
+    {
+        return sectors.getSlotCount();
+    }
+
+    /**
+     * @brief Gets the sectors in dense order.
+     *
+     * @return The sectors.
+     */
+    inline const std::vector<Sector>& getSectors() const
+    {
+        return sectors.getColumn<0>();
+    }
+
+    /**
+     * @brief Gets the indices of the sectors in dense order.
+     *
+     * @return The indices of the sectors.
+     */
+    inline const std::vector<uint32_t>& getSectorIndices() const
+    {
+        return sectors.getSlotIndices();
+    }
+
+    /**
+     * @brief Adds a prefab.
+     *
+     * @param fragment The geometry of the prefab, which must hold lines.
+     * @return The index of the prefab.
+     */
+    int addPrefab(std::shared_ptr<const MapFragment> fragment);
+
+    /**
+     * @brief Gets the number of prefabs.
+     *
+     * @return The number of prefabs.
+     */
+    inline size_t getPrefabCount() const { return prefabs.size(); }
+
+    /**
+     * @brief Gets the geometry of a prefab, which is shared by its
+     * instances.
+     *
+     * @param prefab The index of the prefab.
+     * @return The geometry.
+     */
+    inline const std::shared_ptr<const MapFragment>& getPrefab(
+        int prefab) const
+    {
+        return prefabs[prefab];
+    }
+
+    /**
+     * @brief Gets the geometry of every prefab.
+     *
+     * @return The geometry of each prefab, by index.
+     */
+    inline const std::vector<std::shared_ptr<const MapFragment>>& getPrefabs()
+        const
+    {
+        return prefabs;
+    }
+
+    /**
+     * @brief Adds an instance of a prefab.
+     *
+     * @param instance The instance, whose prefab must exist.
+     * @return The index of the instance.
+     */
+    int addInstance(const PrefabInstance& instance);
+
+    /**
+     * @brief Adds an instance of a prefab at the specified free index.
+     *
+     * @param index The index of the instance, which must be free.
+     * @param instance The instance, whose prefab must exist.
+     */
+    void insertInstance(int index, const PrefabInstance& instance);
+
+    /**
+     * @brief Removes the instance at the specified index.
+     *
+     * @param index The index of the instance.
+     */
+    void removeInstance(int index);
+
+    /**
+     * @brief Checks if the specified instance exists.
+     *
+     * @param index The index of the instance.
+     * @return True if the instance exists, false otherwise.
+     */
+    inline bool hasInstance(int index) const
+    {
+        return index >= 0 && instances.contains(index);
+    }
+
+    /**
+     * @brief Gets the instance at the specified index.
+     *
+     * @param index The index of the instance.
+     * @return The instance.
+     */
+    inline const PrefabInstance& getInstance(int index) const
+    {
+        return instances.get<0>(index);
+    }
+
+    /**
+     * @brief Gets the number of instances.
+     *
+     * @return The number of instances.
+     */
+    inline int getInstanceCount() const { return instances.size(); }
+
+    /**
+     * @brief Gets the instances in dense order.
+     *
+     * @return The instances.
+     */
+    inline const std::vector<PrefabInstance>& getInstances() const
+    {
+        return instances.getColumn<0>();
+    }
+
+    /**
+     * @brief Gets the indices of the instances in dense order.
+     *
+     * @return The indices of the instances.
+     */
+    inline const std::vector<uint32_t>& getInstanceIndices() const
+    {
+        return instances.getSlotIndices();
+    }
+
+    /**
+     * @brief Replaces every instance with a copy of the geometry of its
+     * prefab, for formats that cannot hold instances.
+     */
+    void bakeInstances();
+
+    /**
+     * @brief Replaces every element, prefab and instance with the contents of
+     * flat arrays.
+     *
+     * The arrays are copied in bulk, and the elements take the indices listed
+     * in the arrays, or their position if none are listed. Vertex reference
+     * counts are recomputed from the lines. Handles to the previous elements
+     * become stale.
+     *
+     * @param arrays The arrays, whose cross-references must be in range.
+     */
+    void assign(const MapArrays& arrays);
+
+    /**
+     * @brief Adds copies of the elements of flat arrays, moved by an offset.
+     *
+     * Room for every element is reserved once, and the references between
+     * the elements are remapped to the indices they are stored at in a single
+     * pass, with no lookups of existing elements.
+     *
+     * @param arrays The arrays, which refer to each other by position.
+     * @param offset The offset added to the positions of the vertices.
+     * @param added Set to the indices the elements were stored at.
+     */
+    void append(const MapArrays& arrays, glm::vec2 offset,
+                AppendedElements& added);
+
+    /**
+     * @brief Gets a generation-checked handle to the specified element.
+     *
+     * @param type The type of the element.
+     * @param index The index of the element, which must exist.
+     * @return The handle to the element.
+     */
+    MapElement getElement(ElementType type, int index) const;
+
+    /**
+     * @brief Checks if the specified element handle still refers to a live
+     * element.
+     *
+     * @param element The element handle.
+     * @return True if the element is live, false if it was removed.
+     */
+    bool contains(MapElement element) const;
+
+private:
+    // The columns of the vertex slot map
+    enum VertexColumn
+    {
+        VERTEX_POSITION,
+        VERTEX_REF_COUNT
+    };
+
+    // The columns of the line slot map
+    enum LineColumn
+    {
+        LINE_DATA
+    };
+
+    // The positions and reference counts of the vertices
+    SlotMap<LineVertex, unsigned int> vertices;
+    // The endpoints and sides of the lines
+    SlotMap<Line> lines;
+    // The sides of the map
+    SlotMap<Side> sides;
+    // The sectors of the map
+    SlotMap<Sector> sectors;
+    // The geometry of each prefab
+    std::vector<std::shared_ptr<const MapFragment>> prefabs;
+    // The instances of the prefabs
+    SlotMap<PrefabInstance> instances;
+};
\ No newline at end of file
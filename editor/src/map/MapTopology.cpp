@@ -0,0 +1,194 @@
+#include "MapTopology.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "../utils/macros.h"
+#include "MapStore.h"
+
+void MapTopology::addLine(int line, int startVertex, int endVertex,
+                          glm::vec2 startPos, glm::vec2 endPos)
+{
+    ASSERT(line >= 0);
+    ASSERT(startVertex >= 0 && endVertex >= 0);
+    ASSERT(startVertex != endVertex);
+
+    int front = getHalfEdge(line);
+    int back = getHalfEdge(line, true);
+
+    if (back >= halfEdges.size()) halfEdges.resize(back + 1);
+    int maxVertex = std::max(startVertex, endVertex);
+    if (maxVertex >= outgoing.size()) outgoing.resize(maxVertex + 1);
+
+    ASSERT(halfEdges.at(front).origin == -1);
+
+    glm::vec2 dir = endPos - startPos;
+
+    HalfEdge& frontEdge = halfEdges.at(front);
+    frontEdge = HalfEdge();
+    frontEdge.origin = startVertex;
+    frontEdge.angle = std::atan2(dir.y, dir.x);
+
+    HalfEdge& backEdge = halfEdges.at(back);
+    backEdge = HalfEdge();
+    backEdge.origin = endVertex;
+    backEdge.angle = std::atan2(-dir.y, -dir.x);
+
+    insertOutgoing(front);
+    insertOutgoing(back);
+
+    relink(startVertex);
+    relink(endVertex);
+}
+
+void MapTopology::removeLine(int line)
+{
+    ASSERT(hasLine(line));
+
+    int front = getHalfEdge(line);
+    int back = getHalfEdge(line, true);
+
+    int startVertex = halfEdges.at(front).origin;
+    int endVertex = halfEdges.at(back).origin;
+
+    eraseOutgoing(front);
+    eraseOutgoing(back);
+
+    halfEdges.at(front) = HalfEdge();
+    halfEdges.at(back) = HalfEdge();
+
+    relink(startVertex);
+    relink(endVertex);
+}
+
+int MapTopology::findLine(int vertex1, int vertex2) const
+{
+    // Scan whichever endpoint has the smaller degree
+    if (getDegree(vertex2) < getDegree(vertex1)) std::swap(vertex1, vertex2);
+
+    for (int halfEdge : getOutgoing(vertex1))
+    {
+        if (getDestination(halfEdge) == vertex2) return getLine(halfEdge);
+    }
+
+    return -1;
+}
+
+const std::vector<int>& MapTopology::getOutgoing(int vertex) const
+{
+    static const std::vector<int> empty;
+
+    if (vertex < 0 || vertex >= outgoing.size()) return empty;
+    return outgoing[vertex];
+}
+
+std::vector<int> MapTopology::getIncidentLines(int vertex) const
+{
+    const std::vector<int>& halfEdges = getOutgoing(vertex);
+
+    std::vector<int> lines;
+    lines.reserve(halfEdges.size());
+    for (int halfEdge : halfEdges) lines.push_back(getLine(halfEdge));
+
+    return lines;
+}
+
+void MapTopology::build(const MapStore& store)
+{
+    const std::vector<Line>& lines = store.getLines();
+    const std::vector<uint32_t>& lineIndices = store.getLineIndices();
+    size_t vertexSlotCount = store.getVertexSlotCount();
+
+    halfEdges.assign(2 * store.getLineSlotCount(), HalfEdge());
+    outgoing.assign(vertexSlotCount, std::vector<int>());
+
+    // Size every fan up front so that each is allocated once
+    std::vector<int> degrees(vertexSlotCount, 0);
+    for (const Line& line : lines)
+    {
+        ++degrees[line.startVertex];
+        ++degrees[line.endVertex];
+    }
+
+    for (size_t i = 0; i < vertexSlotCount; ++i)
+        outgoing[i].reserve(degrees[i]);
+
+    for (size_t i = 0; i < lines.size(); ++i)
+    {
+        const Line& line = lines[i];
+        ASSERT(line.startVertex != line.endVertex);
+
+        const LineVertex& start = store.getVertex(line.startVertex);
+        const LineVertex& end = store.getVertex(line.endVertex);
+        glm::vec2 dir = {end.x - start.x, end.y - start.y};
+
+        int front = getHalfEdge(lineIndices[i]);
+        int back = getHalfEdge(lineIndices[i], true);
+
+        halfEdges[front].origin = line.startVertex;
+        halfEdges[front].angle = std::atan2(dir.y, dir.x);
+        halfEdges[front].side = line.front;
+
+        halfEdges[back].origin = line.endVertex;
+        halfEdges[back].angle = std::atan2(-dir.y, -dir.x);
+        halfEdges[back].side = line.back;
+
+        outgoing[line.startVertex].push_back(front);
+        outgoing[line.endVertex].push_back(back);
+    }
+
+    // Ties are ordered by line, as they are when adding lines one by one
+    for (size_t i = 0; i < vertexSlotCount; ++i)
+    {
+        std::vector<int>& edges = outgoing[i];
+        if (edges.empty()) continue;
+
+        std::sort(edges.begin(), edges.end(),
+                  [this](int a, int b)
+                  {
+                      float angleA = halfEdges[a].angle;
+                      float angleB = halfEdges[b].angle;
+                      return angleA < angleB || (angleA == angleB && a < b);
+                  });
+        relink(i);
+    }
+}
+
+void MapTopology::clear()
+{
+    halfEdges.clear();
+    outgoing.clear();
+}
+
+void MapTopology::insertOutgoing(int halfEdge)
+{
+    std::vector<int>& edges = outgoing.at(halfEdges.at(halfEdge).origin);
+    float angle = halfEdges.at(halfEdge).angle;
+
+    auto it = std::upper_bound(edges.begin(), edges.end(), angle,
+                               [this](float angle, int other)
+                               { return angle < halfEdges.at(other).angle; });
+    edges.insert(it, halfEdge);
+}
+
+void MapTopology::eraseOutgoing(int halfEdge)
+{
+    std::vector<int>& edges = outgoing.at(halfEdges.at(halfEdge).origin);
+    edges.erase(std::find(edges.begin(), edges.end(), halfEdge));
+}
+
+void MapTopology::relink(int vertex)
+{
+    const std::vector<int>& edges = outgoing.at(vertex);
+
+    // A half-edge arriving at the vertex continues along the outgoing
+    // half-edge that follows its twin counter-clockwise, which keeps the face
+    // on the right
+    for (int i = 0; i < edges.size(); ++i)
+    {
+        int incoming = getTwin(edges[i]);
+        int next = edges[(i + 1) % edges.size()];
+        halfEdges.at(incoming).next = next;
+        halfEdges.at(next).prev = incoming;
+    }
+}
\ No newline at end of file
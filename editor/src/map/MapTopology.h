@@ -0,0 +1,284 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+class MapStore;
+
+/**
+ * @brief A doubly-connected edge list (DCEL) over the lines of the map.
+ *
+ * This class maintains the half-edge topology of the map so that adjacency
+ * queries scale with the local degree of a vertex rather than with the size of
+ * the map. Every line owns two half-edges: half-edge 2 * line runs from the
+ * start vertex to the end vertex and carries the front side, and half-edge
+ * 2 * line + 1 runs the other way and carries the back side. The face of a
+ * half-edge lies on its right, so following next pointers walks a face in
+ * clockwise order.
+ */
+class MapTopology
+{
+public:
+    /**
+     * @brief Gets the half-edge of the specified line.
+     *
+     * @param line The index of the line.
+     * @param back Whether to get the back half-edge instead of the front one.
+     * @return The index of the half-edge.
+     */
+    static inline int getHalfEdge(int line, bool back = false)
+    {
+        return 2 * line + (back ? 1 : 0);
+    }
+
+    /**
+     * @brief Gets the line that owns the specified half-edge.
+     *
+     * @param halfEdge The index of the half-edge.
+     * @return The index of the line.
+     */
+    static inline int getLine(int halfEdge) { return halfEdge >> 1; }
+
+    /**
+     * @brief Gets the twin of the specified half-edge.
+     *
+     * @param halfEdge The index of the half-edge.
+     * @return The index of the twin half-edge.
+     */
+    static inline int getTwin(int halfEdge) { return halfEdge ^ 1; }
+
+    /**
+     * @brief Checks if the specified half-edge is the back half-edge of its
+     * line.
+     *
+     * @param halfEdge The index of the half-edge.
+     * @return True if the half-edge is a back half-edge, false otherwise.
+     */
+    static inline bool isBack(int halfEdge) { return halfEdge & 1; }
+
+    /**
+     * @brief Adds a line to the topology.
+     *
+     * This method adds the two half-edges of the specified line and links them
+     * into the angular ordering around both endpoints. The cost is
+     * proportional to the degree of the endpoints.
+     *
+     * @param line The index of the line.
+     * @param startVertex The index of the start vertex.
+     * @param endVertex The index of the end vertex.
+     * @param startPos The position of the start vertex.
+     * @param endPos The position of the end vertex.
+     */
+    void addLine(int line, int startVertex, int endVertex, glm::vec2 startPos,
+                 glm::vec2 endPos);
+
+    /**
+     * @brief Removes a line from the topology.
+     *
+     * This method unlinks the two half-edges of the specified line from both
+     * endpoints. The cost is proportional to the degree of the endpoints.
+     *
+     * @param line The index of the line.
+     */
+    void removeLine(int line);
+
+    /**
+     * @brief Gets the index of the line between the specified vertices.
+     *
+     * @param vertex1 The index of the first vertex.
+     * @param vertex2 The index of the second vertex.
+     * @return The index of the line, or -1 if no line is found.
+     */
+    int findLine(int vertex1, int vertex2) const;
+
+    /**
+     * @brief Gets the half-edges leaving the specified vertex.
+     *
+     * The half-edges are sorted counter-clockwise by angle.
+     *
+     * @param vertex The index of the vertex.
+     * @return The outgoing half-edges of the vertex.
+     */
+    const std::vector<int>& getOutgoing(int vertex) const;
+
+    /**
+     * @brief Gets the indices of the lines incident to the specified vertex.
+     *
+     * @param vertex The index of the vertex.
+     * @return A vector containing the indices of the lines.
+     */
+    std::vector<int> getIncidentLines(int vertex) const;
+
+    /**
+     * @brief Gets the number of lines incident to the specified vertex.
+     *
+     * @param vertex The index of the vertex.
+     * @return The degree of the vertex.
+     */
+    inline int getDegree(int vertex) const
+    {
+        return getOutgoing(vertex).size();
+    }
+
+    /**
+     * @brief Gets the origin vertex of the specified half-edge.
+     *
+     * @param halfEdge The index of the half-edge.
+     * @return The index of the origin vertex.
+     */
+    inline int getOrigin(int halfEdge) const
+    {
+        return halfEdges.at(halfEdge).origin;
+    }
+
+    /**
+     * @brief Gets the destination vertex of the specified half-edge.
+     *
+     * @param halfEdge The index of the half-edge.
+     * @return The index of the destination vertex.
+     */
+    inline int getDestination(int halfEdge) const
+    {
+        return halfEdges.at(getTwin(halfEdge)).origin;
+    }
+
+    /**
+     * @brief Gets the next half-edge around the face of the specified
+     * half-edge.
+     *
+     * @param halfEdge The index of the half-edge.
+     * @return The index of the next half-edge.
+     */
+    inline int getNext(int halfEdge) const
+    {
+        return halfEdges.at(halfEdge).next;
+    }
+
+    /**
+     * @brief Gets the previous half-edge around the face of the specified
+     * half-edge.
+     *
+     * @param halfEdge The index of the half-edge.
+     * @return The index of the previous half-edge.
+     */
+    inline int getPrev(int halfEdge) const
+    {
+        return halfEdges.at(halfEdge).prev;
+    }
+
+    /**
+     * @brief Gets the side attached to the specified half-edge.
+     *
+     * @param halfEdge The index of the half-edge.
+     * @return The index of the side, or -1 if no side is attached.
+     */
+    inline int getSide(int halfEdge) const
+    {
+        return halfEdges.at(halfEdge).side;
+    }
+
+    /**
+     * @brief Attaches a side to the specified half-edge.
+     *
+     * @param halfEdge The index of the half-edge.
+     * @param side The index of the side, or -1 to detach the side.
+     */
+    inline void setSide(int halfEdge, int side)
+    {
+        halfEdges.at(halfEdge).side = side;
+    }
+
+    /**
+     * @brief Checks if the specified line is part of the topology.
+     *
+     * @param line The index of the line.
+     * @return True if the line is part of the topology, false otherwise.
+     */
+    inline bool hasLine(int line) const
+    {
+        int halfEdge = getHalfEdge(line);
+        return halfEdge < halfEdges.size() && halfEdges[halfEdge].origin != -1;
+    }
+
+    /**
+     * @brief Walks the face of the specified half-edge.
+     *
+     * This method calls the specified function for every half-edge around the
+     * face, starting at the specified half-edge and following next pointers.
+     * The walk stops early if the function returns false.
+     *
+     * @tparam Func A callable taking a half-edge index and returning a bool.
+     * @param halfEdge The index of the starting half-edge.
+     * @param func The function to call for each half-edge.
+     */
+    template <typename Func>
+    void walkFace(int halfEdge, Func func) const
+    {
+        int current = halfEdge;
+        do
+        {
+            if (!func(current)) return;
+            current = getNext(current);
+        } while (current != halfEdge);
+    }
+
+    /**
+     * @brief Replaces the topology with the lines of a store.
+     *
+     * This is equivalent to adding every line and setting its sides, but
+     * each vertex is sorted and relinked once rather than once per line.
+     *
+     * @param store The store, whose lines must have distinct endpoints.
+     */
+    void build(const MapStore& store);
+
+    /**
+     * @brief Removes all lines from the topology.
+     */
+    void clear();
+
+private:
+    /**
+     * @brief A struct representing a half-edge.
+     */
+    struct HalfEdge
+    {
+        // Index of the origin vertex, or -1 if the half-edge is unused
+        int origin = -1;
+        // Index of the next half-edge around the face
+        int next = -1;
+        // Index of the previous half-edge around the face
+        int prev = -1;
+        // Index of the side attached to the half-edge
+        int side = -1;
+        // Angle of the half-edge around its origin
+        float angle = 0.0f;
+    };
+
+    // The half-edges, indexed by 2 * line (+ 1 for the back half-edge)
+    std::vector<HalfEdge> halfEdges;
+    // The outgoing half-edges of each vertex, sorted counter-clockwise
+    std::vector<std::vector<int>> outgoing;
+
+    /**
+     * @brief Inserts a half-edge into the angular ordering of its origin.
+     *
+     * @param halfEdge The index of the half-edge.
+     */
+    void insertOutgoing(int halfEdge);
+
+    /**
+     * @brief Removes a half-edge from the angular ordering of its origin.
+     *
+     * @param halfEdge The index of the half-edge.
+     */
+    void eraseOutgoing(int halfEdge);
+
+    /**
+     * @brief Relinks the next and previous pointers of the half-edges that
+     * pass through the specified vertex.
+     *
+     * @param vertex The index of the vertex.
+     */
+    void relink(int vertex);
+};
\ No newline at end of file
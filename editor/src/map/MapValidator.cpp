@@ -0,0 +1,445 @@
+#include "MapValidator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <utility>
+
+#include "Geometry.h"
+
+// The name of each kind of problem, and of the elements it refers to
+static const struct
+{
+    const char* name;
+    const char* element;
+    const char* other;
+} ISSUE_NAMES[] = {
+    {"zero_length_line", "line", nullptr},
+    {"duplicate_line", "line", "otherLine"},
+    {"overlapping_line", "line", "otherLine"},
+    {"unclosed_sector", "sector", "vertex"},
+    {"dangling_vertex", "vertex", nullptr},
+    {"invalid_line_side", "line", "side"},
+    {"invalid_side_sector", "side", "sector"},
+    {"ceiling_below_floor", "sector", nullptr},
+};
+
+MapValidator::MapValidator(ThreadPool& pool) : pool(pool) {}
+
+const std::vector<MapIssue>& MapValidator::validate(const MapStore& store)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    issues.clear();
+
+    checkLines(store);
+    checkLinePairs(store);
+    checkSectorLoops(store);
+    checkElements(store);
+
+    std::sort(issues.begin(), issues.end(),
+              [](const MapIssue& a, const MapIssue& b)
+              {
+                  if (a.type != b.type) return a.type < b.type;
+                  if (a.element != b.element) return a.element < b.element;
+                  return a.other < b.other;
+              });
+
+    std::fill(std::begin(issueCounts), std::end(issueCounts), 0);
+    for (const MapIssue& issue : issues)
+        ++issueCounts[static_cast<size_t>(issue.type)];
+
+    lastTime = std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - start)
+                   .count();
+
+    return issues;
+}
+
+void MapValidator::writeReport(std::ostream& stream) const
+{
+    stream << "{\n  \"issueCount\": " << issues.size()
+           << ",\n  \"milliseconds\": " << lastTime << ",\n  \"counts\": {";
+
+    for (size_t i = 0; i < ISSUE_TYPE_COUNT; ++i)
+    {
+        stream << (i == 0 ? "\n" : ",\n") << "    \"" << ISSUE_NAMES[i].name
+               << "\": " << issueCounts[i];
+    }
+
+    stream << "\n  },\n  \"issues\": [";
+
+    for (size_t i = 0; i < issues.size(); ++i)
+    {
+        const MapIssue& issue = issues[i];
+        const auto& names = ISSUE_NAMES[static_cast<size_t>(issue.type)];
+
+        stream << (i == 0 ? "\n" : ",\n") << "    {\"type\": \"" << names.name
+               << "\", \"" << names.element << "\": " << issue.element;
+        if (names.other && issue.other != -1)
+            stream << ", \"" << names.other << "\": " << issue.other;
+        stream << "}";
+    }
+
+    stream << (issues.empty() ? "]\n}" : "\n  ]\n}");
+}
+
+const char* MapValidator::getIssueName(MapIssueType type)
+{
+    return ISSUE_NAMES[static_cast<size_t>(type)].name;
+}
+
+template <typename Func>
+void MapValidator::runCheck(size_t count, Func check)
+{
+    size_t chunkCount = ThreadPool::getChunkCount(count, CHUNK_SIZE);
+    if (chunkIssues.size() < chunkCount) chunkIssues.resize(chunkCount);
+
+    pool.forEachChunk(count, CHUNK_SIZE,
+                      [&](size_t chunk, size_t begin, size_t end)
+                      {
+                          chunkIssues[chunk].clear();
+                          check(begin, end, chunkIssues[chunk]);
+                      });
+
+    for (size_t i = 0; i < chunkCount; ++i)
+        issues.insert(issues.end(), chunkIssues[i].begin(),
+                      chunkIssues[i].end());
+}
+
+void MapValidator::checkLines(const MapStore& store)
+{
+    const std::vector<Line>& lines = store.getLines();
+    const std::vector<uint32_t>& indices = store.getLineIndices();
+    lineEnds.resize(lines.size());
+
+    runCheck(lines.size(),
+             [&](size_t begin, size_t end, std::vector<MapIssue>& found)
+             {
+                 for (size_t i = begin; i < end; ++i)
+                 {
+                     const Line& line = lines[i];
+                     int index = static_cast<int>(indices[i]);
+
+                     const LineVertex& start =
+                         store.getVertex(line.startVertex);
+                     const LineVertex& endVertex =
+                         store.getVertex(line.endVertex);
+                     lineEnds[i] = {glm::vec2(start.x, start.y),
+                                    glm::vec2(endVertex.x, endVertex.y)};
+
+                     if (start == endVertex)
+                         found.push_back(
+                             {MapIssueType::ZERO_LENGTH_LINE, index, -1});
+
+                     for (int side : {line.front, line.back})
+                     {
+                         if (side != -1 && !store.hasSide(side))
+                             found.push_back(
+                                 {MapIssueType::INVALID_LINE_SIDE, index,
+                                  side});
+                     }
+                 }
+             });
+}
+
+void MapValidator::checkLinePairs(const MapStore& store)
+{
+    if (lineEnds.size() < 2) return;
+
+    buildGrid();
+
+    const std::vector<uint32_t>& indices = store.getLineIndices();
+    uint32_t columns = static_cast<uint32_t>(gridColumns);
+
+    runCheck(cellOffsets.size() - 1,
+             [&](size_t begin, size_t end, std::vector<MapIssue>& found)
+             {
+                 for (size_t cell = begin; cell < end; ++cell)
+                 {
+                     uint32_t first = cellOffsets[cell];
+                     uint32_t last = cellOffsets[cell + 1];
+                     glm::ivec2 position(cell % columns, cell / columns);
+
+                     for (uint32_t i = first; i < last; ++i)
+                     {
+                         const LineEnds& a = lineEnds[cellLines[i]];
+                         glm::vec2 minA = glm::min(a.start, a.end);
+                         glm::vec2 maxA = glm::max(a.start, a.end);
+
+                         for (uint32_t j = i + 1; j < last; ++j)
+                         {
+                             const LineEnds& b = lineEnds[cellLines[j]];
+                             glm::vec2 minB = glm::min(b.start, b.end);
+                             glm::vec2 maxB = glm::max(b.start, b.end);
+
+                             if (glm::any(glm::greaterThan(minA, maxB)) ||
+                                 glm::any(glm::greaterThan(minB, maxA)))
+                                 continue;
+
+                             // Test each pair only in the first cell they
+                             // share
+                             if (getCell(glm::max(minA, minB)) != position)
+                                 continue;
+
+                             glm::dvec2 point;
+                             if (Geometry::getContact(a.start, a.end, b.start,
+                                                      b.end, point) !=
+                                 Geometry::ContactType::OVERLAPPING)
+                                 continue;
+
+                             bool isDuplicate =
+                                 (a.start == b.start && a.end == b.end) ||
+                                 (a.start == b.end && a.end == b.start);
+
+                             int indexA = indices[cellLines[i]];
+                             int indexB = indices[cellLines[j]];
+                             found.push_back(
+                                 {isDuplicate ? MapIssueType::DUPLICATE_LINE
+                                              : MapIssueType::OVERLAPPING_LINE,
+                                  std::max(indexA, indexB),
+                                  std::min(indexA, indexB)});
+                         }
+                     }
+                 }
+             });
+}
+
+void MapValidator::checkSectorLoops(const MapStore& store)
+{
+    const std::vector<Line>& lines = store.getLines();
+
+    // Group the lines by vertex with a counting sort
+    vertexOffsets.assign(store.getVertexSlotCount() + 1, 0);
+    for (const Line& line : lines)
+    {
+        ++vertexOffsets[line.startVertex + 1];
+        ++vertexOffsets[line.endVertex + 1];
+    }
+
+    for (size_t i = 1; i < vertexOffsets.size(); ++i)
+        vertexOffsets[i] += vertexOffsets[i - 1];
+
+    vertexLines.resize(vertexOffsets.back());
+    for (size_t i = 0; i < lines.size(); ++i)
+    {
+        vertexLines[vertexOffsets[lines[i].startVertex]++] = i;
+        vertexLines[vertexOffsets[lines[i].endVertex]++] = i;
+    }
+
+    // The scatter advanced each offset to the start of the next vertex
+    for (size_t i = vertexOffsets.size() - 1; i > 0; --i)
+        vertexOffsets[i] = vertexOffsets[i - 1];
+    vertexOffsets[0] = 0;
+
+    size_t issueCount = issues.size();
+
+    runCheck(
+        store.getVertexSlotCount(),
+        [&](size_t begin, size_t end, std::vector<MapIssue>& found)
+        {
+            // The sectors of the sides around a vertex, with +1 for each
+            // side that enters the vertex and -1 for each side that leaves it
+            std::vector<std::pair<int, int>> turns;
+
+            for (size_t vertex = begin; vertex < end; ++vertex)
+            {
+                turns.clear();
+
+                for (uint32_t i = vertexOffsets[vertex];
+                     i < vertexOffsets[vertex + 1]; ++i)
+                {
+                    const Line& line = lines[vertexLines[i]];
+                    if (line.startVertex == line.endVertex) continue;
+
+                    // The front side runs from the start to the end, and the
+                    // back side the other way
+                    int direction =
+                        line.endVertex == static_cast<int>(vertex) ? 1 : -1;
+
+                    int front = getValidSector(store, line.front);
+                    if (front != -1) turns.emplace_back(front, direction);
+
+                    int back = getValidSector(store, line.back);
+                    if (back != -1) turns.emplace_back(back, -direction);
+                }
+
+                std::sort(turns.begin(), turns.end());
+
+                for (size_t i = 0; i < turns.size();)
+                {
+                    int sector = turns[i].first;
+                    int balance = 0;
+                    for (; i < turns.size() && turns[i].first == sector; ++i)
+                        balance += turns[i].second;
+
+                    if (balance != 0)
+                        found.push_back({MapIssueType::UNCLOSED_SECTOR, sector,
+                                         static_cast<int>(vertex)});
+                }
+            }
+        });
+
+    // Report each sector once, at its open vertex of the lowest index
+    std::sort(issues.begin() + issueCount, issues.end(),
+              [](const MapIssue& a, const MapIssue& b)
+              {
+                  return a.element != b.element ? a.element < b.element
+                                                : a.other < b.other;
+              });
+    issues.erase(std::unique(issues.begin() + issueCount, issues.end(),
+                             [](const MapIssue& a, const MapIssue& b)
+                             { return a.element == b.element; }),
+                 issues.end());
+}
+
+void MapValidator::checkElements(const MapStore& store)
+{
+    const std::vector<uint32_t>& vertexIndices = store.getVertexIndices();
+    runCheck(vertexIndices.size(),
+             [&](size_t begin, size_t end, std::vector<MapIssue>& found)
+             {
+                 for (size_t i = begin; i < end; ++i)
+                 {
+                     int vertex = static_cast<int>(vertexIndices[i]);
+                     if (store.getVertexRefCount(vertex) == 0)
+                         found.push_back(
+                             {MapIssueType::DANGLING_VERTEX, vertex, -1});
+                 }
+             });
+
+    const std::vector<Side>& sides = store.getSides();
+    const std::vector<uint32_t>& sideIndices = store.getSideIndices();
+    runCheck(sides.size(),
+             [&](size_t begin, size_t end, std::vector<MapIssue>& found)
+             {
+                 for (size_t i = begin; i < end; ++i)
+                 {
+                     int sector = sides[i].sector;
+                     if (sector != -1 && !store.hasSector(sector))
+                         found.push_back({MapIssueType::INVALID_SIDE_SECTOR,
+                                          static_cast<int>(sideIndices[i]),
+                                          sector});
+                 }
+             });
+
+    const std::vector<Sector>& sectors = store.getSectors();
+    const std::vector<uint32_t>& sectorIndices = store.getSectorIndices();
+    runCheck(sectors.size(),
+             [&](size_t begin, size_t end, std::vector<MapIssue>& found)
+             {
+                 for (size_t i = begin; i < end; ++i)
+                 {
+                     if (sectors[i].ceilingHeight < sectors[i].floorHeight)
+                         found.push_back({MapIssueType::CEILING_BELOW_FLOOR,
+                                          static_cast<int>(sectorIndices[i]),
+                                          -1});
+                 }
+             });
+}
+
+void MapValidator::buildGrid()
+{
+    size_t lineCount = lineEnds.size();
+
+    glm::vec2 min = lineEnds[0].start;
+    glm::vec2 max = min;
+    double totalLength = 0.0;
+    for (const LineEnds& ends : lineEnds)
+    {
+        min = glm::min(min, glm::min(ends.start, ends.end));
+        max = glm::max(max, glm::max(ends.start, ends.end));
+        totalLength += glm::length(ends.end - ends.start);
+    }
+
+    // Cells about as large as an average line keep the number of cells per
+    // line and of lines per cell small
+    glm::vec2 size = max - min;
+    float cellSize = std::max(
+        {std::sqrt(size.x * size.y / lineCount),
+         static_cast<float>(totalLength / lineCount),
+         std::max(size.x, size.y) / (CELLS_PER_LINE * lineCount), 1e-3f});
+
+    while ((size.x / cellSize + 1) * (size.y / cellSize + 1) >
+           CELLS_PER_LINE * lineCount)
+        cellSize *= 2.0f;
+
+    gridOrigin = min;
+    inverseCellSize = 1.0f / cellSize;
+    gridColumns = static_cast<int>(size.x * inverseCellSize) + 1;
+    gridRows = static_cast<int>(size.y * inverseCellSize) + 1;
+
+    // Count the cells covered by the bounding box of each line
+    lineCellOffsets.resize(lineCount + 1);
+    lineCellOffsets[0] = 0;
+    pool.forEachChunk(
+        lineCount, CHUNK_SIZE,
+        [&](size_t chunk, size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const LineEnds& ends = lineEnds[i];
+                glm::ivec2 low = getCell(glm::min(ends.start, ends.end));
+                glm::ivec2 high = getCell(glm::max(ends.start, ends.end));
+                lineCellOffsets[i + 1] =
+                    (high.x - low.x + 1) * (high.y - low.y + 1);
+            }
+        });
+
+    for (size_t i = 0; i < lineCount; ++i)
+        lineCellOffsets[i + 1] += lineCellOffsets[i];
+
+    lineCells.resize(lineCellOffsets.back());
+    pool.forEachChunk(
+        lineCount, CHUNK_SIZE,
+        [&](size_t chunk, size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const LineEnds& ends = lineEnds[i];
+                glm::ivec2 low = getCell(glm::min(ends.start, ends.end));
+                glm::ivec2 high = getCell(glm::max(ends.start, ends.end));
+
+                uint32_t offset = lineCellOffsets[i];
+                for (int y = low.y; y <= high.y; ++y)
+                {
+                    for (int x = low.x; x <= high.x; ++x)
+                        lineCells[offset++] = y * gridColumns + x;
+                }
+            }
+        });
+
+    // Group the lines by cell with a counting sort, which keeps the lines of
+    // each cell in index order
+    cellOffsets.assign(static_cast<size_t>(gridColumns) * gridRows + 1, 0);
+    for (uint32_t cell : lineCells) ++cellOffsets[cell + 1];
+
+    for (size_t i = 1; i < cellOffsets.size(); ++i)
+        cellOffsets[i] += cellOffsets[i - 1];
+
+    cellLines.resize(lineCells.size());
+    for (size_t i = 0; i < lineCount; ++i)
+    {
+        for (uint32_t j = lineCellOffsets[i]; j < lineCellOffsets[i + 1]; ++j)
+            cellLines[cellOffsets[lineCells[j]]++] = i;
+    }
+
+    for (size_t i = cellOffsets.size() - 1; i > 0; --i)
+        cellOffsets[i] = cellOffsets[i - 1];
+    cellOffsets[0] = 0;
+}
+
+glm::ivec2 MapValidator::getCell(glm::vec2 position) const
+{
+    glm::ivec2 cell((position - gridOrigin) * inverseCellSize);
+    return glm::clamp(cell, glm::ivec2(0),
+                      glm::ivec2(gridColumns - 1, gridRows - 1));
+}
+
+int MapValidator::getValidSector(const MapStore& store, int side)
+{
+    if (!store.hasSide(side)) return -1;
+
+    int sector = store.getSide(side).sector;
+    return store.hasSector(sector) ? sector : -1;
+}
\ No newline at end of file
@@ -0,0 +1,233 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <ostream>
+#include <vector>
+
+#include "../utils/ThreadPool.h"
+#include "MapStore.h"
+
+/**
+ * @brief An enum representing the kinds of problems found in a map.
+ */
+enum class MapIssueType : uint8_t
+{
+    // A line whose ends are at the same position
+    ZERO_LENGTH_LINE,
+    // A line that lies on top of another line with the same ends
+    DUPLICATE_LINE,
+    // A line that partly lies on top of another line
+    OVERLAPPING_LINE,
+    // A sector whose sides do not form closed loops
+    UNCLOSED_SECTOR,
+    // A vertex that no line uses
+    DANGLING_VERTEX,
+    // A line that refers to a missing side
+    INVALID_LINE_SIDE,
+    // A side that refers to a missing sector
+    INVALID_SIDE_SECTOR,
+    // A sector whose ceiling is below its floor
+    CEILING_BELOW_FLOOR
+};
+
+/**
+ * @brief A struct representing a problem found in a map.
+ */
+struct MapIssue
+{
+    // The kind of problem
+    MapIssueType type;
+    // The index of the element with the problem, whose type depends on the
+    // kind of problem
+    int element;
+    // The index of a related element, or -1
+    int other;
+};
+
+/**
+ * @brief A class that checks a map for problems that would break it in game.
+ *
+ * Every check reads the densely packed element arrays of the store and is
+ * split into chunks that run on a thread pool. Each chunk collects its own
+ * issues, and the issues are sorted once every check has finished, so the
+ * report does not depend on how the chunks were scheduled.
+ *
+ * Lines are tested against each other through a uniform grid built for the
+ * pass, and a pair of lines is only tested in the cell holding the corner of
+ * the overlap of their bounding boxes, so every pair is tested once. A sector
+ * is closed when its sides enter and leave every vertex equally often.
+ */
+class MapValidator
+{
+public:
+    /**
+     * @brief Constructs a new MapValidator object.
+     *
+     * @param pool The thread pool the checks run on.
+     */
+    explicit MapValidator(ThreadPool& pool);
+
+    MapValidator(const MapValidator&) = delete;
+    MapValidator& operator=(const MapValidator&) = delete;
+
+    /**
+     * @brief Checks the elements of a map.
+     *
+     * @param store The elements of the map.
+     * @return The issues found, sorted by kind and element index. The vector
+     * is reused by the next call.
+     */
+    const std::vector<MapIssue>& validate(const MapStore& store);
+
+    /**
+     * @brief Gets the issues found by the last validation.
+     *
+     * @return The issues.
+     */
+    inline const std::vector<MapIssue>& getIssues() const { return issues; }
+
+    /**
+     * @brief Gets the time the last validation took.
+     *
+     * @return The time in milliseconds.
+     */
+    inline double getLastTime() const { return lastTime; }
+
+    /**
+     * @brief Writes the result of the last validation as a JSON object.
+     *
+     * The object holds the number of issues of each kind and the list of
+     * issues, each naming the type and index of the elements involved.
+     *
+     * @param stream The stream to write to.
+     */
+    void writeReport(std::ostream& stream) const;
+
+    /**
+     * @brief Gets the name of a kind of problem, as used in reports.
+     *
+     * @param type The kind of problem.
+     * @return The name.
+     */
+    static const char* getIssueName(MapIssueType type);
+
+private:
+    // The number of elements checked per chunk
+    static constexpr size_t CHUNK_SIZE = 16384;
+    // The number of kinds of problems
+    static constexpr size_t ISSUE_TYPE_COUNT = 8;
+    // The largest number of grid cells per line, on average
+    static constexpr size_t CELLS_PER_LINE = 4;
+
+    /**
+     * @brief A struct representing the end positions of a line.
+     */
+    struct LineEnds
+    {
+        // The position of the start vertex
+        glm::vec2 start;
+        // The position of the end vertex
+        glm::vec2 end;
+    };
+
+    // The thread pool the checks run on
+    ThreadPool& pool;
+    // The issues found by the last validation
+    std::vector<MapIssue> issues;
+    // The issues found by each chunk of the running check
+    std::vector<std::vector<MapIssue>> chunkIssues;
+    // The counts of the issues found by the last validation, by kind
+    size_t issueCounts[ISSUE_TYPE_COUNT] = {};
+    // The time the last validation took in milliseconds
+    double lastTime = 0.0;
+
+    // The end positions of each line, by dense index
+    std::vector<LineEnds> lineEnds;
+    // The minimum corner of the grid
+    glm::vec2 gridOrigin;
+    // The reciprocal of the size of a grid cell
+    float inverseCellSize = 1.0f;
+    // The number of columns of the grid
+    int gridColumns = 0;
+    // The number of rows of the grid
+    int gridRows = 0;
+    // The offset of the first entry of each cell, plus one past the last
+    std::vector<uint32_t> cellOffsets;
+    // The dense indices of the lines in each cell, grouped by cell
+    std::vector<uint32_t> cellLines;
+    // The offset of the first cell of each line, plus one past the last
+    std::vector<uint32_t> lineCellOffsets;
+    // The cells covered by each line, grouped by line
+    std::vector<uint32_t> lineCells;
+
+    // The offset of the first line of each vertex slot, plus one past the
+    // last
+    std::vector<uint32_t> vertexOffsets;
+    // The dense indices of the lines of each vertex, grouped by vertex slot
+    std::vector<uint32_t> vertexLines;
+
+    /**
+     * @brief Runs a check over a range of elements in chunks and appends its
+     * issues in chunk order.
+     *
+     * @tparam Func The type of the check, called with the first and one past
+     * the last element of a chunk and the vector to add the chunk's issues
+     * to.
+     * @param count The number of elements.
+     * @param check The check.
+     */
+    template <typename Func>
+    void runCheck(size_t count, Func check);
+
+    /**
+     * @brief Checks the lines for zero length and missing sides.
+     *
+     * @param store The elements of the map.
+     */
+    void checkLines(const MapStore& store);
+
+    /**
+     * @brief Checks the lines for duplicates and overlaps.
+     *
+     * @param store The elements of the map.
+     */
+    void checkLinePairs(const MapStore& store);
+
+    /**
+     * @brief Checks that the sides of every sector form closed loops.
+     *
+     * @param store The elements of the map.
+     */
+    void checkSectorLoops(const MapStore& store);
+
+    /**
+     * @brief Checks the vertices, sides and sectors on their own.
+     *
+     * @param store The elements of the map.
+     */
+    void checkElements(const MapStore& store);
+
+    /**
+     * @brief Builds the grid of the lines from their end positions.
+     */
+    void buildGrid();
+
+    /**
+     * @brief Gets the grid cell holding a position.
+     *
+     * @param position The position, which must be inside the grid.
+     * @return The column and row of the cell.
+     */
+    glm::ivec2 getCell(glm::vec2 position) const;
+
+    /**
+     * @brief Gets the sector of a side, if the side and the sector exist.
+     *
+     * @param store The elements of the map.
+     * @param side The index of the side, or -1.
+     * @return The index of the sector, or -1.
+     */
+    static int getValidSector(const MapStore& store, int side);
+};
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "PrefabLibrary.h"
+
+#include "../utils/macros.h"
+
+PrefabLibrary::PrefabLibrary(Map& map) : map(map) {}
+
+int PrefabLibrary::findInstance(glm::vec2 position) const
+{
+    const MapStore& store = map.getStore();
+    int found = -1;
+
+    instanceGrid.query(position, position,
+                       [&](uint32_t index)
+                       {
+                           glm::vec2 min, max;
+                           getBounds(store.getInstance(index), min, max);
+                           if (position.x < min.x || position.x > max.x ||
+                               position.y < min.y || position.y > max.y)
+                               return true;
+
+                           found = index;
+                           return false;
+                       });
+
+    return found;
+}
+
+void PrefabLibrary::unpack(int instance, AppendedElements& added)
+{
+    ASSERT(map.getStore().hasInstance(instance));
+
+    PrefabInstance data = map.getStore().getInstance(instance);
+    map.append(getPrefab(data.prefab)->getArrays(), data.position, added);
+    map.removeInstance(instance);
+}
+
+void PrefabLibrary::onPrefabAdded(int prefab, const MapStore& store)
+{
+    ++revision;
+}
+
+void PrefabLibrary::onInstanceAdded(int index, const PrefabInstance& instance)
+{
+    glm::vec2 min, max;
+    getBounds(instance, min, max);
+    instanceGrid.insert(index, min, max);
+
+    ++revision;
+}
+
+void PrefabLibrary::onInstanceRemoved(int index,
+                                      const PrefabInstance& instance)
+{
+    glm::vec2 min, max;
+    getBounds(instance, min, max);
+    instanceGrid.remove(index, min, max);
+
+    ++revision;
+}
+
+void PrefabLibrary::onMapLoaded(const MapStore& store)
+{
+    instanceGrid.clear();
+
+    const std::vector<PrefabInstance>& instances = store.getInstances();
+    const std::vector<uint32_t>& indices = store.getInstanceIndices();
+    for (size_t i = 0; i < instances.size(); ++i)
+    {
+        glm::vec2 min, max;
+        getBounds(instances[i], min, max);
+        instanceGrid.insert(indices[i], min, max);
+    }
+
+    ++revision;
+}
+
+void PrefabLibrary::getBounds(const PrefabInstance& instance, glm::vec2& min,
+                              glm::vec2& max) const
+{
+    // The geometry of a prefab is relative to its minimum corner
+    min = instance.position;
+    max = instance.position + getPrefab(instance.prefab)->getSize();
+}
\ No newline at end of file
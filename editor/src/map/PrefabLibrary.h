@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+#include "../map_components/PrefabInstance.h"
+#include "Map.h"
+#include "MapFragment.h"
+#include "MapListener.h"
+#include "MapStore.h"
+#include "SpatialGrid.h"
+
+/**
+ * @brief A class that finds and unpacks the prefab instances of a map.
+ *
+ * The prefabs of a map and the instances stamped from them are held by the
+ * map, so stamping and removing an instance are map edits that the edit
+ * history can undo and that map files and the journal keep. An instance only
+ * records its prefab and its position, and every instance shares the geometry
+ * of its prefab, so stamping a prefab costs the same whatever its size and
+ * does not copy it. The geometry of an instance only enters the lines of the
+ * map when the instance is unpacked to be edited, or when the map is baked
+ * for export. This class follows the edits of the map to keep a spatial index
+ * of the instances and a revision for the renderer.
+ */
+class PrefabLibrary : public MapListener
+{
+public:
+    /**
+     * @brief Constructs a new PrefabLibrary object for the specified map.
+     *
+     * The library must be added as a listener of the map to follow its edits.
+     *
+     * @param map The map holding the prefabs.
+     */
+    PrefabLibrary(Map& map);
+
+    PrefabLibrary(const PrefabLibrary&) = delete;
+    PrefabLibrary& operator=(const PrefabLibrary&) = delete;
+
+    /**
+     * @brief Gets the number of prefabs.
+     *
+     * @return The number of prefabs.
+     */
+    inline size_t getPrefabCount() const
+    {
+        return map.getStore().getPrefabCount();
+    }
+
+    /**
+     * @brief Gets the geometry of a prefab, which is shared by its
+     * instances.
+     *
+     * @param prefab The index of the prefab.
+     * @return The geometry.
+     */
+    inline const std::shared_ptr<const MapFragment>& getPrefab(
+        int prefab) const
+    {
+        return map.getStore().getPrefab(prefab);
+    }
+
+    /**
+     * @brief Gets the instances in dense order.
+     *
+     * @return The instances.
+     */
+    inline const std::vector<PrefabInstance>& getInstances() const
+    {
+        return map.getStore().getInstances();
+    }
+
+    /**
+     * @brief Gets a number that changes whenever a prefab is added or an
+     * instance is stamped or removed.
+     *
+     * @return The revision.
+     */
+    inline uint64_t getRevision() const { return revision; }
+
+    /**
+     * @brief Gets an instance whose bounding box contains a position.
+     *
+     * @param position The position.
+     * @return The index of the instance, or -1 if there is none.
+     */
+    int findInstance(glm::vec2 position) const;
+
+    /**
+     * @brief Copies the geometry of an instance into the lines of the map and
+     * removes the instance, so that its geometry can be edited.
+     *
+     * @param instance The index of the instance.
+     * @param added Set to the indices of the copied elements.
+     */
+    void unpack(int instance, AppendedElements& added);
+
+    void onPrefabAdded(int prefab, const MapStore& store) override;
+
+    void onInstanceAdded(int index, const PrefabInstance& instance) override;
+
+    void onInstanceRemoved(int index,
+                           const PrefabInstance& instance) override;
+
+    void onMapLoaded(const MapStore& store) override;
+
+private:
+    // The map holding the prefabs
+    Map& map;
+    // The spatial index of the bounding boxes of the instances
+    SpatialGrid instanceGrid;
+    // The number of changes made to the prefabs and instances
+    uint64_t revision = 0;
+
+    /**
+     * @brief Gets the bounding box of an instance.
+     *
+     * @param instance The instance.
+     * @param min Set to the minimum corner of the bounding box.
+     * @param max Set to the maximum corner of the bounding box.
+     */
+    void getBounds(const PrefabInstance& instance, glm::vec2& min,
+                   glm::vec2& max) const;
+};
\ No newline at end of file
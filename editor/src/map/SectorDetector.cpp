@@ -0,0 +1,643 @@
+#include "SectorDetector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/constants.hpp>
+#include <limits>
+
+#include "Geometry.h"
+#include "Map.h"
+
+/**
+ * @brief Gets the position of a vertex.
+ *
+ * @param store The store of the map.
+ * @param vertex The index of the vertex.
+ * @return The position of the vertex.
+ */
+static glm::vec2 getPosition(const MapStore& store, int vertex)
+{
+    const LineVertex& position = store.getVertex(vertex);
+    return {position.x, position.y};
+}
+
+/**
+ * @brief Sorts a vector of indices and removes the duplicates.
+ *
+ * @param indices The indices.
+ */
+static void sortUnique(std::vector<int>& indices)
+{
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+}
+
+SectorDetector::SectorDetector(const MapTopology& topology)
+    : topology(topology)
+{
+}
+
+void SectorDetector::update(Map& map) { retrace(map, &map); }
+
+void SectorDetector::sync(const Map& map) { retrace(map, nullptr); }
+
+void SectorDetector::retrace(const Map& map, Map* editedMap)
+{
+    if (!isDirty()) return;
+
+    const MapStore& store = map.getStore();
+    ++stamp;
+
+    size_t halfEdgeCount = 2 * store.getLineSlotCount();
+    seeds.clear();
+
+    if (needsRebuild)
+    {
+        cycles.clear();
+        freeCycles.clear();
+        faceCount = 0;
+        halfEdgeCycles.assign(halfEdgeCount, -1);
+        voidHalfEdges.assign(halfEdgeCount, 0);
+        destroyedCycles.clear();
+
+        for (uint32_t line : store.getLineIndices())
+        {
+            seeds.push_back(MapTopology::getHalfEdge(line));
+            seeds.push_back(MapTopology::getHalfEdge(line, true));
+        }
+    }
+    else
+    {
+        if (halfEdgeCycles.size() < halfEdgeCount)
+        {
+            halfEdgeCycles.resize(halfEdgeCount, -1);
+            voidHalfEdges.resize(halfEdgeCount, 0);
+        }
+
+        // Every cycle through a vertex passes through its fan
+        sortUnique(dirtyVertices);
+        for (int vertex : dirtyVertices)
+        {
+            for (int halfEdge : topology.getOutgoing(vertex))
+            {
+                seeds.push_back(halfEdge);
+                seeds.push_back(MapTopology::getTwin(halfEdge));
+            }
+        }
+    }
+
+    traceStamps.resize(halfEdgeCycles.size(), 0);
+
+    // The cycles through the seeds may have been split, merged or moved
+    for (int halfEdge : seeds)
+    {
+        if (halfEdgeCycles[halfEdge] != -1)
+            destroyedCycles.push_back(halfEdgeCycles[halfEdge]);
+    }
+    sortUnique(destroyedCycles);
+
+    holeStates.resize(cycles.size(), HoleState::RESOLVED);
+    for (int cycle : destroyedCycles)
+    {
+        const Cycle& destroyed = cycles[cycle];
+        if (destroyed.isBounded)
+            markHoles(map, cycle, destroyed.min, destroyed.max);
+    }
+
+    for (int cycle : destroyedCycles)
+    {
+        if (cycles[cycle].isBounded && cycles[cycle].sector != -1) --faceCount;
+        cycles[cycle].halfEdge = -1;
+    }
+
+    newCycles.clear();
+    for (int halfEdge : seeds)
+    {
+        if (traceStamps[halfEdge] != stamp)
+            newCycles.push_back(traceCycle(map, halfEdge));
+    }
+
+    // Only free the destroyed cycles now, so that no new cycle reuses one
+    // that a pending hole still refers to
+    freeCycles.insert(freeCycles.end(), destroyedCycles.begin(),
+                      destroyedCycles.end());
+
+    holeStates.resize(cycles.size(), HoleState::RESOLVED);
+    for (int cycle : newCycles)
+    {
+        const Cycle& traced = cycles[cycle];
+        if (traced.isBounded)
+        {
+            claimSector(map, editedMap, cycle);
+            if (traced.sector != -1) ++faceCount;
+
+            // A new face may enclose holes that used to lie in another one
+            markHoles(map, -1, traced.min, traced.max);
+        }
+        else if (holeStates[cycle] == HoleState::RESOLVED)
+        {
+            holeStates[cycle] = HoleState::PENDING;
+            pendingHoles.push_back(cycle);
+        }
+    }
+
+    for (int hole : pendingHoles)
+    {
+        if (cycles[hole].halfEdge == -1)
+            holeStates[hole] = HoleState::RESOLVED;
+        else
+            resolveParent(map, hole);
+    }
+
+    touchedLines.clear();
+    for (const std::vector<int>* changed : {&newCycles, &pendingHoles})
+    {
+        for (int cycle : *changed)
+        {
+            if (cycles[cycle].halfEdge == -1) continue;
+
+            topology.walkFace(cycles[cycle].halfEdge,
+                              [&](int halfEdge)
+                              {
+                                  touchedLines.push_back(
+                                      MapTopology::getLine(halfEdge));
+                                  return true;
+                              });
+        }
+    }
+    pendingHoles.clear();
+
+    // The replayed sides already match the faces, and the sides and sectors
+    // the replay left unused were removed by it
+    if (editedMap)
+    {
+        sortUnique(touchedLines);
+        for (int line : touchedLines) updateSides(*editedMap, line);
+
+        // Sides detached from their lines, by this update or by the edits
+        // before it, and sectors left without sides are removed
+        for (int side : unusedSides)
+        {
+            bool isDetached =
+                side >= sideLines.size() || sideLines[side] == -1;
+            if (store.hasSide(side) && isDetached)
+                editedMap->removeSide(side);
+        }
+
+        for (int sector : unusedSectors)
+        {
+            if (store.hasSector(sector) && sectorRefCounts[sector] == 0)
+                editedMap->removeSector(sector);
+        }
+    }
+
+    unusedSides.clear();
+    unusedSectors.clear();
+    dirtyVertices.clear();
+    destroyedCycles.clear();
+    needsRebuild = false;
+}
+
+void SectorDetector::onVertexAdded(int vertex, glm::vec2 position)
+{
+    lowerMinX(position.x);
+}
+
+void SectorDetector::onVertexMoved(int vertex, glm::vec2 from, glm::vec2 to)
+{
+    lowerMinX(to.x);
+
+    // Moving a vertex reorders the fans at both ends of its lines
+    markVertex(vertex);
+    for (int halfEdge : topology.getOutgoing(vertex))
+        markVertex(topology.getDestination(halfEdge));
+}
+
+void SectorDetector::onLineAdded(int index, const Line& line)
+{
+    markVertex(line.startVertex);
+    markVertex(line.endVertex);
+    setSideLine(line.front, index);
+    setSideLine(line.back, index);
+}
+
+void SectorDetector::onLineRemoved(int index, const Line& line)
+{
+    markVertex(line.startVertex);
+    markVertex(line.endVertex);
+
+    for (int halfEdge : {MapTopology::getHalfEdge(index),
+                         MapTopology::getHalfEdge(index, true)})
+    {
+        if (halfEdge >= halfEdgeCycles.size()) continue;
+
+        // The cycle of a removed half-edge cannot be found from its fans
+        if (halfEdgeCycles[halfEdge] != -1)
+            destroyedCycles.push_back(halfEdgeCycles[halfEdge]);
+        halfEdgeCycles[halfEdge] = -1;
+
+        // A line added in the slot later is not part of this void face
+        voidHalfEdges[halfEdge] = 0;
+    }
+
+    setSideLine(line.front, -1);
+    setSideLine(line.back, -1);
+}
+
+void SectorDetector::onLineChanged(int index, const Line& from, const Line& to)
+{
+    setSideLine(from.front, -1);
+    setSideLine(from.back, -1);
+    setSideLine(to.front, index);
+    setSideLine(to.back, index);
+}
+
+void SectorDetector::onSideAdded(int index, const Side& side)
+{
+    moveSectorRef(-1, side.sector);
+}
+
+void SectorDetector::onSideRemoved(int index, const Side& side)
+{
+    moveSectorRef(side.sector, -1);
+}
+
+void SectorDetector::onSideChanged(int index, const Side& from, const Side& to)
+{
+    moveSectorRef(from.sector, to.sector);
+}
+
+void SectorDetector::onMapLoaded(const MapStore& store)
+{
+    needsRebuild = true;
+    hasMinX = false;
+    dirtyVertices.clear();
+    destroyedCycles.clear();
+    unusedSides.clear();
+    unusedSectors.clear();
+
+    sideLines.clear();
+    const std::vector<Line>& lines = store.getLines();
+    const std::vector<uint32_t>& lineIndices = store.getLineIndices();
+    for (size_t i = 0; i < lines.size(); ++i)
+    {
+        setSideLine(lines[i].front, lineIndices[i]);
+        setSideLine(lines[i].back, lineIndices[i]);
+    }
+
+    sectorRefCounts.clear();
+    for (const Side& side : store.getSides()) moveSectorRef(-1, side.sector);
+}
+
+void SectorDetector::markVertex(int vertex) { dirtyVertices.push_back(vertex); }
+
+void SectorDetector::moveSectorRef(int from, int to)
+{
+    if (from == to) return;
+
+    if (from >= 0 && from < sectorRefCounts.size() &&
+        --sectorRefCounts[from] == 0)
+        unusedSectors.push_back(from);
+
+    if (to < 0) return;
+
+    if (to >= sectorRefCounts.size()) sectorRefCounts.resize(to + 1, 0);
+    ++sectorRefCounts[to];
+}
+
+void SectorDetector::setSideLine(int side, int line)
+{
+    if (side < 0) return;
+
+    if (side >= sideLines.size()) sideLines.resize(side + 1, -1);
+    sideLines[side] = line;
+
+    if (line == -1) unusedSides.push_back(side);
+}
+
+int SectorDetector::traceCycle(const Map& map, int halfEdge)
+{
+    int index;
+    if (!freeCycles.empty())
+    {
+        index = freeCycles.back();
+        freeCycles.pop_back();
+    }
+    else
+    {
+        index = cycles.size();
+        cycles.emplace_back();
+    }
+
+    const MapStore& store = map.getStore();
+    Cycle cycle;
+    cycle.halfEdge = halfEdge;
+    cycle.min = cycle.max = cycle.leftmost =
+        getPosition(store, topology.getOrigin(halfEdge));
+
+    // Twice the signed area, which is negative for clockwise cycles
+    double area = 0.0;
+    topology.walkFace(
+        halfEdge,
+        [&](int current)
+        {
+            traceStamps[current] = stamp;
+            halfEdgeCycles[current] = index;
+
+            glm::vec2 start = getPosition(store, topology.getOrigin(current));
+            glm::vec2 end =
+                getPosition(store, topology.getDestination(current));
+            area += static_cast<double>(start.x) * end.y -
+                    static_cast<double>(end.x) * start.y;
+
+            cycle.min = glm::min(cycle.min, start);
+            cycle.max = glm::max(cycle.max, start);
+            if (start.x < cycle.leftmost.x ||
+                (start.x == cycle.leftmost.x && start.y < cycle.leftmost.y))
+                cycle.leftmost = start;
+
+            return true;
+        });
+
+    cycle.isBounded = area < 0.0;
+    cycles[index] = cycle;
+
+    return index;
+}
+
+void SectorDetector::markHoles(const Map& map, int cycle, glm::vec2 min,
+                               glm::vec2 max)
+{
+    map.queryLines(
+        min, max,
+        [&](uint32_t line)
+        {
+            for (int halfEdge : {MapTopology::getHalfEdge(line),
+                                 MapTopology::getHalfEdge(line, true)})
+            {
+                int hole = halfEdgeCycles[halfEdge];
+                if (hole == -1 || cycles[hole].halfEdge == -1 ||
+                    cycles[hole].isBounded)
+                    continue;
+
+                if (cycle != -1 && cycles[hole].parent != cycle) continue;
+
+                if (holeStates[hole] == HoleState::RESOLVED)
+                {
+                    holeStates[hole] = HoleState::PENDING;
+                    pendingHoles.push_back(hole);
+                }
+            }
+
+            return true;
+        });
+}
+
+void SectorDetector::claimSector(const Map& map, Map* editedMap, int cycle)
+{
+    const MapStore& store = map.getStore();
+    bool isSyncing = editedMap == nullptr;
+
+    candidates.clear();
+    bool wasVoid = false;
+    topology.walkFace(cycles[cycle].halfEdge,
+                      [&](int halfEdge)
+                      {
+                          wasVoid |= voidHalfEdges[halfEdge] != 0;
+
+                          const Line& line =
+                              store.getLine(MapTopology::getLine(halfEdge));
+                          int side = MapTopology::isBack(halfEdge) ? line.back
+                                                                   : line.front;
+                          if (side == -1 || !store.hasSide(side)) return true;
+
+                          int sector = store.getSide(side).sector;
+                          if (sector != -1 && store.hasSector(sector))
+                              candidates.push_back(sector);
+                          return true;
+                      });
+
+    std::sort(candidates.begin(), candidates.end());
+
+    // Find the most common sector, and the most common one not yet claimed
+    int common = -1, unclaimed = -1;
+    size_t commonCount = 0, unclaimedCount = 0;
+    for (size_t first = 0; first < candidates.size();)
+    {
+        int sector = candidates[first];
+        size_t last = first;
+        while (last < candidates.size() && candidates[last] == sector) ++last;
+
+        size_t count = last - first;
+        if (count > commonCount)
+        {
+            common = sector;
+            commonCount = count;
+        }
+
+        if (!isOwned(sector) && count > unclaimedCount)
+        {
+            unclaimed = sector;
+            unclaimedCount = count;
+        }
+
+        first = last;
+    }
+
+    // A face no side faces into is void, as imported, as it was before or as
+    // it was restored
+    bool isVoid = candidates.empty() && (needsRebuild || wasVoid || isSyncing);
+    topology.walkFace(cycles[cycle].halfEdge,
+                      [&](int halfEdge)
+                      {
+                          voidHalfEdges[halfEdge] = isVoid;
+                          return true;
+                      });
+
+    if (isVoid)
+    {
+        cycles[cycle].sector = -1;
+        return;
+    }
+
+    // The restored sides decide the sector, even if a face traced earlier in
+    // the sync still holds it
+    int sector = isSyncing ? common : unclaimed;
+    if (sector == -1)
+    {
+        // A face split off from a sector starts out as a copy of it
+        Sector properties = common != -1 ? store.getSector(common) : Sector();
+        sector = editedMap->addSector(properties);
+    }
+
+    if (sector >= sectorOwners.size()) sectorOwners.resize(sector + 1, -1);
+    sectorOwners[sector] = cycle;
+    cycles[cycle].sector = sector;
+}
+
+bool SectorDetector::isOwned(int sector) const
+{
+    if (sector >= sectorOwners.size() || sectorOwners[sector] == -1)
+        return false;
+
+    // Owners are not cleared when their cycle is destroyed or reused
+    int owner = sectorOwners[sector];
+    return owner < cycles.size() && cycles[owner].halfEdge != -1 &&
+           cycles[owner].isBounded && cycles[owner].sector == sector;
+}
+
+int SectorDetector::resolveParent(const Map& map, int hole)
+{
+    if (holeStates[hole] == HoleState::RESOLVED) return cycles[hole].parent;
+
+    // A ray can only lead back to a hole being resolved if the lines cross
+    if (holeStates[hole] == HoleState::RESOLVING) return -1;
+
+    holeStates[hole] = HoleState::RESOLVING;
+
+    int parent = -1;
+    int hit = castRay(map, cycles[hole].leftmost);
+    if (hit != -1 && hit != hole)
+        parent = cycles[hit].isBounded ? hit : resolveParent(map, hit);
+
+    cycles[hole].parent = parent;
+    holeStates[hole] = HoleState::RESOLVED;
+
+    return parent;
+}
+
+void SectorDetector::lowerMinX(float x)
+{
+    if (hasMinX) minX = std::min(minX, x);
+}
+
+int SectorDetector::castRay(const Map& map, glm::vec2 point)
+{
+    const MapStore& store = map.getStore();
+
+    // Removed and moved vertices leave the bound below the map, which only
+    // lengthens the rays
+    if (!hasMinX)
+    {
+        minX = std::numeric_limits<float>::max();
+        for (const LineVertex& position : store.getVertexPositions())
+            minX = std::min<float>(minX, position.x);
+        hasMinX = true;
+    }
+
+    double bestX = -std::numeric_limits<double>::infinity();
+    int bestVertex = -1, bestHalfEdge = -1;
+
+    // Widen the search to the left until the nearest hit lies within it
+    for (float width = 256.0f;; width *= 2.0f)
+    {
+        float left = point.x - width;
+        map.queryLines(
+            {left, point.y}, point,
+            [&](uint32_t index)
+            {
+                const Line& line = store.getLine(index);
+                glm::vec2 start = getPosition(store, line.startVertex);
+                glm::vec2 end = getPosition(store, line.endVertex);
+
+                // A vertex on the ray takes precedence over the lines
+                // through it
+                for (int vertex : {line.startVertex, line.endVertex})
+                {
+                    glm::vec2 position = getPosition(store, vertex);
+                    if (position.y != point.y || position.x >= point.x)
+                        continue;
+
+                    if (position.x > bestX ||
+                        (position.x == bestX && bestVertex == -1))
+                    {
+                        bestX = position.x;
+                        bestVertex = vertex;
+                        bestHalfEdge = -1;
+                    }
+                }
+
+                if ((start.y < point.y) == (end.y < point.y) ||
+                    start.y == point.y || end.y == point.y)
+                    return true;
+
+                double x = start.x + (static_cast<double>(point.y) - start.y) *
+                                         (end.x - start.x) / (end.y - start.y);
+                if (x >= point.x || x <= bestX) return true;
+
+                // The point lies in the face on the right of the half-edge
+                bool isRight = Geometry::orient(start, end, point) < 0;
+                bestX = x;
+                bestVertex = -1;
+                bestHalfEdge = MapTopology::getHalfEdge(index, !isRight);
+                return true;
+            });
+
+        if (bestX >= left || left <= minX) break;
+    }
+
+    if (bestVertex != -1)
+    {
+        // The ray arrives from the east, which lies in the face of the first
+        // outgoing half-edge counter-clockwise from it. The fan is not
+        // scanned in order, since a half-edge pointing west may be sorted at
+        // either end of it.
+        glm::vec2 origin = getPosition(store, bestVertex);
+        float bestAngle = std::numeric_limits<float>::max();
+        for (int halfEdge : topology.getOutgoing(bestVertex))
+        {
+            glm::vec2 direction =
+                getPosition(store, topology.getDestination(halfEdge)) - origin;
+            float angle = std::atan2(direction.y, direction.x);
+            if (angle <= 0.0f) angle += 2.0f * glm::pi<float>();
+
+            if (angle < bestAngle)
+            {
+                bestAngle = angle;
+                bestHalfEdge = halfEdge;
+            }
+        }
+    }
+
+    return bestHalfEdge != -1 ? halfEdgeCycles[bestHalfEdge] : -1;
+}
+
+int SectorDetector::getFaceSector(int halfEdge) const
+{
+    int cycle = halfEdgeCycles[halfEdge];
+    if (cycle == -1) return -1;
+
+    const Cycle& traced = cycles[cycle];
+    if (traced.isBounded) return traced.sector;
+
+    return traced.parent != -1 ? cycles[traced.parent].sector : -1;
+}
+
+void SectorDetector::updateSides(Map& map, int line)
+{
+    const MapStore& store = map.getStore();
+    Line current = store.getLine(line);
+    int sides[] = {current.front, current.back};
+    bool isChanged = false;
+
+    for (int i = 0; i < 2; ++i)
+    {
+        int sector = getFaceSector(MapTopology::getHalfEdge(line, i == 1));
+
+        // Sides facing the outside are detached and removed later
+        if (sector == -1)
+        {
+            isChanged |= sides[i] != -1;
+            sides[i] = -1;
+        }
+        else if (sides[i] == -1)
+        {
+            sides[i] = map.addSide(Side(sector));
+            isChanged = true;
+        }
+        else if (store.getSide(sides[i]).sector != sector)
+            map.setSide(sides[i], Side(sector));
+    }
+
+    if (isChanged) map.setLineSides(line, sides[0], sides[1]);
+}
\ No newline at end of file
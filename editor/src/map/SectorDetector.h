@@ -0,0 +1,324 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "MapListener.h"
+#include "MapTopology.h"
+
+class Map;
+
+/**
+ * @brief A class that keeps the sides and sectors of a map in step with the
+ * closed loops of its lines.
+ *
+ * The faces of the map are traced by following the next pointers of its
+ * half-edges, which already turn to the neighbouring line in angular order at
+ * every vertex. A traced cycle with a clockwise winding bounds a sector. A
+ * counter-clockwise cycle is the outline of a group of connected lines, which
+ * is a hole in the face around it; that face is found by casting a ray to the
+ * left from the outline. Every half-edge then gets a side referring to the
+ * sector of its face, and half-edges facing the outside of the map get none.
+ *
+ * A bounded face none of whose sides face into it is void, such as the inside
+ * of a pillar made of one-sided lines, and gets no sector either. Only faces
+ * traced when the whole map is rebuilt, or traced again after being void, are
+ * treated this way, so that a closed loop drawn in the editor still gets a new
+ * sector.
+ *
+ * Edits only mark the vertices whose lines changed, and the next update only
+ * re-traces the cycles through those vertices and re-parents the holes of the
+ * faces that changed, so the cost of an update follows the size of the edit
+ * rather than the number of sectors. Faces keep the sector found on most of
+ * their sides, so that a sector keeps its properties while its outline is
+ * edited, and a face split off from a sector gets a copy of it.
+ *
+ * Undoing and redoing restore the sides and sectors the detector chose along
+ * with the lines, so after a replay the detector only syncs its faces with
+ * the restored sides, without editing the map. Deciding the sectors again
+ * could pick different ones and record the changes as a new edit.
+ */
+class SectorDetector : public MapListener
+{
+public:
+    /**
+     * @brief Constructs a new SectorDetector object.
+     *
+     * @param topology The topology of the map, which must outlive the
+     * detector.
+     */
+    explicit SectorDetector(const MapTopology& topology);
+
+    /**
+     * @brief Re-traces the faces touched by the edits made since the last
+     * update, and updates the sides and sectors of the map to match.
+     *
+     * The sides and sectors are changed through the map, so the changes are
+     * reported to its listeners like any other edit.
+     *
+     * @param map The map, whose topology must be the one of the detector.
+     */
+    void update(Map& map);
+
+    /**
+     * @brief Re-traces the faces touched by the edits made since the last
+     * update, and takes their sectors from the sides of the map as they are.
+     *
+     * This method is meant for edits replayed by undo and redo, whose sides
+     * and sectors already match their faces. Each face gets the sector most
+     * of its sides refer to, or is void if none does, and the map is not
+     * edited.
+     *
+     * @param map The map, whose topology must be the one of the detector.
+     */
+    void sync(const Map& map);
+
+    /**
+     * @brief Checks if edits were made since the last update.
+     *
+     * @return True if an update is needed, false otherwise.
+     */
+    inline bool isDirty() const
+    {
+        return needsRebuild || !dirtyVertices.empty() ||
+               !destroyedCycles.empty() || !unusedSides.empty() ||
+               !unusedSectors.empty();
+    }
+
+    /**
+     * @brief Gets the number of traced cycles that bound a sector, which
+     * excludes void faces.
+     *
+     * @return The number of bounded faces.
+     */
+    inline int getFaceCount() const { return faceCount; }
+
+    void onVertexAdded(int vertex, glm::vec2 position) override;
+
+    void onVertexMoved(int vertex, glm::vec2 from, glm::vec2 to) override;
+
+    void onLineAdded(int index, const Line& line) override;
+
+    void onLineRemoved(int index, const Line& line) override;
+
+    void onLineChanged(int index, const Line& from, const Line& to) override;
+
+    void onSideAdded(int index, const Side& side) override;
+
+    void onSideRemoved(int index, const Side& side) override;
+
+    void onSideChanged(int index, const Side& from, const Side& to) override;
+
+    void onMapLoaded(const MapStore& store) override;
+
+private:
+    /**
+     * @brief A struct representing a traced cycle of half-edges.
+     */
+    struct Cycle
+    {
+        // A half-edge of the cycle, or -1 if the cycle is unused
+        int halfEdge = -1;
+        // Whether the cycle winds clockwise and so bounds a sector
+        bool isBounded = false;
+        // The sector of a bounded cycle, or -1 if its face is void
+        int sector = -1;
+        // The bounded cycle around a hole, or -1 for the outside
+        int parent = -1;
+        // The minimum corner of the bounding box
+        glm::vec2 min;
+        // The maximum corner of the bounding box
+        glm::vec2 max;
+        // The lowest of the leftmost vertex positions
+        glm::vec2 leftmost;
+    };
+
+    /**
+     * @brief An enum class representing the state of a hole while its parent
+     * is resolved.
+     */
+    enum class HoleState : uint8_t
+    {
+        // The parent of the hole is known
+        RESOLVED,
+        // The hole must be re-parented
+        PENDING,
+        // The parent of the hole is being looked up
+        RESOLVING
+    };
+
+    // The topology whose faces are traced
+    const MapTopology& topology;
+    // The traced cycles
+    std::vector<Cycle> cycles;
+    // The indices of the unused cycles
+    std::vector<int> freeCycles;
+    // The number of cycles that bound a sector
+    int faceCount = 0;
+    // The cycle of each half-edge, or -1
+    std::vector<int> halfEdgeCycles;
+    // Whether each half-edge was last found in a void face
+    std::vector<uint8_t> voidHalfEdges;
+    // Whether every face must be traced again
+    bool needsRebuild = false;
+    // The vertices whose lines changed since the last update
+    std::vector<int> dirtyVertices;
+    // The cycles that lost a half-edge since the last update
+    std::vector<int> destroyedCycles;
+    // The line of each side, or -1
+    std::vector<int> sideLines;
+    // The number of sides referring to each sector
+    std::vector<int> sectorRefCounts;
+    // The sides that may no longer belong to a line
+    std::vector<int> unusedSides;
+    // The sectors that may no longer have a side
+    std::vector<int> unusedSectors;
+    // The bounded cycle that last claimed each sector
+    std::vector<int> sectorOwners;
+
+    // The pass in which each half-edge was last traced
+    std::vector<uint32_t> traceStamps;
+    // The current pass
+    uint32_t stamp = 0;
+    // The cycles traced in the current update
+    std::vector<int> newCycles;
+    // The holes to re-parent in the current update
+    std::vector<int> pendingHoles;
+    // The state of each cycle as a hole
+    std::vector<HoleState> holeStates;
+    // The half-edges the current update traces from
+    std::vector<int> seeds;
+    // The lines whose sides are updated in the current update
+    std::vector<int> touchedLines;
+    // The sectors of the sides of the cycle being claimed
+    std::vector<int> candidates;
+    // A bound at or below the smallest x coordinate of the map, computed when
+    // first needed and lowered as vertices are added or moved
+    float minX = 0.0f;
+    // Whether the bound on the smallest x coordinate has been computed
+    bool hasMinX = false;
+
+    /**
+     * @brief Re-traces the faces touched by the edits made since the last
+     * update, and updates the sides and sectors of the map to match unless
+     * syncing.
+     *
+     * @param map The map.
+     * @param editedMap The map to edit, which is the same map, or null to
+     * sync with the sides of the map instead.
+     */
+    void retrace(const Map& map, Map* editedMap);
+
+    /**
+     * @brief Marks a vertex as having changed lines.
+     *
+     * @param vertex The index of the vertex.
+     */
+    void markVertex(int vertex);
+
+    /**
+     * @brief Moves the references of a side from one sector to another.
+     *
+     * @param from The sector referred to before, or -1.
+     * @param to The sector referred to after, or -1.
+     */
+    void moveSectorRef(int from, int to);
+
+    /**
+     * @brief Traces the cycle through a half-edge.
+     *
+     * @param map The map.
+     * @param halfEdge The index of the half-edge.
+     * @return The index of the new cycle.
+     */
+    int traceCycle(const Map& map, int halfEdge);
+
+    /**
+     * @brief Marks for re-parenting the holes whose lines lie in a box.
+     *
+     * @param map The map.
+     * @param cycle The index of the bounded cycle whose holes to mark, or -1
+     * to mark every hole in the box.
+     * @param min The minimum corner of the box.
+     * @param max The maximum corner of the box.
+     */
+    void markHoles(const Map& map, int cycle, glm::vec2 min, glm::vec2 max);
+
+    /**
+     * @brief Chooses the sector of a bounded cycle.
+     *
+     * The cycle keeps the sector most of its sides refer to, unless another
+     * cycle owns it, in which case it gets a copy. A cycle without sides
+     * referring to a sector is left void if the map is being rebuilt or the
+     * cycle was void before, and gets a new sector otherwise. While syncing,
+     * the cycle keeps the most common sector even if it is owned, and is
+     * void if it has none.
+     *
+     * @param map The map.
+     * @param editedMap The map to add a new sector to, or null when syncing.
+     * @param cycle The index of the cycle.
+     */
+    void claimSector(const Map& map, Map* editedMap, int cycle);
+
+    /**
+     * @brief Checks if a sector belongs to a traced bounded cycle.
+     *
+     * @param sector The index of the sector.
+     * @return True if a bounded cycle owns the sector, false otherwise.
+     */
+    bool isOwned(int sector) const;
+
+    /**
+     * @brief Finds the bounded cycle around a hole, resolving the holes it
+     * depends on first.
+     *
+     * @param map The map.
+     * @param hole The index of the hole.
+     * @return The index of the bounded cycle, or -1 for the outside.
+     */
+    int resolveParent(const Map& map, int hole);
+
+    /**
+     * @brief Lowers the bound on the smallest x coordinate of the map to
+     * include a vertex, if the bound has been computed.
+     *
+     * @param x The x coordinate of the vertex.
+     */
+    void lowerMinX(float x);
+
+    /**
+     * @brief Finds the cycle first hit by a ray cast to the left from a
+     * point.
+     *
+     * @param map The map.
+     * @param point The point.
+     * @return The index of the cycle whose face the point lies in, or -1 if
+     * the ray hits nothing.
+     */
+    int castRay(const Map& map, glm::vec2 point);
+
+    /**
+     * @brief Gets the sector of the face on the right of a half-edge.
+     *
+     * @param halfEdge The index of the half-edge.
+     * @return The index of the sector, or -1 for the outside.
+     */
+    int getFaceSector(int halfEdge) const;
+
+    /**
+     * @brief Updates the sides of a line to match the faces on either side.
+     *
+     * @param map The map.
+     * @param line The index of the line.
+     */
+    void updateSides(Map& map, int line);
+
+    /**
+     * @brief Records the line a side belongs to.
+     *
+     * @param side The index of the side, or -1.
+     * @param line The index of the line, or -1 if the side was detached.
+     */
+    void setSideLine(int side, int line);
+};
\ No newline at end of file
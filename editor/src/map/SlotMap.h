@@ -0,0 +1,478 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "../utils/macros.h"
+
+/**
+ * @brief A struct representing a generation-checked reference to a slot.
+ *
+ * The index identifies the slot and stays the same for the lifetime of the
+ * element. The generation is bumped every time the slot is freed, so a handle
+ * kept past the removal of its element no longer matches the slot, even after
+ * the slot has been reused.
+ */
+struct SlotHandle
+{
+    // The value of an index that refers to no slot
+    static constexpr uint32_t INVALID_INDEX =
+        std::numeric_limits<uint32_t>::max();
+
+    // The index of the slot
+    uint32_t index = INVALID_INDEX;
+    // The generation of the slot when the handle was created
+    uint32_t generation = 0;
+
+    /**
+     * @brief Checks if the handle refers to a slot at all.
+     *
+     * @return True if the handle has an index, false otherwise.
+     */
+    inline bool isValid() const { return index != INVALID_INDEX; }
+
+    /**
+     * @brief Checks if two handles are equal.
+     *
+     * @param other The other handle to compare.
+     * @return True if the handles are equal, false otherwise.
+     */
+    bool operator==(const SlotHandle& other) const
+    {
+        return index == other.index && generation == other.generation;
+    }
+
+    /**
+     * @brief Checks if two handles are not equal.
+     *
+     * @param other The other handle to compare.
+     * @return True if the handles are not equal, false otherwise.
+     */
+    bool operator!=(const SlotHandle& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief A generational slot map storing its elements as parallel columns.
+ *
+ * Each element is a row of values, one per column type, and each column is
+ * stored in its own densely packed array so that iteration only ever visits
+ * live elements. Elements are addressed by slot index, which is stable for the
+ * lifetime of the element, or by a generation-checked SlotHandle. Insertion
+ * and erasure are O(1): freed slots are kept on an intrusive doubly linked
+ * free list, so that any of them can be reused, and erasing moves the last
+ * dense row into the hole.
+ *
+ * @tparam Columns The types of the columns.
+ */
+template <typename... Columns>
+class SlotMap
+{
+public:
+    /**
+     * @brief Inserts an element.
+     *
+     * @param values The values of the element, one per column.
+     * @return The slot index of the element.
+     */
+    uint32_t insert(Columns... values)
+    {
+        uint32_t index;
+
+        if (freeHead != SlotHandle::INVALID_INDEX)
+        {
+            // Reuse the most recently freed slot
+            index = freeHead;
+            unlinkFree(index);
+        }
+        else
+        {
+            index = slots.size();
+            slots.push_back(0);
+            previousFree.push_back(SlotHandle::INVALID_INDEX);
+            generations.push_back(0);
+        }
+
+        slots[index] = dense.size();
+        dense.push_back(index);
+        pushRow(std::index_sequence_for<Columns...>(), std::move(values)...);
+
+        return index;
+    }
+
+    /**
+     * @brief Inserts an element into the specified free slot.
+     *
+     * This method is used to restore an element at the index it had before it
+     * was erased, so that other references to the index stay valid. Slots past
+     * the end of the slot array are created as needed.
+     *
+     * @param index The slot index, which must not hold an element.
+     * @param values The values of the element, one per column.
+     * @return The slot index of the element.
+     */
+    uint32_t insertAt(uint32_t index, Columns... values)
+    {
+        ASSERT(!contains(index));
+
+        // Create the missing slots on the free list
+        while (slots.size() <= index)
+        {
+            slots.push_back(0);
+            previousFree.push_back(0);
+            generations.push_back(0);
+            pushFree(slots.size() - 1);
+        }
+
+        unlinkFree(index);
+
+        slots[index] = dense.size();
+        dense.push_back(index);
+        pushRow(std::index_sequence_for<Columns...>(), std::move(values)...);
+
+        return index;
+    }
+
+    /**
+     * @brief Erases the element in the specified slot.
+     *
+     * This method moves the last element of the dense arrays into the hole,
+     * so it invalidates dense indices but never slot indices.
+     *
+     * @param index The slot index of the element.
+     */
+    void erase(uint32_t index)
+    {
+        ASSERT(contains(index));
+
+        uint32_t hole = slots[index];
+        uint32_t last = dense.size() - 1;
+        if (hole != last)
+        {
+            dense[hole] = dense[last];
+            slots[dense[hole]] = hole;
+            moveRow(std::index_sequence_for<Columns...>(), last, hole);
+        }
+
+        dense.pop_back();
+        popRow(std::index_sequence_for<Columns...>());
+
+        // Bump the generation and push the slot onto the free list
+        ++generations[index];
+        pushFree(index);
+    }
+
+    /**
+     * @brief Checks if the specified slot holds an element.
+     *
+     * @param index The slot index.
+     * @return True if the slot holds an element, false otherwise.
+     */
+    inline bool contains(uint32_t index) const
+    {
+        if (index >= slots.size()) return false;
+
+        uint32_t denseIndex = slots[index];
+        return denseIndex < dense.size() && dense[denseIndex] == index;
+    }
+
+    /**
+     * @brief Checks if the specified handle refers to a live element.
+     *
+     * @param handle The handle.
+     * @return True if the handle refers to a live element, false otherwise.
+     */
+    inline bool contains(SlotHandle handle) const
+    {
+        return contains(handle.index) &&
+               generations[handle.index] == handle.generation;
+    }
+
+    /**
+     * @brief Gets a handle to the element in the specified slot.
+     *
+     * @param index The slot index.
+     * @return The handle to the element.
+     */
+    inline SlotHandle getHandle(uint32_t index) const
+    {
+        ASSERT(contains(index));
+        return {index, generations[index]};
+    }
+
+    /**
+     * @brief Gets a column value of the element in the specified slot.
+     *
+     * @tparam Column The index of the column.
+     * @param index The slot index.
+     * @return The value.
+     */
+    template <size_t Column>
+    inline auto& get(uint32_t index)
+    {
+        ASSERT(contains(index));
+        return std::get<Column>(columns)[slots[index]];
+    }
+
+    /**
+     * @brief Gets a column value of the element in the specified slot.
+     *
+     * @tparam Column The index of the column.
+     * @param index The slot index.
+     * @return The value.
+     */
+    template <size_t Column>
+    inline const auto& get(uint32_t index) const
+    {
+        ASSERT(contains(index));
+        return std::get<Column>(columns)[slots[index]];
+    }
+
+    /**
+     * @brief Gets a densely packed column.
+     *
+     * The entries are ordered like getSlotIndices.
+     *
+     * @tparam Column The index of the column.
+     * @return The column.
+     */
+    template <size_t Column>
+    inline const auto& getColumn() const
+    {
+        return std::get<Column>(columns);
+    }
+
+    /**
+     * @brief Gets a densely packed column for bulk writes.
+     *
+     * The entries are ordered like getSlotIndices. The column must keep its
+     * size.
+     *
+     * @tparam Column The index of the column.
+     * @return The column.
+     */
+    template <size_t Column>
+    inline auto& getColumn()
+    {
+        return std::get<Column>(columns);
+    }
+
+    /**
+     * @brief Gets the slot indices of the live elements in dense order.
+     *
+     * @return The slot indices.
+     */
+    inline const std::vector<uint32_t>& getSlotIndices() const
+    {
+        return dense;
+    }
+
+    /**
+     * @brief Gets the number of live elements.
+     *
+     * @return The number of live elements.
+     */
+    inline size_t size() const { return dense.size(); }
+
+    /**
+     * @brief Gets the number of slots, including free ones.
+     *
+     * Every slot index is smaller than this value.
+     *
+     * @return The number of slots.
+     */
+    inline size_t getSlotCount() const { return slots.size(); }
+
+    /**
+     * @brief Reserves room for the specified number of elements.
+     *
+     * @param count The number of elements.
+     */
+    void reserve(size_t count)
+    {
+        dense.reserve(count);
+        std::apply([count](auto&... column) { (column.reserve(count), ...); },
+                   columns);
+    }
+
+    /**
+     * @brief Reserves room for the specified number of elements on top of the
+     * stored ones.
+     *
+     * The room grows geometrically, so repeated bulk inserts stay amortized
+     * O(1) per element instead of reallocating on every call. Free slots are
+     * reused first, so slots are only reserved for the elements they cannot
+     * hold.
+     *
+     * @param count The number of elements to make room for.
+     */
+    void reserveAdditional(size_t count)
+    {
+        size_t needed = dense.size() + count;
+        if (needed > dense.capacity())
+            reserve(std::max(needed, dense.capacity() * 2));
+
+        // Every free slot is reused before a new slot is created
+        size_t freeCount = slots.size() - dense.size();
+        if (count <= freeCount) return;
+
+        size_t slotCount = slots.size() + count - freeCount;
+        if (slotCount > slots.capacity())
+        {
+            size_t capacity = std::max(slotCount, slots.capacity() * 2);
+            slots.reserve(capacity);
+            previousFree.reserve(capacity);
+            generations.reserve(capacity);
+        }
+    }
+
+    /**
+     * @brief Replaces the contents with the specified number of
+     * value-initialized elements.
+     *
+     * Without slot indices, the elements occupy slots 0 to count - 1 in
+     * order, so their slot and dense indices are equal. Either way the dense
+     * order follows the given order, so the values can be written in bulk with
+     * getColumn. The generations of all slots are bumped, so handles to the
+     * previous elements become stale.
+     *
+     * @param count The number of elements.
+     * @param indices The distinct slot index of each element, or nullptr to
+     * use slots 0 to count - 1. Defaults to nullptr.
+     */
+    void reset(size_t count, const uint32_t* indices = nullptr)
+    {
+        for (uint32_t& generation : generations) ++generation;
+
+        size_t slotCount = std::max(slots.size(), count);
+        if (indices)
+        {
+            for (size_t i = 0; i < count; ++i)
+                slotCount = std::max<size_t>(slotCount, indices[i] + 1);
+        }
+
+        slots.resize(slotCount);
+        previousFree.resize(slotCount);
+        generations.resize(slotCount, 0);
+        dense.resize(count);
+
+        // Flag the occupied slots, as the free ones are chained through
+        // their entries below
+        std::vector<bool> occupied;
+        if (indices) occupied.assign(slotCount, false);
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uint32_t slot = indices ? indices[i] : i;
+            slots[slot] = i;
+            dense[i] = slot;
+            if (indices) occupied[slot] = true;
+        }
+
+        // Chain the remaining slots so that the lowest is reused first
+        freeHead = SlotHandle::INVALID_INDEX;
+        for (size_t i = slotCount; i-- > (indices ? 0 : count);)
+        {
+            if (indices && occupied[i]) continue;
+
+            pushFree(i);
+        }
+
+        std::apply(
+            [count](auto&... column)
+            { ((column.clear(), column.resize(count)), ...); },
+            columns);
+    }
+
+    /**
+     * @brief Removes every element and frees every slot.
+     *
+     * Generations are kept, so handles to removed elements stay stale.
+     */
+    void clear()
+    {
+        while (!dense.empty()) erase(dense.back());
+    }
+
+private:
+    // The dense index of each slot, or the next free slot if it is free
+    std::vector<uint32_t> slots;
+    // The previous free slot of each free slot, unused for occupied slots
+    std::vector<uint32_t> previousFree;
+    // The generation of each slot
+    std::vector<uint32_t> generations;
+    // The slot index of each dense element
+    std::vector<uint32_t> dense;
+    // The densely packed columns
+    std::tuple<std::vector<Columns>...> columns;
+    // The most recently freed slot
+    uint32_t freeHead = SlotHandle::INVALID_INDEX;
+
+    /**
+     * @brief Pushes a slot onto the free list.
+     *
+     * @param index The slot index, which must not hold an element.
+     */
+    void pushFree(uint32_t index)
+    {
+        slots[index] = freeHead;
+        previousFree[index] = SlotHandle::INVALID_INDEX;
+        if (freeHead != SlotHandle::INVALID_INDEX)
+            previousFree[freeHead] = index;
+        freeHead = index;
+    }
+
+    /**
+     * @brief Unlinks a slot from the free list in O(1).
+     *
+     * @param index The slot index, which must be on the free list.
+     */
+    void unlinkFree(uint32_t index)
+    {
+        uint32_t next = slots[index];
+        uint32_t previous = previousFree[index];
+
+        if (previous == SlotHandle::INVALID_INDEX)
+            freeHead = next;
+        else
+            slots[previous] = next;
+
+        if (next != SlotHandle::INVALID_INDEX) previousFree[next] = previous;
+    }
+
+    /**
+     * @brief Appends a row of values to the columns.
+     *
+     * @param values The values, one per column.
+     */
+    template <size_t... I>
+    void pushRow(std::index_sequence<I...>, Columns&&... values)
+    {
+        (std::get<I>(columns).push_back(std::move(values)), ...);
+    }
+
+    /**
+     * @brief Moves a row of values to another dense index.
+     *
+     * @param from The dense index to move from.
+     * @param to The dense index to move to.
+     */
+    template <size_t... I>
+    void moveRow(std::index_sequence<I...>, uint32_t from, uint32_t to)
+    {
+        ((std::get<I>(columns)[to] = std::move(std::get<I>(columns)[from])),
+         ...);
+    }
+
+    /**
+     * @brief Removes the last row of values from the columns.
+     */
+    template <size_t... I>
+    void popRow(std::index_sequence<I...>)
+    {
+        (std::get<I>(columns).pop_back(), ...);
+    }
+};
\ No newline at end of file
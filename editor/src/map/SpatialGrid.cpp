@@ -0,0 +1,43 @@
+#include "SpatialGrid.h"
+
+#include <algorithm>
+
+void SpatialGrid::insert(uint32_t id, glm::vec2 min, glm::vec2 max)
+{
+    int minX = getCell(min.x), minY = getCell(min.y);
+    int maxX = getCell(max.x), maxY = getCell(max.y);
+
+    for (int y = minY; y <= maxY; ++y)
+        for (int x = minX; x <= maxX; ++x) cells[getKey(x, y)].push_back(id);
+}
+
+void SpatialGrid::remove(uint32_t id, glm::vec2 min, glm::vec2 max)
+{
+    int minX = getCell(min.x), minY = getCell(min.y);
+    int maxX = getCell(max.x), maxY = getCell(max.y);
+
+    for (int y = minY; y <= maxY; ++y)
+    {
+        for (int x = minX; x <= maxX; ++x)
+        {
+            auto it = cells.find(getKey(x, y));
+            if (it == cells.end()) continue;
+
+            // Swap the element with the last one of the cell and pop it
+            std::vector<uint32_t>& ids = it->second;
+            auto found = std::find(ids.begin(), ids.end(), id);
+            if (found == ids.end()) continue;
+
+            *found = ids.back();
+            ids.pop_back();
+            if (ids.empty()) cells.erase(it);
+        }
+    }
+}
+
+void SpatialGrid::clear()
+{
+    cells.clear();
+    stamps.clear();
+    stamp = 0;
+}
\ No newline at end of file
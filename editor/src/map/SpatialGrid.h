@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief A uniform grid that buckets map elements by world region.
+ *
+ * This class stores element indices in the grid cells overlapped by their
+ * bounding boxes, so that region and proximity queries only visit the cells
+ * around the query instead of every element of the map. Points occupy a
+ * single cell and lines occupy every cell overlapped by their bounding box.
+ * Queries report candidates, which the caller tests exactly.
+ */
+class SpatialGrid
+{
+public:
+    /**
+     * @brief Constructs a new SpatialGrid object.
+     *
+     * @param cellSize The side length of a cell in world units. Defaults to
+     * 256.
+     */
+    explicit SpatialGrid(float cellSize = 256.0f) : cellSize(cellSize) {}
+
+    /**
+     * @brief Inserts an element with the specified bounding box.
+     *
+     * @param id The index of the element.
+     * @param min The minimum corner of the bounding box.
+     * @param max The maximum corner of the bounding box.
+     */
+    void insert(uint32_t id, glm::vec2 min, glm::vec2 max);
+
+    /**
+     * @brief Removes an element with the specified bounding box.
+     *
+     * The bounding box must be the one the element was inserted with.
+     *
+     * @param id The index of the element.
+     * @param min The minimum corner of the bounding box.
+     * @param max The maximum corner of the bounding box.
+     */
+    void remove(uint32_t id, glm::vec2 min, glm::vec2 max);
+
+    /**
+     * @brief Calls a function for every element whose cells overlap the
+     * specified box.
+     *
+     * Every element is reported at most once per query. The query stops early
+     * if the function returns false.
+     *
+     * @tparam Func A callable taking an element index and returning a bool.
+     * @param min The minimum corner of the query box.
+     * @param max The maximum corner of the query box.
+     * @param func The function to call for each candidate.
+     */
+    template <typename Func>
+    void query(glm::vec2 min, glm::vec2 max, Func func) const
+    {
+        int minX = getCell(min.x), minY = getCell(min.y);
+        int maxX = getCell(max.x), maxY = getCell(max.y);
+
+        ++stamp;
+
+        for (int y = minY; y <= maxY; ++y)
+        {
+            for (int x = minX; x <= maxX; ++x)
+            {
+                auto it = cells.find(getKey(x, y));
+                if (it == cells.end()) continue;
+
+                for (uint32_t id : it->second)
+                {
+                    // Elements spanning several cells are reported once
+                    if (id >= stamps.size()) stamps.resize(id + 1, 0);
+                    if (stamps[id] == stamp) continue;
+                    stamps[id] = stamp;
+
+                    if (!func(id)) return;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Removes every element from the grid.
+     */
+    void clear();
+
+private:
+    // The side length of a cell
+    float cellSize;
+    // The element indices in each non-empty cell
+    std::unordered_map<uint64_t, std::vector<uint32_t>> cells;
+    // The query in which each element was last reported
+    mutable std::vector<uint32_t> stamps;
+    // The current query stamp
+    mutable uint32_t stamp = 0;
+
+    /**
+     * @brief Gets the cell coordinate of a world coordinate.
+     *
+     * @param coord The world coordinate.
+     * @return The cell coordinate.
+     */
+    inline int getCell(float coord) const
+    {
+        return static_cast<int>(std::floor(coord / cellSize));
+    }
+
+    /**
+     * @brief Gets the key of the specified cell.
+     *
+     * @param x The x coordinate of the cell.
+     * @param y The y coordinate of the cell.
+     * @return The key of the cell.
+     */
+    static inline uint64_t getKey(int x, int y)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) |
+               static_cast<uint32_t>(y);
+    }
+};
\ No newline at end of file
@@ -0,0 +1,235 @@
+#include "VertexWelder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+
+#include "../utils/macros.h"
+
+/**
+ * @brief Gets the cell of the spatial hash holding a coordinate.
+ *
+ * @param coordinate The coordinate.
+ * @param cellSize The size of a cell.
+ * @return The index of the cell, clamped so that it fits a key.
+ */
+static int64_t getCell(float coordinate, float cellSize)
+{
+    double cell = std::floor(static_cast<double>(coordinate) / cellSize);
+    return static_cast<int64_t>(std::clamp(cell, -2147483647.0, 2147483647.0));
+}
+
+const WeldReport& VertexWelder::weld(Map& map, float tolerance)
+{
+    ASSERT(tolerance > 0.0f);
+
+    report = WeldReport();
+
+    const MapStore& store = map.getStore();
+    mergeVertices(store, tolerance);
+    mergeLines(store);
+
+    // Remove the lines first, so that the kept lines never share their ends
+    // with another line while they are moved
+    for (int line : removedLines) map.removeLine(line);
+
+    for (const KeptLine& kept : keptLines)
+    {
+        const Line& line = store.getLine(kept.index);
+        if (line.startVertex != kept.line.startVertex ||
+            line.endVertex != kept.line.endVertex)
+        {
+            map.removeLine(kept.index);
+            map.insertLine(kept.index, kept.line);
+            ++report.remappedLines;
+        }
+        else if (line.front != kept.line.front || line.back != kept.line.back)
+            map.setLineSides(kept.index, kept.line.front, kept.line.back);
+    }
+
+    removeUnusedSides(map);
+
+    for (size_t vertex = 0; vertex < targets.size(); ++vertex)
+    {
+        int index = static_cast<int>(vertex);
+        if (targets[vertex] == -1 || store.getVertexRefCount(index) > 0)
+            continue;
+
+        map.removeVertex(index);
+        if (targets[vertex] == index) ++report.danglingVertices;
+    }
+
+    return report;
+}
+
+void VertexWelder::mergeVertices(const MapStore& store, float tolerance)
+{
+    size_t slotCount = store.getVertexSlotCount();
+    targets.assign(slotCount, -1);
+    nextInCell.assign(slotCount, -1);
+    cellHeads.clear();
+    cellHeads.reserve(store.getVertexCount());
+
+    // Cells several times larger than the tolerance make most vertices fall
+    // inside a single cell along with its tolerance
+    float cellSize = CELL_SIZE_FACTOR * tolerance;
+
+    for (size_t vertex = 0; vertex < slotCount; ++vertex)
+    {
+        int index = static_cast<int>(vertex);
+        if (!store.hasVertex(index)) continue;
+
+        const LineVertex& position = store.getVertex(index);
+        glm::vec2 point(position.x, position.y);
+
+        // Only the cells overlapping the square of the tolerance around the
+        // vertex can hold vertices within it
+        int64_t cellX = getCell(point.x, cellSize);
+        int64_t cellY = getCell(point.y, cellSize);
+        int64_t firstX = getCell(point.x - tolerance, cellSize);
+        int64_t firstY = getCell(point.y - tolerance, cellSize);
+        int64_t lastX = getCell(point.x + tolerance, cellSize);
+        int64_t lastY = getCell(point.y + tolerance, cellSize);
+
+        int nearest = -1;
+        float nearestDistance = tolerance;
+        for (int64_t y = firstY; y <= lastY; ++y)
+        {
+            for (int64_t x = firstX; x <= lastX; ++x)
+            {
+                auto head = cellHeads.find(getCellKey(x, y));
+                if (head == cellHeads.end()) continue;
+
+                for (int kept = head->second; kept != -1;
+                     kept = nextInCell[kept])
+                {
+                    const LineVertex& other = store.getVertex(kept);
+                    float distance =
+                        glm::distance(point, glm::vec2(other.x, other.y));
+                    if (distance > nearestDistance) continue;
+
+                    // Prefer the lower index between equally close vertices
+                    if (distance == nearestDistance && nearest != -1 &&
+                        kept > nearest)
+                        continue;
+
+                    nearest = kept;
+                    nearestDistance = distance;
+                }
+            }
+        }
+
+        if (nearest != -1)
+        {
+            targets[vertex] = nearest;
+            ++report.mergedVertices;
+            continue;
+        }
+
+        targets[vertex] = index;
+
+        auto result = cellHeads.emplace(getCellKey(cellX, cellY), index);
+        if (!result.second)
+        {
+            nextInCell[vertex] = result.first->second;
+            result.first->second = index;
+        }
+    }
+}
+
+void VertexWelder::mergeLines(const MapStore& store)
+{
+    size_t slotCount = store.getLineSlotCount();
+    linePairs.clear();
+    linePairs.reserve(store.getLineCount());
+    keptLines.clear();
+    removedLines.clear();
+    releasedSides.clear();
+
+    for (size_t i = 0; i < slotCount; ++i)
+    {
+        int index = static_cast<int>(i);
+        if (!store.hasLine(index)) continue;
+
+        const Line& line = store.getLine(index);
+        int start = targets[line.startVertex];
+        int end = targets[line.endVertex];
+
+        if (start == end)
+        {
+            releaseLine(line);
+            removedLines.push_back(index);
+            ++report.degenerateLines;
+            continue;
+        }
+
+        auto result =
+            linePairs.emplace(getPairKey(start, end), keptLines.size());
+        if (result.second)
+        {
+            keptLines.push_back(
+                {index, Line(start, end, line.front, line.back)});
+            continue;
+        }
+
+        releaseLine(line);
+        removedLines.push_back(index);
+        ++report.duplicateLines;
+
+        // The front of a line that runs the other way faces the back of the
+        // kept line
+        Line& kept = keptLines[result.first->second].line;
+        bool isReversed = kept.startVertex != start;
+        int front = isReversed ? line.back : line.front;
+        int back = isReversed ? line.front : line.back;
+
+        if (kept.front == -1) kept.front = front;
+        if (kept.back == -1) kept.back = back;
+    }
+}
+
+void VertexWelder::releaseLine(const Line& line)
+{
+    if (line.front != -1) releasedSides.push_back(line.front);
+    if (line.back != -1) releasedSides.push_back(line.back);
+}
+
+void VertexWelder::removeUnusedSides(Map& map)
+{
+    const MapStore& store = map.getStore();
+
+    // Every line left in the map is a kept line
+    usedSides.assign(store.getSideSlotCount(), false);
+    for (const KeptLine& kept : keptLines)
+    {
+        if (kept.line.front != -1) usedSides[kept.line.front] = true;
+        if (kept.line.back != -1) usedSides[kept.line.back] = true;
+    }
+
+    releasedSectors.clear();
+    for (int side : releasedSides)
+    {
+        // A side shared by several removed lines is released once per line
+        if (usedSides[side] || !store.hasSide(side)) continue;
+
+        int sector = store.getSide(side).sector;
+        if (sector != -1) releasedSectors.push_back(sector);
+
+        map.removeSide(side);
+        ++report.danglingSides;
+    }
+
+    if (releasedSectors.empty()) return;
+
+    usedSectors.assign(store.getSectorSlotCount(), false);
+    for (const Side& side : store.getSides())
+        if (side.sector != -1) usedSectors[side.sector] = true;
+
+    for (int sector : releasedSectors)
+    {
+        if (usedSectors[sector] || !store.hasSector(sector)) continue;
+
+        map.removeSector(sector);
+        ++report.danglingSectors;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../map_components/Line.h"
+#include "Map.h"
+
+/**
+ * @brief A struct representing the changes made by a weld.
+ */
+struct WeldReport
+{
+    // The number of vertices merged into a nearby vertex
+    int mergedVertices = 0;
+    // The number of lines whose ends were moved to the vertices they were
+    // merged into
+    int remappedLines = 0;
+    // The number of lines removed because both of their ends were merged
+    int degenerateLines = 0;
+    // The number of lines removed because another line has the same ends
+    int duplicateLines = 0;
+    // The number of vertices removed because no line used them
+    int danglingVertices = 0;
+    // The number of sides removed because their lines were removed
+    int danglingSides = 0;
+    // The number of sectors removed because their sides were removed
+    int danglingSectors = 0;
+};
+
+/**
+ * @brief A class that merges the vertices of a map that lie within a
+ * tolerance of each other, and cleans up the lines left behind.
+ *
+ * Vertices are visited in index order and hashed into cells a few times
+ * larger than the tolerance, so each vertex only tests the vertices kept in
+ * the one to four cells within the tolerance of it, and the weld takes O(n)
+ * expected time. A vertex is merged into
+ * the nearest kept vertex within the tolerance, or kept otherwise, so a
+ * vertex never moves by more than the tolerance and chains of close vertices
+ * do not collapse into one.
+ *
+ * The whole plan is computed in one pass over the vertices and one over the
+ * lines before the map is touched, and only the changed elements are then
+ * edited through the map, so the weld can be undone as one transaction.
+ * Lines that would end at a single vertex are removed, and of lines that
+ * would share both ends, the one of the lowest index is kept and takes over
+ * the sides the others have where it has none. Reference counts follow from
+ * the edits, and vertices left without lines are removed, as are the sides of
+ * the removed lines that no kept line uses and then the sectors of those
+ * sides that no other side uses.
+ */
+class VertexWelder
+{
+public:
+    /**
+     * @brief Constructs a new VertexWelder object.
+     */
+    VertexWelder() = default;
+
+    VertexWelder(const VertexWelder&) = delete;
+    VertexWelder& operator=(const VertexWelder&) = delete;
+
+    /**
+     * @brief Merges the vertices of a map that lie within a tolerance of each
+     * other and removes the degenerate and duplicate lines along with the
+     * elements only they used.
+     *
+     * @param map The map to weld.
+     * @param tolerance The largest distance between merged vertices, which
+     * must be positive.
+     * @return The changes made to the map.
+     */
+    const WeldReport& weld(Map& map, float tolerance);
+
+    /**
+     * @brief Gets the changes made by the last weld.
+     *
+     * @return The changes.
+     */
+    inline const WeldReport& getReport() const { return report; }
+
+private:
+    // The size of a cell of the spatial hash, relative to the tolerance
+    static constexpr float CELL_SIZE_FACTOR = 8.0f;
+
+    /**
+     * @brief A struct representing a line that is kept by the weld.
+     */
+    struct KeptLine
+    {
+        // The index of the line
+        int index;
+        // The line after the weld
+        Line line;
+    };
+
+    // The vertex each vertex slot is merged into, or -1 if the slot is free
+    std::vector<int> targets;
+    // The next kept vertex in the same cell, by vertex slot
+    std::vector<int> nextInCell;
+    // The first kept vertex of each cell
+    std::unordered_map<uint64_t, int> cellHeads;
+    // The kept line of each pair of ends, as an index into the kept lines
+    std::unordered_map<uint64_t, size_t> linePairs;
+    // The lines kept by the weld, in index order
+    std::vector<KeptLine> keptLines;
+    // The lines removed by the weld
+    std::vector<int> removedLines;
+    // The sides of the removed lines, once per line that uses them
+    std::vector<int> releasedSides;
+    // The sectors of the removed sides, once per side that uses them
+    std::vector<int> releasedSectors;
+    // Whether each side slot is used by a kept line
+    std::vector<bool> usedSides;
+    // Whether each sector slot is used by a kept side
+    std::vector<bool> usedSectors;
+    // The changes made by the last weld
+    WeldReport report;
+
+    /**
+     * @brief Chooses the vertex each vertex is merged into.
+     *
+     * @param store The elements of the map.
+     * @param tolerance The largest distance between merged vertices.
+     */
+    void mergeVertices(const MapStore& store, float tolerance);
+
+    /**
+     * @brief Chooses the lines that are kept and computes their ends and
+     * sides after the weld.
+     *
+     * @param store The elements of the map.
+     */
+    void mergeLines(const MapStore& store);
+
+    /**
+     * @brief Records the sides of a removed line, which are removed if no kept
+     * line uses them.
+     *
+     * @param line The removed line.
+     */
+    void releaseLine(const Line& line);
+
+    /**
+     * @brief Removes the sides of the removed lines that no kept line uses,
+     * then the sectors of those sides that no kept side uses.
+     *
+     * @param map The map being welded, whose lines must already be edited.
+     */
+    void removeUnusedSides(Map& map);
+
+    /**
+     * @brief Gets the key of a cell of the spatial hash.
+     *
+     * @param x The column of the cell.
+     * @param y The row of the cell.
+     * @return The key.
+     */
+    static inline uint64_t getCellKey(int64_t x, int64_t y)
+    {
+        return static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32 |
+               static_cast<uint32_t>(y);
+    }
+
+    /**
+     * @brief Gets a key that is the same for both orders of two vertices.
+     *
+     * @param a The index of the first vertex.
+     * @param b The index of the second vertex.
+     * @return The key.
+     */
+    static inline uint64_t getPairKey(int a, int b)
+    {
+        if (a > b) std::swap(a, b);
+        return static_cast<uint64_t>(a) << 32 | static_cast<uint32_t>(b);
+    }
+};
\ No newline at end of file
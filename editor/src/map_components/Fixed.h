@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+/**
+ * @brief A struct representing a 16.16 fixed-point number.
+ *
+ * This struct represents a number as a 32-bit integer counting 1/65536ths, in
+ * the way Doom stores its coordinates. Numbers compare exactly, so equal
+ * positions can be hashed and found by value rather than within a tolerance.
+ * Floats are rounded to the nearest representable number, and saturate at
+ * the ends of the range of about -32768 to 32768, so code that must not merge
+ * distinct values checks isInRange first. Every float rounded this way
+ * converts back to a float exactly, so values passed back and forth between
+ * the two types do not drift.
+ */
+struct Fixed
+{
+    // The number of fractional bits
+    static constexpr int FRACTION_BITS = 16;
+    // The raw value of one
+    static constexpr int32_t ONE = 1 << FRACTION_BITS;
+
+    // The number in 1/65536ths
+    int32_t raw = 0;
+
+    /**
+     * @brief Constructs a new Fixed object.
+     *
+     * This constructor creates a new Fixed object with the value zero.
+     */
+    Fixed() = default;
+
+    /**
+     * @brief Constructs a new Fixed object from a float.
+     *
+     * This constructor creates a new Fixed object with the representable
+     * number nearest to the specified float. NaN becomes zero.
+     *
+     * @param value The float.
+     */
+    explicit Fixed(float value) : raw(fromFloat(value)) {}
+
+    /**
+     * @brief Creates a Fixed object from its raw value.
+     *
+     * @param raw The number in 1/65536ths.
+     * @return The Fixed object.
+     */
+    static Fixed fromRaw(int32_t raw)
+    {
+        Fixed value;
+        value.raw = raw;
+        return value;
+    }
+
+    /**
+     * @brief Converts the number to a float.
+     *
+     * This method rounds numbers of more than 24 significant bits, which
+     * cannot come from a float.
+     *
+     * @return The float.
+     */
+    operator float() const { return static_cast<float>(raw) / ONE; }
+
+    /**
+     * @brief Converts the number to a double, which holds it exactly.
+     *
+     * @return The double.
+     */
+    double toDouble() const { return static_cast<double>(raw) / ONE; }
+
+    /**
+     * @brief Checks if two numbers are equal.
+     *
+     * @param other The other number.
+     * @return True if the numbers are equal, false otherwise.
+     */
+    bool operator==(Fixed other) const { return raw == other.raw; }
+
+    /**
+     * @brief Checks if two numbers differ.
+     *
+     * @param other The other number.
+     * @return True if the numbers differ, false otherwise.
+     */
+    bool operator!=(Fixed other) const { return raw != other.raw; }
+
+    /**
+     * @brief Checks if the number is less than another.
+     *
+     * @param other The other number.
+     * @return True if the number is less, false otherwise.
+     */
+    bool operator<(Fixed other) const { return raw < other.raw; }
+
+    /**
+     * @brief Checks if the number is greater than another.
+     *
+     * @param other The other number.
+     * @return True if the number is greater, false otherwise.
+     */
+    bool operator>(Fixed other) const { return raw > other.raw; }
+
+    /**
+     * @brief Checks if the number is at most another.
+     *
+     * @param other The other number.
+     * @return True if the number is at most the other, false otherwise.
+     */
+    bool operator<=(Fixed other) const { return raw <= other.raw; }
+
+    /**
+     * @brief Checks if the number is at least another.
+     *
+     * @param other The other number.
+     * @return True if the number is at least the other, false otherwise.
+     */
+    bool operator>=(Fixed other) const { return raw >= other.raw; }
+
+    /**
+     * @brief Checks if a float rounds to a number that is not saturated.
+     *
+     * @param value The float.
+     * @return True if the float is in range, false if it is out of range or
+     * NaN.
+     */
+    static bool isInRange(float value)
+    {
+        double scaled = std::round(static_cast<double>(value) * ONE);
+        return scaled >= -2147483648.0 && scaled <= 2147483647.0;
+    }
+
+    /**
+     * @brief Rounds a float to the nearest raw value.
+     *
+     * @param value The float.
+     * @return The raw value, saturated to the range of a 32-bit integer.
+     */
+    static int32_t fromFloat(float value)
+    {
+        // A float times a power of two is exact in a double
+        double scaled = std::round(static_cast<double>(value) * ONE);
+        if (scaled >= 2147483647.0) return 2147483647;
+        if (scaled <= -2147483648.0) return -2147483647 - 1;
+        if (scaled != scaled) return 0;
+
+        return static_cast<int32_t>(scaled);
+    }
+};
\ No newline at end of file
@@ -1,13 +1,11 @@
 #pragma once
 
-#include "../Selectable.h"
-
 /**
  * @brief A struct representing a line.
  *
  * This struct represents a line in the map editor.
  */
-struct Line : public Selectable
+struct Line
 {
     // Index of the start vertex
     int startVertex;
@@ -17,10 +15,6 @@ struct Line : public Selectable
     int front;
     // Index of the back side
     int back;
-    // Flag indicating whether the line is deleted
-    bool deleted = false;
-    // Flag indicating whether the line is selected
-    bool selected = false;
 
     /**
      * @brief Constructs a new Line object.
@@ -33,7 +27,8 @@ struct Line : public Selectable
      * @param front The index of the front side.
      * @param back The index of the back side.
      */
-    Line(int startVertex, int endVertex, int front = -1, int back = -1)
+    Line(int startVertex = -1, int endVertex = -1, int front = -1,
+         int back = -1)
         : startVertex(startVertex),
           endVertex(endVertex),
           front(front),
@@ -1,42 +1,82 @@
 #pragma once
 
+#include <cmath>
+#include <limits>
+
 #include "../utils/macros.h"
+#include "Fixed.h"
+
+#ifdef MAP_FIXED_POINT
+// The type of a map coordinate, a 16.16 fixed-point number
+using MapCoord = Fixed;
+// The largest whole map coordinate
+constexpr float MAX_MAP_COORD = 32767.0f;
+#else
+// The type of a map coordinate
+using MapCoord = float;
+// The largest whole map coordinate
+constexpr float MAX_MAP_COORD = std::numeric_limits<float>::max();
+#endif
+
+/**
+ * @brief Checks if a float can be stored as a map coordinate as it is.
+ *
+ * Fixed-point coordinates saturate at the ends of their range, so positions
+ * past it would be clamped onto each other. Float coordinates only reject
+ * infinities and NaN.
+ *
+ * @param value The float.
+ * @return True if the float is in range, false otherwise.
+ */
+inline bool isMapCoordInRange(float value)
+{
+#ifdef MAP_FIXED_POINT
+    return Fixed::isInRange(value);
+#else
+    return std::isfinite(value);
+#endif
+}
 
 /**
  * @brief A struct representing a line vertex.
  *
- * This struct represents a vertex of a line in the map editor.
+ * This struct represents the position of a vertex of a line in the map
+ * editor. Reference counts are kept in a separate array by the map store.
+ * When the map code is built with MAP_FIXED_POINT, the coordinates are
+ * stored as 16.16 fixed-point numbers and positions compare exactly.
+ * Otherwise they are floats compared within EPSILON.
  */
-struct LineVertex : public Selectable
+struct LineVertex
 {
-    float x, y;
-    // Flag indicating whether the vertex is deleted
-    bool deleted = false;
-    // Flag indicating whether the vertex is selected
-    bool selected = false;
+    MapCoord x, y;
 
     /**
      * @brief Constructs a new LineVertex object.
      *
      * This constructor creates a new LineVertex object with the specified x and
-     * y coordinates.
+     * y coordinates, which are rounded to fixed-point numbers if the
+     * coordinates are stored as such.
      *
      * @param x The x coordinate of the vertex.
      * @param y The y coordinate of the vertex.
      */
-    LineVertex(float x, float y) : x(x), y(y) {}
+    LineVertex(float x = 0.0f, float y = 0.0f) : x(x), y(y) {}
 
     /**
      * @brief Checks if two LineVertex objects are equal.
      *
      * This method checks if two LineVertex objects are equal by comparing their
-     * x and y coordinates.
+     * x and y coordinates, exactly if they are fixed-point numbers.
      *
      * @param other The other LineVertex object to compare.
      * @return True if the LineVertex objects are equal, false otherwise.
      */
     bool operator==(const LineVertex& other) const
     {
+#ifdef MAP_FIXED_POINT
+        return x == other.x && y == other.y;
+#else
         return FP_EQUAL(x, other.x) && FP_EQUAL(y, other.y);
+#endif
     }
 };
\ No newline at end of file
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+/**
+ * @brief A struct representing a prefab stamped into the map.
+ *
+ * An instance only records its prefab and its position, and shares the
+ * geometry of its prefab with every other instance of it.
+ */
+struct PrefabInstance
+{
+    // The index of the prefab
+    int prefab;
+    // The position of the minimum corner of the prefab
+    glm::vec2 position;
+};
\ No newline at end of file
@@ -9,8 +9,6 @@ struct Side
 {
     // Index of the sector that the side belongs to
     int sector;
-    // Flag indicating whether the side is deleted
-    bool deleted = false;
 
     /**
      * @brief Constructs a new Side object.
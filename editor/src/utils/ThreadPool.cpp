@@ -0,0 +1,86 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(size_t threadCount)
+{
+    if (threadCount == 0)
+    {
+        size_t hardwareCount = std::thread::hardware_concurrency();
+        threadCount = hardwareCount > 1 ? hardwareCount - 1 : 1;
+    }
+
+    workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i)
+        workers.emplace_back([this]() { work(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    queued.notify_all();
+
+    for (std::thread& worker : workers) worker.join();
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    queued.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this]() { return tasks.empty() && running == 0; });
+}
+
+void ThreadPool::work()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        queued.wait(lock, [this]() { return stopping || !tasks.empty(); });
+        if (tasks.empty()) return;
+
+        std::function<void()> task = std::move(tasks.front());
+        tasks.pop_front();
+        ++running;
+
+        lock.unlock();
+        task();
+        lock.lock();
+
+        --running;
+        if (tasks.empty() && running == 0) idle.notify_all();
+    }
+}
+
+bool ThreadPool::Loop::enter()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (closed) return false;
+
+    ++active;
+    return true;
+}
+
+void ThreadPool::Loop::leave()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        --active;
+    }
+    left.notify_all();
+}
+
+void ThreadPool::Loop::close()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    closed = true;
+    left.wait(lock, [this]() { return active == 0; });
+}
\ No newline at end of file
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief A fixed set of worker threads that run submitted tasks.
+ *
+ * Besides running independent tasks, the pool splits data-parallel loops into
+ * chunks that the workers and the calling thread claim one at a time. The
+ * calling thread only waits for the chunks already claimed by workers, so a
+ * loop makes progress even when every worker is busy, and loops can be run
+ * from inside tasks.
+ */
+class ThreadPool
+{
+public:
+    /**
+     * @brief Constructs a new ThreadPool object and starts its workers.
+     *
+     * @param threadCount The number of worker threads, or 0 to use one less
+     * than the number of hardware threads, since the calling thread also runs
+     * chunks.
+     */
+    explicit ThreadPool(size_t threadCount = 0);
+
+    /**
+     * @brief Destroys the ThreadPool object, finishing the queued tasks and
+     * joining the workers.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Gets the number of worker threads.
+     *
+     * @return The number of worker threads.
+     */
+    inline size_t getThreadCount() const { return workers.size(); }
+
+    /**
+     * @brief Queues a task to run on a worker thread.
+     *
+     * @param task The task.
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief Waits until every submitted task has finished.
+     */
+    void wait();
+
+    /**
+     * @brief Gets the number of chunks a loop is split into.
+     *
+     * @param count The number of iterations.
+     * @param chunkSize The number of iterations per chunk.
+     * @return The number of chunks.
+     */
+    static inline size_t getChunkCount(size_t count, size_t chunkSize)
+    {
+        return (count + chunkSize - 1) / chunkSize;
+    }
+
+    /**
+     * @brief Runs a loop in chunks spread across the workers and the calling
+     * thread, and waits for it to finish.
+     *
+     * Chunk i covers the iterations [i * chunkSize, (i + 1) * chunkSize), so
+     * results written per chunk can be merged in a deterministic order.
+     *
+     * @tparam Func The type of the function, called with the index of the
+     * chunk and the first and one past the last iteration of the chunk.
+     * @param count The number of iterations.
+     * @param chunkSize The number of iterations per chunk.
+     * @param func The function.
+     */
+    template <typename Func>
+    void forEachChunk(size_t count, size_t chunkSize, Func func)
+    {
+        size_t chunkCount = getChunkCount(count, chunkSize);
+        if (chunkCount == 0) return;
+
+        auto loop = std::make_shared<Loop>();
+        auto run = [loop, count, chunkSize, chunkCount, &func]()
+        {
+            for (size_t chunk = loop->next++; chunk < chunkCount;
+                 chunk = loop->next++)
+            {
+                size_t begin = chunk * chunkSize;
+                func(chunk, begin, std::min(begin + chunkSize, count));
+            }
+        };
+
+        // Helpers that start after the loop is closed return at once, so
+        // the function is never called after this method returns
+        size_t helperCount = std::min(workers.size(), chunkCount - 1);
+        for (size_t i = 0; i < helperCount; ++i)
+            submit(
+                [loop, run]()
+                {
+                    if (!loop->enter()) return;
+                    run();
+                    loop->leave();
+                });
+
+        run();
+        loop->close();
+    }
+
+private:
+    /**
+     * @brief A struct representing the shared state of a chunked loop.
+     */
+    struct Loop
+    {
+        // The index of the next chunk to claim
+        std::atomic<size_t> next{0};
+        // The mutex guarding the helper count
+        std::mutex mutex;
+        // The condition signalled when a helper leaves
+        std::condition_variable left;
+        // The number of helpers running chunks
+        size_t active = 0;
+        // Whether the calling thread has run out of chunks
+        bool closed = false;
+
+        /**
+         * @brief Registers a helper, unless the loop is closed.
+         *
+         * @return True if the helper may run chunks, false otherwise.
+         */
+        bool enter();
+
+        /**
+         * @brief Unregisters a helper.
+         */
+        void leave();
+
+        /**
+         * @brief Closes the loop and waits for the registered helpers.
+         */
+        void close();
+    };
+
+    // The worker threads
+    std::vector<std::thread> workers;
+    // The tasks waiting for a worker
+    std::deque<std::function<void()>> tasks;
+    // The mutex guarding the tasks and the counts
+    std::mutex mutex;
+    // The condition signalled when a task is queued or the pool stops
+    std::condition_variable queued;
+    // The condition signalled when the pool becomes idle
+    std::condition_variable idle;
+    // The number of tasks being run
+    size_t running = 0;
+    // Whether the workers should exit once the queue is empty
+    bool stopping = false;
+
+    /**
+     * @brief Runs queued tasks until the pool stops.
+     */
+    void work();
+};
\ No newline at end of file
@@ -1,7 +1,38 @@
 #pragma once
 
+#include <cstdio>
 #include <cstdlib>
 
 #define EPSILON 0.0001f
 
-#define FP_EQUAL(a, b) (std::abs((a) - (b)) <= EPSILON)
\ No newline at end of file
+#define FP_EQUAL(a, b) (std::abs((a) - (b)) <= EPSILON)
+
+// Map code does not depend on the engine, so provide the engine's assertion
+// and logging macros when they have not been pulled in through Engine.h
+#ifndef ASSERT
+#define ASSERT(condition, ...)                                            \
+    if (!(condition))                                                     \
+    {                                                                     \
+        fprintf(stderr, "%s:%d: [Error]: Assertion failed: (%s)\n",       \
+                __FILE__, __LINE__, #condition);                          \
+        std::exit(EXIT_FAILURE);                                          \
+    }
+#endif
+
+#ifndef LOG_WARN
+#define LOG_WARN(...)                                              \
+    {                                                              \
+        fprintf(stderr, "%s:%d: [Warning]: ", __FILE__, __LINE__); \
+        fprintf(stderr, __VA_ARGS__);                              \
+        fprintf(stderr, "\n");                                     \
+    }
+#endif
+
+#ifndef LOG_INFO
+#define LOG_INFO(...)                                           \
+    {                                                           \
+        fprintf(stderr, "%s:%d: [Info]: ", __FILE__, __LINE__); \
+        fprintf(stderr, __VA_ARGS__);                           \
+        fprintf(stderr, "\n");                                  \
+    }
+#endif
\ No newline at end of file
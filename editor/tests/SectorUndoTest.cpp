@@ -0,0 +1,304 @@
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "map/EditHistory.h"
+#include "map/Map.h"
+#include "map/SectorDetector.h"
+
+// The number of random edit sequences
+static constexpr int SEED_COUNT = 60;
+// The number of edits and undos in each sequence
+static constexpr int STEP_COUNT = 150;
+// The number of grid points along each axis
+static constexpr int GRID_SIZE = 9;
+// The spacing of the grid points
+static constexpr float GRID_SPACING = 40.0f;
+
+/**
+ * @brief Writes every element of a map with its slot index, so that two maps
+ * compare equal only if undo restored the same elements in the same slots.
+ *
+ * @param store The elements of the map.
+ * @return The elements as text.
+ */
+static std::string describe(const MapStore& store)
+{
+    std::ostringstream text;
+
+    for (size_t i = 0; i < store.getVertexSlotCount(); ++i)
+    {
+        if (!store.hasVertex(i)) continue;
+
+        const LineVertex& vertex = store.getVertex(i);
+        text << 'v' << i << ' ' << static_cast<float>(vertex.x) << ' '
+             << static_cast<float>(vertex.y) << '\n';
+    }
+
+    for (size_t i = 0; i < store.getLineSlotCount(); ++i)
+    {
+        if (!store.hasLine(i)) continue;
+
+        const Line& line = store.getLine(i);
+        text << 'l' << i << ' ' << line.startVertex << ' ' << line.endVertex
+             << ' ' << line.front << ' ' << line.back << '\n';
+    }
+
+    for (size_t i = 0; i < store.getSideSlotCount(); ++i)
+    {
+        if (store.hasSide(i))
+            text << 's' << i << ' ' << store.getSide(i).sector << '\n';
+    }
+
+    for (size_t i = 0; i < store.getSectorSlotCount(); ++i)
+    {
+        if (!store.hasSector(i)) continue;
+
+        const Sector& sector = store.getSector(i);
+        text << 'c' << i << ' ' << static_cast<float>(sector.floorHeight)
+             << ' ' << static_cast<float>(sector.ceilingHeight) << ' '
+             << sector.lightLevel << '\n';
+    }
+
+    return text.str();
+}
+
+/**
+ * @brief A class that makes random edits to a map the way the editor does.
+ */
+class EditSequence
+{
+public:
+    /**
+     * @brief Constructs a new EditSequence object.
+     *
+     * @param seed The seed of the edits.
+     */
+    explicit EditSequence(unsigned int seed)
+        : random(seed), detector(map.getTopology())
+    {
+        map.addListener(&detector);
+        map.addListener(&history);
+    }
+
+    /**
+     * @brief Makes the edits, undoing some of them along the way, then undoes
+     * every edit left.
+     *
+     * @return True if every undo restored the map it undid to, false
+     * otherwise.
+     */
+    bool run()
+    {
+        states.assign(1, describe(map.getStore()));
+
+        for (int step = 0; step < STEP_COUNT; ++step)
+        {
+            int action = random() % 10;
+            if (action < 8)
+            {
+                edit(action);
+                continue;
+            }
+
+            int count = 1 + random() % 3;
+            for (int i = 0; i < count && history.canUndo(); ++i)
+            {
+                if (!undo()) return false;
+            }
+
+            // Replaying must leave the redo stack as undo left it
+            if (history.canRedo())
+            {
+                history.redo(map);
+                detector.sync(map);
+                states.push_back(describe(map.getStore()));
+            }
+        }
+
+        while (history.canUndo())
+        {
+            if (!undo()) return false;
+        }
+
+        return states.size() == 1;
+    }
+
+private:
+    // The random generator of the edits
+    std::mt19937 random;
+    // The edited map
+    Map map;
+    // The detector that keeps the sectors in step with the lines
+    SectorDetector detector;
+    // The undo history of the map
+    EditHistory history;
+    // The map after each edit that can be undone
+    std::vector<std::string> states;
+    // The lines touched by the line being placed
+    std::vector<LineIntersection> intersections;
+
+    /**
+     * @brief Gets a random grid point.
+     *
+     * @return The grid point.
+     */
+    glm::vec2 getGridPoint()
+    {
+        return glm::vec2(random() % GRID_SIZE, random() % GRID_SIZE) *
+               GRID_SPACING;
+    }
+
+    /**
+     * @brief Gets the vertex at a position, adding it if there is none.
+     *
+     * @param position The position.
+     * @return The index of the vertex.
+     */
+    int getVertex(glm::vec2 position)
+    {
+        int vertex = map.findVertex(position);
+        return vertex != -1 ? vertex : map.addVertex(position.x, position.y);
+    }
+
+    /**
+     * @brief Adds a line between two vertices unless they are joined.
+     *
+     * @param start The index of the start vertex.
+     * @param end The index of the end vertex.
+     */
+    void joinVertices(int start, int end)
+    {
+        if (start != end && map.getTopology().findLine(start, end) == -1)
+            map.addLine(start, end);
+    }
+
+    /**
+     * @brief Places, deletes or moves a line as one transaction, and records
+     * the map after it if it changed.
+     *
+     * @param action The kind of edit, from 0 to 7.
+     */
+    void edit(int action)
+    {
+        const MapStore& store = map.getStore();
+
+        history.beginTransaction();
+        if (action < 5 || store.getLineCount() == 0)
+            placeLine(getGridPoint(), getGridPoint());
+        else if (action < 7)
+            map.deleteLine(store.getLineIndices()[random() %
+                                                  store.getLineCount()]);
+        else
+            moveVertex(
+                store.getVertexIndices()[random() % store.getVertexCount()],
+                getGridPoint());
+        detector.update(map);
+        history.endTransaction();
+
+        std::string state = describe(store);
+        if (state != states.back()) states.push_back(state);
+    }
+
+    /**
+     * @brief Places a line, split where it touches other lines, as
+     * EditorLayer::placeLine does.
+     *
+     * @param start The start of the line.
+     * @param end The end of the line.
+     */
+    void placeLine(glm::vec2 start, glm::vec2 end)
+    {
+        if (start == end) return;
+
+        map.findIntersections(start, end, intersections);
+        for (const LineIntersection& intersection : intersections)
+        {
+            if (intersection.type == Geometry::ContactType::OVERLAPPING)
+                return;
+        }
+
+        int previous = getVertex(start);
+        for (const LineIntersection& intersection : intersections)
+        {
+            int vertex = getVertex(intersection.position);
+            const Line& line = map.getStore().getLine(intersection.line);
+            if (vertex != line.startVertex && vertex != line.endVertex)
+                map.splitLine(intersection.line, vertex);
+
+            joinVertices(previous, vertex);
+            previous = vertex;
+        }
+
+        joinVertices(previous, getVertex(end));
+    }
+
+    /**
+     * @brief Moves a vertex to a free grid point, unless its lines would
+     * then touch other lines.
+     *
+     * @param vertex The index of the vertex.
+     * @param position The new position of the vertex.
+     */
+    void moveVertex(int vertex, glm::vec2 position)
+    {
+        if (map.findVertex(position) != -1) return;
+
+        const MapStore& store = map.getStore();
+        for (int halfEdge : map.getTopology().getOutgoing(vertex))
+        {
+            const LineVertex& other =
+                store.getVertex(map.getTopology().getDestination(halfEdge));
+            map.findIntersections(position, {other.x, other.y},
+                                  intersections);
+
+            for (const LineIntersection& intersection : intersections)
+            {
+                const Line& line = store.getLine(intersection.line);
+                if (line.startVertex != vertex && line.endVertex != vertex)
+                    return;
+            }
+        }
+
+        map.moveVertex(vertex, position);
+    }
+
+    /**
+     * @brief Undoes the last edit and checks that the map is restored.
+     *
+     * @return True if the map is as it was before the edit and the edit can
+     * be redone, false otherwise.
+     */
+    bool undo()
+    {
+        history.undo(map);
+        detector.sync(map);
+        states.pop_back();
+
+        return history.canRedo() && describe(map.getStore()) == states.back();
+    }
+};
+
+/**
+ * @brief Checks that undoing random edits restores the map exactly, sides
+ * and sectors included, and keeps the edits to redo.
+ *
+ * @return 0 if every sequence was undone to its start, 1 otherwise.
+ */
+int main()
+{
+    int failures = 0;
+    for (int seed = 0; seed < SEED_COUNT; ++seed)
+    {
+        EditSequence sequence(seed);
+        if (sequence.run()) continue;
+
+        std::printf("Undo did not restore the map with seed %d\n", seed);
+        ++failures;
+    }
+
+    std::printf("%d of %d sequences failed\n", failures, SEED_COUNT);
+    return failures == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "io/BinaryMapWriter.h"
+#include "io/UdmfWriter.h"
+#include "io/WadWriter.h"
+#include "map/DungeonGenerator.h"
+#include "map/MapStore.h"
+#include "utils/ThreadPool.h"
+
+/**
+ * @brief Checks if a path ends with an extension.
+ *
+ * @param path The path.
+ * @param extension The extension, including the dot.
+ * @return True if the path ends with the extension, false otherwise.
+ */
+static bool hasExtension(const std::string& path, const char* extension)
+{
+    size_t length = std::strlen(extension);
+    return path.size() >= length &&
+           path.compare(path.size() - length, length, extension) == 0;
+}
+
+/**
+ * @brief Computes the FNV-1a checksum of the elements of a map, which is the
+ * same for every run with the same settings.
+ *
+ * @param data The elements of the map.
+ * @return The checksum.
+ */
+static uint64_t getChecksum(const MapData& data)
+{
+    uint64_t hash = 14695981039346656037ull;
+    auto add = [&hash](const void* bytes, size_t size)
+    {
+        const unsigned char* begin = static_cast<const unsigned char*>(bytes);
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= begin[i];
+            hash *= 1099511628211ull;
+        }
+    };
+
+    add(data.vertices.data(), data.vertices.size() * sizeof(LineVertex));
+    add(data.lines.data(), data.lines.size() * sizeof(Line));
+    add(data.sides.data(), data.sides.size() * sizeof(Side));
+    add(data.sectors.data(), data.sectors.size() * sizeof(Sector));
+
+    return hash;
+}
+
+/**
+ * @brief Generates a dungeon and writes it to a map file.
+ *
+ * Usage: DungeonGen [-s seed] [-w width] [-h height] [-c] [-t threads]
+ * [-o map]
+ *
+ * The map is written as a binary, text or WAD map depending on the extension
+ * of the output path, which defaults to dungeon.dvmap. The -c flag generates
+ * caves instead of rooms, and -t sets the number of worker threads. The same
+ * settings give the same map whatever the number of threads, which the
+ * printed checksum shows.
+ *
+ * @return 0 if the map was written, 1 if it could not be, and 2 if the
+ * arguments are invalid.
+ */
+int main(int argc, char** argv)
+{
+    DungeonSettings settings;
+    size_t threadCount = 0;
+    std::string path = "dungeon.dvmap";
+
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "-s") == 0 && hasValue)
+            settings.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "-w") == 0 && hasValue)
+            settings.width = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "-h") == 0 && hasValue)
+            settings.height = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "-t") == 0 && hasValue)
+            threadCount = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "-o") == 0 && hasValue)
+            path = argv[++i];
+        else if (std::strcmp(argv[i], "-c") == 0)
+            settings.style = DungeonStyle::CAVES;
+        else
+        {
+            std::cerr << "Usage: " << argv[0]
+                      << " [-s seed] [-w width] [-h height] [-c] [-t threads]"
+                         " [-o map]\n";
+            return 2;
+        }
+    }
+
+    // Larger maps do not fit the range of fixed-point coordinates
+    int maxSize = DungeonGenerator::getMaxSize(settings.tileSize);
+    if (settings.width > maxSize || settings.height > maxSize)
+    {
+        std::cerr << "The width and height must be at most " << maxSize
+                  << " tiles\n";
+        return 2;
+    }
+
+    ThreadPool pool(threadCount);
+    DungeonGenerator generator(pool);
+    const MapData& data = generator.generate(settings);
+
+    std::printf("Generated %zu vertices, %zu lines, %zu sides and %zu "
+                "sectors in %.3f ms with %zu worker threads\n",
+                data.vertices.size(), data.lines.size(), data.sides.size(),
+                data.sectors.size(), generator.getLastTime(),
+                pool.getThreadCount());
+    std::printf("Checksum: %016llx\n",
+                static_cast<unsigned long long>(getChecksum(data)));
+
+    MapStore store;
+    store.assign(data.getArrays());
+
+    bool written;
+    if (hasExtension(path, ".wad"))
+    {
+        WadWriter writer;
+        written = writer.write(store, path);
+    }
+    else if (hasExtension(path, ".udmf") || hasExtension(path, ".txt"))
+    {
+        UdmfWriter writer;
+        written = writer.write(store, path);
+    }
+    else
+    {
+        BinaryMapWriter writer;
+        written = writer.write(store, path);
+    }
+
+    if (!written) return 1;
+
+    std::printf("Wrote %s\n", path.c_str());
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,372 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "MapRenderCache.h"
+#include "SelectionManager.h"
+#include "map/EditHistory.h"
+#include "map/Map.h"
+#include "map/SectorDetector.h"
+#include "utils/macros.h"
+
+/**
+ * @brief A struct holding a map wired to the listeners the editor keeps on
+ * it.
+ */
+struct BenchMap
+{
+    // The map
+    Map map;
+    // The undo history of the map
+    EditHistory history;
+    // The detector that keeps the sectors in step with the lines
+    SectorDetector sectorDetector;
+    // The CPU-side buffers used to draw the map
+    MapRenderCache renderCache;
+    // The selection
+    SelectionManager selection;
+    // The lines touched by the line being placed
+    std::vector<LineIntersection> intersections;
+
+    /**
+     * @brief Constructs a new BenchMap object with an empty map.
+     */
+    BenchMap()
+        : sectorDetector(map.getTopology()), renderCache(map.getTopology())
+    {
+        map.addListener(&renderCache);
+        map.addListener(&sectorDetector);
+        map.addListener(&history);
+
+        selection.setHandlers(
+            [this](MapElement element) { setSelected(element, true); },
+            [this](MapElement element) { setSelected(element, false); },
+            [this](MapElement element) { map.deleteLine(element.index); });
+    }
+
+    /**
+     * @brief Updates the highlight of an element, as the editor does when
+     * the selection changes.
+     *
+     * @param element The element.
+     * @param selected Whether the element is selected.
+     */
+    void setSelected(MapElement element, bool selected)
+    {
+        if (!map.getStore().contains(element)) return;
+
+        if (element.type == ElementType::VERTEX)
+            renderCache.setVertexSelected(element.index, selected);
+        else if (element.type == ElementType::LINE)
+            renderCache.setLineSelected(element.index, selected);
+    }
+
+    /**
+     * @brief Gets the vertex at a position, adding it if there is none, as
+     * EditorLayer::addLineVertex does.
+     *
+     * @param position The position.
+     * @return The index of the vertex.
+     */
+    int addLineVertex(glm::vec2 position)
+    {
+        int vertex = map.findVertex(position);
+        return vertex != -1 ? vertex : map.addVertex(position.x, position.y);
+    }
+
+    /**
+     * @brief Places a line as one undoable edit, as EditorLayer::placeLine
+     * does for a line that touches no other line.
+     *
+     * @param start The start of the line.
+     * @param end The end of the line.
+     */
+    void placeLine(glm::vec2 start, glm::vec2 end)
+    {
+        map.findIntersections(start, end, intersections);
+        if (!intersections.empty()) return;
+
+        history.beginTransaction();
+        int startVertex = addLineVertex(start);
+        int endVertex = addLineVertex(end);
+        if (map.getTopology().findLine(startVertex, endVertex) == -1)
+            map.addLine(startVertex, endVertex);
+        sectorDetector.update(map);
+        history.endTransaction();
+    }
+};
+
+/**
+ * @brief A struct holding the timings of an operation at every map size.
+ */
+struct Operation
+{
+    // The name of the operation
+    const char* name;
+    // The time per operation in nanoseconds, by map size
+    std::vector<double> nsPerOp;
+};
+
+/**
+ * @brief Gets the time elapsed since a point in time.
+ *
+ * @param start The point in time.
+ * @return The time in nanoseconds.
+ */
+static double getElapsed(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::nano>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+/**
+ * @brief Gets the exponent of a power law fitted to timings by least squares
+ * on a log-log scale.
+ *
+ * @param sizes The map sizes.
+ * @param times The time per operation at each size.
+ * @return The exponent, which is about 0 for operations whose cost does not
+ * grow with the map and about 1 for operations that scan it.
+ */
+static double getExponent(const std::vector<size_t>& sizes,
+                          const std::vector<double>& times)
+{
+    size_t count = times.size();
+    if (count < 2) return 0.0;
+
+    double sumX = 0.0, sumY = 0.0, sumXX = 0.0, sumXY = 0.0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        double x = std::log(static_cast<double>(sizes[i]));
+        double y = std::log(std::max(times[i], 1e-3));
+        sumX += x;
+        sumY += y;
+        sumXX += x * x;
+        sumXY += x * y;
+    }
+
+    double denominator = count * sumXX - sumX * sumX;
+    return denominator != 0.0 ? (count * sumXY - sumX * sumY) / denominator
+                              : 0.0;
+}
+
+/**
+ * @brief Runs every operation on a map of a given size.
+ *
+ * The map is built of square rooms placed line by line, so every fourth line
+ * closes a sector.
+ *
+ * @param lineCount The number of lines of the map.
+ * @param random The random generator of the queries.
+ * @param operations The operations, whose timings are extended.
+ */
+static void runSize(size_t lineCount, std::mt19937& random,
+                    std::vector<Operation>& operations)
+{
+    const float roomSize = 64.0f;
+    const float spacing = 128.0f;
+    const size_t queryCount = 100000;
+    const size_t regionCount = 1000;
+    const size_t rebuildCount = 5;
+    const size_t deleteCount = 1000;
+
+    auto bench = std::make_unique<BenchMap>();
+    size_t roomCount = (lineCount + 3) / 4;
+    size_t columns = static_cast<size_t>(std::ceil(std::sqrt(roomCount)));
+    float extent = columns * spacing;
+    size_t operation = 0;
+
+    auto record = [&](double elapsed, size_t count)
+    { operations[operation++].nsPerOp.push_back(elapsed / count); };
+
+    // Place the lines of the rooms
+    auto start = std::chrono::steady_clock::now();
+    for (size_t line = 0; line < lineCount; ++line)
+    {
+        size_t room = line / 4;
+        glm::vec2 origin = {(room % columns) * spacing,
+                            (room / columns) * spacing};
+        glm::vec2 corners[] = {origin,
+                               origin + glm::vec2(0.0f, roomSize),
+                               origin + glm::vec2(roomSize, roomSize),
+                               origin + glm::vec2(roomSize, 0.0f)};
+        bench->placeLine(corners[line % 4], corners[(line + 1) % 4]);
+    }
+    record(getElapsed(start), lineCount);
+
+    std::uniform_real_distribution<float> coordinate(0.0f, extent);
+    std::vector<glm::vec2> points(queryCount);
+    for (glm::vec2& point : points)
+        point = {coordinate(random), coordinate(random)};
+
+    Map& map = bench->map;
+    const MapStore& store = map.getStore();
+
+    // Hit-test vertices and lines as a click does
+    start = std::chrono::steady_clock::now();
+    size_t hits = 0;
+    for (glm::vec2 point : points) hits += map.findVertex(point, 10.0f) != -1;
+    record(getElapsed(start), queryCount);
+
+    start = std::chrono::steady_clock::now();
+    for (glm::vec2 point : points) hits += map.findLine(point, 6.0f) != -1;
+    record(getElapsed(start), queryCount);
+
+    // Select the elements in boxes of about four rooms
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < regionCount; ++i)
+    {
+        glm::vec2 min = points[i];
+        glm::vec2 max = min + glm::vec2(2.0f * spacing);
+        map.queryVertices(min, max,
+                          [&](uint32_t vertex)
+                          {
+                              bench->selection.select(store.getElement(
+                                  ElementType::VERTEX, vertex));
+                              return true;
+                          });
+        map.queryLines(min, max,
+                       [&](uint32_t line)
+                       {
+                           bench->selection.select(
+                               store.getElement(ElementType::LINE, line));
+                           return true;
+                       });
+        bench->selection.deselectAll();
+    }
+    record(getElapsed(start), regionCount);
+
+    // Select and deselect every element
+    start = std::chrono::steady_clock::now();
+    for (uint32_t vertex : store.getVertexIndices())
+        bench->selection.select(store.getElement(ElementType::VERTEX, vertex));
+    for (uint32_t line : store.getLineIndices())
+        bench->selection.select(store.getElement(ElementType::LINE, line));
+    bench->selection.deselectAll();
+    record(getElapsed(start), store.getVertexCount() + store.getLineCount());
+
+    // Rebuild the buffers from scratch, as buildVertexVBO does
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < rebuildCount; ++i)
+        bench->renderCache.rebuild(store);
+    record(getElapsed(start), rebuildCount);
+
+    // Delete random lines, each as one undoable edit
+    std::vector<uint32_t> lines = store.getLineIndices();
+    std::shuffle(lines.begin(), lines.end(), random);
+    size_t deleted = std::min(deleteCount, lines.size());
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < deleted; ++i)
+    {
+        bench->history.beginTransaction();
+        map.deleteLine(lines[i]);
+        bench->sectorDetector.update(map);
+        bench->history.endTransaction();
+    }
+    record(getElapsed(start), deleted);
+
+    // Keep the queries from being optimized away
+    if (hits == 0) LOG_WARN("No hits at %zu lines", lineCount);
+}
+
+/**
+ * @brief Measures how the editor's map operations scale with the size of the
+ * map and writes the results as JSON.
+ *
+ * Usage: MapBench [-n maxLines] [-o results.json]
+ *
+ * The operations run headlessly on maps of 1k lines up to the largest size,
+ * which defaults to 1M, with the listeners the editor keeps on the map. The
+ * time per operation is reported for every size, along with the exponent of
+ * a power law fitted to it: an exponent near 1 marks an operation that scans
+ * the whole map, which makes a loop over the map quadratic.
+ *
+ * @return 0 if the results were written, 1 if they could not be, and 2 if
+ * the arguments are invalid.
+ */
+int main(int argc, char** argv)
+{
+    size_t maxLines = 1000000;
+    std::string outputPath;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+            maxLines = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+            outputPath = argv[++i];
+        else
+        {
+            std::cerr << "Usage: " << argv[0]
+                      << " [-n maxLines] [-o results.json]\n";
+            return 2;
+        }
+    }
+
+    std::vector<size_t> sizes;
+    for (size_t size = 1000; size <= maxLines; size *= 10)
+    {
+        sizes.push_back(size);
+        if (size * 3 <= maxLines) sizes.push_back(size * 3);
+    }
+
+    if (sizes.empty())
+    {
+        std::cerr << "The largest size must be at least 1000 lines\n";
+        return 2;
+    }
+
+    std::vector<Operation> operations = {
+        {"placeLine", {}},    {"findVertex", {}},   {"findLine", {}},
+        {"selectRegion", {}}, {"selectElement", {}}, {"rebuildBuffers", {}},
+        {"deleteLine", {}}};
+
+    std::mt19937 random(42);
+    for (size_t size : sizes)
+    {
+        std::cerr << "Running " << size << " lines\n";
+        runSize(size, random, operations);
+    }
+
+    std::ofstream file;
+    if (!outputPath.empty())
+    {
+        file.open(outputPath);
+        if (!file)
+        {
+            LOG_WARN("Failed to open file: %s", outputPath.c_str());
+            return 1;
+        }
+    }
+    std::ostream& stream = outputPath.empty() ? std::cout : file;
+
+    stream << "{\n  \"sizes\": [";
+    for (size_t i = 0; i < sizes.size(); ++i)
+        stream << (i ? ", " : "") << sizes[i];
+    stream << "],\n  \"operations\": [\n";
+
+    for (size_t i = 0; i < operations.size(); ++i)
+    {
+        const Operation& operation = operations[i];
+        stream << "    {\"name\": \"" << operation.name << "\", \"nsPerOp\": [";
+        for (size_t j = 0; j < operation.nsPerOp.size(); ++j)
+            stream << (j ? ", " : "") << operation.nsPerOp[j];
+        stream << "], \"exponent\": "
+               << getExponent(sizes, operation.nsPerOp) << "}"
+               << (i + 1 < operations.size() ? "," : "") << "\n";
+    }
+
+    stream << "  ]\n}\n";
+    stream.flush();
+
+    return stream ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,191 @@
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "io/BinaryMapReader.h"
+#include "io/UdmfReader.h"
+#include "io/WadFile.h"
+#include "io/WadMapReader.h"
+#include "map/MapStore.h"
+#include "map/MapValidator.h"
+#include "utils/ThreadPool.h"
+#include "utils/macros.h"
+
+/**
+ * @brief Writes a string as a JSON string literal.
+ *
+ * @param stream The stream to write to.
+ * @param text The string.
+ */
+static void writeJsonString(std::ostream& stream, const std::string& text)
+{
+    stream << '"';
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            stream << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20)
+            stream << ' ';
+        else
+            stream << c;
+    }
+    stream << '"';
+}
+
+/**
+ * @brief Checks if a path ends with an extension.
+ *
+ * @param path The path.
+ * @param extension The extension, including the dot.
+ * @return True if the path ends with the extension, false otherwise.
+ */
+static bool hasExtension(const std::string& path, const char* extension)
+{
+    size_t length = std::strlen(extension);
+    return path.size() >= length &&
+           path.compare(path.size() - length, length, extension) == 0;
+}
+
+/**
+ * @brief Writes the report entry of a map.
+ *
+ * @param stream The stream to write to.
+ * @param name The name of the map.
+ * @param validator The validator that checked the map, or nullptr if the map
+ * could not be read.
+ * @param isFirst Whether the entry is the first of the report.
+ */
+static void writeEntry(std::ostream& stream, const std::string& name,
+                       const MapValidator* validator, bool isFirst)
+{
+    stream << (isFirst ? "" : ",\n") << "{\"map\": ";
+    writeJsonString(stream, name);
+
+    if (validator)
+    {
+        stream << ", \"report\": ";
+        validator->writeReport(stream);
+    }
+    else
+        stream << ", \"error\": \"unreadable\"";
+
+    stream << "}";
+}
+
+/**
+ * @brief Validates every map in the files named on the command line and
+ * writes one JSON report for all of them.
+ *
+ * Usage: MapValidate [-o report.json] maps...
+ *
+ * Binary, text and WAD maps are told apart by their extension, and every map
+ * of a WAD is validated. The report is written to standard output unless a
+ * file is given.
+ *
+ * @return 0 if every map was read and has no issues, 1 if a map has issues,
+ * and 2 if a map could not be read or the arguments are invalid.
+ */
+int main(int argc, char** argv)
+{
+    std::vector<std::string> paths;
+    std::string reportPath;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+            reportPath = argv[++i];
+        else
+            paths.push_back(argv[i]);
+    }
+
+    if (paths.empty())
+    {
+        std::cerr << "Usage: " << argv[0] << " [-o report.json] maps...\n";
+        return 2;
+    }
+
+    std::ofstream file;
+    if (!reportPath.empty())
+    {
+        file.open(reportPath);
+        if (!file)
+        {
+            LOG_WARN("Failed to open file: %s", reportPath.c_str());
+            return 2;
+        }
+    }
+    std::ostream& stream = reportPath.empty() ? std::cout : file;
+
+    ThreadPool pool;
+    MapValidator validator(pool);
+    MapStore store;
+    bool hasIssues = false;
+    bool hasErrors = false;
+    bool isFirst = true;
+
+    // Validates the elements of one map and adds its entry to the report
+    auto validate = [&](const std::string& name, const MapArrays& arrays)
+    {
+        store.assign(arrays);
+        hasIssues |= !validator.validate(store).empty();
+        writeEntry(stream, name, &validator, isFirst);
+        isFirst = false;
+    };
+
+    // Adds the entry of a map that could not be read to the report
+    auto fail = [&](const std::string& name)
+    {
+        hasErrors = true;
+        writeEntry(stream, name, nullptr, isFirst);
+        isFirst = false;
+    };
+
+    stream << "[\n";
+
+    for (const std::string& path : paths)
+    {
+        if (hasExtension(path, ".wad"))
+        {
+            WadFile wad;
+            std::vector<int> maps;
+            if (wad.open(path)) maps = wad.findMaps();
+            if (maps.empty()) fail(path);
+
+            for (int marker : maps)
+            {
+                std::string name =
+                    path + ":" + std::string(wad.getLumpName(marker));
+
+                WadMapReader reader;
+                if (reader.read(wad, marker))
+                    validate(name, reader.getArrays());
+                else
+                    fail(name);
+            }
+        }
+        else if (hasExtension(path, ".udmf") || hasExtension(path, ".txt"))
+        {
+            UdmfReader reader;
+            if (reader.open(path))
+                validate(path, reader.getArrays());
+            else
+                fail(path);
+        }
+        else
+        {
+            BinaryMapReader reader;
+            if (reader.open(path))
+                validate(path, reader.getArrays());
+            else
+                fail(path);
+        }
+    }
+
+    stream << "\n]\n";
+    stream.flush();
+
+    if (hasErrors) return 2;
+    return hasIssues ? 1 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,461 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "io/BinaryMapReader.h"
+#include "io/BinaryMapWriter.h"
+#include "io/MapStreamer.h"
+#include "io/UdmfReader.h"
+#include "io/UdmfWriter.h"
+#include "io/WadFile.h"
+#include "io/WadMapReader.h"
+#include "io/WadWriter.h"
+#include "map/Map.h"
+#include "map/MapValidator.h"
+#include "map/SectorDetector.h"
+#include "map/VertexWelder.h"
+#include "utils/ThreadPool.h"
+#include "utils/macros.h"
+
+/**
+ * @brief A struct representing the steps run on every map and where the
+ * results go.
+ */
+struct Options
+{
+    // Whether vertices within the tolerance of each other are merged
+    bool weld = false;
+    // Whether the sides and sectors are rebuilt from the closed line loops
+    bool sectors = false;
+    // Whether the maps are checked for issues
+    bool validate = false;
+    // Whether the maps are written back
+    bool write = false;
+    // Whether the maps are written as chunked maps for streaming
+    bool chunk = false;
+    // The largest distance between welded vertices
+    float tolerance = 0.5f;
+    // The side length of the chunks of chunked maps
+    float chunkSize = MapStreamer::DEFAULT_CHUNK_SIZE;
+    // The extension of the written maps, or empty to keep that of the input
+    std::string format;
+    // The directory the maps are written to, or empty to write them next to
+    // their inputs
+    std::string outputDir;
+};
+
+/**
+ * @brief A struct representing the outcome of processing one file.
+ */
+struct FileResult
+{
+    // The lines describing what was done to each map of the file
+    std::string summary;
+    // The number of maps processed
+    int mapCount = 0;
+    // The number of issues found in the maps
+    size_t issueCount = 0;
+    // Whether a map could not be read or written
+    bool failed = false;
+    // The time processing the file took in milliseconds
+    double time = 0.0;
+};
+
+/**
+ * @brief Checks if a path ends with an extension.
+ *
+ * @param path The path.
+ * @param extension The extension, including the dot.
+ * @return True if the path ends with the extension, false otherwise.
+ */
+static bool hasExtension(const std::string& path, const char* extension)
+{
+    size_t length = std::strlen(extension);
+    return path.size() >= length &&
+           path.compare(path.size() - length, length, extension) == 0;
+}
+
+/**
+ * @brief Parses a comma-separated list of steps into the options.
+ *
+ * @param steps The list of steps.
+ * @param options The options to enable the steps in.
+ * @return True if every step is known, false otherwise.
+ */
+static bool parseSteps(const std::string& steps, Options& options)
+{
+    std::stringstream stream(steps);
+    std::string step;
+    while (std::getline(stream, step, ','))
+    {
+        if (step == "validate")
+            options.validate = true;
+        else if (step == "weld")
+            options.weld = options.write = true;
+        else if (step == "sectors")
+            options.sectors = options.write = true;
+        else if (step == "convert")
+            options.write = true;
+        else if (step == "chunk")
+            options.chunk = true;
+        else
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Gets the path a processed map is written to.
+ *
+ * @param options The options.
+ * @param input The path of the file the map was read from.
+ * @param mapName The name of the map.
+ * @param isSplit Whether the file holds several maps, which are written to
+ * one file each.
+ * @return The output path.
+ */
+static std::string getOutputPath(const Options& options,
+                                 const std::string& input,
+                                 const std::string& mapName, bool isSplit)
+{
+    std::filesystem::path path(input);
+    std::string extension =
+        options.format.empty() ? path.extension().string() : options.format;
+
+    std::string name = path.stem().string();
+    if (isSplit) name += "-" + mapName;
+
+    std::filesystem::path directory = path.parent_path();
+    if (!options.outputDir.empty()) directory = options.outputDir;
+    return (directory / (name + extension)).string();
+}
+
+/**
+ * @brief Writes a map as a binary, text or WAD map depending on the extension
+ * of the path.
+ *
+ * @param store The elements of the map.
+ * @param path The path of the file.
+ * @param mapName The name of the map marker if a WAD is written.
+ * @return True if the file was written, false otherwise.
+ */
+static bool writeMap(const MapStore& store, const std::string& path,
+                     const std::string& mapName)
+{
+    bool isWad = hasExtension(path, ".wad");
+    bool isText = hasExtension(path, ".udmf") || hasExtension(path, ".txt");
+
+    // Only binary maps hold prefab instances, so the others get their lines
+    if ((isWad || isText) && store.getInstanceCount() > 0)
+    {
+        MapStore baked = store;
+        baked.bakeInstances();
+        return writeMap(baked, path, mapName);
+    }
+
+    if (isWad)
+    {
+        WadWriter writer;
+        return writer.write(store, path, mapName);
+    }
+
+    if (isText)
+    {
+        UdmfWriter writer;
+        return writer.write(store, path);
+    }
+
+    BinaryMapWriter writer;
+    return writer.write(store, path);
+}
+
+/**
+ * @brief Runs the steps on one map and writes it if needed.
+ *
+ * @param options The options.
+ * @param pool The thread pool the validation runs on.
+ * @param arrays The elements of the map.
+ * @param input The path of the file the map was read from.
+ * @param mapName The name of the map.
+ * @param isSplit Whether the file holds several maps.
+ * @param result The result of the file, which the outcome is added to.
+ */
+static void processMap(const Options& options, ThreadPool& pool,
+                       const MapArrays& arrays, const std::string& input,
+                       const std::string& mapName, bool isSplit,
+                       FileResult& result)
+{
+    Map map;
+    SectorDetector detector(map.getTopology());
+    if (options.sectors) map.addListener(&detector);
+    map.load(arrays);
+
+    std::string label = isSplit ? input + ":" + mapName : input;
+    std::string summary = "  " + label + ":";
+    char buffer[128];
+
+    if (options.weld)
+    {
+        VertexWelder welder;
+        const WeldReport& report = welder.weld(map, options.tolerance);
+        std::snprintf(buffer, sizeof(buffer),
+                      " merged %d vertices, removed %d lines;",
+                      report.mergedVertices,
+                      report.degenerateLines + report.duplicateLines);
+        summary += buffer;
+    }
+
+    if (options.sectors)
+    {
+        detector.update(map);
+        std::snprintf(buffer, sizeof(buffer), " %d sectors;",
+                      map.getStore().getSectorCount());
+        summary += buffer;
+    }
+
+    if (options.validate)
+    {
+        MapValidator validator(pool);
+        size_t issueCount = validator.validate(map.getStore()).size();
+        result.issueCount += issueCount;
+        std::snprintf(buffer, sizeof(buffer), " %zu issues;", issueCount);
+        summary += buffer;
+    }
+
+    if (options.write)
+    {
+        std::string output = getOutputPath(options, input, mapName, isSplit);
+        if (writeMap(map.getStore(), output, mapName))
+            summary += " wrote " + output + ";";
+        else
+        {
+            result.failed = true;
+            summary += " failed to write " + output + ";";
+        }
+    }
+
+    if (options.chunk)
+    {
+        // The chunks are written to a directory named after the map
+        std::filesystem::path output =
+            getOutputPath(options, input, mapName, isSplit);
+        output.replace_extension(".chunks");
+        if (MapStreamer::build(map.getStore(), output.string(),
+                               options.chunkSize))
+            summary += " chunked into " + output.string() + ";";
+        else
+        {
+            result.failed = true;
+            summary += " failed to chunk into " + output.string() + ";";
+        }
+    }
+
+    summary.back() = '\n';
+    result.summary += summary;
+    ++result.mapCount;
+}
+
+/**
+ * @brief Reads every map of a file and runs the steps on it.
+ *
+ * @param options The options.
+ * @param pool The thread pool the validation runs on.
+ * @param path The path of the file.
+ * @return The outcome.
+ */
+static FileResult processFile(const Options& options, ThreadPool& pool,
+                              const std::string& path)
+{
+    auto start = std::chrono::steady_clock::now();
+    FileResult result;
+
+    // Records a map that could not be read
+    auto fail = [&result](const std::string& name)
+    {
+        result.failed = true;
+        result.summary += "  " + name + ": unreadable\n";
+    };
+
+    if (hasExtension(path, ".wad"))
+    {
+        WadFile wad;
+        std::vector<int> maps;
+        if (wad.open(path)) maps = wad.findMaps();
+        if (maps.empty()) fail(path);
+
+        for (int marker : maps)
+        {
+            std::string name(wad.getLumpName(marker));
+
+            WadMapReader reader;
+            if (reader.read(wad, marker))
+                processMap(options, pool, reader.getArrays(), path, name,
+                           maps.size() > 1, result);
+            else
+                fail(path + ":" + name);
+        }
+    }
+    else if (hasExtension(path, ".udmf") || hasExtension(path, ".txt"))
+    {
+        UdmfReader reader;
+        if (reader.open(path))
+            processMap(options, pool, reader.getArrays(), path, "MAP01",
+                       false, result);
+        else
+            fail(path);
+    }
+    else
+    {
+        BinaryMapReader reader;
+        if (reader.open(path))
+            processMap(options, pool, reader.getArrays(), path, "MAP01",
+                       false, result);
+        else
+            fail(path);
+    }
+
+    result.time = std::chrono::duration<double, std::milli>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+    return result;
+}
+
+/**
+ * @brief Runs a list of steps on every map in the files named on the command
+ * line, processing the files concurrently.
+ *
+ * Usage: mapc [-t threads] [-o dir] [-f format] [-e tolerance] [-c size]
+ * steps maps...
+ *
+ * The steps are a comma-separated list run in this order whatever the order
+ * they are listed in:
+ * - weld merges the vertices within the tolerance of each other.
+ * - sectors rebuilds the sides and sectors from the closed line loops.
+ * - validate checks the map for issues.
+ * - convert only writes the map, which the other editing steps also do.
+ * - chunk writes the map as a chunked map for streaming, with chunks of the
+ *   side length set by -c, to a directory named after the map.
+ *
+ * Binary, text and WAD maps are told apart by their extension. Written maps
+ * keep the name and format of their input unless -o sets their directory or
+ * -f their extension, such as .dvmap, .udmf or .wad, and every map of a WAD
+ * that holds several is written to its own file. A line is printed as each
+ * file finishes, followed by the total time.
+ *
+ * @return 0 if every map was processed and has no issues, 1 if a map has
+ * issues, and 2 if a map could not be read or written or the arguments are
+ * invalid.
+ */
+int main(int argc, char** argv)
+{
+    Options options;
+    size_t threadCount = 0;
+    std::string steps;
+    std::vector<std::string> paths;
+    bool isValid = true;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "-t") == 0 && hasValue)
+            threadCount = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "-o") == 0 && hasValue)
+            options.outputDir = argv[++i];
+        else if (std::strcmp(argv[i], "-f") == 0 && hasValue)
+        {
+            options.format = argv[++i];
+            if (!options.format.empty() && options.format.front() != '.')
+                options.format.insert(options.format.begin(), '.');
+        }
+        else if (std::strcmp(argv[i], "-e") == 0 && hasValue)
+            options.tolerance = std::strtof(argv[++i], nullptr);
+        else if (std::strcmp(argv[i], "-c") == 0 && hasValue)
+            options.chunkSize = std::strtof(argv[++i], nullptr);
+        else if (argv[i][0] == '-')
+            isValid = false;
+        else if (steps.empty())
+            steps = argv[i];
+        else
+            paths.push_back(argv[i]);
+    }
+
+    if (!isValid || paths.empty() || !parseSteps(steps, options) ||
+        options.tolerance <= 0.0f || !(options.chunkSize > 0.0f))
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " [-t threads] [-o dir] [-f format] [-e tolerance]"
+                     " [-c size] steps maps...\n"
+                     "Steps: a comma-separated list of validate, weld,"
+                     " sectors, convert and chunk\n";
+        return 2;
+    }
+
+    // A format on its own asks for the maps to be converted
+    if (!options.format.empty()) options.write = true;
+
+    if (!options.outputDir.empty())
+    {
+        std::error_code error;
+        std::filesystem::create_directories(options.outputDir, error);
+        if (error)
+        {
+            LOG_WARN("Failed to create directory: %s",
+                     options.outputDir.c_str());
+            return 2;
+        }
+    }
+
+    ThreadPool pool(threadCount);
+    std::vector<FileResult> results(paths.size());
+    std::mutex outputMutex;
+    size_t finishedCount = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Each file is one chunk, so the files are claimed one at a time by the
+    // workers and the calling thread
+    pool.forEachChunk(
+        paths.size(), 1,
+        [&](size_t chunk, size_t begin, size_t end)
+        {
+            FileResult& result = results[chunk];
+            result = processFile(options, pool, paths[chunk]);
+
+            std::lock_guard<std::mutex> lock(outputMutex);
+            ++finishedCount;
+            std::printf("[%zu/%zu] %s in %.3f ms\n%s", finishedCount,
+                        paths.size(), paths[chunk].c_str(), result.time,
+                        result.summary.c_str());
+            std::fflush(stdout);
+        });
+
+    double time = std::chrono::duration<double, std::milli>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+
+    int mapCount = 0;
+    size_t issueCount = 0;
+    bool hasErrors = false;
+    for (const FileResult& result : results)
+    {
+        mapCount += result.mapCount;
+        issueCount += result.issueCount;
+        hasErrors |= result.failed;
+    }
+
+    std::printf("Processed %d maps from %zu files in %.3f ms with %zu worker "
+                "threads\n",
+                mapCount, paths.size(), time, pool.getThreadCount());
+    if (options.validate) std::printf("Found %zu issues\n", issueCount);
+
+    if (hasErrors) return 2;
+    return issueCount > 0 ? 1 : 0;
+}
\ No newline at end of file
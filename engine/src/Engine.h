@@ -25,7 +25,10 @@
 #include "events/Event.h"
 #include "events/KeyEvent.h"
 #include "events/MouseEvent.h"
+#include "graphics/DynamicMesh.h"
+#include "graphics/Framebuffer.h"
 #include "graphics/Mesh.h"
 #include "graphics/Shader.h"
 #include "graphics/Texture.h"
+#include "graphics/TextureBuffer.h"
 #include "utils/EngineDebug.h"
\ No newline at end of file
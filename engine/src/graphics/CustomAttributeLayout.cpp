@@ -5,9 +5,10 @@
 namespace Engine
 {
     int CustomAttributeLayout::addAttribute(AttributeType type,
-                                            unsigned int count)
+                                            unsigned int count,
+                                            unsigned int divisor)
     {
-        elements.emplace_back(type, count, GL_FALSE);
+        elements.emplace_back(type, count, GL_FALSE, divisor);
         stride += count * CustomAttribute::getSizeOfType(type);
 
         return Vertex::getAttributeCount() + elements.size() - 1;
@@ -29,29 +29,33 @@ namespace Engine
      * This struct represents a single custom attribute in a custom vertex
      * attribute layout. Each element has a type indicating the OpenGL type
      * of the vertex attribute, a count indicating the number of elements in
-     * the vertex attribute, and a flag indicating whether the data should
-     * be normalized.
+     * the vertex attribute, a flag indicating whether the data should be
+     * normalized, and a divisor indicating how often the attribute advances
+     * when drawing instances.
      */
     struct CustomAttribute
     {
         AttributeType type;
         unsigned int count;
         unsigned char normalized;
+        unsigned int divisor;
 
         /**
          * @brief Constructs a new CustomAttribute object.
          *
          * This constructor creates a new CustomAttribute object with the
-         * specified type, count, and normalized flag.
+         * specified type, count, normalized flag and divisor.
          *
          * @param type The type of the attribute.
          * @param count The number of elements in the attribute.
          * @param normalized A flag indicating whether the data should be
          * normalized.
+         * @param divisor The number of instances drawn before the attribute
+         * advances, or 0 if it advances per vertex. Defaults to 0.
          */
         CustomAttribute(AttributeType type, unsigned int count,
-                        unsigned char normalized)
-            : type(type), count(count), normalized(normalized)
+                        unsigned char normalized, unsigned int divisor = 0)
+            : type(type), count(count), normalized(normalized), divisor(divisor)
         {
         }
 
@@ -104,14 +108,18 @@ namespace Engine
          * @brief Adds a new attribute to the layout.
          *
          * This method adds a new attribute to the layout with the specified
-         * type and count. The method returns the index of the attribute in the
-         * layout.
+         * type, count and divisor. The method returns the index of the
+         * attribute in the layout. An attribute with a nonzero divisor holds
+         * one element per instance rather than one per vertex.
          *
          * @param type The type of the attribute.
          * @param count The number of elements in the attribute.
+         * @param divisor The number of instances drawn before the attribute
+         * advances, or 0 if it advances per vertex. Defaults to 0.
          * @return The index of the attribute in the layout.
          */
-        int addAttribute(AttributeType type, unsigned int count);
+        int addAttribute(AttributeType type, unsigned int count,
+                         unsigned int divisor = 0);
 
         /**
          * @brief Gets the element at the specified index.
@@ -0,0 +1,168 @@
+#include "DynamicMesh.h"
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+
+namespace Engine
+{
+    DynamicMesh::DynamicMesh(
+        const std::string& name, MeshType type,
+        const std::optional<CustomAttributeLayout>& customLayout)
+        : name(name),
+          type(type),
+          customLayout(customLayout.value_or(CustomAttributeLayout()))
+    {
+        // Create the vertex array
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &vbo.id);
+        glGenBuffers(1, &ibo.id);
+
+        // Bind the vertex array
+        glBindVertexArray(vao);
+
+        // Bind the buffers so that the vertex array records them
+        glBindBuffer(GL_ARRAY_BUFFER, vbo.id);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo.id);
+
+        // Set the vertex attribute pointers
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                              (void*)0);
+
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                              (void*)offsetof(Vertex, color));
+
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                              (void*)offsetof(Vertex, texCoords));
+
+        // Create the custom attribute buffer objects
+        const auto& elements = this->customLayout.getElements();
+        customBuffers.resize(elements.size());
+        for (int i = 0; i < elements.size(); ++i)
+        {
+            const CustomAttribute& attribute = elements.at(i);
+            int index = Vertex::getAttributeCount() + i;
+
+            glGenBuffers(1, &customBuffers.at(i).id);
+            glBindBuffer(GL_ARRAY_BUFFER, customBuffers.at(i).id);
+            glEnableVertexAttribArray(index);
+
+            // Integer attributes must not be converted to floats
+            if (attribute.type == AttributeType::FLOAT)
+                glVertexAttribPointer(index, attribute.count, GL_FLOAT,
+                                      attribute.normalized, 0, (void*)0);
+            else
+                glVertexAttribIPointer(index, attribute.count,
+                                       static_cast<GLenum>(attribute.type), 0,
+                                       (void*)0);
+
+            if (attribute.divisor != 0)
+                glVertexAttribDivisor(index, attribute.divisor);
+        }
+
+        // Unbind the vertex array
+        glBindVertexArray(0);
+        // Unbind the vertex buffer
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        // Unbind the index buffer
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+
+    DynamicMesh::~DynamicMesh()
+    {
+        // Delete the vertex array and buffers
+        glDeleteVertexArrays(1, &vao);
+        glDeleteBuffers(1, &vbo.id);
+        glDeleteBuffers(1, &ibo.id);
+
+        // Delete the custom attribute buffers
+        for (const BufferObject& buffer : customBuffers)
+            if (buffer.id) glDeleteBuffers(1, &buffer.id);
+    }
+
+    void DynamicMesh::updateVertices(const std::vector<Vertex>& vertices,
+                                     size_t first, size_t count)
+    {
+        vertexCount = vertices.size();
+        uploadRange(GL_ARRAY_BUFFER, vbo, vertices.data(),
+                    vertices.size() * sizeof(Vertex), first * sizeof(Vertex),
+                    count * sizeof(Vertex));
+    }
+
+    void DynamicMesh::updateIndices(const std::vector<unsigned int>& indices,
+                                    size_t first, size_t count)
+    {
+        indexCount = indices.size();
+        uploadRange(GL_ELEMENT_ARRAY_BUFFER, ibo, indices.data(),
+                    indices.size() * sizeof(unsigned int),
+                    first * sizeof(unsigned int),
+                    count * sizeof(unsigned int));
+    }
+
+    void DynamicMesh::draw(const Shader& shader)
+    {
+        if (indexCount == 0) return;
+
+        glBindVertexArray(vao);
+        glDrawElements(static_cast<GLenum>(type), indexCount, GL_UNSIGNED_INT,
+                       nullptr);
+        glBindVertexArray(0);
+    }
+
+    void DynamicMesh::drawArrays(const Shader& shader, MeshType type)
+    {
+        if (vertexCount == 0) return;
+
+        glBindVertexArray(vao);
+        glDrawArrays(static_cast<GLenum>(type), 0, vertexCount);
+        glBindVertexArray(0);
+    }
+
+    void DynamicMesh::drawInstanced(const Shader& shader,
+                                    size_t instanceCount)
+    {
+        if (indexCount == 0 || instanceCount == 0) return;
+
+        glBindVertexArray(vao);
+        glDrawElementsInstanced(static_cast<GLenum>(type), indexCount,
+                                GL_UNSIGNED_INT, nullptr, instanceCount);
+        glBindVertexArray(0);
+    }
+
+    void DynamicMesh::uploadRange(GLenum target, BufferObject& buffer,
+                                  const void* data, size_t size, size_t offset,
+                                  size_t length)
+    {
+        if (size == 0) return;
+
+        // Bind the vertex array so that binding the index buffer does not
+        // modify another vertex array
+        glBindVertexArray(vao);
+        glBindBuffer(target, buffer.id);
+
+        if (size > buffer.capacity)
+        {
+            // Reallocate with room to grow and upload everything
+            buffer.capacity = std::max(size, buffer.capacity * 2);
+            glBufferData(target, buffer.capacity, nullptr, GL_DYNAMIC_DRAW);
+            glBufferSubData(target, 0, size, data);
+        }
+        else
+        {
+            // Clamp the range to the data, which may have shrunk
+            length = offset < size ? std::min(length, size - offset) : 0;
+            if (length > 0)
+                glBufferSubData(target, offset, length,
+                                static_cast<const char*>(data) + offset);
+        }
+
+        // Unbind the vertex array
+        glBindVertexArray(0);
+        // Unbind the vertex buffer
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+}  // namespace Engine
\ No newline at end of file
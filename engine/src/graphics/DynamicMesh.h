@@ -0,0 +1,234 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "CustomAttributeLayout.h"
+#include "Mesh.h"
+#include "Shader.h"
+#include "Vertex.h"
+#include "utils/EngineDebug.h"
+
+namespace Engine
+{
+    /**
+     * @brief A class that represents a mesh whose buffers persist on the GPU.
+     *
+     * Unlike Mesh, which uploads all of its data when it is constructed, a
+     * DynamicMesh keeps its buffer objects alive and lets the caller upload
+     * only the ranges of the vertex, index and custom buffers that have
+     * changed. Buffers grow geometrically, so a range update only reallocates
+     * the buffer when the data no longer fits.
+     */
+    class DynamicMesh
+    {
+    public:
+        /**
+         * @brief Constructs a new DynamicMesh object.
+         *
+         * This constructor creates a new DynamicMesh object with the specified
+         * name, type and optionally a custom attribute layout. The buffers are
+         * created empty.
+         *
+         * @param name The name of the mesh.
+         * @param type The type of the mesh. Defaults to MeshType::TRIANGLES.
+         * @param customLayout An optional custom attribute layout for the mesh.
+         * Defaults to std::nullopt.
+         */
+        DynamicMesh(const std::string& name,
+                    MeshType type = MeshType::TRIANGLES,
+                    const std::optional<CustomAttributeLayout>& customLayout =
+                        std::nullopt);
+
+        /**
+         * @brief Destroys the DynamicMesh object.
+         *
+         * This destructor destroys the DynamicMesh object and frees any
+         * resources associated with it.
+         */
+        ~DynamicMesh();
+
+        DynamicMesh(const DynamicMesh&) = delete;
+        DynamicMesh& operator=(const DynamicMesh&) = delete;
+
+        /**
+         * @brief Uploads a range of vertices to the mesh.
+         *
+         * This method uploads the vertices in [first, first + count) of the
+         * specified vertex list and sets the vertex count of the mesh to the
+         * size of the list. If the list no longer fits in the vertex buffer,
+         * the buffer is reallocated and the whole list is uploaded.
+         *
+         * @param vertices The full vertex list of the mesh.
+         * @param first The index of the first vertex to upload.
+         * @param count The number of vertices to upload.
+         */
+        void updateVertices(const std::vector<Vertex>& vertices, size_t first,
+                            size_t count);
+
+        /**
+         * @brief Uploads a range of indices to the mesh.
+         *
+         * This method uploads the indices in [first, first + count) of the
+         * specified index list and sets the index count of the mesh to the
+         * size of the list. If the list no longer fits in the index buffer,
+         * the buffer is reallocated and the whole list is uploaded.
+         *
+         * @param indices The full index list of the mesh.
+         * @param first The index of the first index to upload.
+         * @param count The number of indices to upload.
+         */
+        void updateIndices(const std::vector<unsigned int>& indices,
+                           size_t first, size_t count);
+
+        /**
+         * @brief Uploads a range of a custom buffer to the mesh.
+         *
+         * This method uploads the elements in [first, first + count) of the
+         * specified custom buffer at the specified attribute index. Ranges are
+         * given in vertices, not in components.
+         *
+         * @tparam T The type of the buffer.
+         * @param index The index of the custom attribute in the shader.
+         * @param buffer The full custom buffer.
+         * @param first The index of the first vertex to upload.
+         * @param count The number of vertices to upload.
+         */
+        template <typename T>
+        void updateCustomBuffer(int index, const std::vector<T>& buffer,
+                                size_t first, size_t count)
+        {
+            const CustomAttribute* attribute = customLayout.getElement(index);
+
+            if (!attribute)
+            {
+                LOG_WARN("Custom attribute at index %d not found", index);
+                return;
+            }
+
+            ASSERT(CustomAttribute::getSizeOfType(attribute->type) ==
+                   sizeof(T));
+
+            size_t stride = attribute->count * sizeof(T);
+            uploadRange(GL_ARRAY_BUFFER,
+                        customBuffers.at(index - Vertex::getAttributeCount()),
+                        buffer.data(), buffer.size() * sizeof(T),
+                        first * stride, count * stride);
+        }
+
+        /**
+         * @brief Draws the mesh.
+         *
+         * This method draws the uploaded indices of the mesh using the
+         * specified shader.
+         *
+         * @param shader The shader to use when drawing the mesh.
+         */
+        void draw(const Shader& shader);
+
+        /**
+         * @brief Draws the vertices of the mesh without indices.
+         *
+         * This method draws the uploaded vertices of the mesh in order as
+         * primitives of the specified type, ignoring the index buffer.
+         *
+         * @param shader The shader to use when drawing the mesh.
+         * @param type The type of primitives to draw.
+         */
+        void drawArrays(const Shader& shader, MeshType type);
+
+        /**
+         * @brief Draws several instances of the mesh.
+         *
+         * This method draws the uploaded indices of the mesh the specified
+         * number of times in a single draw call. Custom attributes with a
+         * nonzero divisor advance per instance, so they can hold the data
+         * that differs between instances.
+         *
+         * @param shader The shader to use when drawing the mesh.
+         * @param instanceCount The number of instances to draw.
+         */
+        void drawInstanced(const Shader& shader, size_t instanceCount);
+
+        /**
+         * @brief Gets the name of the mesh.
+         *
+         * This method returns the name of the mesh.
+         *
+         * @return The name of the mesh.
+         */
+        inline const std::string& getName() const { return name; }
+
+        /**
+         * @brief Gets the number of vertices in the mesh.
+         *
+         * This method returns the number of vertices last uploaded.
+         *
+         * @return The number of vertices in the mesh.
+         */
+        inline size_t getVertexCount() const { return vertexCount; }
+
+        /**
+         * @brief Gets the number of indices in the mesh.
+         *
+         * This method returns the number of indices last uploaded.
+         *
+         * @return The number of indices in the mesh.
+         */
+        inline size_t getIndexCount() const { return indexCount; }
+
+    private:
+        /**
+         * @brief A struct representing a GPU buffer and its allocated size.
+         */
+        struct BufferObject
+        {
+            // The OpenGL ID of the buffer
+            unsigned int id = 0;
+            // The allocated size of the buffer in bytes
+            size_t capacity = 0;
+        };
+
+        // The name of the mesh
+        std::string name;
+        // The type of the mesh
+        MeshType type;
+        // The custom attribute layout of the mesh
+        CustomAttributeLayout customLayout;
+
+        // The vertex array object
+        unsigned int vao;
+        // The vertex buffer object
+        BufferObject vbo;
+        // The index buffer object
+        BufferObject ibo;
+        // A vector of custom vertex buffer objects
+        std::vector<BufferObject> customBuffers;
+
+        // The number of vertices in the mesh
+        size_t vertexCount = 0;
+        // The number of indices in the mesh
+        size_t indexCount = 0;
+
+        /**
+         * @brief Uploads a byte range of the specified data to a buffer.
+         *
+         * This method uploads [offset, offset + length) of the data with
+         * glBufferSubData. If the data does not fit in the buffer, the buffer
+         * is reallocated with room to grow and the whole data is uploaded.
+         *
+         * @param target The target to bind the buffer to.
+         * @param buffer The buffer to upload to.
+         * @param data The full data of the buffer.
+         * @param size The size of the full data in bytes.
+         * @param offset The offset of the range in bytes.
+         * @param length The length of the range in bytes.
+         */
+        void uploadRange(GLenum target, BufferObject& buffer, const void* data,
+                         size_t size, size_t offset, size_t length);
+    };
+}  // namespace Engine
\ No newline at end of file
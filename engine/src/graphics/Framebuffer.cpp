@@ -0,0 +1,132 @@
+#include "Framebuffer.h"
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "utils/EngineDebug.h"
+
+namespace Engine
+{
+    Framebuffer::Framebuffer(int width, int height)
+        : width(width), height(height)
+    {
+        ASSERT(width > 0 && height > 0);
+
+        // Generate the color texture
+        glGenTextures(1, &textureId);
+        glBindTexture(GL_TEXTURE_2D, textureId);
+
+        // Set the texture parameters
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        allocate();
+
+        // Generate the framebuffer and attach the texture to it
+        glGenFramebuffers(1, &id);
+        glBindFramebuffer(GL_FRAMEBUFFER, id);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                               GL_TEXTURE_2D, textureId, 0);
+
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) !=
+            GL_FRAMEBUFFER_COMPLETE)
+            LOG_WARN("Framebuffer of %dx%d is incomplete", width, height);
+
+        // Unbind the framebuffer
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    Framebuffer::~Framebuffer()
+    {
+        // Delete the framebuffer and the texture
+        glDeleteFramebuffers(1, &id);
+        glDeleteTextures(1, &textureId);
+    }
+
+    void Framebuffer::resize(int width, int height)
+    {
+        ASSERT(width > 0 && height > 0);
+
+        if (width == this->width && height == this->height) return;
+
+        this->width = width;
+        this->height = height;
+
+        glBindTexture(GL_TEXTURE_2D, textureId);
+        allocate();
+    }
+
+    void Framebuffer::bind()
+    {
+        // Save the viewport of the previous render target
+        glGetIntegerv(GL_VIEWPORT, previousViewport);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, id);
+        glViewport(0, 0, width, height);
+    }
+
+    void Framebuffer::unbind() const
+    {
+        glDisable(GL_SCISSOR_TEST);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(previousViewport[0], previousViewport[1],
+                   previousViewport[2], previousViewport[3]);
+    }
+
+    void Framebuffer::clear(const glm::vec4& color) const
+    {
+        // Save the clear color used for the window
+        float previousColor[4];
+        glGetFloatv(GL_COLOR_CLEAR_VALUE, previousColor);
+
+        glClearColor(color.r, color.g, color.b, color.a);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        glClearColor(previousColor[0], previousColor[1], previousColor[2],
+                     previousColor[3]);
+    }
+
+    void Framebuffer::setScissor(int x, int y, int width, int height) const
+    {
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(x, y, width, height);
+    }
+
+    void Framebuffer::clearScissor() const { glDisable(GL_SCISSOR_TEST); }
+
+    void Framebuffer::blit() const
+    {
+        int viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, id);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        glBlitFramebuffer(0, 0, width, height, viewport[0], viewport[1],
+                          viewport[0] + viewport[2], viewport[1] + viewport[3],
+                          GL_COLOR_BUFFER_BIT, GL_LINEAR);
+
+        // Unbind the framebuffer
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    void Framebuffer::bindTexture(unsigned int slot) const
+    {
+        // Activate the texture slot
+        glActiveTexture(GL_TEXTURE0 + slot);
+
+        // Bind the texture
+        glBindTexture(GL_TEXTURE_2D, textureId);
+    }
+
+    void Framebuffer::unbindTexture() const { glBindTexture(GL_TEXTURE_2D, 0); }
+
+    void Framebuffer::allocate()
+    {
+        // The texture must be bound
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA,
+                     GL_UNSIGNED_BYTE, nullptr);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+}  // namespace Engine
\ No newline at end of file
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+namespace Engine
+{
+    /**
+     * @brief A class that encapsulates an OpenGL framebuffer object.
+     *
+     * This class renders into an offscreen color texture instead of the
+     * window, so that a scene can be drawn once and then drawn again as a
+     * texture, or patched one region at a time with the scissor test.
+     */
+    class Framebuffer
+    {
+    public:
+        /**
+         * @brief Creates a new Framebuffer object.
+         *
+         * This constructor creates a new Framebuffer object with an RGBA color
+         * texture of the specified size.
+         *
+         * @param width The width of the color texture.
+         * @param height The height of the color texture.
+         */
+        Framebuffer(int width, int height);
+
+        /**
+         * @brief Destroys the Framebuffer object.
+         *
+         * This destructor destroys the Framebuffer object and frees any
+         * resources associated with it.
+         */
+        ~Framebuffer();
+
+        Framebuffer(const Framebuffer&) = delete;
+        Framebuffer& operator=(const Framebuffer&) = delete;
+
+        /**
+         * @brief Resizes the color texture of the Framebuffer.
+         *
+         * This method reallocates the color texture if the size has changed,
+         * which leaves its contents undefined.
+         *
+         * @param width The new width of the color texture.
+         * @param height The new height of the color texture.
+         */
+        void resize(int width, int height);
+
+        /**
+         * @brief Binds the Framebuffer as the render target.
+         *
+         * This method binds the Framebuffer so that subsequent draw calls
+         * render into its color texture, and sets the viewport to cover the
+         * texture. The previous viewport is restored by unbind.
+         */
+        void bind();
+
+        /**
+         * @brief Unbinds the Framebuffer, making the window the render target.
+         *
+         * This method rebinds the default framebuffer, disables the scissor
+         * test, and restores the viewport saved by bind.
+         */
+        void unbind() const;
+
+        /**
+         * @brief Clears the color texture to the specified color.
+         *
+         * This method clears the whole texture, or only the scissor region if
+         * one is set. The Framebuffer must be bound.
+         *
+         * @param color The color to clear to.
+         */
+        void clear(const glm::vec4& color) const;
+
+        /**
+         * @brief Restricts clearing and drawing to a region of the texture.
+         *
+         * This method enables the scissor test with the specified region, in
+         * texels from the bottom-left corner. The Framebuffer must be bound.
+         *
+         * @param x The left edge of the region.
+         * @param y The bottom edge of the region.
+         * @param width The width of the region.
+         * @param height The height of the region.
+         */
+        void setScissor(int x, int y, int width, int height) const;
+
+        /**
+         * @brief Lifts the restriction set by setScissor.
+         */
+        void clearScissor() const;
+
+        /**
+         * @brief Copies the color texture to the window.
+         *
+         * This method copies the color texture over the viewport of the
+         * window, stretching it if their sizes differ. Unlike drawing the
+         * texture on a quad, the copy needs no shader and ignores blending.
+         * The Framebuffer must not be bound.
+         */
+        void blit() const;
+
+        /**
+         * @brief Binds the color texture to the specified texture slot.
+         *
+         * This method binds the color texture so that a sampler2D uniform set
+         * to the slot reads what was rendered into the Framebuffer.
+         *
+         * @param slot The texture slot to bind the color texture to.
+         */
+        void bindTexture(unsigned int slot = 0) const;
+
+        /**
+         * @brief Unbinds the color texture from the current texture slot.
+         */
+        void unbindTexture() const;
+
+        /**
+         * @brief Gets the width of the color texture.
+         *
+         * @return The width of the color texture.
+         */
+        inline int getWidth() const { return width; }
+
+        /**
+         * @brief Gets the height of the color texture.
+         *
+         * @return The height of the color texture.
+         */
+        inline int getHeight() const { return height; }
+
+    private:
+        // The OpenGL ID of the framebuffer
+        unsigned int id = 0;
+        // The OpenGL ID of the color texture
+        unsigned int textureId = 0;
+        // The width of the color texture
+        int width;
+        // The height of the color texture
+        int height;
+        // The viewport to restore when the framebuffer is unbound
+        int previousViewport[4] = {0, 0, 0, 0};
+
+        /**
+         * @brief Allocates the storage of the color texture for the current
+         * size.
+         */
+        void allocate();
+    };
+}  // namespace Engine
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include "TextureBuffer.h"
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+
+namespace Engine
+{
+    TextureBuffer::TextureBuffer()
+    {
+        // Generate the buffer and the texture viewing it
+        glGenBuffers(1, &bufferId);
+        glGenTextures(1, &textureId);
+
+        glBindTexture(GL_TEXTURE_BUFFER, textureId);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, bufferId);
+
+        // Unbind the texture
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+
+    TextureBuffer::~TextureBuffer()
+    {
+        // Delete the texture and the buffer
+        glDeleteTextures(1, &textureId);
+        glDeleteBuffers(1, &bufferId);
+    }
+
+    void TextureBuffer::update(const std::vector<uint32_t>& words,
+                               size_t first, size_t count)
+    {
+        size_t size = words.size() * sizeof(uint32_t);
+        if (size == 0) return;
+
+        glBindBuffer(GL_TEXTURE_BUFFER, bufferId);
+
+        if (size > capacity)
+        {
+            // Reallocate with room to grow and upload everything
+            capacity = std::max(size, capacity * 2);
+            glBufferData(GL_TEXTURE_BUFFER, capacity, nullptr, GL_DYNAMIC_DRAW);
+            glBufferSubData(GL_TEXTURE_BUFFER, 0, size, words.data());
+
+            // Attach the new data store to the texture
+            glBindTexture(GL_TEXTURE_BUFFER, textureId);
+            glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, bufferId);
+            glBindTexture(GL_TEXTURE_BUFFER, 0);
+        }
+        else
+        {
+            // Clamp the range to the data, which may have shrunk
+            size_t end = std::min(first + count, words.size());
+            if (first < end)
+                glBufferSubData(GL_TEXTURE_BUFFER, first * sizeof(uint32_t),
+                                (end - first) * sizeof(uint32_t),
+                                words.data() + first);
+        }
+
+        // Unbind the buffer
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    void TextureBuffer::bind(unsigned int slot) const
+    {
+        // Activate the texture slot
+        glActiveTexture(GL_TEXTURE0 + slot);
+
+        // Bind the texture
+        glBindTexture(GL_TEXTURE_BUFFER, textureId);
+    }
+
+    void TextureBuffer::unbind() const
+    {
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+}  // namespace Engine
\ No newline at end of file
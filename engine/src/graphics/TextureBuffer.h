@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Engine
+{
+    /**
+     * @brief A class that encapsulates an OpenGL buffer texture.
+     *
+     * This class stores an array of 32-bit unsigned integers in a buffer object
+     * that shaders read through a usamplerBuffer with texelFetch. Like
+     * DynamicMesh, it keeps its buffer alive and lets the caller upload only
+     * the range of words that has changed, growing the buffer geometrically
+     * when the data no longer fits.
+     */
+    class TextureBuffer
+    {
+    public:
+        /**
+         * @brief Creates a new TextureBuffer object.
+         *
+         * This constructor creates an empty buffer and a texture viewing it
+         * as one GL_R32UI texel per word.
+         */
+        TextureBuffer();
+
+        /**
+         * @brief Destroys the TextureBuffer object.
+         *
+         * This destructor destroys the TextureBuffer object and frees any
+         * resources associated with it.
+         */
+        ~TextureBuffer();
+
+        TextureBuffer(const TextureBuffer&) = delete;
+        TextureBuffer& operator=(const TextureBuffer&) = delete;
+
+        /**
+         * @brief Uploads a range of words to the buffer.
+         *
+         * This method uploads the words in [first, first + count) of the
+         * specified word list. If the list no longer fits in the buffer, the
+         * buffer is reallocated and the whole list is uploaded.
+         *
+         * @param words The full word list of the buffer.
+         * @param first The index of the first word to upload.
+         * @param count The number of words to upload.
+         */
+        void update(const std::vector<uint32_t>& words, size_t first,
+                    size_t count);
+
+        /**
+         * @brief Binds the TextureBuffer to the current OpenGL context.
+         *
+         * This method binds the texture to the specified texture slot so that
+         * a usamplerBuffer uniform set to the slot reads from it.
+         *
+         * @param slot The texture slot to bind the TextureBuffer to.
+         */
+        void bind(unsigned int slot = 0) const;
+
+        /**
+         * @brief Unbinds the TextureBuffer from the current OpenGL context.
+         */
+        void unbind() const;
+
+    private:
+        // The OpenGL ID of the texture
+        unsigned int textureId = 0;
+        // The OpenGL ID of the buffer
+        unsigned int bufferId = 0;
+        // The allocated size of the buffer in bytes
+        size_t capacity = 0;
+    };
+}  // namespace Engine
\ No newline at end of file